@@ -0,0 +1,100 @@
+package main
+
+import "fmt"
+
+// 每個 worker 從 jobs 取工作，把結果送到 results，jobs 關閉後通知 done
+func worker(id int, jobs chan int, results chan int, done chan bool) {
+	for j := range jobs {
+		s := 0
+		for i := 1; i <= j; i++ {
+			s += i * i
+		}
+		results <- s
+	}
+	done <- true
+}
+
+// 開 workers 個 worker，送出 1..n 的工作，回傳所有結果的總和
+func pool(workers int, n int, jobs chan int) int {
+	results := make(chan int, n)
+	done := make(chan bool)
+	for w := 1; w <= workers; w++ {
+		go worker(w, jobs, results, done)
+	}
+	for j := 1; j <= n; j++ {
+		jobs <- j
+	}
+	close(jobs)
+	for w := 1; w <= workers; w++ {
+		<-done
+	}
+	close(results)
+	total := 0
+	for r := range results {
+		total += r
+	}
+	return total
+}
+
+func main() {
+	// 無緩衝的 jobs：每次送出都要等某個 worker 接收
+	fmt.Println("unbuffered pool", pool(4, 200, make(chan int)))
+	// 有緩衝的 jobs：送出先放進緩衝
+	fmt.Println("buffered pool", pool(8, 200, make(chan int, 16)))
+
+	// select 的 default：沒有分支能立即完成時選 default
+	c := make(chan int, 1)
+	select {
+	case v := <-c:
+		fmt.Println("unexpected", v)
+	default:
+		fmt.Println("empty, default taken")
+	}
+	c <- 7
+	select {
+	case v := <-c:
+		fmt.Println("received", v)
+	default:
+		fmt.Println("unexpected default")
+	}
+	select {
+	case c <- 8:
+		fmt.Println("sent 8")
+	default:
+		fmt.Println("unexpected default")
+	}
+	select {
+	case c <- 9:
+		fmt.Println("unexpected send")
+	default:
+		fmt.Println("full, default taken")
+	}
+
+	// 已關閉的 channel：先取完緩衝中的值，之後得到零值與 ok == false
+	q := make(chan int, 2)
+	q <- 1
+	q <- 2
+	close(q)
+	for i := 0; i < 3; i++ {
+		v, ok := <-q
+		fmt.Println("recv", v, ok)
+	}
+	close(c)
+	v, ok := <-c
+	fmt.Println("drained", v, ok)
+	v, ok = <-c
+	fmt.Println("closed", v, ok)
+}
+
+// 預期輸出（ZHCL_THREADS=1、2、8 皆相同）：
+// unbuffered pool 136016700
+// buffered pool 136016700
+// empty, default taken
+// received 7
+// sent 8
+// full, default taken
+// recv 1 true
+// recv 2 true
+// recv 0 false
+// drained 8 true
+// closed 0 false
@@ -0,0 +1,18 @@
+package main
+
+import "fmt"
+
+func main() {
+	c := make(chan int, 2)
+	c <- 1
+	c <- 2
+	fmt.Println("buffer full")
+	// 緩衝已滿且沒有其他 goroutine 會接收：所有 goroutine 都在等待，程式以 deadlock 結束
+	c <- 3
+	fmt.Println("unreachable")
+}
+
+// 預期輸出：
+// buffer full
+// （標準錯誤）[vm] all goroutines are asleep - deadlock
+// 結束碼 8（Go 本身印出 "fatal error: all goroutines are asleep - deadlock!"，結束碼 2）
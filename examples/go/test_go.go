@@ -1,7 +1,7 @@
-package main
-
-import "fmt"
-
-func main() {
-    fmt.Println("Hello from Go!")
+package main
+
+import "fmt"
+
+func main() {
+    fmt.Println("Hello from Go!")
 }
\ No newline at end of file
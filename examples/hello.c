@@ -1,17 +1,17 @@
-#include <stdio.h>
-#include <stdlib.h>
-#include <stdbool.h>
-#include <string.h>
-#include <math.h>
-#include <time.h>
-
-int main() {
-    srand(time(NULL));
-
-printf("%s", "=== 中文編程語言演示 ===\n");
-int 隨機 = 隨機數();
-printf("%s", "隨機數值: ");
-printf("%d", 隨機);
-return;
-    return 0;
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+int main() {
+    srand(time(NULL));
+
+printf("%s", "=== 中文編程語言演示 ===\n");
+int 隨機 = 隨機數();
+printf("%s", "隨機數值: ");
+printf("%d", 隨機);
+return;
+    return 0;
 }
\ No newline at end of file
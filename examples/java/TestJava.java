@@ -1,5 +1,5 @@
-public class TestJava {
-    public static void main(String[] args) {
-        System.out.println("Hello from Java!");
-    }
+public class TestJava {
+    public static void main(String[] args) {
+        System.out.println("Hello from Java!");
+    }
 }
\ No newline at end of file
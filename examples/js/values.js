@@ -0,0 +1,30 @@
+// js-lite 的值與型別：數值一律為 f64，型別固定的變數用型別化操作碼，混用型別的變數改存標記值
+let n = 7
+let s = "js"
+const ok = true
+console.log(n, 2.5, s, ok, null)
+console.log(n / 2, n % -3, -7 % 3, 5 % 0, -0)
+console.log(5 * 1000000000000 * 1000000000, 9007199254740993, 0.1 + 0.2)
+console.log("n = " + n + ", half = " + n / 2 + ", ok = " + ok)
+console.log("6" * 2, "3" - 1, true + 1, -false)
+console.log("1" == 1, "1" === 1, null == 0, 0 == false, n != "7")
+
+// x 先後是數值、字串、布林，成為標記值
+let x = 41
+x = x + 1
+console.log(x)
+x = "4" + x
+console.log(x, x - 1)
+x = false
+console.log(x, x + 1, x == 0)
+
+// 預期輸出（與 node 相同）：
+// 7 2.5 js true null
+// 3.5 1 -1 NaN -0
+// 5e+21 9007199254740992 0.30000000000000004
+// n = 7, half = 3.5, ok = true
+// 12 2 2 -0
+// true false false true false
+// 42
+// 442 441
+// false 1 true
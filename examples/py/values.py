@@ -0,0 +1,32 @@
+# py-lite 的值與型別：型別固定的變數用型別化操作碼，混用型別的變數改存標記值
+n = 7
+f = 2.5
+s = "py"
+ok = True
+print(n, f, s, ok, None)
+print(n / 2, n * f, 10 / 4, 1 / 3)
+print(0.1 + 0.2, 1e16, 1e-5, 2.0, -0.0)
+print(-7 % 3, 7 % -3, -7.5 % 2, n % -3)
+print(s + "-lite", n == 7, f < n, s == "py")
+
+# x 先後是整數、字串、小數、None，成為標記值
+x = 41
+x = x + 1
+print(x)
+x = "forty-two"
+print(x)
+x = 4.5
+print(x % -2, x * 2)
+x = None
+print(x)
+
+# 預期輸出（與 python3 相同）：
+# 7 2.5 py True None
+# 3.5 17.5 2.5 0.3333333333333333
+# 0.30000000000000004 1e+16 1e-05 2.0 -0.0
+# 2 -2 0.5 -2
+# py-lite True True True
+# 42
+# forty-two
+# -1.5 9.0
+# None
@@ -1,16 +1,16 @@
-#include "chinese.h"
-
-void 隨機數生成器(void) {
-    初始化中文環境();
-    用時間當種子();
-
-    輸出字串("=== 隨機數生成器 ===\n");
-    輸出字串("輸入要生成的隨機數個數：");
-    int 個數 = 輸入整數();
-
-    輸出字串("生成的隨機數：\n");
-    for (int i = 0; i < 個數; i++) {
-        輸出格式("%d ", 隨機數());
-    }
-    輸出字串("\n");
+#include "chinese.h"
+
+void 隨機數生成器(void) {
+    初始化中文環境();
+    用時間當種子();
+
+    輸出字串("=== 隨機數生成器 ===\n");
+    輸出字串("輸入要生成的隨機數個數：");
+    int 個數 = 輸入整數();
+
+    輸出字串("生成的隨機數：\n");
+    for (int i = 0; i < 個數; i++) {
+        輸出格式("%d ", 隨機數());
+    }
+    輸出字串("\n");
 }
\ No newline at end of file
@@ -0,0 +1,118 @@
+#pragma once
+// fe_script.h — js-lite / py-lite 共用的運算式降階。
+// 編譯時推斷型別：型別固定的變數與暫存放在單一槽位，直接使用型別化操作碼（OP_ADD、OP_FADD …），執行時不檢查標記；
+// 只有賦值過不同型別的變數（或只存過 null / None）改為動態值（pair，見 zh_bytecode.h 的 OP_DBOX），
+// 經過這類值的運算才走 OP_D* 操作碼
+#include <cstdint>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include "zh_bytecode.h"
+
+namespace script
+{
+    // 靜態型別；Dyn 為執行期才確定（佔兩個槽位）
+    enum class Ty
+    {
+        Int,
+        F64,
+        Bool,
+        Str,
+        Nil,
+        Dyn,
+    };
+
+    // 語言之間的差異
+    struct Dialect
+    {
+        const char *kw_true, *kw_false, *kw_nil;
+        uint8_t fmt;         // OP_DPRINT 的格式（DF_JS / DF_PY）
+        bool concat_any;     // 字串 + 其他型別：true 時轉成字串串接（js），false 時為編譯錯誤（py）
+        bool js_eq;          // 接受 === / !==（嚴格相等）；== / != 為寬鬆相等（型別不同時轉成數值，OP_DJEQ / OP_DJNE）
+        bool num_f64;        // 數值一律為 f64（js 的 Number）：整數字面值與算術也用小數操作碼
+        bool floor_mod;      // % 為向下取整的餘數（與除數同號，OP_FLMOD / OP_FFLMOD / OP_DFLMOD；py），否則同 C（js）
+    };
+    extern const Dialect JS;
+    extern const Dialect PY;
+
+    struct Val
+    {
+        uint32_t slot;
+        Ty ty;
+    };
+
+    class Lowering
+    {
+    public:
+        // dynamic：以動態值存放的變數，通常是前一次降階的 conflicts()
+        Lowering(std::vector<uint8_t> &bc, selfhost::bcw::StrPool &pool, const Dialect &d,
+                 const std::set<std::string> &dynamic);
+
+        // 每條語句開始時呼叫，暫存槽位可重複使用
+        void begin_stmt();
+        // name = expr（let / const / var 與一般賦值相同）；語法錯誤時丟出 std::runtime_error
+        void assign(const std::string &name, const std::string &expr);
+        // 印出以逗號分隔的一或多個運算式，之間以空白分隔，最後換行
+        void print(const std::string &args);
+
+        // 型別與先前不同、需改為動態值的變數。非空時本次輸出作廢，前端應把它們加進 dynamic 重新降階
+        const std::set<std::string> &conflicts() const { return conflicts_; }
+        // 第一個靜態型別錯誤（py 的 字串 + 整數 等）。運算元可能只是還沒改成動態值，
+        // 因此降階時只記下不丟出；前端在 conflicts() 為空的那一輪才回報
+        const std::string &type_error() const { return type_error_; }
+        // 使用的槽位數
+        uint32_t frame() const { return next_; }
+        // 常數初始化（SET_I64 / SET_F64 / SCONST），需放在程式碼最前面
+        const std::vector<uint8_t> &prologue() const { return prologue_; }
+
+    private:
+        std::vector<uint8_t> &bc_;
+        selfhost::bcw::StrPool &pool_;
+        const Dialect &d_;
+        const std::set<std::string> &dynamic_;
+        std::set<std::string> conflicts_;
+        std::string type_error_;
+        std::map<std::string, Val> vars_;
+        std::map<int64_t, uint32_t> consts_, fconsts_; // 值 / 位元型樣 -> 槽位
+        std::map<std::string, uint32_t> sconsts_;
+        std::vector<uint8_t> prologue_;
+        std::vector<uint32_t> temps_, dtemps_; // 單槽 / pair 暫存
+        size_t ntemp_ = 0, ndtemp_ = 0;
+        uint32_t next_ = 0;
+        std::string s_;
+        size_t p_ = 0;
+        // 最後一條寫入單槽暫存的指令：目的槽位欄位的位移與指令結尾（assign 改寫目的槽位，省一次 COPY）
+        size_t last_at_ = SIZE_MAX, last_end_ = 0;
+        uint32_t last_dst_ = 0;
+
+        uint32_t alloc(uint32_t n);
+        uint32_t temp();
+        uint32_t dtemp();
+        uint32_t konst(int64_t v);
+        uint32_t fkonst(double v);
+        uint32_t skonst(const std::string &s);
+
+        Val eval(const std::string &src);
+        void wrote(size_t at, uint32_t t);
+        uint32_t to_float(Val v);
+        uint32_t box(Val v);
+        uint32_t to_str(Val v);
+        Val emit(char op, Val l, Val r);
+        Val emit_cmp(selfhost::Op op, Val l, Val r, bool loose = false);
+
+        void skip_ws();
+        bool eat(const char *tok);
+        bool string_lit(std::string &out);
+        Val parse_primary();
+        Val parse_unary();
+        Val parse_mul();
+        Val parse_add();
+        Val parse_cmp();
+    };
+
+    // 字串是否只含一個字串字面值（前後可有空白）；是的話取出內容
+    bool string_literal_only(const std::string &s, std::string &out);
+    // 去掉行尾註解（marker 為 "//" 或 "#"；字串字面值內的不算）
+    std::string strip_comment(const std::string &line, const char *marker);
+}
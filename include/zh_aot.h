@@ -0,0 +1,70 @@
+#pragma once
+// zh_aot.h — 分層 AOT：把 emit_cpp_from_bc() 的輸出編譯成共享函式庫，以位元碼雜湊為鍵快取在磁碟上。
+// 第一次執行照常直譯，同時在背景執行緒呼叫 C++ 編譯器；之後的執行直接載入快取並呼叫入口函式。
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <thread>
+#include "zh_cache.h"
+
+namespace selfhost
+{
+    // 共享函式庫匯出的入口：int zh_aot_main(void)，回傳值即結束碼
+    const char *const AOT_ENTRY = "zh_aot_main";
+    // emit_cpp_from_bc() 的輸出語意改變時遞增；版本納入快取鍵，舊的快取自然失效
+    const uint32_t AOT_ABI = 1;
+
+    // AOT 物件放在 cache_root() 下的 aot/；取不到快取目錄時回傳空字串
+    std::string aot_dir();
+
+    // 快取鍵：AOT_ABI、位元碼長度與雜湊
+    std::string aot_key(const uint8_t *bc, size_t n);
+
+    // 讀取環境變數 ZHCL_AOT（1 啟用；未設定或 0 停用）
+    bool aot_enabled_from_env();
+
+    // 已載入的共享函式庫；僅可移動
+    class AotModule
+    {
+    public:
+        AotModule() = default;
+        ~AotModule();
+        AotModule(AotModule &&o) noexcept;
+        AotModule &operator=(AotModule &&o) noexcept;
+        AotModule(const AotModule &) = delete;
+        AotModule &operator=(const AotModule &) = delete;
+
+        explicit operator bool() const { return entry_ != nullptr; }
+
+        // 載入快取中此鍵的物件；不存在、載入失敗或缺少入口時回傳 false
+        bool open(const std::string &key);
+        // 執行入口函式；輸出經 stdio，返回前會 fflush(stdout)
+        int run() const;
+
+    private:
+        void *handle_ = nullptr;
+        int (*entry_)() = nullptr;
+    };
+
+    // 背景編譯：先寫到暫存檔，成功後改名，並行的行程不會載入半成品。
+    // 編譯器為 ZHCL_AOT_CXX（完整指令前綴），否則 POSIX 用 c++、Windows 用 cl；
+    // 編譯失敗時留下 .fail 標記，之後同一鍵不再重試。解構時等待編譯結束
+    class AotBuild
+    {
+    public:
+        AotBuild(const std::string &key, std::string cpp);
+        ~AotBuild();
+        AotBuild(const AotBuild &) = delete;
+        AotBuild &operator=(const AotBuild &) = delete;
+
+        // 等待編譯結束；成功時回傳 true
+        bool wait();
+
+    private:
+        bool ok_ = false; // 必須先於 t_ 初始化
+        std::thread t_;
+    };
+
+    // 此鍵是否已編譯失敗過
+    bool aot_failed(const std::string &key);
+}
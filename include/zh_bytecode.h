@@ -0,0 +1,1107 @@
+#pragma once
+// zh_bytecode.h — selfhost VM 位元碼定義（前端、VM、反組譯共用）
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace selfhost
+{
+    // ---- 容器標頭 ----
+    // 'Z' 'B' enc flags uleb(frame_size) [區段...]，之後為程式碼。
+    // 沒有標頭的位元碼為舊格式（ENC_LEGACY）：槽位運算元為 u8，frame 固定 256。
+    // 'Z' (0x5A) 不是合法操作碼，兩者可由第一個位元組區分。
+    enum BcEnc : uint8_t
+    {
+        ENC_LEGACY = 0, // 無標頭；槽位 u8，字串長度 u64，立即值 i64
+        ENC_WIDE = 1,   // 槽位 ULEB128；其餘運算元同 ENC_LEGACY
+        ENC_VARINT = 2, // 槽位與字串長度 ULEB128，立即值 zigzag-LEB128（selfhost v2）
+    };
+    // 跳躍位移在各編碼中皆為定長 i32，前端才能先輸出再 patch
+    const uint8_t BC_MAGIC0 = 'Z';
+    const uint8_t BC_MAGIC1 = 'B';
+    const uint32_t LEGACY_FRAME = 256;
+    const uint32_t MAX_FRAME = 1u << 24; // 標頭宣告的 frame 上限（每槽 8 bytes → 128 MiB）
+
+    // 標頭 flags：各區段依位元順序接在 frame 之後
+    enum BcFlag : uint8_t
+    {
+        // 字串常數池：uleb(count)、count 個 u32le 結束位移、所有字串內容連續存放（不含換行）。
+        // 設定時 OP_PRINT 的運算元改為 ULEB128 池索引；相同字串只存一份
+        BCF_POOL = 1,
+        // 除錯行表：uleb(檔名長度)、檔名、uleb(count)、count 組 (uleb 位移增量, zigzag 行號增量)。
+        // 位移相對於程式碼起點、遞增排列；每組表示自該位移起（到下一組為止）的指令來自該行，行號 0 為無對應。
+        // 只供剖析與反組譯使用，執行時忽略；打包時預設剝除
+        BCF_DEBUG = 2,
+        // 原生函式表版本：uleb(version)。使用 OP_CALL_NATIVE 時必須設定，函式編號需小於該版本的表長
+        BCF_NATIVE = 4,
+    };
+    const uint8_t BCF_KNOWN = BCF_POOL | BCF_DEBUG | BCF_NATIVE;
+
+    struct BcHeader
+    {
+        uint8_t enc = ENC_LEGACY;
+        uint8_t flags = 0;
+        uint32_t frame = LEGACY_FRAME; // 程式使用的槽位數
+        size_t sections = 0;           // 區段起點（frame 之後）；無區段時等於 code
+        size_t code = 0;               // 程式碼起點
+        uint32_t pool_count = 0;       // 字串池項數
+        size_t pool_ends = 0;          // 結束位移表起點
+        size_t pool_data = 0;          // 字串內容起點
+        size_t debug = 0;              // 行表區段起點（無行表時為 0）
+        size_t debug_end = 0;          // 行表區段結尾
+        uint32_t natives = 0;          // 原生函式表版本（無 BCF_NATIVE 時為 0）
+    };
+
+    // 行表的一組：自 off（相對程式碼起點）起的指令來自 line
+    struct DebugRow
+    {
+        size_t off;
+        uint32_t line;
+    };
+
+    // 讀取 ULEB128；超出 n 或超過 max 時回傳 false
+    static inline bool read_uleb(const uint8_t *bc, size_t n, size_t &off, uint64_t &out, uint64_t max = UINT64_MAX)
+    {
+        uint64_t v = 0;
+        for (unsigned shift = 0; shift < 64; shift += 7)
+        {
+            if (off >= n)
+                return false;
+            uint8_t b = bc[off++];
+            v |= (uint64_t)(b & 0x7F) << shift;
+            if (!(b & 0x80))
+            {
+                out = v;
+                return v <= max;
+            }
+        }
+        return false;
+    }
+
+    // zigzag：小的負數也編成短 varint
+    static inline uint64_t zigzag(int64_t v) { return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63); }
+    static inline int64_t unzigzag(uint64_t u) { return (int64_t)(u >> 1) ^ -(int64_t)(u & 1); }
+
+    static inline uint32_t rd_u32le(const uint8_t *p)
+    {
+        uint32_t v = 0;
+        std::memcpy(&v, p, 4); // 位元碼一律 LE；目前支援的平台皆為 LE
+        return v;
+    }
+
+    // 字串池第 i 項；i 必須小於 h.pool_count
+    static inline const char *pool_str(const uint8_t *bc, const BcHeader &h, uint32_t i, uint32_t &len)
+    {
+        uint32_t begin = i ? rd_u32le(bc + h.pool_ends + 4 * (size_t)(i - 1)) : 0;
+        len = rd_u32le(bc + h.pool_ends + 4 * (size_t)i) - begin;
+        return (const char *)bc + h.pool_data + begin;
+    }
+
+    // 解析標頭；沒有標頭時回傳舊格式預設值。標頭損毀或 enc 不支援時回傳 false
+    static inline bool parse_header(const uint8_t *bc, size_t n, BcHeader &h)
+    {
+        h = BcHeader{};
+        if (n < 1 || bc[0] != BC_MAGIC0)
+            return true;
+        if (n < 4 || bc[1] != BC_MAGIC1 || (bc[2] != ENC_WIDE && bc[2] != ENC_VARINT) || (bc[3] & ~BCF_KNOWN))
+            return false;
+        h.enc = bc[2];
+        h.flags = bc[3];
+        size_t off = 4;
+        uint64_t frame = 0;
+        if (!read_uleb(bc, n, off, frame, MAX_FRAME))
+            return false;
+        h.frame = (uint32_t)frame;
+        h.sections = off;
+        if (h.flags & BCF_POOL)
+        {
+            // 結束位移需遞增且不超出檔案，之後 pool_str() 不必再檢查
+            uint64_t count = 0;
+            if (!read_uleb(bc, n, off, count, UINT32_MAX) || count > (n - off) / 4)
+                return false;
+            h.pool_count = (uint32_t)count;
+            h.pool_ends = off;
+            off += 4 * (size_t)count;
+            h.pool_data = off;
+            uint32_t prev = 0;
+            for (uint32_t i = 0; i < h.pool_count; i++)
+            {
+                uint32_t end = rd_u32le(bc + h.pool_ends + 4 * (size_t)i);
+                if (end < prev)
+                    return false;
+                prev = end;
+            }
+            if (prev > n - off)
+                return false;
+            off += prev;
+        }
+        if (h.flags & BCF_DEBUG)
+        {
+            // 只檢查結構完整；位移與行號的範圍由 read_debug() 處理
+            h.debug = off;
+            uint64_t len = 0, count = 0, v = 0;
+            if (!read_uleb(bc, n, off, len) || len > n - off)
+                return false;
+            off += (size_t)len;
+            if (!read_uleb(bc, n, off, count) || count > (n - off) / 2)
+                return false;
+            for (uint64_t i = 0; i < 2 * count; i++)
+                if (!read_uleb(bc, n, off, v))
+                    return false;
+            h.debug_end = off;
+        }
+        if (h.flags & BCF_NATIVE)
+        {
+            // 版本是否支援由 verify_bc 判斷（可回報版本號）
+            uint64_t ver = 0;
+            if (!read_uleb(bc, n, off, ver, UINT32_MAX))
+                return false;
+            h.natives = (uint32_t)ver;
+        }
+        h.code = off;
+        return true;
+    }
+
+    // 讀取行表；沒有行表時回傳 false。位移超出程式碼或未遞增的項目捨棄
+    static inline bool read_debug(const uint8_t *bc, size_t n, const BcHeader &h, std::string &file,
+                                  std::vector<DebugRow> &rows)
+    {
+        file.clear();
+        rows.clear();
+        if (!(h.flags & BCF_DEBUG))
+            return false;
+        size_t off = h.debug;
+        uint64_t len = 0, count = 0;
+        read_uleb(bc, h.code, off, len);
+        file.assign((const char *)bc + off, (size_t)len);
+        off += (size_t)len;
+        read_uleb(bc, h.code, off, count);
+        uint64_t at = 0;
+        int64_t line = 0;
+        for (uint64_t i = 0; i < count; i++)
+        {
+            uint64_t d = 0, dl = 0;
+            read_uleb(bc, h.code, off, d);
+            read_uleb(bc, h.code, off, dl);
+            at += d;
+            line += unzigzag(dl);
+            if (at >= n - h.code || line < 0 || line > UINT32_MAX)
+                break;
+            rows.push_back({(size_t)at, (uint32_t)line});
+        }
+        return true;
+    }
+
+    // 程式碼位移 off（相對程式碼起點）所在的行；rows 為 read_debug() 的結果，找不到時回傳 0
+    static inline uint32_t debug_line(const std::vector<DebugRow> &rows, size_t off)
+    {
+        size_t lo = 0, hi = rows.size();
+        while (lo < hi)
+        {
+            size_t mid = (lo + hi) / 2;
+            if (rows[mid].off <= off)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        return lo ? rows[lo - 1].line : 0;
+    }
+
+    // 操作碼數值需與各前端輸出的位元組一致（fe_*.cpp / zh_glue.cpp 以 0x04 作為 END）
+    enum Op : uint8_t
+    {
+        OP_PRINT = 1,     // len, bytes；有 BCF_POOL 時為池索引
+        OP_PRINT_INT = 2, // slot
+        OP_SET_I64 = 3,   // slot, imm
+        OP_END = 4,
+        OP_COPY_I64 = 6, // slot dst, slot src
+
+        // 浮點：槽位同樣是 64 位元，f64 以位元型樣存放，由操作碼決定如何解讀
+        OP_SET_F64 = 0x08,   // slot, 8 bytes IEEE-754（各編碼皆為定長 LE）
+        OP_I2F = 0x09,       // slot dst, slot src：int64 → f64
+        OP_F2I = 0x0A,       // slot dst, slot src：f64 → int64，向零截斷（見 vm_f2i）
+        OP_PRINT_F64 = 0x0B, // slot；格式同 chinese.h 的 輸出小數（%.15g）
+
+        // 槽位運算元：ENC_LEGACY 為 u8，ENC_WIDE 為 ULEB128
+        // 整數運算：dst, a, b（除以 0 得 0）
+        OP_ADD = 0x10,
+        OP_SUB = 0x11,
+        OP_MUL = 0x12,
+        OP_DIV = 0x13,
+        OP_MOD = 0x14,
+        OP_FLMOD = 0x15, // 向下取整的餘數（py 的 %）：非 0 的結果與除數同號，見 vm_flmod
+
+        // 比較：dst, a, b，結果 0/1
+        OP_EQ = 0x18,
+        OP_NE = 0x19,
+        OP_LT = 0x1A,
+        OP_LE = 0x1B,
+        OP_GT = 0x1C,
+        OP_GE = 0x1D,
+
+        // 跳躍：位移為 i32，相對於本指令結尾
+        OP_JMP = 0x20, // i32 rel
+        OP_JZ = 0x21,  // slot, i32 rel
+        OP_JNZ = 0x22, // slot, i32 rel
+
+        // 浮點運算與比較：與整數版本相差 0x20，運算元相同；比較結果為整數 0/1
+        OP_FADD = 0x30,
+        OP_FSUB = 0x31,
+        OP_FMUL = 0x32,
+        OP_FDIV = 0x33, // IEEE 語意（除以 0 得 ±inf / NaN）
+        OP_FMOD = 0x34, // fmod
+        OP_FFLMOD = 0x35, // 向下取整的餘數：非 0 的結果與除數同號，0 帶除數的正負號（同 Python 的 float %）
+        OP_FEQ = 0x38,
+        OP_FNE = 0x39,
+        OP_FLT = 0x3A,
+        OP_FLE = 0x3B,
+        OP_FGT = 0x3C,
+        OP_FGE = 0x3D,
+
+        // 數學函式（libm）：u8 函式編號（MathFn）, slot dst, slot a, slot b；單參數函式的 b 與 a 相同
+        OP_MATH = 0x40,
+
+        // 陣列：槽位存放陣列代號（1 起算；0 與無效代號視為空陣列），元素為 64 位元（int64 或 f64 位元型樣）。
+        // 陣列屬於單次執行，長度上限 ARRAY_MAX_LEN，負數視為 0；總量超過 4 * ARRAY_MAX_LEN 時 ANEW 得 0
+        OP_ANEW = 0x50, // slot dst, slot len：配置歸零的陣列
+        OP_ALEN = 0x51, // slot dst, slot arr
+        OP_AGET = 0x52, // slot dst, slot arr, slot idx（0 起算；超出範圍得 0）
+        OP_ASET = 0x53, // slot arr, slot idx, slot src（超出範圍不動作）
+        // 批次運算：u8 種類（VecOp）, slot a, slot b, slot c；見 VecOp
+        OP_VEC = 0x54,
+
+        // 呼叫原生函式：uleb 函式編號（NativeId）, slot dst, uleb argc, argc 個運算元。
+        // 運算元依 native_sig()：s 為字串池索引，其餘為槽位；無回傳值的函式 dst 寫 0、不使用
+        OP_CALL_NATIVE = 0x58,
+        // 呼叫位元碼函式：slot dst, uleb argc, argc 個槽位, u32 frame, i32 目標（相對欄位結尾，即指令結尾）。
+        // 被呼叫者在呼叫堆疊上取得新的槽位窗口：參數依序複製到槽位 0..argc-1，其餘 frame 個以內的槽位歸零
+        // （argc <= frame <= 標頭 frame，argc <= CALL_MAX_ARGS）。函式的常數初始化放在目標處，每次進入都重新執行
+        OP_CALL = 0x59,
+        // 尾呼叫：uleb argc, argc 個槽位, u32 frame, i32 目標；沿用目前的窗口與返回位置（不加深呼叫），其餘同 OP_CALL
+        OP_TAILCALL = 0x5A,
+        // 返回：slot src。值寫入呼叫端 OP_CALL 的 dst 並從其下一條繼續；不在函式中時同 OP_END
+        OP_RET = 0x5B,
+        // 平行工作：slot lo, slot hi, uleb n, n 組（u8 歸約方式 ReduceOp, slot）, i32 目標（相對指令結尾）。
+        // 把 [vars[lo], vars[hi]) 切成固定的塊（與執行緒數無關），每塊一個工作：取得目前窗口的私有副本，
+        // lo / hi 改為該塊的範圍、歸約槽位設為初值，從目標執行到 OP_RET / OP_END。
+        // 工作在 OP_JOIN 時才排入各核心的 work-stealing 佇列；同一個 OP_JOIN 之前的所有 SPAWN 一起執行。
+        // 工作可讀寫既有陣列的元素與呼叫位元碼函式，不可輸出、配置陣列、呼叫原生函式、使用動態值或再 SPAWN / JOIN
+        OP_SPAWN = 0x5C,
+        // 等待之前的 SPAWN 全部完成，依 SPAWN 與塊的順序把歸約結果併回目前窗口（結果與排程無關）
+        OP_JOIN = 0x5D,
+
+        // 動態值：相鄰兩個槽位組成 16 bytes 的標記值（v 為標記 ValueTag、v + 1 為內容），下稱 pair；
+        // frame 歸零即為 VT_NIL。前端知道型別時直接對內容槽位使用上面的型別化操作碼，不檢查標記；
+        // 型別在執行期才確定或混用時才經由以下操作碼
+        OP_DBOX = 0x60,   // u8 標記, pair dst, slot src：以該標記包裝 src
+        OP_DUNBOX = 0x61, // u8 標記, slot dst, pair src：轉成該型別後取出（規則見 VT_*）
+        OP_DMOV = 0x62,   // pair dst, pair src
+        OP_SCONST = 0x63, // slot dst, uleb 池索引：字串代號（需 BCF_POOL）
+        OP_DPRINT = 0x64, // u8 格式（DynFmt）, pair
+        OP_SPRINT = 0x65, // slot：印出字串代號 + 換行
+        OP_SCAT = 0x66,   // slot dst, slot a, slot b：字串代號串接（兩邊都必須是字串）
+
+        // 動態運算：pair dst, pair a, pair b。任一邊為字串時 DADD 為串接（另一邊依 DF_JS 格式轉成字串）；
+        // 否則兩邊皆為整數類（NIL、I64、BOOL）時為整數運算（同 OP_ADD …），其餘以 f64 運算。DDIV 一律為 f64 除法
+        OP_DADD = 0x70,
+        OP_DSUB = 0x71,
+        OP_DMUL = 0x72,
+        OP_DDIV = 0x73,
+        OP_DMOD = 0x74,
+        OP_DFLMOD = 0x75, // 同 OP_DMOD，但為向下取整的餘數（OP_FLMOD / OP_FFLMOD）
+        // 動態比較：slot dst（整數 0/1）, pair a, pair b。字串之間逐位元組比較；NIL 只等於 NIL；
+        // 字串與數值比較時 EQ 為假、NE 為真，大小比較把字串轉成數值
+        OP_DEQ = 0x78,
+        OP_DNE = 0x79,
+        OP_DLT = 0x7A,
+        OP_DLE = 0x7B,
+        OP_DGT = 0x7C,
+        OP_DGE = 0x7D,
+        // js 的寬鬆相等（==、!=）：NIL 只等於 NIL；字串與數值 / 布林比較時把字串轉成數值（轉不了為 NaN），
+        // 其餘同 OP_DEQ / OP_DNE
+        OP_DJEQ = 0x7E,
+        OP_DJNE = 0x7F,
+
+        // goroutine 與 channel（M:N 排程，見 zh_vm.h 的 GO_* 常數）。含這些操作碼的程式整個交給排程器：
+        // 主程式本身是第一個 goroutine，它結束（OP_END，或不在函式中的 OP_RET）時整個程式結束，其他 goroutine 直接捨棄。
+        // goroutine 可輸出、呼叫位元碼與原生函式，不可配置陣列、使用動態值或 SPAWN / JOIN。
+        // channel 代號不是 OP_CHAN 的結果（含 0）時視為 nil：送出與接收永遠阻塞，select 略過該分支
+        // 啟動 goroutine：uleb argc, argc 個槽位, u32 frame, i32 目標；參數與窗口同 OP_CALL，函式返回時結束（返回值捨棄）
+        OP_GO = 0x80,
+        // slot dst, slot cap：建立 channel，dst 為其代號。cap > 0 為有界緩衝，0 為無緩衝（送出等到有人接收），< 0 為無界
+        OP_CHAN = 0x81,
+        // slot ch, slot src：送出；緩衝已滿（無緩衝時為沒有接收者）時阻塞。對已關閉的 channel 送出為執行期錯誤
+        OP_SEND = 0x82,
+        // slot dst, slot ok, slot ch：接收；沒有值時阻塞。已關閉且取完時 dst = 0、ok = 0，否則 ok = 1
+        OP_RECV = 0x83,
+        // slot ch：關閉；等待中的接收者得到 (0, 0)，等待中的送出者為執行期錯誤。重複關閉或關閉 nil 為執行期錯誤
+        OP_CLOSE = 0x84,
+        // slot idx, slot dst, slot ok, uleb n, n 個分支（u8 SelectKind, 其槽位）：等待其中一個分支完成，
+        // 分支編號（0 起算，依位元碼順序）寫入 idx，接收分支的值與 ok 同 OP_RECV。同時有多個分支可完成時隨機擇一；
+        // 有 SEL_DEFAULT 時沒有分支能立即完成就選它
+        OP_SELECT = 0x85,
+    };
+
+    // OP_SELECT 的分支
+    enum SelectKind : uint8_t
+    {
+        SEL_RECV = 0,    // slot ch
+        SEL_SEND = 1,    // slot ch, slot src
+        SEL_DEFAULT = 2, // 無運算元，至多一個
+        SEL_KIND_COUNT,
+    };
+    const unsigned SELECT_MAX_CASES = 8; // 分支上限；各分支的槽位合計不超過 NATIVE_MAX_ARGS
+
+    // OP_SPAWN 的歸約方式：低 4 位元為種類，RD_F64 表示槽位為 f64
+    enum ReduceOp : uint8_t
+    {
+        RD_SUM = 0,  // 工作從 0 起算，JOIN 依序加回
+        RD_PROD = 1, // 從 1 起算，依序乘回
+        RD_MAX = 2,  // 從最小值起算，JOIN 取大於目前值的最大者；相同時取最前面的塊（有 RD_TIE 時取最後面的）
+        RD_MIN = 3,  // 同上，取最小者
+        RD_ARG = 4,  // 跟隨前面最近的 RD_MAX / RD_MIN：取其勝出的塊的值（例如最大值的索引）
+        RD_KIND_COUNT,
+        RD_KIND = 0x0F,
+        RD_F64 = 0x10,
+        RD_TIE = 0x20,
+    };
+    const unsigned SPAWN_MAX_REDUCE = 8; // 每個 OP_SPAWN 的歸約槽位上限
+
+    // 歸約種類的名稱（反組譯用）；未知種類回傳 nullptr
+    static inline const char *reduce_name(unsigned r)
+    {
+        static const char *const names[RD_KIND_COUNT] = {"sum", "prod", "max", "min", "arg"};
+        return (r & RD_KIND) < RD_KIND_COUNT ? names[r & RD_KIND] : nullptr;
+    }
+
+    // 動態值的標記（pair 的第一個槽位）
+    enum ValueTag : uint8_t
+    {
+        VT_NIL = 0,  // 轉整數 / 小數為 0，轉布林為假
+        VT_I64 = 1,  // 轉小數同 OP_I2F
+        VT_F64 = 2,  // 轉整數同 OP_F2I；NaN 與 0 轉布林為假
+        VT_BOOL = 3, // 內容 0/1
+        VT_STR = 4,  // 內容為字串代號；轉數值時以 strtod 解析（空字串為 0，無法解析為 NaN），空字串轉布林為假
+        VT_COUNT,
+    };
+
+    // 名稱（反組譯用）；未知標記回傳 nullptr
+    static inline const char *tag_name(unsigned t)
+    {
+        static const char *const names[VT_COUNT] = {"nil", "i64", "f64", "bool", "str"};
+        return t < VT_COUNT ? names[t] : nullptr;
+    }
+
+    // 字串代號（VT_STR 的內容）：0 為空字串，負數為 OP_SCONST 的字串池常數，正數為執行期產生的字串（編碼由 VM 決定）。
+    // 字串屬於單次執行；執行期字串佔用的空間超過 STRING_HEAP_MAX 時，結果為空字串
+    const int64_t STRING_HEAP_MAX = (int64_t)1 << 30;
+
+    // OP_DPRINT 的格式
+    enum DynFmt : uint8_t
+    {
+        DF_JS = 0,  // true / false / null，NaN / Infinity，小數同 Number#toString（最短可還原位數）
+        DF_PY = 1,  // True / False / None，nan / inf，小數同 repr（最短可還原位數，整數值加上 ".0"）
+        DF_SEP = 2, // 以空白代替換行結尾（多個參數的 print）
+        DF_MASK = 3,
+    };
+
+    const int64_t ARRAY_MAX_LEN = (int64_t)1 << 26; // 單一陣列 512 MB
+
+    // OP_VEC 的種類；_F 版本把元素與純量視為 f64。逐元素運算處理三者長度的最小值
+    enum VecOp : uint8_t
+    {
+        VK_ADD_I = 0, // arr a = arr b + arr c
+        VK_MUL_I,     // arr a = arr b * arr c
+        VK_FMA_I,     // arr a += arr b * arr c（_F 為融合乘加）
+        VK_SCALE_I,   // arr a = arr b * slot c
+        VK_SUM_I,     // slot a = Σ arr b（c 與 b 相同）
+        VK_MIN_I,     // slot a = min arr b（空陣列得 0）
+        VK_MAX_I,     // slot a = max arr b
+        VK_DOT_I,     // slot a = Σ arr b[i] * arr c[i]
+        VK_ADD_F,
+        VK_MUL_F,
+        VK_FMA_F,
+        VK_SCALE_F,
+        VK_SUM_F,
+        VK_MIN_F,
+        VK_MAX_F,
+        VK_DOT_F,
+        VK_COUNT,
+    };
+
+    // 名稱（反組譯用）；未知種類回傳 nullptr
+    static inline const char *vec_name(unsigned k)
+    {
+        static const char *const names[VK_COUNT] = {"add.i", "mul.i", "fma.i", "scale.i", "sum.i", "min.i",
+                                                    "max.i", "dot.i", "add.f", "mul.f", "fma.f", "scale.f",
+                                                    "sum.f", "min.f", "max.f", "dot.f"};
+        return k < VK_COUNT ? names[k] : nullptr;
+    }
+    // 結果寫入槽位（歸約）而非陣列
+    static inline bool vec_reduces(unsigned k)
+    {
+        unsigned b = k & 7;
+        return b == VK_SUM_I || b == VK_MIN_I || b == VK_MAX_I || b == VK_DOT_I;
+    }
+
+    // OP_MATH 的函式編號；名稱對應 chinese.h 的別名（平方根 = sqrt …）
+    enum MathFn : uint8_t
+    {
+        MF_SQRT = 0, // 平方根
+        MF_CBRT,     // 立方根
+        MF_SIN,      // 正弦
+        MF_COS,      // 餘弦
+        MF_TAN,      // 正切
+        MF_ASIN,     // 反正弦
+        MF_ACOS,     // 反餘弦
+        MF_ATAN,     // 反正切
+        MF_ATAN2,    // 雙變量反正切
+        MF_POW,      // 次冪
+        MF_FABS,     // 絕對值
+        MF_FLOOR,    // 向下取整
+        MF_CEIL,     // 向上取整
+        MF_ROUND,    // 四捨五入
+        MF_EXP,
+        MF_LOG,
+        MF_LOG10,
+        MF_COUNT,
+    };
+
+    // <cmath> 的函式名稱（反組譯 / emit_cpp 用）；未知編號回傳 nullptr
+    static inline const char *math_name(unsigned fn)
+    {
+        static const char *const names[MF_COUNT] = {"sqrt", "cbrt", "sin", "cos", "tan", "asin",
+                                                    "acos", "atan", "atan2", "pow", "fabs", "floor",
+                                                    "ceil", "round", "exp", "log", "log10"};
+        return fn < MF_COUNT ? names[fn] : nullptr;
+    }
+    static inline int math_arity(unsigned fn) { return fn == MF_ATAN2 || fn == MF_POW ? 2 : 1; }
+
+    // ---- 原生函式表（OP_CALL_NATIVE）----
+    // 對應 chinese.h 的執行期函式。編號只能在尾端新增：新增時遞增 NATIVE_VERSION，並在 native_count() 記下該版本的表長
+    const uint32_t NATIVE_VERSION = 1;
+    const unsigned NATIVE_MAX_ARGS = 8; // 槽位參數上限（不含字串）
+    const unsigned CALL_MAX_ARGS = NATIVE_MAX_ARGS; // OP_CALL / OP_TAILCALL 的參數上限
+
+    enum NativeId : uint8_t
+    {
+        NF_RAND = 0,   // 隨機數()
+        NF_TIME,       // 當前秒()
+        NF_SRAND,      // 設隨機種子(n)
+        NF_SRAND_TIME, // 用時間當種子()
+        NF_READ_INT,   // 輸入整數()
+        NF_READ_F64,   // 輸入小數()
+        NF_PRINTF,     // 輸出格式("…", …)
+        NF_WRITE,      // 印出("…")：不換行
+        NF_PRINT_U64,  // 輸出無號(n)
+        NF_PRINT_BOOL, // 輸出布林(n)
+        NF_POW,        // 數學巨集：次冪 … 四捨五入
+        NF_SQRT,
+        NF_CBRT,
+        NF_SIN,
+        NF_COS,
+        NF_TAN,
+        NF_ASIN,
+        NF_ACOS,
+        NF_ATAN,
+        NF_ATAN2,
+        NF_FABS,
+        NF_FLOOR,
+        NF_CEIL,
+        NF_ROUND,
+        NF_COUNT,
+    };
+
+    // name 為 chinese.h 的名稱；sig 第一個字元為回傳型別（v 無、i int64、f f64），其後為參數：
+    // i / f 為槽位（前端先轉成該型別），s 為字串池索引，* 為其後任意個槽位（輸出格式 依轉換規格解讀）
+    struct NativeSig
+    {
+        const char *name;
+        const char *sig;
+    };
+    static inline const NativeSig *native_sig(unsigned id)
+    {
+        static const NativeSig sigs[NF_COUNT] = {
+            {u8"隨機數", "i"}, {u8"當前秒", "i"}, {u8"設隨機種子", "vi"}, {u8"用時間當種子", "v"},
+            {u8"輸入整數", "i"}, {u8"輸入小數", "f"}, {u8"輸出格式", "vs*"}, {u8"印出", "vs"},
+            {u8"輸出無號", "vi"}, {u8"輸出布林", "vi"}, {u8"次冪", "fff"}, {u8"平方根", "ff"},
+            {u8"立方根", "ff"}, {u8"正弦", "ff"}, {u8"餘弦", "ff"}, {u8"正切", "ff"},
+            {u8"反正弦", "ff"}, {u8"反餘弦", "ff"}, {u8"反正切", "ff"}, {u8"雙變量反正切", "fff"},
+            {u8"絕對值", "ff"}, {u8"向下取整", "ff"}, {u8"向上取整", "ff"}, {u8"四捨五入", "ff"},
+        };
+        return id < NF_COUNT ? &sigs[id] : nullptr;
+    }
+    // 該版本的表長（版本 0 表示未宣告，不允許呼叫）
+    static inline unsigned native_count(uint32_t version) { return version >= 1 ? NF_COUNT : 0; }
+    // 依名稱查編號；找不到時回傳 -1
+    static inline int native_find(const std::string &name)
+    {
+        for (unsigned i = 0; i < NF_COUNT; i++)
+            if (name == native_sig(i)->name)
+                return (int)i;
+        return -1;
+    }
+
+    // 操作碼名稱（反組譯 / 剖析報表用）；未知操作碼回傳 nullptr
+    static inline const char *op_name(uint8_t op)
+    {
+        switch (op)
+        {
+        case OP_PRINT: return "PRINT";
+        case OP_PRINT_INT: return "PRINT_INT";
+        case OP_SET_I64: return "SET_I64";
+        case OP_END: return "END";
+        case OP_COPY_I64: return "COPY_I64";
+        case OP_SET_F64: return "SET_F64";
+        case OP_I2F: return "I2F";
+        case OP_F2I: return "F2I";
+        case OP_PRINT_F64: return "PRINT_F64";
+        case OP_ADD: return "ADD";
+        case OP_SUB: return "SUB";
+        case OP_MUL: return "MUL";
+        case OP_DIV: return "DIV";
+        case OP_MOD: return "MOD";
+        case OP_FLMOD: return "FLMOD";
+        case OP_EQ: return "EQ";
+        case OP_NE: return "NE";
+        case OP_LT: return "LT";
+        case OP_LE: return "LE";
+        case OP_GT: return "GT";
+        case OP_GE: return "GE";
+        case OP_JMP: return "JMP";
+        case OP_JZ: return "JZ";
+        case OP_JNZ: return "JNZ";
+        case OP_FADD: return "FADD";
+        case OP_FSUB: return "FSUB";
+        case OP_FMUL: return "FMUL";
+        case OP_FDIV: return "FDIV";
+        case OP_FMOD: return "FMOD";
+        case OP_FFLMOD: return "FFLMOD";
+        case OP_FEQ: return "FEQ";
+        case OP_FNE: return "FNE";
+        case OP_FLT: return "FLT";
+        case OP_FLE: return "FLE";
+        case OP_FGT: return "FGT";
+        case OP_FGE: return "FGE";
+        case OP_MATH: return "MATH";
+        case OP_ANEW: return "ANEW";
+        case OP_ALEN: return "ALEN";
+        case OP_AGET: return "AGET";
+        case OP_ASET: return "ASET";
+        case OP_VEC: return "VEC";
+        case OP_CALL_NATIVE: return "CALL_NATIVE";
+        case OP_CALL: return "CALL";
+        case OP_TAILCALL: return "TAILCALL";
+        case OP_RET: return "RET";
+        case OP_SPAWN: return "SPAWN";
+        case OP_JOIN: return "JOIN";
+        case OP_GO: return "GO";
+        case OP_CHAN: return "CHAN";
+        case OP_SEND: return "SEND";
+        case OP_RECV: return "RECV";
+        case OP_CLOSE: return "CLOSE";
+        case OP_SELECT: return "SELECT";
+        case OP_DBOX: return "DBOX";
+        case OP_DUNBOX: return "DUNBOX";
+        case OP_DMOV: return "DMOV";
+        case OP_SCONST: return "SCONST";
+        case OP_DPRINT: return "DPRINT";
+        case OP_SPRINT: return "SPRINT";
+        case OP_SCAT: return "SCAT";
+        case OP_DADD: return "DADD";
+        case OP_DSUB: return "DSUB";
+        case OP_DMUL: return "DMUL";
+        case OP_DDIV: return "DDIV";
+        case OP_DMOD: return "DMOD";
+        case OP_DFLMOD: return "DFLMOD";
+        case OP_DEQ: return "DEQ";
+        case OP_DNE: return "DNE";
+        case OP_DLT: return "DLT";
+        case OP_DLE: return "DLE";
+        case OP_DGT: return "DGT";
+        case OP_DGE: return "DGE";
+        case OP_DJEQ: return "DJEQ";
+        case OP_DJNE: return "DJNE";
+        default: return nullptr;
+        }
+    }
+
+    // 動態值操作碼中佔兩個槽位（pair）的運算元：bit 0 = a、bit 1 = b、bit 2 = c
+    static inline unsigned pair_operands(uint8_t op)
+    {
+        switch (op)
+        {
+        case OP_DBOX:
+        case OP_DPRINT:
+            return 1;
+        case OP_DUNBOX:
+            return 2;
+        case OP_DMOV:
+            return 3;
+        default:
+            if (op >= OP_DADD && op <= OP_DFLMOD)
+                return 7;
+            return op >= OP_DEQ && op <= OP_DJNE ? 6 : 0;
+        }
+    }
+
+    // 整數除法語意（VM、emit_cpp 共用）：除以 0 得 0，INT64_MIN / -1 環繞；vm_flmod 為向下取整的餘數
+    static inline int64_t vm_div(int64_t a, int64_t b)
+    {
+        if (b == 0)
+            return 0;
+        if (b == -1)
+            return (int64_t)(0 - (uint64_t)a);
+        return a / b;
+    }
+    static inline int64_t vm_mod(int64_t a, int64_t b)
+    {
+        if (b == 0 || b == -1)
+            return 0;
+        return a % b;
+    }
+    static inline int64_t vm_flmod(int64_t a, int64_t b)
+    {
+        const int64_t r = vm_mod(a, b);
+        return r != 0 && (r < 0) != (b < 0) ? r + b : r;
+    }
+
+    // 槽位與 f64 互轉（位元型樣不變）
+    static inline double as_f64(int64_t v)
+    {
+        double d;
+        std::memcpy(&d, &v, 8);
+        return d;
+    }
+    static inline int64_t f64_bits(double d)
+    {
+        int64_t v;
+        std::memcpy(&v, &d, 8);
+        return v;
+    }
+    // f64 → int64：向零截斷，NaN 得 0，超出範圍者飽和（C 的轉型在這些情況是未定義行為）
+    static inline int64_t vm_f2i(double d)
+    {
+        if (d != d)
+            return 0;
+        if (d >= 9223372036854775807.0)
+            return INT64_MAX;
+        if (d <= -9223372036854775808.0)
+            return INT64_MIN;
+        return (int64_t)d;
+    }
+
+    // ---- 位元碼寫入小工具（前端用）----
+    // 預設輸出 ENC_VARINT；前端寫完程式碼後呼叫 finish() 補上標頭
+    namespace bcw
+    {
+        inline void u8(std::vector<uint8_t> &bc, unsigned v) { bc.push_back((uint8_t)v); }
+        inline void u64le(std::vector<uint8_t> &bc, uint64_t v)
+        {
+            for (int i = 0; i < 8; i++)
+                bc.push_back((uint8_t)((v >> (8 * i)) & 0xFF));
+        }
+        inline void i32le(std::vector<uint8_t> &bc, int32_t v)
+        {
+            for (int i = 0; i < 4; i++)
+                bc.push_back((uint8_t)(((uint32_t)v >> (8 * i)) & 0xFF));
+        }
+        inline void uleb(std::vector<uint8_t> &bc, uint64_t v)
+        {
+            do
+            {
+                uint8_t b = v & 0x7F;
+                v >>= 7;
+                bc.push_back(v ? (uint8_t)(b | 0x80) : b);
+            } while (v);
+        }
+
+        inline void sleb(std::vector<uint8_t> &bc, int64_t v) { uleb(bc, zigzag(v)); }
+        // 字串：ULEB128 長度 + 內容
+        inline void str(std::vector<uint8_t> &bc, const std::string &s)
+        {
+            uleb(bc, (uint64_t)s.size());
+            bc.insert(bc.end(), s.begin(), s.end());
+        }
+
+        // 字串常數池：intern() 回傳索引，相同內容共用同一項
+        class StrPool
+        {
+        public:
+            uint32_t intern(const std::string &s)
+            {
+                auto it = index_.find(s);
+                if (it != index_.end())
+                    return it->second;
+                uint32_t id = (uint32_t)strs_.size();
+                index_.emplace(s, id);
+                strs_.push_back(s);
+                return id;
+            }
+            bool empty() const { return strs_.empty(); }
+
+            // 輸出 BCF_POOL 區段
+            void write(std::vector<uint8_t> &bc) const
+            {
+                uleb(bc, strs_.size());
+                uint32_t end = 0;
+                for (auto &s : strs_)
+                {
+                    end += (uint32_t)s.size();
+                    for (int i = 0; i < 4; i++)
+                        bc.push_back((uint8_t)((end >> (8 * i)) & 0xFF));
+                }
+                for (auto &s : strs_)
+                    bc.insert(bc.end(), s.begin(), s.end());
+            }
+
+        private:
+            std::unordered_map<std::string, uint32_t> index_;
+            std::vector<std::string> strs_;
+        };
+
+        // 除錯行表：每輸出一段程式碼前以 mark() 記下目前位移（bc.size()）與來源行
+        class DebugTable
+        {
+        public:
+            explicit DebugTable(std::string file = std::string()) : file_(std::move(file)) {}
+
+            void mark(size_t off, uint32_t line)
+            {
+                if (!rows_.empty() && rows_.back().off == off)
+                    rows_.pop_back(); // 前一行沒有產生程式碼
+                if (rows_.empty() || rows_.back().line != line)
+                    rows_.push_back({off, line});
+            }
+            // 程式碼前方插入了 n bytes（例如常數初始化）；插入的部分不對應任何行
+            void shift(size_t n)
+            {
+                if (n == 0)
+                    return;
+                for (auto &r : rows_)
+                    r.off += n;
+                if (rows_.empty() || rows_.front().off != 0)
+                    rows_.insert(rows_.begin(), DebugRow{0, 0});
+            }
+            bool empty() const { return rows_.empty(); }
+            const std::string &file() const { return file_; }
+            std::string &file() { return file_; }
+            const std::vector<DebugRow> &rows() const { return rows_; }
+            std::vector<DebugRow> &rows() { return rows_; }
+
+            // 輸出 BCF_DEBUG 區段
+            void write(std::vector<uint8_t> &bc) const
+            {
+                str(bc, file_);
+                uleb(bc, rows_.size());
+                size_t at = 0;
+                int64_t line = 0;
+                for (auto &r : rows_)
+                {
+                    uleb(bc, r.off - at);
+                    sleb(bc, (int64_t)r.line - line);
+                    at = r.off;
+                    line = r.line;
+                }
+            }
+
+        private:
+            std::string file_;
+            std::vector<DebugRow> rows_;
+        };
+
+        inline void print(std::vector<uint8_t> &bc, StrPool &pool, const std::string &s)
+        {
+            u8(bc, OP_PRINT);
+            uleb(bc, pool.intern(s));
+        }
+        inline void print_int(std::vector<uint8_t> &bc, uint32_t slot)
+        {
+            u8(bc, OP_PRINT_INT);
+            uleb(bc, slot);
+        }
+        inline void set_i64(std::vector<uint8_t> &bc, uint32_t slot, int64_t v)
+        {
+            u8(bc, OP_SET_I64);
+            uleb(bc, slot);
+            sleb(bc, v);
+        }
+        // 依指定編碼輸出 SET_I64（在既有位元碼前插入指令時使用）
+        inline void set_i64_enc(std::vector<uint8_t> &bc, uint8_t enc, uint32_t slot, int64_t v)
+        {
+            u8(bc, OP_SET_I64);
+            if (enc == ENC_LEGACY)
+                u8(bc, slot);
+            else
+                uleb(bc, slot);
+            if (enc == ENC_VARINT)
+                sleb(bc, v);
+            else
+                u64le(bc, (uint64_t)v);
+        }
+        inline void copy(std::vector<uint8_t> &bc, uint32_t dst, uint32_t src)
+        {
+            u8(bc, OP_COPY_I64);
+            uleb(bc, dst);
+            uleb(bc, src);
+        }
+        inline void binop(std::vector<uint8_t> &bc, Op op, uint32_t dst, uint32_t a, uint32_t b)
+        {
+            u8(bc, op);
+            uleb(bc, dst);
+            uleb(bc, a);
+            uleb(bc, b);
+        }
+        inline void end(std::vector<uint8_t> &bc) { u8(bc, OP_END); }
+        inline void set_f64(std::vector<uint8_t> &bc, uint32_t slot, double v)
+        {
+            u8(bc, OP_SET_F64);
+            uleb(bc, slot);
+            u64le(bc, (uint64_t)f64_bits(v));
+        }
+        // I2F / F2I / ANEW / ALEN / DMOV / CHAN / SEND：dst（SEND 為 ch）, src
+        inline void unop(std::vector<uint8_t> &bc, Op op, uint32_t dst, uint32_t src)
+        {
+            u8(bc, op);
+            uleb(bc, dst);
+            uleb(bc, src);
+        }
+        inline void print_f64(std::vector<uint8_t> &bc, uint32_t slot)
+        {
+            u8(bc, OP_PRINT_F64);
+            uleb(bc, slot);
+        }
+        inline void math(std::vector<uint8_t> &bc, MathFn fn, uint32_t dst, uint32_t a, uint32_t b)
+        {
+            u8(bc, OP_MATH);
+            u8(bc, fn);
+            uleb(bc, dst);
+            uleb(bc, a);
+            uleb(bc, b);
+        }
+        inline void vec(std::vector<uint8_t> &bc, VecOp k, uint32_t a, uint32_t b, uint32_t c)
+        {
+            u8(bc, OP_VEC);
+            u8(bc, k);
+            uleb(bc, a);
+            uleb(bc, b);
+            uleb(bc, c);
+        }
+
+        // 原生函式呼叫；ops 依 native_sig() 排列（s 參數放池索引）
+        inline void call_native(std::vector<uint8_t> &bc, NativeId fn, uint32_t dst, const std::vector<uint32_t> &ops)
+        {
+            u8(bc, OP_CALL_NATIVE);
+            uleb(bc, fn);
+            uleb(bc, dst);
+            uleb(bc, ops.size());
+            for (uint32_t o : ops)
+                uleb(bc, o);
+        }
+
+        // 動態值：DBOX / DUNBOX 的 tag 為 ValueTag
+        inline void dbox(std::vector<uint8_t> &bc, ValueTag tag, uint32_t pair, uint32_t src)
+        {
+            u8(bc, OP_DBOX);
+            u8(bc, tag);
+            uleb(bc, pair);
+            uleb(bc, src);
+        }
+        inline void dunbox(std::vector<uint8_t> &bc, ValueTag tag, uint32_t dst, uint32_t pair)
+        {
+            u8(bc, OP_DUNBOX);
+            u8(bc, tag);
+            uleb(bc, dst);
+            uleb(bc, pair);
+        }
+        inline void sconst(std::vector<uint8_t> &bc, StrPool &pool, uint32_t dst, const std::string &s)
+        {
+            u8(bc, OP_SCONST);
+            uleb(bc, dst);
+            uleb(bc, pool.intern(s));
+        }
+        inline void sprint(std::vector<uint8_t> &bc, uint32_t slot)
+        {
+            u8(bc, OP_SPRINT);
+            uleb(bc, slot);
+        }
+        inline void dprint(std::vector<uint8_t> &bc, unsigned fmt, uint32_t pair)
+        {
+            u8(bc, OP_DPRINT);
+            u8(bc, fmt);
+            uleb(bc, pair);
+        }
+
+        // 跳躍：回傳 i32 欄位位置，供之後 patch()；slot 僅 JZ/JNZ 使用
+        inline size_t jump(std::vector<uint8_t> &bc, Op op, uint32_t slot = 0)
+        {
+            u8(bc, op);
+            if (op != OP_JMP)
+                uleb(bc, slot);
+            size_t at = bc.size();
+            i32le(bc, 0);
+            return at;
+        }
+        inline void patch(std::vector<uint8_t> &bc, size_t at, size_t target)
+        {
+            int32_t rel = (int32_t)((int64_t)target - (int64_t)(at + 4));
+            for (int i = 0; i < 4; i++)
+                bc[at + i] = (uint8_t)(((uint32_t)rel >> (8 * i)) & 0xFF);
+        }
+        // 向後跳（目標已知）
+        inline void jump_to(std::vector<uint8_t> &bc, Op op, size_t target, uint32_t slot = 0)
+        {
+            patch(bc, jump(bc, op, slot), target);
+        }
+
+        // 位元碼函式呼叫：回傳 u32 frame 欄位位置，函式位置確定後以 patch_call() 填入 frame 與目標
+        inline size_t call(std::vector<uint8_t> &bc, uint32_t dst, const std::vector<uint32_t> &args, bool tail = false)
+        {
+            u8(bc, tail ? OP_TAILCALL : OP_CALL);
+            if (!tail)
+                uleb(bc, dst);
+            uleb(bc, args.size());
+            for (uint32_t a : args)
+                uleb(bc, a);
+            size_t at = bc.size();
+            i32le(bc, 0);
+            i32le(bc, 0);
+            return at;
+        }
+        inline void patch_call(std::vector<uint8_t> &bc, size_t at, uint32_t frame, size_t target)
+        {
+            for (int i = 0; i < 4; i++)
+                bc[at + i] = (uint8_t)((frame >> (8 * i)) & 0xFF);
+            patch(bc, at + 4, target);
+        }
+        inline void ret(std::vector<uint8_t> &bc, uint32_t slot)
+        {
+            u8(bc, OP_RET);
+            uleb(bc, slot);
+        }
+
+        // 平行工作：reduce 為（ReduceOp, 槽位）；回傳 i32 目標欄位位置，供之後 patch()
+        inline size_t spawn(std::vector<uint8_t> &bc, uint32_t lo, uint32_t hi,
+                            const std::vector<std::pair<uint8_t, uint32_t>> &reduce)
+        {
+            u8(bc, OP_SPAWN);
+            uleb(bc, lo);
+            uleb(bc, hi);
+            uleb(bc, reduce.size());
+            for (auto &r : reduce)
+            {
+                u8(bc, r.first);
+                uleb(bc, r.second);
+            }
+            size_t at = bc.size();
+            i32le(bc, 0);
+            return at;
+        }
+        inline void join(std::vector<uint8_t> &bc) { u8(bc, OP_JOIN); }
+
+        // 啟動 goroutine：回傳 u32 frame 欄位位置，同 call() 以 patch_call() 填入
+        inline size_t go(std::vector<uint8_t> &bc, const std::vector<uint32_t> &args)
+        {
+            u8(bc, OP_GO);
+            uleb(bc, args.size());
+            for (uint32_t a : args)
+                uleb(bc, a);
+            size_t at = bc.size();
+            i32le(bc, 0);
+            i32le(bc, 0);
+            return at;
+        }
+        inline void recv(std::vector<uint8_t> &bc, uint32_t dst, uint32_t ok, uint32_t ch)
+        {
+            u8(bc, OP_RECV);
+            uleb(bc, dst);
+            uleb(bc, ok);
+            uleb(bc, ch);
+        }
+        inline void close_chan(std::vector<uint8_t> &bc, uint32_t ch)
+        {
+            u8(bc, OP_CLOSE);
+            uleb(bc, ch);
+        }
+        struct SelectCase
+        {
+            SelectKind kind;
+            uint32_t ch, src; // SEL_DEFAULT 不用；src 僅 SEL_SEND
+        };
+        inline void select(std::vector<uint8_t> &bc, uint32_t idx, uint32_t dst, uint32_t ok,
+                           const std::vector<SelectCase> &cases)
+        {
+            u8(bc, OP_SELECT);
+            uleb(bc, idx);
+            uleb(bc, dst);
+            uleb(bc, ok);
+            uleb(bc, cases.size());
+            for (auto &c : cases)
+            {
+                u8(bc, c.kind);
+                if (c.kind != SEL_DEFAULT)
+                    uleb(bc, c.ch);
+                if (c.kind == SEL_SEND)
+                    uleb(bc, c.src);
+            }
+        }
+
+        // 在程式碼前補上標頭；frame 為使用的槽位數。跳躍皆為相對位移，前插不影響
+        inline void finish(std::vector<uint8_t> &bc, uint32_t frame, uint8_t enc = ENC_VARINT)
+        {
+            std::vector<uint8_t> h{BC_MAGIC0, BC_MAGIC1, enc, 0};
+            uleb(h, frame);
+            bc.insert(bc.begin(), h.begin(), h.end());
+        }
+        // 同上並附上字串池（PRINT 以 print(bc, pool, s) 輸出時使用）與行表（可為 nullptr）；
+        // 程式碼含 OP_CALL_NATIVE 時 natives 傳入編譯時的 NATIVE_VERSION
+        inline void finish(std::vector<uint8_t> &bc, uint32_t frame, const StrPool &pool,
+                           const DebugTable *debug = nullptr, uint32_t natives = 0)
+        {
+            bool dbg = debug && !debug->empty();
+            uint8_t flags = (uint8_t)((pool.empty() ? 0 : BCF_POOL) | (dbg ? BCF_DEBUG : 0) | (natives ? BCF_NATIVE : 0));
+            std::vector<uint8_t> h{BC_MAGIC0, BC_MAGIC1, ENC_VARINT, flags};
+            uleb(h, frame);
+            if (!pool.empty())
+                pool.write(h);
+            if (dbg)
+                debug->write(h);
+            if (natives)
+                uleb(h, natives);
+            bc.insert(bc.begin(), h.begin(), h.end());
+        }
+        // 以既有位元碼 src 的標頭為範本補上標頭（沿用 enc、flags 與各區段），frame 改為指定值。
+        // code 開頭比 src 的程式碼多出 prefix bytes 時，行表位移一併後移
+        inline void refinish(std::vector<uint8_t> &code, const uint8_t *src, size_t n, const BcHeader &h,
+                             uint32_t frame, size_t prefix = 0)
+        {
+            std::vector<uint8_t> hd{BC_MAGIC0, BC_MAGIC1, h.enc, h.flags};
+            uleb(hd, frame);
+            if ((h.flags & BCF_DEBUG) && prefix)
+            {
+                hd.insert(hd.end(), src + h.sections, src + h.debug);
+                DebugTable t;
+                read_debug(src, n, h, t.file(), t.rows());
+                t.shift(prefix);
+                t.write(hd);
+                hd.insert(hd.end(), src + h.debug_end, src + h.code);
+            }
+            else
+                hd.insert(hd.end(), src + h.sections, src + h.code);
+            code.insert(code.begin(), hd.begin(), hd.end());
+        }
+        // 移除行表（打包時使用）；沒有行表時不變
+        inline void strip_debug(std::vector<uint8_t> &bc)
+        {
+            BcHeader h;
+            if (!parse_header(bc.data(), bc.size(), h) || !(h.flags & BCF_DEBUG))
+                return;
+            bc.erase(bc.begin() + (std::ptrdiff_t)h.debug, bc.begin() + (std::ptrdiff_t)h.debug_end);
+            bc[3] &= (uint8_t)~BCF_DEBUG;
+        }
+    }
+}
@@ -0,0 +1,49 @@
+#pragma once
+// zh_cache.h — 磁碟快取：快取目錄、內容雜湊，以及 zhcl run 的已編譯位元碼快取。
+// 位元碼快取以原始碼內容、檔名、指定的前端與 zhcl 執行檔本身為鍵；命中時略過正規化、前端比對與編譯。
+// 總大小超過上限時依最後使用時間（檔案 mtime，命中時更新）淘汰最舊的項目
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace selfhost
+{
+    // 快取目錄：ZHCL_CACHE_DIR，否則 $XDG_CACHE_HOME/zhcl、~/.cache/zhcl（Windows 為 %LOCALAPPDATA%\zhcl）；
+    // 取不到時回傳空字串
+    std::string cache_root();
+
+    // 64 位元 FNV-1a（快取鍵用，非密碼學雜湊）
+    uint64_t fnv1a64(const void *p, size_t n, uint64_t h = 0xcbf29ce484222325ULL);
+
+    // CRC-32（IEEE 802.3）；打包的 trailer 與 .zbc 檔的校驗和
+    uint32_t crc32(const uint8_t *data, size_t len);
+
+    // 目前執行檔的識別（大小與修改時間的雜湊）；zhcl 重新建置後舊的快取自然失效
+    const std::string &self_build_id();
+
+    // 位元碼快取（cache_root()/bc）。每個項目記錄原始碼長度與第二個雜湊、前端名稱與內容校驗和，
+    // 讀取時任何一項不符都當作未命中。寫入先寫暫存檔再改名，可供多個行程 / 執行緒同時使用
+    class BcCache
+    {
+    public:
+        // max_bytes 為 0 時取 ZHCL_CACHE_MAX_MB（預設 64 MB）
+        explicit BcCache(uint64_t max_bytes = 0);
+
+        bool enabled() const { return !dir_.empty(); }
+
+        // path 為命令列上的檔名，forced 為 --frontend 指定的名稱（可為空）
+        static std::string key(const std::string &src, const std::string &path, const std::string &forced);
+
+        bool get(const std::string &key, const std::string &src, std::string &frontend, std::vector<uint8_t> &bc) const;
+        void put(const std::string &key, const std::string &src, const std::string &frontend,
+                 const std::vector<uint8_t> &bc) const;
+
+        // 總大小超過上限時刪除最久未使用的項目
+        void evict() const;
+
+    private:
+        std::string dir_;
+        uint64_t max_bytes_;
+    };
+}
@@ -5,5 +5,6 @@
 
 class ZhFrontend {
 public:
-    std::vector<uint8_t> translate_to_bc(const std::string& src);
+    // file 寫入除錯行表（BCF_DEBUG）；打包時預設剝除
+    std::vector<uint8_t> translate_to_bc(const std::string& src, const std::string& file = "");
 };
\ No newline at end of file
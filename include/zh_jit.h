@@ -0,0 +1,52 @@
+#pragma once
+// zh_jit.h — selfhost 位元碼的 x86-64 樣板 JIT（baseline tier）
+// 每條已解碼指令對應一段固定機器碼；最常用的幾個槽位常駐於 callee-saved 暫存器，
+// 其餘槽位留在 vars 陣列（以 rbx 為基底）。PRINT / PRINT_INT 呼叫回 OutputSink。
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include "zh_vm.h"
+
+#if (defined(__x86_64__) || defined(_M_X64)) && (defined(_WIN32) || defined(__linux__) || defined(__APPLE__) || defined(__FreeBSD__))
+#define ZHVM_JIT 1
+#else
+#define ZHVM_JIT 0
+#endif
+
+namespace selfhost
+{
+    // 一段已產生的機器碼（RX 記憶體）；僅可移動
+    class JitCode
+    {
+    public:
+        JitCode() = default;
+        ~JitCode();
+        JitCode(JitCode &&o) noexcept;
+        JitCode &operator=(JitCode &&o) noexcept;
+        JitCode(const JitCode &) = delete;
+        JitCode &operator=(const JitCode &) = delete;
+
+        explicit operator bool() const { return entry_ != nullptr; }
+        size_t size() const { return size_; }
+
+        // 執行；vars 至少需 prog.frame 個槽位，結束時常駐暫存器的槽位會寫回 vars
+        void run(int64_t *vars, OutputSink &out) const;
+
+    private:
+        friend bool jit_compile(const Program &, JitCode &, std::string *);
+        void release();
+
+        void *mem_ = nullptr;
+        size_t map_size_ = 0;
+        size_t size_ = 0;
+        void (*entry_)(int64_t *, OutputSink *) = nullptr;
+    };
+
+    // 目前平台是否支援 JIT
+    bool jit_available();
+
+    // 將已解碼的程式編譯成機器碼；平台不支援、含 JIT 不認得的操作碼或配置記憶體失敗時回傳 false，
+    // why 填入原因，呼叫端應退回 run_program()。
+    // 字串運算元直接引用位元碼緩衝，執行期間該緩衝必須仍然有效
+    bool jit_compile(const Program &prog, JitCode &out, std::string *why = nullptr);
+}
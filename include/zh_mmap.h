@@ -0,0 +1,38 @@
+#pragma once
+// zh_mmap.h — 唯讀檔案對映（POSIX mmap / Windows MapViewOfFile）。
+// 打包的執行檔與位元碼檔直接在對映的頁面上驗證與執行，不再整段複製；同一檔案的多個行程共用頁面快取
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <filesystem>
+
+namespace selfhost
+{
+    // 無法對映時（例如空檔案或不支援的檔案系統）改為整檔讀入記憶體，呼叫端不需區分；僅可移動
+    class MappedFile
+    {
+    public:
+        MappedFile() = default;
+        ~MappedFile();
+        MappedFile(MappedFile &&o) noexcept;
+        MappedFile &operator=(MappedFile &&o) noexcept;
+        MappedFile(const MappedFile &) = delete;
+        MappedFile &operator=(const MappedFile &) = delete;
+
+        // 開啟並對映整個檔案；失敗時回傳 false，先前的對映會被釋放
+        bool open(const std::filesystem::path &p);
+        void close();
+
+        const uint8_t *data() const { return data_; }
+        size_t size() const { return size_; }
+        explicit operator bool() const { return data_ != nullptr; }
+        // 是否為真正的對映（false 表示退回整檔讀取）
+        bool mapped() const { return view_ != nullptr; }
+
+    private:
+        const uint8_t *data_ = nullptr;
+        size_t size_ = 0;
+        void *view_ = nullptr;     // 對映的起點
+        std::vector<uint8_t> own_; // 退回整檔讀取時的內容
+    };
+}
@@ -0,0 +1,32 @@
+#pragma once
+// zh_native.h — OP_CALL_NATIVE 的原生函式表（對應 chinese.h 的執行期函式，編號見 zh_bytecode.h 的 NativeId）
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+namespace selfhost
+{
+    class OutputSink;
+
+    // 一次呼叫的參數：v 為槽位值（f 參數為 f64 位元樣式），s / len 為字串參數；輸出一律經 out，與 PRINT 保持順序
+    struct NativeArgs
+    {
+        const int64_t *v;
+        uint32_t n;
+        const char *s;
+        uint32_t len;
+        OutputSink &out;
+    };
+
+    // 回傳值依 native_sig() 的回傳型別（f 為 f64 位元樣式）；無回傳值的函式回傳 0
+    typedef int64_t (*NativeFn)(const NativeArgs &a);
+
+    // 以 NativeId 為索引的函式表（NF_COUNT 項）
+    const NativeFn *native_table();
+
+    // 把 輸出格式 的格式字串正規化成只含 64 位元轉換的 printf 格式：
+    // 整數轉換（d i u o x X c）一律改成 ll，浮點轉換（f F e E g G a A）不帶長度修飾；
+    // 其他轉換（%s、%n、%p…）不支援，原樣當成文字輸出。types 依序記下每個參數的型別（'i' 或 'f'）。
+    // * 寬度 / 精度不支援，同樣當成文字
+    std::string native_format(const char *fmt, size_t n, std::string &types);
+}
@@ -0,0 +1,44 @@
+#pragma once
+// zh_simd.h — VM 陣列批次運算（OP_VEC）的核心迴圈
+// 執行期以 CPUID 選擇 AVX2 / SSE2 / 純量版本；各版本結果逐位元相同：
+// 浮點歸約（總和、內積、最小 / 最大值）一律以 8 條 lane 交錯累加（lane k 處理 i ≡ k mod 8），
+// 再以 ((l0+l1)+(l2+l3)) + ((l4+l5)+(l6+l7)) 合併、尾端依序處理；乘加（fma）一律為融合運算。
+#include <cstdint>
+#include <cstddef>
+
+namespace selfhost
+{
+    namespace simd
+    {
+        enum class Level
+        {
+            Scalar,
+            SSE2,
+            AVX2, // 另需 FMA 才會用於 fma_f64
+        };
+
+        // 本機可用的最高層級（第一次呼叫時偵測）；環境變數 ZHCL_SIMD=scalar|sse2|avx2 可再往下限制
+        Level level();
+        const char *level_name(Level l);
+
+        // 逐元素：d[i] = a[i] op b[i]（d 可與 a / b 相同）；整數運算環繞
+        void add_i64(int64_t *d, const int64_t *a, const int64_t *b, size_t n);
+        void mul_i64(int64_t *d, const int64_t *a, const int64_t *b, size_t n);
+        void fma_i64(int64_t *d, const int64_t *a, const int64_t *b, size_t n); // d[i] += a[i] * b[i]
+        void scale_i64(int64_t *d, const int64_t *a, int64_t s, size_t n);
+        void add_f64(double *d, const double *a, const double *b, size_t n);
+        void mul_f64(double *d, const double *a, const double *b, size_t n);
+        void fma_f64(double *d, const double *a, const double *b, size_t n); // d[i] = fma(a[i], b[i], d[i])
+        void scale_f64(double *d, const double *a, double s, size_t n);
+
+        // 歸約；n 為 0 時回傳 0。最小 / 最大值的比較同 minpd / maxpd：x < m ? x : m
+        int64_t sum_i64(const int64_t *a, size_t n);
+        int64_t dot_i64(const int64_t *a, const int64_t *b, size_t n);
+        int64_t min_i64(const int64_t *a, size_t n);
+        int64_t max_i64(const int64_t *a, size_t n);
+        double sum_f64(const double *a, size_t n);
+        double dot_f64(const double *a, const double *b, size_t n);
+        double min_f64(const double *a, size_t n);
+        double max_f64(const double *a, size_t n);
+    }
+}
@@ -0,0 +1,316 @@
+#pragma once
+// zh_vm.h — selfhost 位元碼直譯器
+// 兩階段：decode_bc() 先把位元組串解成定長指令陣列（運算元已展開），
+// run_program() 再以 computed goto（GCC/Clang）或 switch（其他編譯器）逐條派發。
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <string>
+#include <memory>
+#include <cstdio>
+#include "zh_bytecode.h"
+
+#if defined(__GNUC__) || defined(__clang__)
+#define ZHVM_THREADED 1 // direct threading：指令內直接存放處理常式位址
+#else
+#define ZHVM_THREADED 0
+#endif
+
+namespace selfhost
+{
+    // 定長指令（32 bytes）；字串運算元指向原始位元碼（內嵌字串或字串池），不複製
+    struct Insn
+    {
+        const void *h; // 處理常式位址（僅 ZHVM_THREADED 使用，由 run_program 填入）
+        uint16_t op;
+        uint16_t pad;
+        uint32_t a; // dst / slot
+        uint32_t b; // src / 字串長度
+        uint32_t c; // 第二來源 / 跳躍目標（指令索引）
+        union
+        {
+            int64_t imm;
+            const char *s;
+        };
+    };
+
+    // OP_CALL_NATIVE 的運算元（Insn::c 為 Program::calls 的索引，imm 為函式編號，a 為 dst）。
+    // OP_CALL / OP_TAILCALL 共用同一張表：imm 為索引，a 為 dst，b 為被呼叫者的 frame，c 為目標（指令索引）。
+    // OP_SPAWN 也是：imm 為索引，a / b 為範圍槽位，c 為目標；argv 為歸約槽位，red 為其歸約方式。
+    // OP_GO 同 OP_TAILCALL；OP_SELECT 的 imm 為索引，red 為各分支的 SelectKind，argv 依序為各分支的槽位
+    struct NativeCall
+    {
+        uint32_t argc;
+        uint32_t argv[NATIVE_MAX_ARGS]; // 槽位參數
+        const char *s;                  // 字串參數（指向字串池），沒有時為 nullptr
+        uint32_t len;
+        bool ret; // 是否寫回 dst
+        uint8_t red[SPAWN_MAX_REDUCE];
+    };
+    static_assert(SPAWN_MAX_REDUCE <= NATIVE_MAX_ARGS, "OP_SPAWN 的歸約槽位放在 NativeCall::argv");
+    static_assert(SELECT_MAX_CASES <= SPAWN_MAX_REDUCE, "OP_SELECT 的分支種類放在 NativeCall::red");
+
+    // OP_SCONST 的字串（指向字串池）
+    struct StrConst
+    {
+        const char *s;
+        uint32_t len;
+    };
+
+    struct Program
+    {
+        std::vector<Insn> code;        // 永遠以 OP_END 結尾
+        std::vector<NativeCall> calls;
+        std::vector<StrConst> strs;    // 字串代號 -(k + 1) 為第 k 項（Insn::imm 即為代號）
+        uint32_t frame = LEGACY_FRAME; // 槽位數（取自標頭）
+        bool threaded = false;         // h 欄位是否已填妥
+        bool go = false;               // 含 goroutine / channel 操作碼（run_program 交給排程器）
+        std::vector<size_t> offs;      // 每條指令在位元碼中的起點（與 code 對齊；行表對照用）
+    };
+
+    // 單條指令的原始欄位（decode_bc / 反組譯 / emit_cpp 共用）
+    struct RawInsn
+    {
+        size_t off;  // 指令起點
+        size_t next; // 下一條指令起點
+        uint8_t op;
+        uint32_t a, b, c; // 有字串池時 PRINT 的 a 為池索引
+        int64_t imm;      // SET_I64 的值；跳躍指令為絕對目標位移
+        const char *s;
+        uint64_t len;
+        uint32_t argc;                  // OP_CALL_NATIVE 的槽位參數（s / len 為字串參數）
+        uint32_t args[NATIVE_MAX_ARGS];
+        uint8_t red[SPAWN_MAX_REDUCE];  // OP_SPAWN：args 各槽位的歸約方式；OP_SELECT：各分支的 SelectKind（argc 為分支數）
+    };
+
+    // 讀取 off 處的一條指令（h 取自 parse_header）；未知操作碼、運算元不完整或池索引超出範圍時回傳 false
+    bool read_insn(const uint8_t *bc, size_t n, size_t off, const BcHeader &h, RawInsn &out);
+
+    // 同上但不做任何長度檢查；bc 必須已通過 verify_bc
+    RawInsn read_insn_verified(const uint8_t *bc, size_t off, const BcHeader &h);
+
+    // 載入時驗證：標頭、操作碼、運算元長度、槽位是否在 frame 內、跳躍目標；失敗時回報出錯指令的位移
+    struct VerifyError
+    {
+        size_t offset = 0;
+        std::string message;
+    };
+    bool verify_bc(const uint8_t *bc, size_t n, VerifyError &err);
+
+    // 解碼（含檢查）；遇到未知操作碼、運算元不完整或槽位超出 frame 即停止，其後補一條 OP_END；
+    // 跳躍目標轉為指令索引，落在指令中間或範圍外者一律導向結尾的 OP_END
+    Program decode_bc(const uint8_t *bc, size_t n);
+
+    // 解碼（不檢查）；bc 必須已通過 verify_bc
+    Program decode_verified(const uint8_t *bc, size_t n);
+
+    // VM 輸出緩衝：PRINT / PRINT_INT 先寫入緩衝，滿了、OP_END 或解構時一次送出；
+    // stdout 為終端機時每行送出一次，互動輸出不延遲。
+    // POSIX 上較長的字串以 line_ref() 引用原位（字串池），flush 時與緩衝一起 writev，不複製。
+    // 以 capture 建構時改為附加到該字串（差異測試用），不寫 stdout
+    class OutputSink
+    {
+    public:
+        explicit OutputSink(size_t capacity = 64 * 1024);
+        explicit OutputSink(std::string *capture, size_t capacity = 64 * 1024);
+        ~OutputSink();
+        OutputSink(const OutputSink &) = delete;
+        OutputSink &operator=(const OutputSink &) = delete;
+
+        void line(const char *s, size_t n); // 字串 + 換行
+        // 同 line()，但 s 在下一次 flush() 前必須保持有效（例如位元碼內的字串）
+        void line_ref(const char *s, size_t n);
+        void int_line(int64_t v);           // 十進位整數 + 換行
+        void f64_line(double v);            // %.15g + 換行（同 輸出小數）
+        void write(const char *p, size_t n); // 原樣輸出（不加換行）
+        void flush();
+        bool captures() const { return capture_ != nullptr; }
+
+    private:
+        void sys_write(const char *p, size_t n);
+        void write_refs();
+
+        // 待送出的片段：依序為緩衝區段或外部字串
+        struct Span
+        {
+            const char *p;
+            size_t n;
+        };
+
+        std::vector<char> buf_;
+        size_t len_ = 0;
+        std::vector<Span> refs_; // 非空時 flush 以 writev 送出
+        size_t mark_ = 0;        // 緩衝中尚未列入 refs_ 的起點
+        size_t ref_bytes_ = 0;   // refs_ 中外部字串的總長
+        bool line_flush_ = false;
+        std::string *capture_ = nullptr;
+#ifdef _WIN32
+        void *handle_ = nullptr;
+#endif
+    };
+
+    // 大型 frame 的配置來源：以 64K 槽位為單位的 bump allocator，reset() 後保留已配置的區塊重複使用
+    class SlotArena
+    {
+    public:
+        SlotArena() = default;
+        SlotArena(const SlotArena &) = delete;
+        SlotArena &operator=(const SlotArena &) = delete;
+
+        int64_t *alloc(size_t n); // 內容歸零
+        void reset();
+
+    private:
+        struct Chunk
+        {
+            std::unique_ptr<int64_t[]> p;
+            size_t cap;
+        };
+        std::vector<Chunk> chunks_;
+        size_t cur_ = 0;  // 目前使用中的區塊
+        size_t used_ = 0; // 該區塊已用槽位
+    };
+
+    // 一次執行的槽位 frame：不超過 FRAME_STACK_SLOTS 時放在物件內（通常位於堆疊），否則向 arena 取用
+    const uint32_t FRAME_STACK_SLOTS = 256;
+    class Frame
+    {
+    public:
+        Frame(uint32_t n, SlotArena &arena);
+        Frame(const Frame &) = delete;
+        Frame &operator=(const Frame &) = delete;
+
+        int64_t *data() { return p_; }
+        uint32_t size() const { return n_; }
+
+    private:
+        int64_t local_[FRAME_STACK_SLOTS];
+        int64_t *p_;
+        uint32_t n_;
+    };
+
+    // 每個操作碼的執行次數與累計時間（x86 為 rdtsc 週期，其他平台為 steady_clock 奈秒）
+    struct VmProfile
+    {
+        uint64_t count[256] = {};
+        uint64_t ticks[256] = {}; // ticks[0] 為進入派發迴圈前的零頭
+        // 每條指令的次數與時間（與 Program::code 對齊）；換成不同長度的程式時歸零重來
+        std::vector<uint64_t> insn_count, insn_ticks;
+
+        static const char *unit(); // "cycles" 或 "ns"
+        void merge(const VmProfile &o);
+        void print(std::FILE *f) const;                // 依時間排序的表格
+        bool write_json(const std::string &path) const; // 失敗時回傳 false
+    };
+
+    // 依 BCF_DEBUG 行表把逐指令資料彙總到原始碼行，依時間遞減；line 0 為無對應行（常數初始化、結尾）。
+    // bc 必須是解碼出 prog 的位元碼；沒有行表或資料不屬於此程式時回傳 false
+    struct LineProfile
+    {
+        uint32_t line;
+        uint64_t count, ticks;
+    };
+    bool profile_lines(const uint8_t *bc, size_t n, const Program &prog, const VmProfile &prof, std::string &file,
+                       std::vector<LineProfile> &out);
+
+    // 執行已解碼的程式；vars 至少需 prog.frame 個槽位（主程式的窗口，函式的窗口在呼叫堆疊上）。
+    // 含 goroutine / channel 操作碼（prog.go）時交給 M:N 排程器，vars 為主 goroutine 的窗口。
+    // 回傳 VM_OK、VM_STACK_OVERFLOW、VM_TASK_FAULT 或 VM_GO_PANIC
+    int run_program(Program &prog, int64_t *vars, OutputSink &out);
+    // 同上並記錄每個操作碼的次數與時間（獨立的派發迴圈，不影響上面的版本）
+    int run_program(Program &prog, int64_t *vars, OutputSink &out, VmProfile &prof);
+
+    // 執行層級：Off = 直譯器；On = x86-64 JIT（不支援時自動退回直譯器）；
+    // Check = 直譯器與 JIT 各跑一次並比對輸出與槽位（差異測試）
+    enum class JitMode
+    {
+        Off,
+        On,
+        Check,
+    };
+
+    // 讀取環境變數 ZHCL_JIT（1 / check；未設定或 0 為 Off），供打包後的執行檔使用
+    JitMode jit_mode_from_env();
+
+    // Vm::run() / execute_bc() 的狀態碼（同時作為 zhcl 的結束碼）
+    const int VM_OK = 0;
+    const int VM_REJECTED = 3;       // 位元碼未通過驗證，或尚未載入程式
+    const int VM_JIT_MISMATCH = 5;   // JitMode::Check 比對不一致
+    const int VM_STACK_OVERFLOW = 6; // OP_CALL 超出呼叫堆疊
+    const int VM_TASK_FAULT = 7;     // 平行工作（OP_SPAWN）或 goroutine 執行了不允許的指令
+    const int VM_GO_PANIC = 8;       // 所有 goroutine 都在等待（deadlock）、對已關閉的 channel 送出或重複關閉
+
+    // 呼叫堆疊（OP_CALL）：第一次呼叫時一次配置，之後的呼叫不再配置記憶體。
+    // 每層佔呼叫者的 frame 個槽位，外加一筆返回紀錄；超出任一上限即停止執行並回報 VM_STACK_OVERFLOW
+    const uint32_t CALL_STACK_SLOTS = 1u << 22; // 32 MiB
+    const uint32_t CALL_DEPTH_MAX = 1u << 18;
+
+    // OP_SPAWN 把範圍切成的塊數上限。塊的邊界只取決於範圍，小數歸約的結果因此不隨核心數改變；
+    // 執行緒數為硬體核心數，可用環境變數 ZHCL_THREADS 指定（1 = 全部在呼叫 JOIN 的執行緒上依序執行）
+    const uint32_t TASK_CHUNKS = 256;
+
+    // goroutine（OP_GO）：每個 goroutine 有自己的呼叫堆疊（同樣在第一次呼叫時配置，上限較小），
+    // 由 ZHCL_THREADS 個執行緒（同上）以 work-stealing 佇列排程。阻塞的 channel 操作讓出執行緒；
+    // 不阻塞的 goroutine 每 GO_SLICE 次向後跳躍或呼叫讓出一次，長時間的迴圈不會獨佔執行緒
+    const uint32_t GO_STACK_SLOTS = 1u << 16; // 512 KiB
+    const uint32_t GO_DEPTH_MAX = 1u << 12;
+    const uint32_t GO_SLICE = 1u << 14;
+
+    class JitCode;
+
+    // 可重複使用的 VM 實例：load() 一次後可多次 run()；reset() 清掉程式但保留已配置的記憶體。
+    // 不會結束行程，長駐的宿主可在同一行程內執行大量小程式。單一實例不可同時在多個執行緒使用
+    class Vm
+    {
+    public:
+        explicit Vm(OutputSink *out = nullptr); // nullptr：寫到 stdout
+        ~Vm();
+        Vm(const Vm &) = delete;
+        Vm &operator=(const Vm &) = delete;
+
+        void set_output(OutputSink *out); // nullptr：改回 stdout
+        void set_jit(JitMode mode);
+        // 設定後 run() 改走剖析版本的直譯器（不用 JIT），結果累加到 prof；nullptr 關閉
+        void set_profile(VmProfile *prof) { prof_ = prof; }
+
+        // 驗證 + 解碼；失敗時回傳 false，原因見 error()。verified = true 時略過驗證（例如 trailer 已標記）。
+        // 此版本不複製 bc，執行期間 bc 必須保持有效
+        bool load(const uint8_t *bc, size_t n, bool verified = false);
+        // 同上，但位元碼由 Vm 保存
+        bool load(std::vector<uint8_t> bc, bool verified = false);
+        const VerifyError &error() const { return err_; }
+
+        // 以全新（歸零）的槽位執行已載入的程式，輸出在返回前全部送出
+        int run();
+
+        // 上次 run() 結束時的槽位（frame() 個）；尚未執行時為 nullptr
+        const int64_t *slots() const { return vars_; }
+        uint32_t frame() const { return prog_.frame; }
+        const Program &program() const { return prog_; }
+
+        void reset();
+
+    private:
+        OutputSink *out_ = nullptr;
+        std::unique_ptr<OutputSink> stdout_;
+        JitMode jit_ = JitMode::Off;
+        VmProfile *prof_ = nullptr;
+        std::vector<uint8_t> own_; // load(vector) 保存的位元碼
+        Program prog_;
+        bool loaded_ = false;
+        std::unique_ptr<JitCode> native_;
+        bool jit_tried_ = false;
+        SlotArena arena_;
+        int64_t local_[FRAME_STACK_SLOTS]; // 小 frame 不經 arena（同 Frame）
+        int64_t *vars_ = nullptr;
+        VerifyError err_;
+    };
+
+    // 一次性執行：以 Vm 驗證、解碼並執行，驗證失敗時在 stderr 報告；回傳狀態碼，不結束行程
+    // prof 不為 nullptr 時以剖析模式執行（見 Vm::set_profile）
+    int execute_bc(const std::vector<uint8_t> &bc, bool verified = false, JitMode jit = JitMode::Off,
+                   VmProfile *prof = nullptr);
+    // 同上，但不複製位元碼（例如直接在檔案對映上執行）；執行期間 bc 必須保持有效
+    int execute_bc(const uint8_t *bc, size_t n, bool verified = false, JitMode jit = JitMode::Off,
+                   VmProfile *prof = nullptr);
+}
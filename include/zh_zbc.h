@@ -0,0 +1,60 @@
+#pragma once
+// zh_zbc.h — .zbc 位元碼檔：zhcl compile 的輸出，zhcl run / selfhost explain 直接以檔案對映載入。
+// 格式（小端序）：
+//   "ZBC\x1A" | u32 版本 | u32 區段數 | u32 保留（0）
+//   區段表：每項 u32 種類 | u32 保留（0）| u64 位移 | u64 長度（位移相對檔案開頭）
+//   區段內容 | u32 CRC-32（涵蓋之前的所有位元組）
+// IMAGE 為 VM 執行的完整位元碼（含 zh_bytecode.h 的標頭），執行時不重組、不複製。
+// CONST / DEBUG 指向 IMAGE 內的字串池與行表，沒有對應區段時省略；載入時必須與 IMAGE 的標頭一致。
+// 不認得的區段種類略過，版本較新的檔案拒絕載入
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <filesystem>
+#include "zh_mmap.h"
+
+namespace selfhost
+{
+    const uint32_t ZBC_VERSION = 1;
+
+    enum ZbcSection : uint32_t
+    {
+        ZBC_SEC_IMAGE = 1, // 位元碼（必要）
+        ZBC_SEC_CONST = 2, // 字串常數池（IMAGE 內的範圍）
+        ZBC_SEC_DEBUG = 3, // 除錯行表（IMAGE 內的範圍）
+        ZBC_SEC_META = 4,  // u32 長度 + 前端名稱、u32 長度 + 原始檔路徑
+    };
+
+    // 副檔名是否為 .zbc（不分大小寫）
+    bool is_zbc_path(const std::filesystem::path &p);
+
+    // 把位元碼包成 .zbc；bc 應已通過 verify_bc
+    std::vector<uint8_t> zbc_build(const std::vector<uint8_t> &bc, const std::string &frontend,
+                                   const std::string &source);
+
+    // 已開啟的 .zbc；image() 指向檔案對映，物件存在期間有效。僅可移動
+    class ZbcFile
+    {
+    public:
+        // 失敗時回傳 false，原因寫入 err
+        bool open(const std::filesystem::path &p, std::string &err);
+
+        const uint8_t *image() const { return image_; }
+        size_t image_size() const { return image_size_; }
+        uint32_t version() const { return version_; }
+        const std::string &frontend() const { return frontend_; }
+        const std::string &source() const { return source_; }
+        size_t const_size() const { return const_size_; }
+        size_t debug_size() const { return debug_size_; }
+        size_t file_size() const { return file_.size(); }
+
+    private:
+        MappedFile file_;
+        const uint8_t *image_ = nullptr;
+        size_t image_size_ = 0;
+        uint32_t version_ = 0;
+        std::string frontend_, source_;
+        size_t const_size_ = 0, debug_size_ = 0;
+    };
+}
@@ -1,139 +1,1734 @@
-#include "../include/fe_golite.h"
-#include "../include/frontend.h"
-#include <regex>
-#include <map>
-#include <sstream>
-
-// 共用小工具：BOM/換行正規化
-static inline void strip_utf8_bom(std::string &s)
-{
-    if (s.size() >= 3 &&
-        (unsigned char)s[0] == 0xEF &&
-        (unsigned char)s[1] == 0xBB &&
-        (unsigned char)s[2] == 0xBF)
-    {
-        s.erase(0, 3);
-    }
-}
-
-static inline void normalize_newlines(std::string &s)
-{
-    // 把 CRLF/CR 全部正規化成 \n
-    std::string out;
-    out.reserve(s.size());
-    for (size_t i = 0; i < s.size(); ++i)
-    {
-        char c = s[i];
-        if (c == '\r')
-        {
-            if (i + 1 < s.size() && s[i + 1] == '\n')
-                ++i; // 吃掉 \r\n 的 \n
-            out.push_back('\n');
-        }
-        else
-        {
-            out.push_back(c);
-        }
-    }
-    s.swap(out);
-}
-
-class FE_GoLite final : public IFrontend
-{
-public:
-    std::string name() const override { return "go-lite"; }
-    bool accepts(const std::string &path, const std::string &src) const override;
-    bool compile(const FrontendContext &ctx, Bytecode &out, std::string &err) const override;
-};
-
-static void u8(std::vector<uint8_t> &v, uint8_t x) { v.push_back(x); }
-static void u64le(std::vector<uint8_t> &v, uint64_t x)
-{
-    for (int i = 0; i < 8; i++)
-        v.push_back((uint8_t)(x >> (8 * i)));
-}
-static void i64le(std::vector<uint8_t> &v, int64_t x) { u64le(v, (uint64_t)x); }
-static void emit_print(Bytecode &bc, const std::string &s)
-{
-    u8(bc.data, 0x01);
-    u64le(bc.data, (uint64_t)s.size());
-    bc.data.insert(bc.data.end(), s.begin(), s.end());
-}
-static void emit_set_i64(Bytecode &bc, uint8_t slot, int64_t v)
-{
-    u8(bc.data, 0x03);
-    u8(bc.data, slot);
-    i64le(bc.data, v);
-}
-static void emit_print_int(Bytecode &bc, uint8_t slot)
-{
-    u8(bc.data, 0x02);
-    u8(bc.data, slot);
-}
-
-bool FE_GoLite::accepts(const std::string &path, const std::string &src) const
-{
-    auto ends = [&](const char *ext)
-    { return path.size() >= 3 && path.rfind(ext) == path.size() - strlen(ext); };
-    if (ends(".go"))
-        return true;
-    // 內容嗅探：有 package / import / fmt.Println( 或 := )
-    if (src.find("fmt.Println(") != std::string::npos)
-        return true;
-    if (src.find("package ") != std::string::npos)
-        return true;
-    return false;
-}
-
-bool FE_GoLite::compile(const FrontendContext &ctx, Bytecode &out, std::string &err) const
-{
-    std::string src = ctx.src;
-    // BOM/換行正規化
-    strip_utf8_bom(src);
-    normalize_newlines(src);
-
-    std::map<std::string, uint8_t> slot;
-    auto slot_of = [&](const std::string &name) -> uint8_t
-    {
-        auto it = slot.find(name);
-        if (it != slot.end())
-            return it->second;
-        uint8_t id = (uint8_t)slot.size();
-        slot[name] = id;
-        return id;
-    };
-    std::regex re_print_s(R"(fmt\.Println\(\s*\"([^\"]*)\"\s*\)\s*;?)");
-    std::regex re_set_i(R"((?:var\s+)?([A-Za-z_]\w*)\s*(?::=\s*|\s*=\s*|\s+int\s*=\s*)(-?\d+)\s*;?)");
-    std::regex re_print_i(R"(fmt\.Println\(\s*([A-Za-z_]\w*)\s*\)\s*;?)");
-
-    std::string line;
-    std::stringstream ss(src);
-    while (std::getline(ss, line))
-    {
-        std::smatch m;
-        if (std::regex_search(line, m, re_print_s))
-        {
-            emit_print(out, m[1].str());
-            continue;
-        }
-        if (std::regex_search(line, m, re_set_i))
-        {
-            auto id = slot_of(m[1].str());
-            emit_set_i64(out, id, std::stoll(m[2].str()));
-            continue;
-        }
-        if (std::regex_search(line, m, re_print_i))
-        {
-            auto id = slot_of(m[1].str());
-            emit_print_int(out, id);
-            continue;
-        }
-    }
-    u8(out.data, 0x04);
-    return true;
-}
-
-extern "C" void register_fe_golite()
-{
-    FrontendRegistry::instance().register_frontend(std::make_unique<FE_GoLite>());
-}
+#include "../include/fe_golite.h"
+#include "../include/frontend.h"
+#include "../include/zh_bytecode.h"
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// go-lite：Go 的子集，直接降階為位元碼。
+// 支援 package / import（略過）、頂層 func（int / bool / chan 參數，至多一個回傳值）、var / := / = / op= / ++ / --、
+// if / else、for（三段式、條件、無窮、range channel、range 整數）、break / continue / return、
+// fmt.Println / Print / Printf（整數、布林與字串字面值）、make(chan T[, n])、ch <- v、<-ch、v, ok := <-ch、close、
+// go f(…) 與 select。make 的容量為負數時為無界 channel（go-lite 的延伸）。
+// 閉包、指標、slice / map / 字串變數、struct 與其他套件不支援，遇到時回報行號與原因
+
+// 共用小工具：BOM/換行正規化
+static inline void strip_utf8_bom(std::string &s)
+{
+    if (s.size() >= 3 &&
+        (unsigned char)s[0] == 0xEF &&
+        (unsigned char)s[1] == 0xBB &&
+        (unsigned char)s[2] == 0xBF)
+    {
+        s.erase(0, 3);
+    }
+}
+
+static inline void normalize_newlines(std::string &s)
+{
+    // 把 CRLF/CR 全部正規化成 \n
+    std::string out;
+    out.reserve(s.size());
+    for (size_t i = 0; i < s.size(); ++i)
+    {
+        char c = s[i];
+        if (c == '\r')
+        {
+            if (i + 1 < s.size() && s[i + 1] == '\n')
+                ++i; // 吃掉 \r\n 的 \n
+            out.push_back('\n');
+        }
+        else
+        {
+            out.push_back(c);
+        }
+    }
+    s.swap(out);
+}
+
+class FE_GoLite final : public IFrontend
+{
+public:
+    std::string name() const override { return "go-lite"; }
+    bool accepts(const std::string &path, const std::string &src) const override;
+    bool compile(const FrontendContext &ctx, Bytecode &out, std::string &err) const override;
+};
+
+namespace
+{
+    namespace bcw = selfhost::bcw;
+
+    struct GoError : std::runtime_error
+    {
+        uint32_t line;
+        GoError(uint32_t l, const std::string &m) : std::runtime_error(m), line(l) {}
+    };
+
+    // ---- 詞法 ----
+    enum TokKind
+    {
+        T_EOF,
+        T_IDENT, // 含關鍵字
+        T_INT,   // 整數與 rune 字面值
+        T_STR,
+        T_OP,
+        T_SEMI, // ; 或自動插入的分號
+    };
+
+    struct Tok
+    {
+        TokKind k;
+        std::string s; // T_STR 為解碼後的內容
+        int64_t v;
+        uint32_t line;
+    };
+
+    // Go 的自動分號：行尾的識別字（下列關鍵字除外）、字面值、) ] } ++ -- 之後
+    static bool ends_stmt(const std::vector<Tok> &out)
+    {
+        if (out.empty())
+            return false;
+        const Tok &t = out.back();
+        if (t.k == T_INT || t.k == T_STR)
+            return true;
+        if (t.k == T_IDENT)
+        {
+            static const char *const kw[] = {"if", "else", "for", "func", "go", "select", "case", "default",
+                                             "var", "chan", "package", "import", "range", "switch"};
+            for (const char *k : kw)
+                if (t.s == k)
+                    return false;
+            return true;
+        }
+        return t.k == T_OP && (t.s == ")" || t.s == "]" || t.s == "}" || t.s == "++" || t.s == "--");
+    }
+
+    static int hex_digit(char c)
+    {
+        if (c >= '0' && c <= '9')
+            return c - '0';
+        if (c >= 'a' && c <= 'f')
+            return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F')
+            return c - 'A' + 10;
+        return -1;
+    }
+
+    // 字串 / rune 字面值的跳脫；i 指向反斜線之後
+    static void unescape(const std::string &src, size_t &i, std::string &out, uint32_t line)
+    {
+        char c = i < src.size() ? src[i++] : '\0';
+        switch (c)
+        {
+        case 'n': out += '\n'; return;
+        case 't': out += '\t'; return;
+        case 'r': out += '\r'; return;
+        case 'a': out += '\a'; return;
+        case 'b': out += '\b'; return;
+        case 'f': out += '\f'; return;
+        case 'v': out += '\v'; return;
+        case '\\': out += '\\'; return;
+        case '"': out += '"'; return;
+        case '\'': out += '\''; return;
+        case 'x':
+            if (i + 1 < src.size() && hex_digit(src[i]) >= 0 && hex_digit(src[i + 1]) >= 0)
+            {
+                out += (char)(hex_digit(src[i]) * 16 + hex_digit(src[i + 1]));
+                i += 2;
+                return;
+            }
+            break;
+        default:
+            break;
+        }
+        throw GoError(line, "unknown escape sequence");
+    }
+
+    static std::vector<Tok> lex(const std::string &src)
+    {
+        static const char *const ops3[] = {"<<=", ">>=", "&^=", "..."};
+        static const char *const ops2[] = {":=", "<-", "++", "--", "+=", "-=", "*=", "/=", "%=", "&=", "|=", "^=",
+                                           "&&", "||", "==", "!=", "<=", ">=", "<<", ">>", "&^"};
+        std::vector<Tok> out;
+        uint32_t line = 1;
+        size_t i = 0;
+        const size_t n = src.size();
+        auto newline = [&]()
+        {
+            if (ends_stmt(out))
+                out.push_back(Tok{T_SEMI, "\n", 0, line});
+            line++;
+        };
+        while (i < n)
+        {
+            const char c = src[i];
+            if (c == '\n')
+            {
+                newline();
+                i++;
+                continue;
+            }
+            if (c == ' ' || c == '\t' || c == '\r')
+            {
+                i++;
+                continue;
+            }
+            if (c == '/' && i + 1 < n && src[i + 1] == '/')
+            {
+                while (i < n && src[i] != '\n')
+                    i++;
+                continue;
+            }
+            if (c == '/' && i + 1 < n && src[i + 1] == '*')
+            {
+                size_t e = src.find("*/", i + 2);
+                if (e == std::string::npos)
+                    throw GoError(line, "comment not terminated");
+                bool nl = false;
+                for (size_t k = i; k < e; k++)
+                    if (src[k] == '\n')
+                    {
+                        if (!nl && ends_stmt(out))
+                            out.push_back(Tok{T_SEMI, "\n", 0, line});
+                        nl = true;
+                        line++;
+                    }
+                i = e + 2;
+                continue;
+            }
+            if (std::isalpha((unsigned char)c) || c == '_' || (unsigned char)c >= 0x80)
+            {
+                size_t s = i;
+                while (i < n && (std::isalnum((unsigned char)src[i]) || src[i] == '_' || (unsigned char)src[i] >= 0x80))
+                    i++;
+                out.push_back(Tok{T_IDENT, src.substr(s, i - s), 0, line});
+                continue;
+            }
+            if (std::isdigit((unsigned char)c))
+            {
+                size_t s = i;
+                while (i < n && (std::isalnum((unsigned char)src[i]) || src[i] == '_'))
+                    i++;
+                std::string d;
+                for (size_t k = s; k < i; k++)
+                    if (src[k] != '_')
+                        d += src[k];
+                int base = 10;
+                size_t skip = 0;
+                if (d.size() > 1 && d[0] == '0')
+                {
+                    const char p = (char)std::tolower((unsigned char)d[1]);
+                    base = p == 'x' ? 16 : p == 'o' ? 8 : p == 'b' ? 2 : 8;
+                    skip = std::isdigit((unsigned char)p) ? 1 : 2;
+                }
+                const std::string digits = d.substr(skip);
+                char *end = nullptr;
+                errno = 0;
+                const unsigned long long v = std::strtoull(digits.c_str(), &end, base);
+                if (digits.empty() || *end || errno == ERANGE || v > (unsigned long long)INT64_MAX)
+                    throw GoError(line, "invalid integer literal " + src.substr(s, i - s));
+                out.push_back(Tok{T_INT, src.substr(s, i - s), (int64_t)v, line});
+                continue;
+            }
+            if (c == '"')
+            {
+                std::string s;
+                i++;
+                while (i < n && src[i] != '"')
+                {
+                    if (src[i] == '\n')
+                        throw GoError(line, "string literal not terminated");
+                    if (src[i] == '\\')
+                    {
+                        i++;
+                        unescape(src, i, s, line);
+                    }
+                    else
+                        s += src[i++];
+                }
+                if (i >= n)
+                    throw GoError(line, "string literal not terminated");
+                i++;
+                out.push_back(Tok{T_STR, s, 0, line});
+                continue;
+            }
+            if (c == '`')
+            {
+                size_t e = src.find('`', i + 1);
+                if (e == std::string::npos)
+                    throw GoError(line, "raw string literal not terminated");
+                out.push_back(Tok{T_STR, src.substr(i + 1, e - i - 1), 0, line});
+                for (size_t k = i; k < e; k++)
+                    line += src[k] == '\n';
+                i = e + 1;
+                continue;
+            }
+            if (c == '\'')
+            {
+                // rune：ASCII、跳脫或一個 UTF-8 字元
+                std::string s;
+                i++;
+                if (i < n && src[i] == '\\')
+                {
+                    i++;
+                    unescape(src, i, s, line);
+                }
+                else
+                    while (i < n && src[i] != '\'' && src[i] != '\n')
+                        s += src[i++];
+                if (i >= n || src[i] != '\'' || s.empty())
+                    throw GoError(line, "invalid rune literal");
+                i++;
+                int64_t v = (unsigned char)s[0];
+                if (s.size() > 1)
+                {
+                    const int extra = (int)s.size() - 1;
+                    v &= 0x3F >> extra;
+                    for (int k = 1; k <= extra; k++)
+                        v = (v << 6) | ((unsigned char)s[k] & 0x3F);
+                }
+                out.push_back(Tok{T_INT, "'" + s + "'", v, line});
+                continue;
+            }
+            if (c == ';')
+            {
+                out.push_back(Tok{T_SEMI, ";", 0, line});
+                i++;
+                continue;
+            }
+            std::string op;
+            for (const char *o : ops3)
+                if (src.compare(i, 3, o) == 0)
+                    op = o;
+            if (op.empty())
+                for (const char *o : ops2)
+                    if (src.compare(i, 2, o) == 0)
+                        op = o;
+            if (op.empty())
+            {
+                if (!std::strchr("+-*/%&|^<>=!()[]{},:.~", c))
+                    throw GoError(line, std::string("unexpected character '") + c + "'");
+                op = std::string(1, c);
+            }
+            out.push_back(Tok{T_OP, op, 0, line});
+            i += op.size();
+        }
+        if (ends_stmt(out))
+            out.push_back(Tok{T_SEMI, "\n", 0, line});
+        out.push_back(Tok{T_EOF, "", 0, line});
+        return out;
+    }
+
+    // ---- 降階 ----
+    // 型別以字串表示："int"、"bool"、"struct{}"、"chan int"、"chan chan bool"…；"nil" 為未定型的 nil，"" 為沒有值。
+    // 所有值都佔一個槽位：布林為 0 / 1，channel 為 OP_CHAN 的代號（nil 為 0）
+    struct Val
+    {
+        uint32_t slot;
+        std::string ty;
+    };
+
+    struct Func
+    {
+        std::string name, ret;
+        std::vector<std::string> params, ptypes;
+        size_t body = 0;  // 「{」的記號位置
+        size_t entry = 0; // 位元碼位移
+        uint32_t frame = 1;
+    };
+
+    // break / continue 的目標；select 只接受 break
+    struct Jumps
+    {
+        bool loop;
+        std::vector<size_t> breaks, conts;
+    };
+
+    // Printf 與 Println 的輸出片段：字面值、整數（text 為轉換規格）或布林
+    struct Piece
+    {
+        enum Kind
+        {
+            LIT,
+            INT,
+            BOOL,
+        } kind;
+        std::string text;
+        uint32_t slot;
+    };
+
+    static bool is_chan(const std::string &ty) { return ty.compare(0, 5, "chan ") == 0; }
+
+    class GoLower
+    {
+    public:
+        GoLower(const std::string &path, std::vector<Tok> toks) : t_(std::move(toks)), dbg_(path) {}
+
+        void run(std::vector<uint8_t> &out)
+        {
+            top();
+            auto m = fidx_.find("main");
+            if (m == fidx_.end())
+                throw GoError(t_.back().line, "function main is undeclared");
+            function(funcs_[m->second]);
+            for (size_t f = 0; f < funcs_.size(); f++)
+                if (f != m->second)
+                    function(funcs_[f]);
+            uint32_t frame = 1;
+            for (auto &f : funcs_)
+                frame = std::max(frame, f.frame);
+            for (auto &x : fix_)
+                bcw::patch_call(bc_, x.first, funcs_[x.second].frame, funcs_[x.second].entry);
+            out.swap(bc_);
+            bcw::finish(out, frame, pool_, &dbg_, natives_ ? selfhost::NATIVE_VERSION : 0);
+        }
+
+    private:
+        std::vector<Tok> t_;
+        size_t p_ = 0;
+        std::vector<uint8_t> bc_;
+        bcw::StrPool pool_;
+        bcw::DebugTable dbg_;
+        bool natives_ = false;
+        std::vector<Func> funcs_;
+        std::map<std::string, size_t> fidx_;
+        std::vector<std::pair<size_t, size_t>> fix_; // patch_call 的位置、函式
+        std::vector<std::map<std::string, Val>> scopes_;
+        std::vector<Jumps> jumps_;
+        const Func *cur_ = nullptr;
+        uint32_t next_ = 0;
+        std::vector<uint32_t> free_, held_; // 暫存槽位：可重用 / 目前語句使用中
+        bool side_ = false;                 // 最近的運算式含呼叫或接收（可作為語句）
+
+        // ---- 記號 ----
+        const Tok &peek(size_t k = 0) const { return t_[std::min(p_ + k, t_.size() - 1)]; }
+        bool is(const char *op, size_t k = 0) const { return peek(k).k == T_OP && peek(k).s == op; }
+        bool is_kw(const char *kw, size_t k = 0) const { return peek(k).k == T_IDENT && peek(k).s == kw; }
+        [[noreturn]] void fail(const std::string &msg) const { throw GoError(peek().line, msg); }
+        std::string shown(const Tok &t) const
+        {
+            return t.k == T_EOF ? "end of file" : t.k == T_SEMI ? "newline" : t.k == T_STR ? "string literal" : t.s;
+        }
+        void expect(const char *op)
+        {
+            if (!is(op))
+                fail(std::string("expected ") + op + ", found " + shown(peek()));
+            p_++;
+        }
+        std::string ident()
+        {
+            if (peek().k != T_IDENT)
+                fail("expected name, found " + shown(peek()));
+            return t_[p_++].s;
+        }
+        void end_stmt()
+        {
+            if (peek().k == T_SEMI)
+                p_++;
+            else if (!is("}"))
+                fail("unexpected " + shown(peek()) + " at end of statement");
+        }
+        // 從目前位置往後找 depth 0 的 what（不跨過「{」）；找到時回傳其位置
+        bool find_before_brace(bool (*what)(const Tok &), size_t &at) const
+        {
+            int depth = 0;
+            for (size_t k = p_; k < t_.size() && t_[k].k != T_EOF; k++)
+            {
+                const Tok &t = t_[k];
+                if (t.k == T_OP && (t.s == "(" || t.s == "["))
+                    depth++;
+                else if (t.k == T_OP && (t.s == ")" || t.s == "]"))
+                    depth--;
+                else if (depth == 0 && t.k == T_OP && t.s == "{")
+                    return false;
+                if (depth == 0 && what(t))
+                {
+                    at = k;
+                    return true;
+                }
+            }
+            return false;
+        }
+        // 跳過一個以「{」開頭的區塊
+        void skip_block()
+        {
+            expect("{");
+            for (int depth = 1; depth;)
+            {
+                if (peek().k == T_EOF)
+                    fail("unexpected end of file");
+                depth += is("{") ? 1 : is("}") ? -1 : 0;
+                p_++;
+            }
+        }
+
+        // ---- 槽位 ----
+        uint32_t fresh()
+        {
+            if (next_ == UINT32_MAX)
+                fail("too many variables");
+            return next_++;
+        }
+        uint32_t temp()
+        {
+            uint32_t t;
+            if (!free_.empty())
+            {
+                t = free_.back();
+                free_.pop_back();
+            }
+            else
+                t = fresh();
+            held_.push_back(t);
+            return t;
+        }
+        size_t mark() const { return held_.size(); }
+        void release(size_t m)
+        {
+            free_.insert(free_.end(), held_.begin() + (ptrdiff_t)m, held_.end());
+            held_.resize(m);
+        }
+        Val konst(int64_t v, const char *ty = "int")
+        {
+            const uint32_t t = temp();
+            bcw::set_i64(bc_, t, v);
+            return Val{t, ty};
+        }
+
+        // ---- 變數 ----
+        Val *lookup(const std::string &name)
+        {
+            for (size_t k = scopes_.size(); k-- > 0;)
+            {
+                auto it = scopes_[k].find(name);
+                if (it != scopes_[k].end())
+                    return &it->second;
+            }
+            return nullptr;
+        }
+        Val var(const std::string &name)
+        {
+            if (Val *v = lookup(name))
+                return *v;
+            if (fidx_.count(name))
+                fail("function values are not supported: " + name);
+            fail("undefined: " + name);
+        }
+        // 新變數；「_」只配置槽位
+        uint32_t declare(const std::string &name, const std::string &ty)
+        {
+            if (ty.empty() || ty == "nil")
+                fail("cannot declare " + name + " without a type");
+            const uint32_t s = fresh();
+            if (name != "_")
+            {
+                if (scopes_.back().count(name))
+                    fail(name + " redeclared in this block");
+                scopes_.back()[name] = Val{s, ty};
+            }
+            return s;
+        }
+
+        // ---- 型別 ----
+        std::string type()
+        {
+            if (is("<-"))
+            {
+                p_++;
+                if (!is_kw("chan"))
+                    fail("expected chan");
+                p_++;
+                return "chan " + type();
+            }
+            if (is_kw("chan"))
+            {
+                p_++;
+                if (is("<-"))
+                    p_++;
+                return "chan " + type();
+            }
+            if (is_kw("struct") && is("{", 1) && is("}", 2))
+            {
+                p_ += 3;
+                return "struct{}";
+            }
+            const std::string t = ident();
+            static const char *const ints[] = {"int", "int8", "int16", "int32", "int64", "uint", "uint8",
+                                               "uint16", "uint32", "uint64", "uintptr", "byte", "rune"};
+            for (const char *k : ints)
+                if (t == k)
+                    return "int";
+            if (t == "bool")
+                return t;
+            fail("unsupported type " + t);
+        }
+        void need(const Val &v, const char *what, const char *ctx)
+        {
+            if (v.ty == what || (std::strcmp(what, "chan") == 0 && is_chan(v.ty)))
+                return;
+            fail(std::string(ctx) + ": expected " + what + ", found " + (v.ty.empty() ? "no value" : v.ty));
+        }
+        static bool assignable(const std::string &dst, const std::string &src)
+        {
+            return dst == src || (src == "nil" && is_chan(dst));
+        }
+        void check_assign(const std::string &dst, const Val &v)
+        {
+            if (v.ty.empty())
+                fail("function call used as value has no result");
+            if (!assignable(dst, v.ty))
+                fail("cannot use " + v.ty + " value as " + dst);
+        }
+
+        // ---- 宣告 ----
+        void top()
+        {
+            while (peek().k != T_EOF)
+            {
+                if (peek().k == T_SEMI)
+                    p_++;
+                else if (is_kw("package"))
+                {
+                    p_++;
+                    ident();
+                    end_stmt();
+                }
+                else if (is_kw("import"))
+                {
+                    p_++;
+                    if (is("("))
+                    {
+                        p_++;
+                        while (!is(")"))
+                        {
+                            if (peek().k != T_STR && peek().k != T_SEMI)
+                                fail("expected import path");
+                            p_++;
+                        }
+                        p_++;
+                    }
+                    else if (peek().k == T_STR)
+                        p_++;
+                    else
+                        fail("expected import path");
+                    end_stmt();
+                }
+                else if (is_kw("func"))
+                    signature();
+                else
+                    fail("unsupported top-level declaration " + shown(peek()) + " (only func is supported)");
+            }
+        }
+
+        void signature()
+        {
+            p_++;
+            Func f;
+            if (is("("))
+                fail("methods are not supported");
+            f.name = ident();
+            if (fidx_.count(f.name))
+                fail(f.name + " redeclared");
+            expect("(");
+            std::vector<std::string> pending;
+            while (!is(")"))
+            {
+                pending.push_back(ident());
+                if (is(","))
+                {
+                    p_++;
+                    continue;
+                }
+                const std::string ty = type();
+                for (auto &n : pending)
+                {
+                    f.params.push_back(n);
+                    f.ptypes.push_back(ty);
+                }
+                pending.clear();
+                if (!is(")"))
+                    expect(",");
+            }
+            if (!pending.empty())
+                fail("missing parameter type");
+            p_++;
+            if (f.params.size() > selfhost::CALL_MAX_ARGS)
+                fail("too many parameters (at most " + std::to_string(selfhost::CALL_MAX_ARGS) + ")");
+            if (is("("))
+            {
+                p_++;
+                f.ret = type();
+                expect(")");
+            }
+            else if (!is("{"))
+                f.ret = type();
+            if (f.name == "main" && (!f.params.empty() || !f.ret.empty()))
+                fail("func main must have no arguments and no return values");
+            f.body = p_;
+            skip_block();
+            fidx_[f.name] = funcs_.size();
+            funcs_.push_back(f);
+        }
+
+        void function(Func &f)
+        {
+            cur_ = &f;
+            f.entry = bc_.size();
+            next_ = 0;
+            free_.clear();
+            held_.clear();
+            scopes_.assign(1, {});
+            jumps_.clear();
+            for (size_t k = 0; k < f.params.size(); k++)
+                declare(f.params[k], f.ptypes[k]);
+            p_ = f.body;
+            block(false);
+            dbg_.mark(bc_.size(), t_[p_ - 1].line);
+            if (f.name == "main")
+                bcw::end(bc_);
+            else
+                bcw::ret(bc_, 0); // 沒有 return 的結尾；frame 至少為 1
+            f.frame = std::max(next_, 1u);
+        }
+
+        // ---- 語句 ----
+        void block(bool scope = true)
+        {
+            expect("{");
+            if (scope)
+                scopes_.emplace_back();
+            while (!is("}"))
+            {
+                if (peek().k == T_EOF)
+                    fail("unexpected end of file");
+                if (peek().k == T_SEMI)
+                    p_++;
+                else
+                    stmt();
+            }
+            p_++;
+            if (scope)
+                scopes_.pop_back();
+        }
+
+        void stmt()
+        {
+            dbg_.mark(bc_.size(), peek().line);
+            const size_t m = mark();
+            if (is_kw("var"))
+                var_decl();
+            else if (is_kw("if"))
+                if_stmt();
+            else if (is_kw("for"))
+                for_stmt();
+            else if (is_kw("select"))
+                select_stmt();
+            else if (is_kw("go"))
+                go_stmt();
+            else if (is_kw("return"))
+                return_stmt();
+            else if (is_kw("break") || is_kw("continue"))
+                branch_stmt();
+            else if (is("{"))
+                block();
+            else if (is_kw("switch") || is_kw("defer") || is_kw("goto") || is_kw("const") || is_kw("type"))
+                fail(peek().s + " statements are not supported");
+            else
+                simple_stmt();
+            release(m);
+            end_stmt();
+        }
+
+        void var_decl()
+        {
+            p_++;
+            if (is("("))
+                fail("grouped var declarations are not supported");
+            std::vector<std::string> names{ident()};
+            while (is(","))
+            {
+                p_++;
+                names.push_back(ident());
+            }
+            std::string ty;
+            if (!is("="))
+                ty = type();
+            if (!is("="))
+            {
+                for (auto &n : names)
+                    bcw::set_i64(bc_, declare(n, ty), 0); // 零值
+                return;
+            }
+            p_++;
+            std::vector<Val> vals = rhs_list(names.size());
+            for (size_t k = 0; k < names.size(); k++)
+            {
+                const std::string t = ty.empty() ? vals[k].ty : ty;
+                check_assign(t, vals[k]);
+                bcw::copy(bc_, declare(names[k], t), vals[k].slot);
+            }
+        }
+
+        // 右側的 n 個運算式；多於一個時先複製到暫存（a, b = b, a）
+        std::vector<Val> rhs_list(size_t n)
+        {
+            std::vector<Val> vals{expr()};
+            while (is(","))
+            {
+                p_++;
+                vals.push_back(expr());
+            }
+            if (vals.size() != n)
+                fail("assignment mismatch: " + std::to_string(n) + " variable(s) but " + std::to_string(vals.size()) +
+                     " value(s)");
+            if (n > 1)
+                for (auto &v : vals)
+                {
+                    const uint32_t t = temp();
+                    bcw::copy(bc_, t, v.slot);
+                    v.slot = t;
+                }
+            return vals;
+        }
+
+        // 簡單語句：:=、=、op=、++ / --、送出、運算式
+        void simple_stmt()
+        {
+            size_t k = 0;
+            while (peek(k).k == T_IDENT && is(",", k + 1))
+                k += 2;
+            if (peek(k).k == T_IDENT && (is(":=", k + 1) || is("=", k + 1)))
+            {
+                std::vector<std::string> names;
+                for (size_t q = 0; q <= k; q += 2)
+                    names.push_back(peek(q).s);
+                p_ += k + 1;
+                const bool define = t_[p_++].s == ":=";
+                if (names.size() == 2 && is("<-"))
+                {
+                    // v, ok := <-ch
+                    p_++;
+                    const Val ch = unary();
+                    need(ch, "chan", "receive");
+                    const uint32_t v = temp(), ok = temp();
+                    bcw::recv(bc_, v, ok, ch.slot);
+                    bind(names[0], Val{v, ch.ty.substr(5)}, define);
+                    bind(names[1], Val{ok, "bool"}, define);
+                    return;
+                }
+                const std::vector<Val> vals = rhs_list(names.size());
+                bool fresh_name = false;
+                for (size_t q = 0; q < names.size(); q++)
+                    fresh_name |= bind(names[q], vals[q], define);
+                if (define && !fresh_name)
+                    fail("no new variables on left side of :=");
+                return;
+            }
+            if (peek().k == T_IDENT && peek(1).k == T_OP &&
+                (peek(1).s == "++" || peek(1).s == "--" ||
+                 (peek(1).s.size() >= 2 && peek(1).s.back() == '=' && std::strchr("+-*/%&|^<>", peek(1).s[0]) &&
+                  peek(1).s != "<=" && peek(1).s != ">=")))
+            {
+                const Val v = var(ident());
+                const std::string op = t_[p_++].s;
+                need(v, "int", op.c_str());
+                const selfhost::Op o = arith_op(op.substr(0, op.size() == 2 && op[1] == op[0] ? 1 : op.size() - 1));
+                if (o == selfhost::OP_END)
+                    fail("operator " + op + " is not supported");
+                const Val r = op == "++" || op == "--" ? konst(1) : expr();
+                need(r, "int", op.c_str());
+                bcw::binop(bc_, o, v.slot, v.slot, r.slot);
+                return;
+            }
+            if (is_kw("fmt") && is(".", 1))
+            {
+                print_stmt();
+                return;
+            }
+            if (is_kw("close") && is("(", 1))
+            {
+                p_ += 2;
+                const Val ch = expr();
+                need(ch, "chan", "close");
+                expect(")");
+                bcw::close_chan(bc_, ch.slot);
+                return;
+            }
+            side_ = false;
+            const Val v = expr();
+            if (is("<-"))
+            {
+                p_++;
+                need(v, "chan", "send");
+                const Val x = expr();
+                check_assign(v.ty.substr(5), x);
+                bcw::unop(bc_, selfhost::OP_SEND, v.slot, x.slot);
+                return;
+            }
+            if (!side_)
+                fail("expression is not used as a statement");
+        }
+
+        // name = v 或 name := v；回傳是否宣告了新變數。v 是本語句的暫存時，新變數直接接手其槽位，省一次 COPY
+        bool bind(const std::string &name, const Val &v, bool define)
+        {
+            if (name == "_")
+            {
+                if (v.ty.empty())
+                    fail("function call used as value has no result");
+                return false;
+            }
+            Val *old = define ? (scopes_.back().count(name) ? &scopes_.back()[name] : nullptr) : lookup(name);
+            if (!old && !define)
+                var(name);
+            if (old)
+            {
+                check_assign(old->ty, v);
+                bcw::copy(bc_, old->slot, v.slot);
+                return false;
+            }
+            if (v.ty.empty())
+                fail("function call used as value has no result");
+            if (v.ty == "nil")
+                fail("use of untyped nil in assignment");
+            auto h = std::find(held_.begin(), held_.end(), v.slot);
+            if (h == held_.end())
+            {
+                bcw::copy(bc_, declare(name, v.ty), v.slot);
+                return true;
+            }
+            held_.erase(h); // 暫存不再歸還
+            scopes_.back()[name] = Val{v.slot, v.ty};
+            return true;
+        }
+
+        void if_stmt()
+        {
+            p_++;
+            scopes_.emplace_back(); // if 的初始化語句
+            size_t at;
+            if (find_before_brace([](const Tok &t) { return t.k == T_SEMI; }, at))
+            {
+                simple_stmt();
+                expect_semi();
+            }
+            const size_t m = mark();
+            const Val c = expr();
+            need(c, "bool", "if condition");
+            const size_t jz = bcw::jump(bc_, selfhost::OP_JZ, c.slot);
+            release(m);
+            block();
+            if (is_kw("else"))
+            {
+                p_++;
+                const size_t jend = bcw::jump(bc_, selfhost::OP_JMP);
+                bcw::patch(bc_, jz, bc_.size());
+                dbg_.mark(bc_.size(), peek().line);
+                if (is_kw("if"))
+                    if_stmt();
+                else
+                    block();
+                bcw::patch(bc_, jend, bc_.size());
+            }
+            else
+                bcw::patch(bc_, jz, bc_.size());
+            scopes_.pop_back();
+        }
+
+        void expect_semi()
+        {
+            if (peek().k != T_SEMI)
+                fail("expected ;, found " + shown(peek()));
+            p_++;
+        }
+
+        void for_stmt()
+        {
+            p_++;
+            scopes_.emplace_back();
+            jumps_.push_back(Jumps{true, {}, {}});
+            size_t at;
+            size_t cont = 0, head;
+            if (is("{"))
+            {
+                head = cont = bc_.size();
+                block();
+            }
+            else if (find_before_brace([](const Tok &t) { return t.k == T_IDENT && t.s == "range"; }, at))
+                return range_stmt(at);
+            else if (find_before_brace([](const Tok &t) { return t.k == T_SEMI; }, at))
+            {
+                // for init; cond; post：post 在本體之後才輸出
+                if (peek().k != T_SEMI)
+                    simple_stmt();
+                expect_semi();
+                head = bc_.size();
+                size_t jz = SIZE_MAX;
+                if (peek().k != T_SEMI)
+                {
+                    const size_t m = mark();
+                    const Val c = expr();
+                    need(c, "bool", "for condition");
+                    jz = bcw::jump(bc_, selfhost::OP_JZ, c.slot);
+                    release(m);
+                }
+                expect_semi();
+                const size_t post = p_;
+                while (!is("{"))
+                {
+                    if (peek().k == T_EOF)
+                        fail("unexpected end of file");
+                    p_++;
+                }
+                block();
+                const size_t after = p_;
+                cont = bc_.size();
+                p_ = post;
+                if (!is("{"))
+                {
+                    const size_t m = mark();
+                    simple_stmt();
+                    release(m);
+                }
+                p_ = after;
+                bcw::jump_to(bc_, selfhost::OP_JMP, head);
+                if (jz != SIZE_MAX)
+                    jumps_.back().breaks.push_back(jz);
+                return close_loop(cont);
+            }
+            else
+            {
+                head = cont = bc_.size();
+                const size_t m = mark();
+                const Val c = expr();
+                need(c, "bool", "for condition");
+                jumps_.back().breaks.push_back(bcw::jump(bc_, selfhost::OP_JZ, c.slot));
+                release(m);
+                block();
+            }
+            bcw::jump_to(bc_, selfhost::OP_JMP, head);
+            close_loop(cont);
+        }
+
+        // 迴圈結束：break 跳到這裡，continue 跳到 cont
+        void close_loop(size_t cont)
+        {
+            for (size_t j : jumps_.back().breaks)
+                bcw::patch(bc_, j, bc_.size());
+            for (size_t j : jumps_.back().conts)
+                bcw::patch(bc_, j, cont);
+            jumps_.pop_back();
+            scopes_.pop_back();
+        }
+
+        // for [k] (:= | =) range x：x 為 channel 時逐一接收直到關閉，為整數時 k 從 0 到 x - 1
+        void range_stmt(size_t at)
+        {
+            std::vector<std::string> names;
+            bool define = true;
+            if (p_ != at)
+            {
+                names.push_back(ident());
+                if (is(","))
+                    fail("range over channel or integer permits only one iteration variable");
+                define = is(":=");
+                if (!is(":=") && !is("="))
+                    fail("expected := or = before range");
+                p_++;
+            }
+            p_++; // range
+            const Val x = expr();
+            const uint32_t src = fresh(); // 迴圈期間保留
+            bcw::copy(bc_, src, x.slot);
+            size_t head, cont;
+            if (is_chan(x.ty))
+            {
+                head = cont = bc_.size();
+                const uint32_t v = fresh(), ok = fresh();
+                bcw::recv(bc_, v, ok, src);
+                jumps_.back().breaks.push_back(bcw::jump(bc_, selfhost::OP_JZ, ok));
+                if (!names.empty())
+                    bind(names[0], Val{v, x.ty.substr(5)}, define);
+                block();
+            }
+            else
+            {
+                need(x, "int", "range");
+                const uint32_t i = fresh(), t = fresh(), one = fresh();
+                bcw::set_i64(bc_, i, 0);
+                bcw::set_i64(bc_, one, 1);
+                head = bc_.size();
+                bcw::binop(bc_, selfhost::OP_LT, t, i, src);
+                jumps_.back().breaks.push_back(bcw::jump(bc_, selfhost::OP_JZ, t));
+                if (!names.empty())
+                    bind(names[0], Val{i, "int"}, define);
+                block();
+                cont = bc_.size();
+                bcw::binop(bc_, selfhost::OP_ADD, i, i, one);
+            }
+            bcw::jump_to(bc_, selfhost::OP_JMP, head);
+            close_loop(cont);
+        }
+
+        void branch_stmt()
+        {
+            const bool brk = peek().s == "break";
+            p_++;
+            if (peek().k == T_IDENT)
+                fail("labels are not supported");
+            for (size_t k = jumps_.size(); k-- > 0;)
+                if (brk || jumps_[k].loop)
+                {
+                    const size_t j = bcw::jump(bc_, selfhost::OP_JMP);
+                    (brk ? jumps_[k].breaks : jumps_[k].conts).push_back(j);
+                    return;
+                }
+            fail(brk ? "break is not in a loop or select" : "continue is not in a loop");
+        }
+
+        void return_stmt()
+        {
+            p_++;
+            if (peek().k == T_SEMI || is("}"))
+            {
+                if (!cur_->ret.empty())
+                    fail("not enough return values");
+                if (cur_->name == "main")
+                    bcw::end(bc_);
+                else
+                    bcw::ret(bc_, 0);
+                return;
+            }
+            if (cur_->ret.empty())
+                fail("too many return values");
+            // return f(…)：回傳型別相同的函式呼叫改為 OP_TAILCALL
+            if (peek().k == T_IDENT && is("(", 1) && fidx_.count(peek().s) && peek().s != "main")
+            {
+                const size_t save = p_;
+                const std::string name = ident();
+                const Func &f = funcs_[fidx_[name]];
+                if (f.ret == cur_->ret)
+                {
+                    const std::vector<uint32_t> args = call_args(f);
+                    if (peek().k == T_SEMI || is("}"))
+                    {
+                        fix_.emplace_back(bcw::call(bc_, 0, args, true), fidx_[name]);
+                        return;
+                    }
+                }
+                p_ = save;
+            }
+            const Val v = expr();
+            check_assign(cur_->ret, v);
+            bcw::ret(bc_, v.slot);
+        }
+
+        void go_stmt()
+        {
+            p_++;
+            if (is_kw("func"))
+                fail("function literals are not supported; use go with a named function");
+            const std::string name = ident();
+            if (!fidx_.count(name) || name == "main" || !is("("))
+                fail("go requires a call to a named function");
+            const std::vector<uint32_t> args = call_args(funcs_[fidx_[name]]);
+            fix_.emplace_back(bcw::go(bc_, args), fidx_[name]);
+        }
+
+        // select：先依序求出各分支的 channel 與送出的值，發出 OP_SELECT，再依分支編號跳到各自的本體
+        void select_stmt()
+        {
+            p_++;
+            expect("{");
+            struct Case
+            {
+                bcw::SelectCase sc;
+                std::vector<std::string> names; // 接收分支的變數（0 到 2 個）
+                bool define;
+                size_t body;
+                uint32_t elem_line;
+                std::string elem;
+            };
+            std::vector<Case> cases;
+            bool dflt = false;
+            unsigned nslot = 0;
+            while (!is("}"))
+            {
+                if (peek().k == T_SEMI)
+                {
+                    p_++;
+                    continue;
+                }
+                Case c{bcw::SelectCase{selfhost::SEL_DEFAULT, 0, 0}, {}, false, 0, peek().line, ""};
+                if (is_kw("default"))
+                {
+                    if (dflt)
+                        fail("multiple defaults in select");
+                    dflt = true;
+                    p_++;
+                }
+                else if (is_kw("case"))
+                {
+                    p_++;
+                    size_t k = 0;
+                    while (peek(k).k == T_IDENT && is(",", k + 1))
+                        k += 2;
+                    if (peek(k).k == T_IDENT && (is(":=", k + 1) || is("=", k + 1)))
+                    {
+                        for (size_t q = 0; q <= k; q += 2)
+                            c.names.push_back(peek(q).s);
+                        if (c.names.size() > 2)
+                            fail("too many variables in select case");
+                        p_ += k + 1;
+                        c.define = t_[p_++].s == ":=";
+                        if (!is("<-"))
+                            fail("select case must be receive, send or assign recv");
+                    }
+                    if (is("<-"))
+                    {
+                        p_++;
+                        const Val ch = unary();
+                        need(ch, "chan", "select case");
+                        c.sc = bcw::SelectCase{selfhost::SEL_RECV, ch.slot, 0};
+                        c.elem = ch.ty.substr(5);
+                        nslot += 1;
+                    }
+                    else
+                    {
+                        if (!c.names.empty())
+                            fail("select case must be receive, send or assign recv");
+                        const Val ch = expr();
+                        need(ch, "chan", "select case");
+                        expect("<-");
+                        const Val x = expr();
+                        check_assign(ch.ty.substr(5), x);
+                        c.sc = bcw::SelectCase{selfhost::SEL_SEND, ch.slot, x.slot};
+                        nslot += 2;
+                    }
+                }
+                else
+                    fail("expected case or default, found " + shown(peek()));
+                expect(":");
+                c.body = p_;
+                // 本體之後再輸出：先跳到下一個分支
+                int depth = 0;
+                while (depth > 0 || !(is_kw("case") || is_kw("default") || is("}")))
+                {
+                    if (peek().k == T_EOF)
+                        fail("unexpected end of file");
+                    depth += is("{") ? 1 : is("}") ? -1 : 0;
+                    p_++;
+                }
+                cases.push_back(c);
+            }
+            const size_t end = p_ + 1;
+            if (cases.size() > selfhost::SELECT_MAX_CASES || nslot > selfhost::NATIVE_MAX_ARGS)
+                fail("too many select cases (at most " + std::to_string(selfhost::SELECT_MAX_CASES) + " cases and " +
+                     std::to_string(selfhost::NATIVE_MAX_ARGS) + " channel operands)");
+            std::vector<bcw::SelectCase> scs;
+            for (auto &c : cases)
+                scs.push_back(c.sc);
+            const uint32_t idx = temp(), v = temp(), ok = temp();
+            bcw::select(bc_, idx, v, ok, scs);
+            jumps_.push_back(Jumps{false, {}, {}});
+            for (size_t k = 0; k < cases.size(); k++)
+            {
+                Case &c = cases[k];
+                size_t next = SIZE_MAX;
+                if (k + 1 < cases.size())
+                {
+                    const size_t m = mark();
+                    const uint32_t t = temp();
+                    bcw::binop(bc_, selfhost::OP_EQ, t, idx, konst((int64_t)k).slot);
+                    next = bcw::jump(bc_, selfhost::OP_JZ, t);
+                    release(m);
+                }
+                scopes_.emplace_back();
+                p_ = c.body;
+                dbg_.mark(bc_.size(), c.elem_line);
+                if (!c.names.empty())
+                    bind(c.names[0], Val{v, c.elem}, c.define);
+                if (c.names.size() > 1)
+                    bind(c.names[1], Val{ok, "bool"}, c.define);
+                while (!(is_kw("case") || is_kw("default") || is("}")))
+                {
+                    if (peek().k == T_SEMI)
+                        p_++;
+                    else
+                        stmt();
+                }
+                scopes_.pop_back();
+                if (k + 1 < cases.size())
+                    jumps_.back().breaks.push_back(bcw::jump(bc_, selfhost::OP_JMP));
+                if (next != SIZE_MAX)
+                    bcw::patch(bc_, next, bc_.size());
+            }
+            for (size_t j : jumps_.back().breaks)
+                bcw::patch(bc_, j, bc_.size());
+            jumps_.pop_back();
+            p_ = end;
+        }
+
+        // ---- 輸出 ----
+        void print_stmt()
+        {
+            p_ += 2;
+            const std::string fn = ident();
+            if (fn != "Println" && fn != "Print" && fn != "Printf")
+                fail("unsupported function fmt." + fn);
+            expect("(");
+            std::vector<Piece> ps;
+            if (fn == "Printf")
+            {
+                if (peek().k != T_STR)
+                    fail("fmt.Printf format must be a string literal");
+                const std::string f = t_[p_++].s;
+                printf_pieces(f, ps);
+            }
+            else
+            {
+                bool prev_str = false;
+                for (size_t k = 0; !is(")"); k++)
+                {
+                    if (k)
+                        expect(",");
+                    if (is(")"))
+                        break;
+                    const bool str = peek().k == T_STR && (is(",", 1) || is(")", 1));
+                    if (k && (fn == "Println" || (!str && !prev_str)))
+                        ps.push_back(Piece{Piece::LIT, " ", 0});
+                    if (str)
+                        ps.push_back(Piece{Piece::LIT, t_[p_++].s, 0});
+                    else
+                        value_piece(expr(), "%d", ps);
+                    prev_str = str;
+                }
+                if (fn == "Println")
+                    ps.push_back(Piece{Piece::LIT, "\n", 0});
+            }
+            expect(")");
+            emit_pieces(ps);
+        }
+
+        void value_piece(const Val &v, const std::string &spec, std::vector<Piece> &ps)
+        {
+            if (v.ty == "int")
+                ps.push_back(Piece{Piece::INT, spec, v.slot});
+            else if (v.ty == "bool")
+                ps.push_back(Piece{Piece::BOOL, "", v.slot});
+            else if (v.ty == "struct{}")
+                ps.push_back(Piece{Piece::LIT, "{}", 0});
+            else if (v.ty == "nil")
+                ps.push_back(Piece{Piece::LIT, "<nil>", 0});
+            else if (v.ty.empty())
+                fail("function call used as value has no result");
+            else
+                fail("printing a " + v.ty + " is not supported");
+        }
+
+        // Printf 的格式：%v / %d / %t 與整數的 %x %X %o %c（可帶旗標與寬度）；參數必須剛好用完
+        void printf_pieces(const std::string &f, std::vector<Piece> &ps)
+        {
+            std::string lit;
+            for (size_t i = 0; i < f.size(); i++)
+            {
+                if (f[i] != '%')
+                {
+                    lit += f[i];
+                    continue;
+                }
+                if (i + 1 < f.size() && f[i + 1] == '%')
+                {
+                    lit += '%';
+                    i++;
+                    continue;
+                }
+                size_t j = i + 1;
+                while (j < f.size() && std::strchr("-+ #0123456789.", f[j]))
+                    j++;
+                if (j >= f.size())
+                    fail("incomplete verb in fmt.Printf format");
+                const char verb = f[j];
+                if (!std::strchr("vdtxXoc", verb))
+                    fail(std::string("unsupported verb %") + verb + " in fmt.Printf format");
+                if (!is(","))
+                    fail(std::string("missing argument for %") + verb);
+                p_++;
+                const Val v = expr();
+                if (!lit.empty())
+                    ps.push_back(Piece{Piece::LIT, lit, 0});
+                lit.clear();
+                if (v.ty == "bool" && verb != 'v' && verb != 't')
+                    fail(std::string("%") + verb + " needs an integer");
+                if (v.ty == "int" && verb == 't')
+                    fail("%t needs a bool");
+                value_piece(v, f.substr(i, j - i) + (verb == 'v' ? 'd' : verb), ps);
+                i = j;
+            }
+            if (!lit.empty())
+                ps.push_back(Piece{Piece::LIT, lit, 0});
+            if (is(","))
+                fail("too many arguments for fmt.Printf format");
+        }
+
+        // 只有字面值（以換行結尾）時用 OP_PRINT，單一整數加換行用 OP_PRINT_INT；
+        // 其餘字面值與整數合併成 輸出格式 呼叫，布林以分支印出 true / false
+        void emit_pieces(std::vector<Piece> &ps)
+        {
+            std::vector<Piece> m;
+            for (auto &p : ps)
+                if (p.kind == Piece::LIT && !m.empty() && m.back().kind == Piece::LIT)
+                    m.back().text += p.text;
+                else if (p.kind != Piece::LIT || !p.text.empty())
+                    m.push_back(p);
+            if (m.size() == 1 && m[0].kind == Piece::LIT && m[0].text.back() == '\n')
+            {
+                bcw::print(bc_, pool_, m[0].text.substr(0, m[0].text.size() - 1));
+                return;
+            }
+            if (m.size() == 2 && m[0].kind == Piece::INT && m[0].text == "%d" && m[1].kind == Piece::LIT &&
+                m[1].text == "\n")
+            {
+                bcw::print_int(bc_, m[0].slot);
+                return;
+            }
+            std::string fmt;
+            std::vector<uint32_t> args;
+            auto flush = [&]()
+            {
+                if (fmt.empty())
+                    return;
+                if (args.empty())
+                {
+                    // 只有字面值：還原 %% 給 印出
+                    std::string raw;
+                    for (size_t i = 0; i < fmt.size(); i++)
+                    {
+                        raw += fmt[i];
+                        if (fmt[i] == '%' && i + 1 < fmt.size() && fmt[i + 1] == '%')
+                            i++;
+                    }
+                    fmt.swap(raw);
+                }
+                natives_ = true;
+                std::vector<uint32_t> ops{pool_.intern(fmt)};
+                ops.insert(ops.end(), args.begin(), args.end());
+                bcw::call_native(bc_, args.empty() ? selfhost::NF_WRITE : selfhost::NF_PRINTF, 0, ops);
+                fmt.clear();
+                args.clear();
+            };
+            for (auto &p : m)
+            {
+                if (p.kind == Piece::BOOL)
+                {
+                    flush();
+                    natives_ = true;
+                    const size_t jz = bcw::jump(bc_, selfhost::OP_JZ, p.slot);
+                    bcw::call_native(bc_, selfhost::NF_WRITE, 0, {pool_.intern("true")});
+                    const size_t jend = bcw::jump(bc_, selfhost::OP_JMP);
+                    bcw::patch(bc_, jz, bc_.size());
+                    bcw::call_native(bc_, selfhost::NF_WRITE, 0, {pool_.intern("false")});
+                    bcw::patch(bc_, jend, bc_.size());
+                    continue;
+                }
+                if (p.kind == Piece::INT)
+                {
+                    if (args.size() == selfhost::NATIVE_MAX_ARGS)
+                        flush();
+                    fmt += p.text;
+                    args.push_back(p.slot);
+                    continue;
+                }
+                // 輸出格式 的字面 % 需寫成 %%；印出 則原樣輸出
+                for (char c : p.text)
+                    fmt += c == '%' ? "%%" : std::string(1, c);
+            }
+            flush();
+        }
+
+        // ---- 運算式 ----
+        static selfhost::Op arith_op(const std::string &op)
+        {
+            if (op == "+")
+                return selfhost::OP_ADD;
+            if (op == "-")
+                return selfhost::OP_SUB;
+            if (op == "*")
+                return selfhost::OP_MUL;
+            if (op == "/")
+                return selfhost::OP_DIV;
+            if (op == "%")
+                return selfhost::OP_MOD;
+            return selfhost::OP_END;
+        }
+
+        static int prec(const Tok &t)
+        {
+            if (t.k != T_OP)
+                return 0;
+            const std::string &s = t.s;
+            if (s == "||")
+                return 1;
+            if (s == "&&")
+                return 2;
+            if (s == "==" || s == "!=" || s == "<" || s == "<=" || s == ">" || s == ">=")
+                return 3;
+            if (s == "+" || s == "-" || s == "|" || s == "^")
+                return 4;
+            if (s == "*" || s == "/" || s == "%" || s == "<<" || s == ">>" || s == "&" || s == "&^")
+                return 5;
+            return 0;
+        }
+
+        Val expr() { return binary(1); }
+
+        Val binary(int min)
+        {
+            Val l = unary();
+            for (;;)
+            {
+                const int pr = prec(peek());
+                if (pr == 0 || pr < min)
+                    return l;
+                const std::string op = t_[p_++].s;
+                if (op == "&&" || op == "||")
+                {
+                    // 短路：結果先放左值，必要時才求右值
+                    need(l, "bool", op.c_str());
+                    const uint32_t d = temp();
+                    bcw::copy(bc_, d, l.slot);
+                    const size_t j = bcw::jump(bc_, op == "&&" ? selfhost::OP_JZ : selfhost::OP_JNZ, d);
+                    const Val r = binary(pr + 1);
+                    need(r, "bool", op.c_str());
+                    bcw::copy(bc_, d, r.slot);
+                    bcw::patch(bc_, j, bc_.size());
+                    l = Val{d, "bool"};
+                    continue;
+                }
+                const Val r = binary(pr + 1);
+                l = binop(op, l, r);
+            }
+        }
+
+        Val binop(const std::string &op, const Val &l, const Val &r)
+        {
+            const uint32_t d = temp();
+            if (pr_cmp(op))
+            {
+                const bool eq = op == "==" || op == "!=";
+                if (l.ty.empty() || r.ty.empty())
+                    fail("function call used as value has no result");
+                if (eq ? !(assignable(l.ty, r.ty) || assignable(r.ty, l.ty)) : (l.ty != "int" || r.ty != "int"))
+                    fail("invalid operation: " + l.ty + " " + op + " " + r.ty);
+                static const std::map<std::string, selfhost::Op> ops = {
+                    {"==", selfhost::OP_EQ}, {"!=", selfhost::OP_NE}, {"<", selfhost::OP_LT},
+                    {"<=", selfhost::OP_LE}, {">", selfhost::OP_GT},  {">=", selfhost::OP_GE}};
+                bcw::binop(bc_, ops.at(op), d, l.slot, r.slot);
+                return Val{d, "bool"};
+            }
+            const selfhost::Op o = arith_op(op);
+            if (o == selfhost::OP_END)
+                fail("operator " + op + " is not supported");
+            need(l, "int", op.c_str());
+            need(r, "int", op.c_str());
+            bcw::binop(bc_, o, d, l.slot, r.slot);
+            return Val{d, "int"};
+        }
+        static bool pr_cmp(const std::string &op) { return prec(Tok{T_OP, op, 0, 0}) == 3; }
+
+        Val unary()
+        {
+            if (is("-") || is("+") || is("!"))
+            {
+                const std::string op = t_[p_++].s;
+                if (op == "-" && peek().k == T_INT)
+                    return konst((int64_t)(0 - (uint64_t)t_[p_++].v));
+                const Val v = unary();
+                if (op == "+")
+                {
+                    need(v, "int", "+");
+                    return v;
+                }
+                const uint32_t d = temp();
+                if (op == "-")
+                {
+                    need(v, "int", "-");
+                    bcw::binop(bc_, selfhost::OP_SUB, d, konst(0).slot, v.slot);
+                    return Val{d, "int"};
+                }
+                need(v, "bool", "!");
+                bcw::binop(bc_, selfhost::OP_EQ, d, v.slot, konst(0).slot);
+                return Val{d, "bool"};
+            }
+            if (is("<-"))
+            {
+                p_++;
+                const Val ch = unary();
+                need(ch, "chan", "receive");
+                const uint32_t d = temp(), ok = temp();
+                bcw::recv(bc_, d, ok, ch.slot);
+                side_ = true;
+                return Val{d, ch.ty.substr(5)};
+            }
+            if (is("^") || is("&") || is("*"))
+                fail("operator " + peek().s + " is not supported");
+            return primary();
+        }
+
+        std::vector<uint32_t> call_args(const Func &f)
+        {
+            expect("(");
+            std::vector<uint32_t> args;
+            while (!is(")"))
+            {
+                if (!args.empty())
+                    expect(",");
+                const Val v = expr();
+                if (args.size() >= f.params.size())
+                    fail("too many arguments in call to " + f.name);
+                check_assign(f.ptypes[args.size()], v);
+                args.push_back(v.slot);
+            }
+            p_++;
+            if (args.size() != f.params.size())
+                fail("not enough arguments in call to " + f.name);
+            return args;
+        }
+
+        Val primary()
+        {
+            const Tok &t = peek();
+            if (t.k == T_INT)
+            {
+                p_++;
+                return konst(t.v);
+            }
+            if (t.k == T_STR)
+                fail("string values are only supported as fmt.Print / Println / Printf arguments");
+            if (is("("))
+            {
+                p_++;
+                const Val v = expr();
+                expect(")");
+                return v;
+            }
+            if (t.k != T_IDENT)
+                fail("unexpected " + shown(t));
+            const std::string name = t.s;
+            if (!lookup(name))
+            {
+                if (name == "true" || name == "false")
+                {
+                    p_++;
+                    return konst(name == "true", "bool");
+                }
+                if (name == "nil")
+                {
+                    p_++;
+                    return konst(0, "nil");
+                }
+                if (name == "make")
+                {
+                    p_++;
+                    expect("(");
+                    const std::string ty = type();
+                    if (!is_chan(ty))
+                        fail("make supports only channels");
+                    Val cap = is(",") ? (p_++, expr()) : konst(0);
+                    need(cap, "int", "make");
+                    expect(")");
+                    const uint32_t d = temp();
+                    bcw::unop(bc_, selfhost::OP_CHAN, d, cap.slot);
+                    return Val{d, ty};
+                }
+                if (name == "struct")
+                {
+                    const std::string ty = type();
+                    expect("{");
+                    expect("}");
+                    return konst(0, ty.c_str());
+                }
+                if (is("(", 1))
+                {
+                    if (name == "int" || name == "int64")
+                    {
+                        p_ += 2;
+                        const Val v = expr();
+                        need(v, "int", name.c_str());
+                        expect(")");
+                        return v;
+                    }
+                    if (fidx_.count(name))
+                    {
+                        if (name == "main")
+                            fail("cannot call main");
+                        p_++;
+                        const size_t f = fidx_[name];
+                        const std::vector<uint32_t> args = call_args(funcs_[f]);
+                        const uint32_t d = temp();
+                        fix_.emplace_back(bcw::call(bc_, d, args), f);
+                        side_ = true;
+                        return Val{d, funcs_[f].ret};
+                    }
+                }
+                if (name == "func")
+                    fail("function literals are not supported");
+                if (is(".", 1))
+                    fail("unsupported selector " + name + "." + peek(2).s);
+                if (name == "len" || name == "cap" || name == "append" || name == "new" || name == "panic" ||
+                    name == "print" || name == "println")
+                    fail("builtin " + name + " is not supported");
+            }
+            p_++;
+            if (is("(") && !fidx_.count(name))
+                fail("cannot call non-function " + name);
+            return var(name);
+        }
+    };
+}
+
+bool FE_GoLite::accepts(const std::string &path, const std::string &src) const
+{
+    auto ends = [&](const char *ext)
+    { return path.size() >= 3 && path.rfind(ext) == path.size() - strlen(ext); };
+    if (ends(".go"))
+        return true;
+    // 內容嗅探：有 package / import / fmt.Println( 或 := )
+    if (src.find("fmt.Println(") != std::string::npos)
+        return true;
+    if (src.find("package ") != std::string::npos)
+        return true;
+    return false;
+}
+
+bool FE_GoLite::compile(const FrontendContext &ctx, Bytecode &out, std::string &err) const
+{
+    std::string src = ctx.src;
+    // BOM/換行正規化
+    strip_utf8_bom(src);
+    normalize_newlines(src);
+
+    try
+    {
+        GoLower L(ctx.path, lex(src));
+        L.run(out.data);
+    }
+    catch (const GoError &e)
+    {
+        err = "line " + std::to_string(e.line) + ": " + e.what();
+        return false;
+    }
+    return true;
+}
+
+extern "C" void register_fe_golite()
+{
+    FrontendRegistry::instance().register_frontend(std::make_unique<FE_GoLite>());
+}
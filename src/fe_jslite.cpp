@@ -1,130 +1,134 @@
-#include "../include/frontend.h"
-#include "../include/fe_jslite.h"
-#include <regex>
-#include <map>
-#include <sstream>
-#include <cstdint>
-
-// 共用小工具：BOM/換行正規化
-static inline void strip_utf8_bom(std::string &s)
-{
-  if (s.size() >= 3 &&
-      (unsigned char)s[0] == 0xEF &&
-      (unsigned char)s[1] == 0xBB &&
-      (unsigned char)s[2] == 0xBF)
-  {
-    s.erase(0, 3);
-  }
-}
-
-static inline void normalize_newlines(std::string &s)
-{
-  // 把 CRLF/CR 全部正規化成 \n
-  std::string out;
-  out.reserve(s.size());
-  for (size_t i = 0; i < s.size(); ++i)
-  {
-    char c = s[i];
-    if (c == '\r')
-    {
-      if (i + 1 < s.size() && s[i + 1] == '\n')
-        ++i; // 吃掉 \r\n 的 \n
-      out.push_back('\n');
-    }
-    else
-    {
-      out.push_back(c);
-    }
-  }
-  s.swap(out);
-}
-
-class FE_JSLite final : public IFrontend
-{
-public:
-  std::string name() const override { return "js-lite"; }
-  bool accepts(const std::string &fn, const std::string &src) const override
-  {
-    auto n = fn.size();
-    return (n >= 3 && (fn.substr(n - 3) == ".js" || fn.substr(n - 4) == ".mjs")) || src.rfind("// js-lite", 0) == 0;
-  }
-  bool compile(const FrontendContext &ctx, Bytecode &out, std::string &err) const override
-  {
-    std::string src = ctx.src;
-    // BOM/換行正規化
-    strip_utf8_bom(src);
-    normalize_newlines(src);
-
-    out.data.clear();
-    std::map<std::string, uint8_t> slot; // name -> id
-    auto get_slot = [&](const std::string &name) -> uint8_t
-    {
-      auto it = slot.find(name);
-      if (it != slot.end())
-        return it->second;
-      uint8_t id = (uint8_t)slot.size();
-      slot[name] = id;
-      return id;
-    };
-    auto u8 = [&](unsigned v)
-    { out.data.push_back((unsigned char)v); };
-    auto u64 = [&](uint64_t v)
-    { for(int i=0;i<8;++i) out.data.push_back((unsigned char)((v>>(i*8))&0xFF)); };
-    auto i64 = [&](int64_t v)
-    { u64((uint64_t)v); };
-    auto s64 = [&](const std::string &s)
-    { u64((uint64_t)s.size()); out.data.insert(out.data.end(), s.begin(), s.end()); };
-
-    std::regex re_log_s(R"(console\.log\(\s*\"([^\"]*)\"\s*\)\s*;)");
-    std::regex re_let(R"(let\s+([A-Za-z_]\w*)\s*=\s*([0-9]+)\s*;)");
-    std::regex re_log_id(R"(console\.log\(\s*([A-Za-z_]\w*)\s*\)\s*;)");
-
-    std::stringstream ss(src);
-    std::string line;
-    std::smatch m;
-    while (std::getline(ss, line))
-    {
-      if (std::regex_search(line, m, re_log_s))
-      {
-        std::string str = m[1].str();
-        u8(0x01); // OP_PRINT
-        s64(str);
-      }
-      else if (std::regex_search(line, m, re_let))
-      {
-        std::string var = m[1].str();
-        int64_t val = std::stoll(m[2]);
-        uint8_t id = get_slot(var);
-        u8(0x03); // OP_SET_I64
-        u8(id);
-        i64(val);
-      }
-      else if (std::regex_search(line, m, re_log_id))
-      {
-        std::string var = m[1].str();
-        uint8_t id = get_slot(var);
-        u8(0x02); // OP_PRINT_INT
-        u8(id);
-      }
-      else if (line.find_first_not_of(" \t\r\n") == std::string::npos)
-      {
-      }
-      else
-      {
-        err = "Unsupported JS-lite: " + line;
-        return false;
-      }
-    }
-    u8(0x04); // OP_END
-    return true;
-  }
-};
-
-extern "C" void register_fe_jslite()
-{
-  FrontendRegistry::instance().register_frontend(std::make_unique<FE_JSLite>());
-}
-static struct _Auto
-{
-  _Auto() { register_fe_jslite(); }
-} _autoreg;
+#include "../include/frontend.h"
+#include "../include/zh_bytecode.h"
+#include "../include/fe_jslite.h"
+#include "../include/fe_script.h"
+#include <regex>
+#include <set>
+#include <sstream>
+#include <cstdint>
+
+// 共用小工具：BOM/換行正規化
+static inline void strip_utf8_bom(std::string &s)
+{
+  if (s.size() >= 3 &&
+      (unsigned char)s[0] == 0xEF &&
+      (unsigned char)s[1] == 0xBB &&
+      (unsigned char)s[2] == 0xBF)
+  {
+    s.erase(0, 3);
+  }
+}
+
+static inline void normalize_newlines(std::string &s)
+{
+  // 把 CRLF/CR 全部正規化成 \n
+  std::string out;
+  out.reserve(s.size());
+  for (size_t i = 0; i < s.size(); ++i)
+  {
+    char c = s[i];
+    if (c == '\r')
+    {
+      if (i + 1 < s.size() && s[i + 1] == '\n')
+        ++i; // 吃掉 \r\n 的 \n
+      out.push_back('\n');
+    }
+    else
+    {
+      out.push_back(c);
+    }
+  }
+  s.swap(out);
+}
+
+class FE_JSLite final : public IFrontend
+{
+public:
+  std::string name() const override { return "js-lite"; }
+  bool accepts(const std::string &fn, const std::string &src) const override
+  {
+    auto n = fn.size();
+    return (n >= 3 && (fn.substr(n - 3) == ".js" || fn.substr(n - 4) == ".mjs")) || src.rfind("// js-lite", 0) == 0;
+  }
+  bool compile(const FrontendContext &ctx, Bytecode &out, std::string &err) const override
+  {
+    std::string src = ctx.src;
+    // BOM/換行正規化
+    strip_utf8_bom(src);
+    normalize_newlines(src);
+
+    // 變數型別不一致時，把這些變數改成動態值再降階一次（每輪至少多一個，必定結束）
+    std::set<std::string> dynamic;
+    for (;;)
+    {
+      std::set<std::string> conflicts;
+      if (!lower(ctx.path, src, dynamic, out, conflicts, err))
+        return false;
+      if (conflicts.empty())
+        return true;
+      dynamic.insert(conflicts.begin(), conflicts.end());
+    }
+  }
+
+private:
+  static bool lower(const std::string &path, const std::string &src, const std::set<std::string> &dynamic,
+                    Bytecode &out, std::set<std::string> &conflicts, std::string &err)
+  {
+    std::vector<uint8_t> code;
+    selfhost::bcw::StrPool pool;
+    selfhost::bcw::DebugTable dbg(path); // 每行起點 → 行號
+    script::Lowering L(code, pool, script::JS, dynamic);
+    uint32_t lineno = 0;
+
+    std::regex re_log(R"(^\s*console\.log\s*\((.*)\)\s*;?\s*$)");
+    std::regex re_assign(R"(^\s*(?:(?:let|const|var)\s+)?([A-Za-z_$][\w$]*)\s*=(?!=)\s*(.*?)\s*;?\s*$)");
+
+    std::stringstream ss(src);
+    std::string line, type_err;
+    std::smatch m;
+    while (std::getline(ss, line))
+    {
+      dbg.mark(code.size(), ++lineno);
+      line = script::strip_comment(line, "//");
+      L.begin_stmt();
+      try
+      {
+        if (std::regex_match(line, m, re_log))
+          L.print(m[1].str());
+        else if (std::regex_match(line, m, re_assign))
+          L.assign(m[1].str(), m[2].str());
+        else if (line.find_first_not_of(" \t\r\n") != std::string::npos)
+        {
+          err = "Unsupported JS-lite: " + line;
+          return false;
+        }
+      }
+      catch (const std::exception &e)
+      {
+        err = "line " + std::to_string(lineno) + ": " + e.what();
+        return false;
+      }
+      if (type_err.empty() && !L.type_error().empty())
+        type_err = "line " + std::to_string(lineno) + ": " + L.type_error();
+    }
+    conflicts = L.conflicts();
+    if (conflicts.empty() && !type_err.empty())
+    {
+      err = type_err; // 變數都已是最終型別，錯誤確實存在
+      return false;
+    }
+    dbg.mark(code.size(), 0);
+    selfhost::bcw::end(code);
+    // 常數初始化放在最前面，行表位移一併後移
+    out.data = L.prologue();
+    out.data.insert(out.data.end(), code.begin(), code.end());
+    dbg.shift(L.prologue().size());
+    selfhost::bcw::finish(out.data, L.frame(), pool, &dbg);
+    return true;
+  }
+};
+
+extern "C" void register_fe_jslite()
+{
+  FrontendRegistry::instance().register_frontend(std::make_unique<FE_JSLite>());
+}
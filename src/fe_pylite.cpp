@@ -1,146 +1,146 @@
-#include "../include/fe_pylite.h"
-#include "../include/frontend.h"
-#include <regex>
-#include <map>
-#include <sstream>
-
-// 共用小工具：BOM/換行正規化
-static inline void strip_utf8_bom(std::string &s)
-{
-    if (s.size() >= 3 &&
-        (unsigned char)s[0] == 0xEF &&
-        (unsigned char)s[1] == 0xBB &&
-        (unsigned char)s[2] == 0xBF)
-    {
-        s.erase(0, 3);
-    }
-}
-
-static inline void normalize_newlines(std::string &s)
-{
-    // 把 CRLF/CR 全部正規化成 \n
-    std::string out;
-    out.reserve(s.size());
-    for (size_t i = 0; i < s.size(); ++i)
-    {
-        char c = s[i];
-        if (c == '\r')
-        {
-            if (i + 1 < s.size() && s[i + 1] == '\n')
-                ++i; // 吃掉 \r\n 的 \n
-            out.push_back('\n');
-        }
-        else
-        {
-            out.push_back(c);
-        }
-    }
-    s.swap(out);
-}
-
-class FE_PyLite final : public IFrontend
-{
-public:
-    std::string name() const override { return "py-lite"; }
-    bool accepts(const std::string &path, const std::string &src) const override;
-    bool compile(const FrontendContext &ctx, Bytecode &out, std::string &err) const override;
-};
-
-static void u8(std::vector<uint8_t> &v, uint8_t x) { v.push_back(x); }
-static void u64le(std::vector<uint8_t> &v, uint64_t x)
-{
-    for (int i = 0; i < 8; i++)
-        v.push_back((uint8_t)(x >> (8 * i)));
-}
-static void i64le(std::vector<uint8_t> &v, int64_t x) { u64le(v, (uint64_t)x); }
-static void emit_print(Bytecode &bc, const std::string &s)
-{
-    u8(bc.data, 0x01);
-    u64le(bc.data, (uint64_t)s.size());
-    bc.data.insert(bc.data.end(), s.begin(), s.end());
-}
-static void emit_set_i64(Bytecode &bc, uint8_t slot, int64_t v)
-{
-    u8(bc.data, 0x03);
-    u8(bc.data, slot);
-    i64le(bc.data, v);
-}
-static void emit_print_int(Bytecode &bc, uint8_t slot)
-{
-    u8(bc.data, 0x02);
-    u8(bc.data, slot);
-}
-
-static std::string trim(const std::string &s)
-{
-    size_t a = 0, b = s.size();
-    while (a < b && isspace((unsigned char)s[a]))
-        a++;
-    while (b > a && isspace((unsigned char)s[b - 1]))
-        b--;
-    return s.substr(a, b - a);
-}
-
-bool FE_PyLite::accepts(const std::string &path, const std::string &src) const
-{
-    if (path.size() >= 3 && path.rfind(".py") == path.size() - 3)
-        return true;
-    if (src.find("print(") != std::string::npos)
-        return true;
-    return false;
-}
-
-bool FE_PyLite::compile(const FrontendContext &ctx, Bytecode &out, std::string &err) const
-{
-    std::string src = ctx.src;
-    // BOM/換行正規化
-    strip_utf8_bom(src);
-    normalize_newlines(src);
-
-    std::map<std::string, uint8_t> slot;
-    auto slot_of = [&](const std::string &name) -> uint8_t
-    {
-        auto it = slot.find(name);
-        if (it != slot.end())
-            return it->second;
-        uint8_t id = (uint8_t)slot.size();
-        slot[name] = id;
-        return id;
-    };
-
-    std::regex re_print_s(R"(^print\(\s*\"([^\"]*)\"\s*\)\s*$)");
-    std::regex re_set_i(R"(^([A-Za-z_]\w*)\s*=\s*(-?\d+)\s*$)");
-    std::regex re_print_i(R"(^print\(\s*([A-Za-z_]\w*)\s*\)\s*$)");
-
-    std::string line;
-    std::stringstream ss(src);
-    while (std::getline(ss, line))
-    {
-        line = trim(line);
-        std::smatch m;
-        if (std::regex_match(line, m, re_print_s))
-        {
-            emit_print(out, m[1].str());
-            continue;
-        }
-        if (std::regex_match(line, m, re_set_i))
-        {
-            auto id = slot_of(m[1].str());
-            emit_set_i64(out, id, std::stoll(m[2].str()));
-            continue;
-        }
-        if (std::regex_match(line, m, re_print_i))
-        {
-            auto id = slot_of(m[1].str());
-            emit_print_int(out, id);
-            continue;
-        }
-    }
-    u8(out.data, 0x04);
-    return true;
-}
-
-extern "C" void register_fe_pylite()
-{
-    FrontendRegistry::instance().register_frontend(std::make_unique<FE_PyLite>());
-}
+#include "../include/fe_pylite.h"
+#include "../include/frontend.h"
+#include "../include/zh_bytecode.h"
+#include "../include/fe_script.h"
+#include <regex>
+#include <set>
+#include <sstream>
+
+// 共用小工具：BOM/換行正規化
+static inline void strip_utf8_bom(std::string &s)
+{
+    if (s.size() >= 3 &&
+        (unsigned char)s[0] == 0xEF &&
+        (unsigned char)s[1] == 0xBB &&
+        (unsigned char)s[2] == 0xBF)
+    {
+        s.erase(0, 3);
+    }
+}
+
+static inline void normalize_newlines(std::string &s)
+{
+    // 把 CRLF/CR 全部正規化成 \n
+    std::string out;
+    out.reserve(s.size());
+    for (size_t i = 0; i < s.size(); ++i)
+    {
+        char c = s[i];
+        if (c == '\r')
+        {
+            if (i + 1 < s.size() && s[i + 1] == '\n')
+                ++i; // 吃掉 \r\n 的 \n
+            out.push_back('\n');
+        }
+        else
+        {
+            out.push_back(c);
+        }
+    }
+    s.swap(out);
+}
+
+class FE_PyLite final : public IFrontend
+{
+public:
+    std::string name() const override { return "py-lite"; }
+    bool accepts(const std::string &path, const std::string &src) const override;
+    bool compile(const FrontendContext &ctx, Bytecode &out, std::string &err) const override;
+};
+
+static std::string trim(const std::string &s)
+{
+    size_t a = 0, b = s.size();
+    while (a < b && isspace((unsigned char)s[a]))
+        a++;
+    while (b > a && isspace((unsigned char)s[b - 1]))
+        b--;
+    return s.substr(a, b - a);
+}
+
+bool FE_PyLite::accepts(const std::string &path, const std::string &src) const
+{
+    if (path.size() >= 3 && path.rfind(".py") == path.size() - 3)
+        return true;
+    if (src.find("print(") != std::string::npos)
+        return true;
+    return false;
+}
+
+// 降階一次；型別與先前不同的變數放進 conflicts（見 script::Lowering）
+static bool lower(const FrontendContext &ctx, const std::string &src, const std::set<std::string> &dynamic,
+                  Bytecode &out, std::set<std::string> &conflicts, std::string &err)
+{
+    std::vector<uint8_t> code;
+    selfhost::bcw::StrPool pool; // PRINT 字串去重
+    selfhost::bcw::DebugTable dbg(ctx.path); // 每行起點 → 行號
+    script::Lowering L(code, pool, script::PY, dynamic);
+    uint32_t lineno = 0;
+
+    std::regex re_print(R"(^print\s*\((.*)\)$)");
+    std::regex re_assign(R"(^([A-Za-z_]\w*)\s*=(?!=)\s*(.+)$)");
+
+    std::string line, type_err;
+    std::stringstream ss(src);
+    while (std::getline(ss, line))
+    {
+        dbg.mark(code.size(), ++lineno);
+        line = trim(script::strip_comment(line, "#"));
+        L.begin_stmt();
+        std::smatch m;
+        try
+        {
+            if (std::regex_match(line, m, re_print))
+                L.print(m[1].str());
+            else if (std::regex_match(line, m, re_assign))
+                L.assign(m[1].str(), m[2].str());
+            // 其他語句略過
+        }
+        catch (const std::exception &e)
+        {
+            err = "line " + std::to_string(lineno) + ": " + e.what();
+            return false;
+        }
+        if (type_err.empty() && !L.type_error().empty())
+            type_err = "line " + std::to_string(lineno) + ": " + L.type_error();
+    }
+    conflicts = L.conflicts();
+    if (conflicts.empty() && !type_err.empty())
+    {
+        err = type_err; // 變數都已是最終型別，錯誤確實存在
+        return false;
+    }
+    dbg.mark(code.size(), 0);
+    selfhost::bcw::end(code);
+    // 常數初始化放在最前面，行表位移一併後移
+    out.data = L.prologue();
+    out.data.insert(out.data.end(), code.begin(), code.end());
+    dbg.shift(L.prologue().size());
+    selfhost::bcw::finish(out.data, L.frame(), pool, &dbg);
+    return true;
+}
+
+bool FE_PyLite::compile(const FrontendContext &ctx, Bytecode &out, std::string &err) const
+{
+    std::string src = ctx.src;
+    // BOM/換行正規化
+    strip_utf8_bom(src);
+    normalize_newlines(src);
+
+    // 變數型別不一致時，把這些變數改成動態值再降階一次（每輪至少多一個，必定結束）
+    std::set<std::string> dynamic;
+    for (;;)
+    {
+        std::set<std::string> conflicts;
+        if (!lower(ctx, src, dynamic, out, conflicts, err))
+            return false;
+        if (conflicts.empty())
+            return true;
+        dynamic.insert(conflicts.begin(), conflicts.end());
+    }
+}
+
+extern "C" void register_fe_pylite()
+{
+    FrontendRegistry::instance().register_frontend(std::make_unique<FE_PyLite>());
+}
@@ -0,0 +1,558 @@
+// fe_script.cpp — js-lite / py-lite 共用的運算式降階（型別推斷 + 動態值）
+#include "../include/fe_script.h"
+#include <cctype>
+#include <cstdlib>
+#include <stdexcept>
+
+using namespace selfhost;
+
+namespace script
+{
+    const Dialect JS = {"true", "false", "null", DF_JS, true, true, true, false};
+    const Dialect PY = {"True", "False", "None", DF_PY, false, false, false, true};
+
+    static ValueTag tag_of(Ty t)
+    {
+        switch (t)
+        {
+        case Ty::Int: return VT_I64;
+        case Ty::F64: return VT_F64;
+        case Ty::Bool: return VT_BOOL;
+        case Ty::Str: return VT_STR;
+        default: return VT_NIL;
+        }
+    }
+    static bool numeric(Ty t) { return t == Ty::Int || t == Ty::F64 || t == Ty::Bool; }
+
+    // 自 s[p] 的引號起讀一個字串字面值（'…' 或 "…"，支援 \n \t \r \0 \\ \' \"），p 移到結尾引號之後
+    static bool read_string(const std::string &s, size_t &p, std::string &out)
+    {
+        if (p >= s.size() || (s[p] != '"' && s[p] != '\''))
+            return false;
+        const char q = s[p];
+        out.clear();
+        for (size_t i = p + 1; i < s.size(); ++i)
+        {
+            char c = s[i];
+            if (c == q)
+            {
+                p = i + 1;
+                return true;
+            }
+            if (c == '\\' && i + 1 < s.size())
+            {
+                c = s[++i];
+                switch (c)
+                {
+                case 'n': c = '\n'; break;
+                case 't': c = '\t'; break;
+                case 'r': c = '\r'; break;
+                case '0': c = '\0'; break;
+                default: break; // \\ \' \" 與其他字元照原樣
+                }
+            }
+            out.push_back(c);
+        }
+        throw std::runtime_error("unterminated string: " + s);
+    }
+
+    bool string_literal_only(const std::string &s, std::string &out)
+    {
+        size_t p = s.find_first_not_of(" \t");
+        if (p == std::string::npos || !read_string(s, p, out))
+            return false;
+        return s.find_first_not_of(" \t", p) == std::string::npos;
+    }
+
+    std::string strip_comment(const std::string &line, const char *marker)
+    {
+        const size_t m = std::char_traits<char>::length(marker);
+        char q = 0;
+        for (size_t i = 0; i < line.size(); ++i)
+        {
+            char c = line[i];
+            if (q)
+            {
+                if (c == '\\')
+                    ++i;
+                else if (c == q)
+                    q = 0;
+            }
+            else if (c == '"' || c == '\'')
+                q = c;
+            else if (line.compare(i, m, marker) == 0)
+                return line.substr(0, i);
+        }
+        return line;
+    }
+
+    Lowering::Lowering(std::vector<uint8_t> &bc, bcw::StrPool &pool, const Dialect &d, const std::set<std::string> &dynamic)
+        : bc_(bc), pool_(pool), d_(d), dynamic_(dynamic)
+    {
+    }
+
+    void Lowering::begin_stmt()
+    {
+        ntemp_ = 0;
+        ndtemp_ = 0;
+        last_at_ = SIZE_MAX;
+    }
+
+    uint32_t Lowering::alloc(uint32_t n)
+    {
+        uint32_t id = next_;
+        next_ += n;
+        return id;
+    }
+    uint32_t Lowering::temp()
+    {
+        if (ntemp_ == temps_.size())
+            temps_.push_back(alloc(1));
+        return temps_[ntemp_++];
+    }
+    uint32_t Lowering::dtemp()
+    {
+        if (ndtemp_ == dtemps_.size())
+            dtemps_.push_back(alloc(2));
+        return dtemps_[ndtemp_++];
+    }
+
+    // 常數槽位：每個不同的值只設定一次，集中放在 prologue
+    uint32_t Lowering::konst(int64_t v)
+    {
+        auto it = consts_.find(v);
+        if (it != consts_.end())
+            return it->second;
+        uint32_t id = alloc(1);
+        consts_[v] = id;
+        bcw::set_i64(prologue_, id, v);
+        return id;
+    }
+    uint32_t Lowering::fkonst(double v)
+    {
+        int64_t bits = f64_bits(v); // 以位元型樣區分（0.0 與 -0.0 不同）
+        auto it = fconsts_.find(bits);
+        if (it != fconsts_.end())
+            return it->second;
+        uint32_t id = alloc(1);
+        fconsts_[bits] = id;
+        bcw::set_f64(prologue_, id, v);
+        return id;
+    }
+    uint32_t Lowering::skonst(const std::string &s)
+    {
+        auto it = sconsts_.find(s);
+        if (it != sconsts_.end())
+            return it->second;
+        uint32_t id = alloc(1);
+        sconsts_[s] = id;
+        bcw::sconst(prologue_, pool_, id, s);
+        return id;
+    }
+
+    void Lowering::wrote(size_t at, uint32_t t)
+    {
+        last_at_ = at;
+        last_dst_ = t;
+        last_end_ = bc_.size();
+    }
+
+    uint32_t Lowering::to_float(Val v)
+    {
+        if (v.ty == Ty::F64)
+            return v.slot;
+        uint32_t t = temp();
+        bcw::unop(bc_, OP_I2F, t, v.slot);
+        return t;
+    }
+
+    // 已知型別的值包成 pair；已是動態值者原樣回傳
+    uint32_t Lowering::box(Val v)
+    {
+        if (v.ty == Ty::Dyn)
+            return v.slot;
+        uint32_t t = dtemp();
+        bcw::dbox(bc_, tag_of(v.ty), t, v.ty == Ty::Nil ? konst(0) : v.slot);
+        return t;
+    }
+
+    // 已知型別的值轉成字串代號（js 的字串串接）
+    uint32_t Lowering::to_str(Val v)
+    {
+        if (v.ty == Ty::Str)
+            return v.slot;
+        if (v.ty == Ty::Nil)
+            return skonst(d_.kw_nil);
+        uint32_t t = temp();
+        bcw::dunbox(bc_, VT_STR, t, box(v));
+        return t;
+    }
+
+    // + - * / %：兩邊皆為數值時用型別化操作碼（/ 一律為小數除法），已知型別的字串串接用 OP_SCAT，否則經動態值
+    Val Lowering::emit(char op, Val l, Val r)
+    {
+        // 向下取整的 %（OP_FLMOD、OP_FFLMOD、OP_DFLMOD）在 OP_MOD 等的下一個
+        const int k = op == '+' ? 0 : op == '-' ? 1 : op == '*' ? 2 : op == '/' ? 3 : d_.floor_mod ? 5 : 4;
+        if (numeric(l.ty) && numeric(r.ty))
+        {
+            uint32_t t = temp();
+            if (op == '/' || l.ty == Ty::F64 || r.ty == Ty::F64 || d_.num_f64)
+            {
+                uint32_t a = to_float(l), b = to_float(r);
+                size_t at = bc_.size() + 1;
+                bcw::binop(bc_, (Op)(OP_FADD + k), t, a, b);
+                wrote(at, t);
+                return {t, Ty::F64};
+            }
+            size_t at = bc_.size() + 1;
+            bcw::binop(bc_, (Op)(OP_ADD + k), t, l.slot, r.slot);
+            wrote(at, t);
+            return {t, Ty::Int};
+        }
+        if (d_.num_f64 && op != '+')
+        {
+            // js 的 - * / % 一律為數值運算：非數值的一邊先轉成 f64（字串以 strtod 解析，同 Number()）
+            auto num = [&](Val v) {
+                if (numeric(v.ty))
+                    return to_float(v);
+                uint32_t u = temp(), p = box(v);
+                bcw::dunbox(bc_, VT_F64, u, p);
+                return u;
+            };
+            uint32_t a = num(l);
+            return emit(op, Val{a, Ty::F64}, Val{num(r), Ty::F64});
+        }
+        const bool str = l.ty == Ty::Str || r.ty == Ty::Str;
+        const bool dyn = l.ty == Ty::Dyn || r.ty == Ty::Dyn;
+        if (str && !dyn && !d_.concat_any && (op != '+' || l.ty != r.ty))
+        {
+            // 先記下；結果當作動態值，這一輪的輸出若有 conflicts() 會作廢
+            if (type_error_.empty())
+                type_error_ = std::string("unsupported operand types for ") + op + ": " + s_;
+            return {dtemp(), Ty::Dyn};
+        }
+        if (op == '+' && str && !dyn)
+        {
+            uint32_t a = to_str(l), b = to_str(r), t = temp();
+            size_t at = bc_.size() + 1;
+            bcw::binop(bc_, OP_SCAT, t, a, b);
+            wrote(at, t);
+            return {t, Ty::Str};
+        }
+        uint32_t a = box(l), b = box(r), t = dtemp();
+        bcw::binop(bc_, (Op)(OP_DADD + k), t, a, b);
+        if (op == '+' && str && (d_.concat_any || !dyn))
+        {
+            // 結果必為字串：取出代號，之後以字串型別使用
+            uint32_t u = temp();
+            size_t at = bc_.size() + 2;
+            bcw::dunbox(bc_, VT_STR, u, t);
+            wrote(at, u);
+            return {u, Ty::Str};
+        }
+        return {t, Ty::Dyn};
+    }
+
+    // loose：js 的 == / !=，有非數值的一邊時改用 OP_DJEQ / OP_DJNE
+    Val Lowering::emit_cmp(Op op, Val l, Val r, bool loose)
+    {
+        uint32_t t = temp(), a, b;
+        if (!numeric(l.ty) || !numeric(r.ty))
+        {
+            a = box(l);
+            b = box(r);
+            op = loose ? (op == OP_EQ ? OP_DJEQ : OP_DJNE) : (Op)(op + (OP_DADD - OP_ADD));
+        }
+        else if (l.ty == Ty::F64 || r.ty == Ty::F64)
+        {
+            a = to_float(l);
+            b = to_float(r);
+            op = (Op)(op + (OP_FADD - OP_ADD));
+        }
+        else
+        {
+            a = l.slot;
+            b = r.slot;
+        }
+        size_t at = bc_.size() + 1;
+        bcw::binop(bc_, op, t, a, b);
+        wrote(at, t);
+        return {t, Ty::Bool};
+    }
+
+    void Lowering::assign(const std::string &name, const std::string &expr)
+    {
+        Val v = eval(expr);
+        auto it = vars_.find(name);
+        if (dynamic_.count(name))
+        {
+            if (it == vars_.end())
+                it = vars_.emplace(name, Val{alloc(2), Ty::Dyn}).first;
+            uint32_t dst = it->second.slot;
+            if (v.ty != Ty::Dyn)
+                bcw::dbox(bc_, tag_of(v.ty), dst, v.ty == Ty::Nil ? konst(0) : v.slot);
+            else if (v.slot != dst)
+                bcw::unop(bc_, OP_DMOV, dst, v.slot);
+            return;
+        }
+        if (v.ty == Ty::Nil || v.ty == Ty::Dyn || (it != vars_.end() && it->second.ty != v.ty))
+        {
+            conflicts_.insert(name);
+            return;
+        }
+        if (it == vars_.end())
+            it = vars_.emplace(name, Val{alloc(1), v.ty}).first;
+        const uint32_t dst = it->second.slot;
+        if (v.slot == dst)
+            return;
+        if (v.slot == last_dst_ && last_at_ != SIZE_MAX && last_end_ == bc_.size())
+        {
+            // 運算式的最後一條指令直接寫入變數；槽位為變長編碼，需重新編碼該欄位
+            size_t e = last_at_;
+            while (bc_[e] & 0x80)
+                ++e;
+            std::vector<uint8_t> enc;
+            bcw::uleb(enc, dst);
+            bc_.erase(bc_.begin() + (std::ptrdiff_t)last_at_, bc_.begin() + (std::ptrdiff_t)e + 1);
+            bc_.insert(bc_.begin() + (std::ptrdiff_t)last_at_, enc.begin(), enc.end());
+            last_at_ = SIZE_MAX;
+            return;
+        }
+        bcw::copy(bc_, dst, v.slot);
+    }
+
+    void Lowering::print(const std::string &args)
+    {
+        std::string lit;
+        if (string_literal_only(args, lit))
+        {
+            bcw::print(bc_, pool_, lit); // 字面值直接引用字串池，不經字串代號
+            return;
+        }
+        s_ = args;
+        p_ = 0;
+        skip_ws();
+        if (p_ == s_.size())
+        {
+            bcw::print(bc_, pool_, "");
+            return;
+        }
+        std::vector<Val> vals;
+        do
+            vals.push_back(parse_cmp());
+        while (eat(","));
+        skip_ws();
+        if (p_ != s_.size())
+            throw std::runtime_error("unexpected '" + s_.substr(p_) + "' in arguments: " + s_);
+        if (vals.size() > 1)
+        {
+            for (size_t i = 0; i < vals.size(); i++)
+                bcw::dprint(bc_, d_.fmt | (i + 1 < vals.size() ? DF_SEP : 0), box(vals[i]));
+            return;
+        }
+        Val v = vals[0];
+        switch (v.ty)
+        {
+        case Ty::Int:
+            bcw::print_int(bc_, v.slot);
+            break;
+        case Ty::F64:
+            bcw::dprint(bc_, d_.fmt, box(v)); // OP_PRINT_F64 是 輸出小數 的 %.15g，js / py 要最短可還原位數
+            break;
+        case Ty::Str:
+            bcw::sprint(bc_, v.slot);
+            break;
+        case Ty::Nil:
+            bcw::print(bc_, pool_, d_.kw_nil);
+            break;
+        case Ty::Bool:
+        {
+            size_t f = bcw::jump(bc_, OP_JZ, v.slot);
+            bcw::print(bc_, pool_, d_.kw_true);
+            size_t e = bcw::jump(bc_, OP_JMP);
+            bcw::patch(bc_, f, bc_.size());
+            bcw::print(bc_, pool_, d_.kw_false);
+            bcw::patch(bc_, e, bc_.size());
+            break;
+        }
+        default:
+            bcw::dprint(bc_, d_.fmt, v.slot);
+            break;
+        }
+    }
+
+    // ---- 運算式剖析 ----
+    Val Lowering::eval(const std::string &src)
+    {
+        s_ = src;
+        p_ = 0;
+        Val r = parse_cmp();
+        skip_ws();
+        if (p_ != s_.size())
+            throw std::runtime_error("unexpected '" + s_.substr(p_) + "' in expression: " + src);
+        return r;
+    }
+
+    void Lowering::skip_ws()
+    {
+        while (p_ < s_.size() && (s_[p_] == ' ' || s_[p_] == '\t'))
+            ++p_;
+    }
+    bool Lowering::eat(const char *tok)
+    {
+        skip_ws();
+        size_t n = std::char_traits<char>::length(tok);
+        if (s_.compare(p_, n, tok) != 0)
+            return false;
+        p_ += n;
+        return true;
+    }
+
+    Val Lowering::parse_primary()
+    {
+        skip_ws();
+        if (eat("("))
+        {
+            Val r = parse_cmp();
+            if (!eat(")"))
+                throw std::runtime_error("missing ')' in expression: " + s_);
+            return r;
+        }
+        std::string str;
+        if (read_string(s_, p_, str))
+            return {skonst(str), Ty::Str};
+        if (p_ < s_.size() && (std::isdigit((unsigned char)s_[p_]) ||
+                               (s_[p_] == '.' && p_ + 1 < s_.size() && std::isdigit((unsigned char)s_[p_ + 1]))))
+        {
+            // 整數，或含小數點 / 指數的小數字面值
+            size_t b = p_;
+            bool fl = false;
+            while (p_ < s_.size() && std::isdigit((unsigned char)s_[p_]))
+                ++p_;
+            if (p_ < s_.size() && s_[p_] == '.')
+            {
+                fl = true;
+                ++p_;
+                while (p_ < s_.size() && std::isdigit((unsigned char)s_[p_]))
+                    ++p_;
+            }
+            if (p_ < s_.size() && (s_[p_] == 'e' || s_[p_] == 'E'))
+            {
+                size_t q = p_ + 1;
+                if (q < s_.size() && (s_[q] == '+' || s_[q] == '-'))
+                    ++q;
+                if (q < s_.size() && std::isdigit((unsigned char)s_[q]))
+                {
+                    fl = true;
+                    p_ = q;
+                    while (p_ < s_.size() && std::isdigit((unsigned char)s_[p_]))
+                        ++p_;
+                }
+            }
+            std::string num = s_.substr(b, p_ - b);
+            if (fl || d_.num_f64) // 超過 2^53 的整數由 strtod 捨入，同 js
+                return {fkonst(std::strtod(num.c_str(), nullptr)), Ty::F64};
+            return {konst(std::strtoll(num.c_str(), nullptr, 10)), Ty::Int};
+        }
+        size_t b = p_;
+        while (p_ < s_.size() && (std::isalnum((unsigned char)s_[p_]) || s_[p_] == '_' || s_[p_] == '$'))
+            ++p_;
+        if (b == p_ || std::isdigit((unsigned char)s_[b]))
+            throw std::runtime_error("expected value in expression: " + s_);
+        std::string name = s_.substr(b, p_ - b);
+        if (name == d_.kw_true)
+            return {konst(1), Ty::Bool};
+        if (name == d_.kw_false)
+            return {konst(0), Ty::Bool};
+        if (name == d_.kw_nil)
+            return {0, Ty::Nil};
+        if (eat("("))
+            throw std::runtime_error("unknown function '" + name + "' in expression: " + s_);
+        auto it = vars_.find(name);
+        if (it == vars_.end())
+        {
+            // 尚未賦值的變數：動態值為 nil，其餘視為數值 0
+            bool dyn = dynamic_.count(name) != 0;
+            Ty ty = dyn ? Ty::Dyn : d_.num_f64 ? Ty::F64 : Ty::Int;
+            it = vars_.emplace(name, Val{alloc(dyn ? 2 : 1), ty}).first;
+        }
+        return it->second;
+    }
+    Val Lowering::parse_unary()
+    {
+        if (!eat("-"))
+            return parse_primary();
+        Val v = parse_unary();
+        if (v.ty == Ty::F64 || (d_.num_f64 && numeric(v.ty)))
+        {
+            uint32_t t = temp(), m = fkonst(-1.0), x = to_float(v);
+            size_t at = bc_.size() + 1;
+            bcw::binop(bc_, OP_FMUL, t, m, x); // 保留 -0.0（0 - x 會得到 +0.0）
+            wrote(at, t);
+            return {t, Ty::F64};
+        }
+        if (numeric(v.ty))
+        {
+            uint32_t t = temp(), z = konst(0);
+            size_t at = bc_.size() + 1;
+            bcw::binop(bc_, OP_SUB, t, z, v.slot);
+            wrote(at, t);
+            return {t, Ty::Int};
+        }
+        return emit('*', d_.num_f64 ? Val{fkonst(-1.0), Ty::F64} : Val{konst(-1), Ty::Int}, v);
+    }
+    Val Lowering::parse_mul()
+    {
+        Val l = parse_unary();
+        for (;;)
+        {
+            if (eat("*"))
+                l = emit('*', l, parse_unary());
+            else if (eat("/"))
+                l = emit('/', l, parse_unary());
+            else if (eat("%"))
+                l = emit('%', l, parse_unary());
+            else
+                return l;
+        }
+    }
+    Val Lowering::parse_add()
+    {
+        Val l = parse_mul();
+        for (;;)
+        {
+            if (eat("+"))
+                l = emit('+', l, parse_mul());
+            else if (eat("-"))
+                l = emit('-', l, parse_mul());
+            else
+                return l;
+        }
+    }
+    Val Lowering::parse_cmp()
+    {
+        Val l = parse_add();
+        for (;;)
+        {
+            // 長的運算子須先比對
+            if (d_.js_eq && eat("==="))
+                l = emit_cmp(OP_EQ, l, parse_add());
+            else if (eat("=="))
+                l = emit_cmp(OP_EQ, l, parse_add(), d_.js_eq);
+            else if (d_.js_eq && eat("!=="))
+                l = emit_cmp(OP_NE, l, parse_add());
+            else if (eat("!="))
+                l = emit_cmp(OP_NE, l, parse_add(), d_.js_eq);
+            else if (eat("<="))
+                l = emit_cmp(OP_LE, l, parse_add());
+            else if (eat(">="))
+                l = emit_cmp(OP_GE, l, parse_add());
+            else if (eat("<"))
+                l = emit_cmp(OP_LT, l, parse_add());
+            else if (eat(">"))
+                l = emit_cmp(OP_GT, l, parse_add());
+            else
+                return l;
+        }
+    }
+}
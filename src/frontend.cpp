@@ -1,41 +1,69 @@
-#include "../include/frontend.h"
-#include <unordered_set>
-
-FrontendRegistry& FrontendRegistry::instance() {
-    static FrontendRegistry instance;
-    return instance;
-}
-
-void FrontendRegistry::register_frontend(std::unique_ptr<IFrontend> fe) {
-    static std::unordered_set<std::string> registered_names;
-    std::string name = fe->name();
-    if (name.empty() || registered_names.count(name)) {
-        return; // 去重：同名前端只保留第一个
-    }
-    registered_names.insert(name);
-    frontends_.push_back(std::move(fe));
-}
-
-std::vector<IFrontend*> FrontendRegistry::all() const {
-    std::vector<IFrontend*> result;
-    for (const auto& fe : frontends_) {
-        result.push_back(fe.get());
-    }
-    return result;
-}
-
-IFrontend* FrontendRegistry::match(const std::string& path, const std::string& src) const {
-    for (const auto& fe : frontends_) {
-        if (fe->accepts(path, src)) {
-            return fe.get();
-        }
-    }
-    return nullptr;
-}
-
-IFrontend* FrontendRegistry::by_name(const std::string& name) const {
-    for (const auto& fe : frontends_) {
-        if (fe->name() == name) return fe.get();
-    }
-    return nullptr;
+#include "../include/frontend.h"
+#include <mutex>
+#include <unordered_set>
+
+// 內建前端（fe_*.cpp）
+extern "C" void register_fe_clite();
+extern "C" void register_fe_cpplite();
+extern "C" void register_fe_jslite();
+extern "C" void register_fe_zh();
+extern "C" void register_fe_golite();
+extern "C" void register_fe_javalite();
+extern "C" void register_fe_pylite();
+
+// 第一次查詢時才註冊內建前端，且只註冊一次；執行打包的 payload 或只印說明時不會建立任何前端。
+// 順序即 match() 的比對順序
+static void register_builtin_frontends() {
+    static std::once_flag once;
+    std::call_once(once, [] {
+        register_fe_clite();
+        register_fe_cpplite();
+        register_fe_jslite();
+        register_fe_zh();
+        register_fe_golite();
+        register_fe_javalite();
+        register_fe_pylite();
+    });
+}
+
+FrontendRegistry& FrontendRegistry::instance() {
+    static FrontendRegistry instance;
+    return instance;
+}
+
+void FrontendRegistry::register_frontend(std::unique_ptr<IFrontend> fe) {
+    static std::unordered_set<std::string> registered_names;
+    std::string name = fe->name();
+    if (name.empty() || registered_names.count(name)) {
+        return; // 去重：同名前端只保留第一个
+    }
+    registered_names.insert(name);
+    frontends_.push_back(std::move(fe));
+}
+
+std::vector<IFrontend*> FrontendRegistry::all() const {
+    register_builtin_frontends();
+    std::vector<IFrontend*> result;
+    for (const auto& fe : frontends_) {
+        result.push_back(fe.get());
+    }
+    return result;
+}
+
+IFrontend* FrontendRegistry::match(const std::string& path, const std::string& src) const {
+    register_builtin_frontends();
+    for (const auto& fe : frontends_) {
+        if (fe->accepts(path, src)) {
+            return fe.get();
+        }
+    }
+    return nullptr;
+}
+
+IFrontend* FrontendRegistry::by_name(const std::string& name) const {
+    register_builtin_frontends();
+    for (const auto& fe : frontends_) {
+        if (fe->name() == name) return fe.get();
+    }
+    return nullptr;
 }
\ No newline at end of file
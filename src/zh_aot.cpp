@@ -0,0 +1,203 @@
+// zh_aot.cpp — 分層 AOT 的磁碟快取、背景編譯與載入
+#include "../include/zh_aot.h"
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+#include <utility>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <process.h>
+#else
+#include <dlfcn.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace selfhost
+{
+#if defined(_WIN32)
+    static const char *const SO_EXT = ".dll";
+#elif defined(__APPLE__)
+    static const char *const SO_EXT = ".dylib";
+#else
+    static const char *const SO_EXT = ".so";
+#endif
+
+    std::string aot_dir()
+    {
+        std::string root = cache_root();
+        return root.empty() ? root : (fs::path(root) / "aot").string();
+    }
+
+    std::string aot_key(const uint8_t *bc, size_t n)
+    {
+        char buf[64];
+        std::snprintf(buf, sizeof(buf), "v%u-%016llx-%llu", (unsigned)AOT_ABI, (unsigned long long)fnv1a64(bc, n),
+                      (unsigned long long)n);
+        return buf;
+    }
+
+    bool aot_enabled_from_env()
+    {
+        const char *v = std::getenv("ZHCL_AOT");
+        return v && *v && *v != '0';
+    }
+
+    static std::string aot_path(const std::string &key, const char *suffix)
+    {
+        std::string dir = aot_dir();
+        return dir.empty() ? dir : (fs::path(dir) / (key + suffix)).string();
+    }
+
+    bool aot_failed(const std::string &key)
+    {
+        std::string p = aot_path(key, ".fail");
+        std::error_code ec;
+        return !p.empty() && fs::exists(p, ec);
+    }
+
+    // ---- 載入 ----
+    AotModule::~AotModule()
+    {
+#ifdef _WIN32
+        if (handle_)
+            FreeLibrary((HMODULE)handle_);
+#else
+        if (handle_)
+            dlclose(handle_);
+#endif
+    }
+
+    AotModule::AotModule(AotModule &&o) noexcept { *this = std::move(o); }
+
+    AotModule &AotModule::operator=(AotModule &&o) noexcept
+    {
+        if (this != &o)
+        {
+            std::swap(handle_, o.handle_);
+            std::swap(entry_, o.entry_);
+        }
+        return *this;
+    }
+
+    bool AotModule::open(const std::string &key)
+    {
+        std::string p = aot_path(key, SO_EXT);
+        std::error_code ec;
+        if (p.empty() || !fs::exists(p, ec))
+            return false;
+#ifdef _WIN32
+        HMODULE h = LoadLibraryW(fs::path(p).c_str());
+        if (!h)
+            return false;
+        void *e = (void *)GetProcAddress(h, AOT_ENTRY);
+        if (!e)
+        {
+            FreeLibrary(h);
+            return false;
+        }
+#else
+        void *h = dlopen(p.c_str(), RTLD_NOW | RTLD_LOCAL);
+        if (!h)
+            return false;
+        void *e = dlsym(h, AOT_ENTRY);
+        if (!e)
+        {
+            dlclose(h);
+            return false;
+        }
+#endif
+        AotModule m;
+        m.handle_ = (void *)h;
+        m.entry_ = (int (*)())e;
+        *this = std::move(m);
+        return true;
+    }
+
+    int AotModule::run() const
+    {
+        int rc = entry_ ? entry_() : 0;
+        std::fflush(stdout);
+        return rc;
+    }
+
+    // ---- 背景編譯 ----
+#ifndef _WIN32
+    static std::string shell_quote(const std::string &s)
+    {
+        std::string q = "'";
+        for (char c : s)
+            q += c == '\'' ? std::string("'\\''") : std::string(1, c);
+        return q + "'";
+    }
+#endif
+
+    static bool aot_compile(const std::string &key, const std::string &cpp)
+    {
+        std::string dir = aot_dir();
+        std::error_code ec;
+        if (dir.empty() || (!fs::create_directories(dir, ec) && ec))
+            return false;
+#ifdef _WIN32
+        std::string tag = "." + std::to_string(_getpid());
+#else
+        std::string tag = "." + std::to_string(getpid());
+#endif
+        std::string base = (fs::path(dir) / key).string() + tag;
+        std::string src = base + ".cpp", tmp = base + ".tmp" + SO_EXT;
+        {
+            std::ofstream f(src, std::ios::binary);
+            f << cpp;
+            if (!f)
+                return false;
+        }
+        const char *cxx = std::getenv("ZHCL_AOT_CXX");
+#ifdef _WIN32
+        // cmd.exe 會剝掉整行最外層的引號，故再包一層
+        std::string cmd = std::string("\"") + (cxx && *cxx ? cxx : "cl") +
+                          " /nologo /std:c++17 /O2 /LD /EHsc /utf-8 \"" + src + "\" /Fe:\"" + tmp + "\" /Fo:\"" + base +
+                          ".obj\" >nul 2>&1\"";
+#else
+        // 不允許把 a*b+c 合併成 FMA，結果才與直譯器逐位元相同
+        std::string cmd = std::string(cxx && *cxx ? cxx : "c++") + " -std=c++17 -O2 -ffp-contract=off -shared -fPIC -o " +
+                          shell_quote(tmp) + " " + shell_quote(src) + " >/dev/null 2>&1";
+#endif
+        int rc = std::system(cmd.c_str());
+        fs::remove(src, ec);
+#ifdef _WIN32
+        for (const char *x : {".obj", ".tmp.lib", ".tmp.exp"})
+            fs::remove(base + x, ec);
+#endif
+        if (rc == 0 && fs::exists(tmp, ec))
+        {
+            // 改名為原子操作，其他行程只會看到完整的檔案（Windows 上目標已存在時改名失敗，沿用既有的版本）
+            fs::rename(tmp, aot_path(key, SO_EXT), ec);
+            if (!ec)
+                return true;
+            fs::remove(tmp, ec);
+            return fs::exists(aot_path(key, SO_EXT), ec);
+        }
+        fs::remove(tmp, ec);
+        std::ofstream(aot_path(key, ".fail")) << "compiler exit status " << rc << "\n";
+        return false;
+    }
+
+    AotBuild::AotBuild(const std::string &key, std::string cpp)
+        : t_([this, key, cpp = std::move(cpp)] { ok_ = aot_compile(key, cpp); })
+    {
+    }
+
+    AotBuild::~AotBuild() { wait(); }
+
+    bool AotBuild::wait()
+    {
+        if (t_.joinable())
+            t_.join();
+        return ok_;
+    }
+}
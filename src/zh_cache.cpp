@@ -0,0 +1,260 @@
+// zh_cache.cpp — 快取目錄、執行檔識別與位元碼快取
+#include "../include/zh_cache.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <system_error>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace selfhost
+{
+    std::string cache_root()
+    {
+        const char *d = std::getenv("ZHCL_CACHE_DIR");
+        if (d && *d)
+            return d;
+#ifdef _WIN32
+        d = std::getenv("LOCALAPPDATA");
+        if (d && *d)
+            return (fs::path(d) / "zhcl").string();
+#else
+        d = std::getenv("XDG_CACHE_HOME");
+        if (d && *d)
+            return (fs::path(d) / "zhcl").string();
+        d = std::getenv("HOME");
+        if (d && *d)
+            return (fs::path(d) / ".cache" / "zhcl").string();
+#endif
+        return "";
+    }
+
+    uint64_t fnv1a64(const void *p, size_t n, uint64_t h)
+    {
+        const uint8_t *b = (const uint8_t *)p;
+        for (size_t i = 0; i < n; i++)
+        {
+            h ^= b[i];
+            h *= 0x100000001b3ULL;
+        }
+        return h;
+    }
+
+    uint32_t crc32(const uint8_t *data, size_t len)
+    {
+        // 查表版本，每個位元組一次查表（結果與逐位元計算相同）
+        static const auto table = []
+        {
+            std::array<uint32_t, 256> t{};
+            for (uint32_t i = 0; i < 256; i++)
+            {
+                uint32_t c = i;
+                for (int k = 0; k < 8; k++)
+                    c = (c >> 1) ^ (0xEDB88320u & (0u - (c & 1u)));
+                t[i] = c;
+            }
+            return t;
+        }();
+        uint32_t c = 0xFFFFFFFFu;
+        for (size_t i = 0; i < len; i++)
+            c = table[(c ^ data[i]) & 0xFFu] ^ (c >> 8);
+        return ~c;
+    }
+
+    static std::string hex64(uint64_t v)
+    {
+        char buf[20];
+        std::snprintf(buf, sizeof(buf), "%016llx", (unsigned long long)v);
+        return buf;
+    }
+
+    const std::string &self_build_id()
+    {
+        static const std::string id = []
+        {
+            std::error_code ec;
+#ifdef _WIN32
+            wchar_t buf[MAX_PATH];
+            fs::path exe = GetModuleFileNameW(nullptr, buf, MAX_PATH) ? fs::path(buf) : fs::path();
+#else
+            fs::path exe = "/proc/self/exe";
+#endif
+            // 取不到時兩者皆為 0，所有版本共用同一個識別
+            uint64_t v[2] = {(uint64_t)fs::file_size(exe, ec), 0};
+            if (ec)
+                v[0] = 0;
+            auto t = fs::last_write_time(exe, ec);
+            if (!ec)
+                v[1] = (uint64_t)t.time_since_epoch().count();
+            return hex64(fnv1a64(v, sizeof(v)));
+        }();
+        return id;
+    }
+
+    // ---- 位元碼快取 ----
+    // 項目格式（小端序）："ZBCC" u32 版本 | u64 原始碼長度 | u64 原始碼第二雜湊 | u64 位元碼雜湊 | u32 前端名稱長度 | 名稱 | 位元碼
+    static const char ENTRY_MAGIC[4] = {'Z', 'B', 'C', 'C'};
+    static const uint32_t ENTRY_VERSION = 1;
+    static const size_t ENTRY_HEAD = 4 + 4 + 8 + 8 + 8 + 4;
+    static const uint64_t SRC_SEED2 = 0x84222325cbf29ce4ULL; // 第二雜湊用不同的起始值
+    static const uint64_t DEFAULT_MAX_MB = 64;
+
+    static void put_u32(std::string &b, uint32_t v)
+    {
+        for (int i = 0; i < 4; i++)
+            b.push_back((char)(v >> (8 * i)));
+    }
+    static void put_u64(std::string &b, uint64_t v)
+    {
+        for (int i = 0; i < 8; i++)
+            b.push_back((char)(v >> (8 * i)));
+    }
+    static uint64_t get_le(const std::string &b, size_t off, int n)
+    {
+        uint64_t v = 0;
+        for (int i = 0; i < n; i++)
+            v |= (uint64_t)(uint8_t)b[off + i] << (8 * i);
+        return v;
+    }
+
+    BcCache::BcCache(uint64_t max_bytes) : max_bytes_(max_bytes)
+    {
+        std::string root = cache_root();
+        if (!root.empty())
+            dir_ = (fs::path(root) / "bc").string();
+        if (!max_bytes_)
+        {
+            const char *v = std::getenv("ZHCL_CACHE_MAX_MB");
+            uint64_t mb = v && *v ? std::strtoull(v, nullptr, 10) : DEFAULT_MAX_MB;
+            max_bytes_ = (mb ? mb : DEFAULT_MAX_MB) << 20;
+        }
+    }
+
+    std::string BcCache::key(const std::string &src, const std::string &path, const std::string &forced)
+    {
+        // 各欄位以 '\0' 分隔，避免拼接後相同
+        uint64_t h = fnv1a64(src.data(), src.size());
+        for (const std::string *s : {&path, &forced, &self_build_id()})
+        {
+            h = fnv1a64("", 1, h);
+            h = fnv1a64(s->data(), s->size(), h);
+        }
+        return hex64(h);
+    }
+
+    bool BcCache::get(const std::string &key, const std::string &src, std::string &frontend,
+                      std::vector<uint8_t> &bc) const
+    {
+        if (dir_.empty())
+            return false;
+        fs::path p = fs::path(dir_) / (key + ".bc");
+        std::ifstream f(p, std::ios::binary);
+        if (!f)
+            return false;
+        std::string b((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+        if (b.size() < ENTRY_HEAD || std::memcmp(b.data(), ENTRY_MAGIC, 4) != 0 || get_le(b, 4, 4) != ENTRY_VERSION ||
+            get_le(b, 8, 8) != src.size() || get_le(b, 16, 8) != fnv1a64(src.data(), src.size(), SRC_SEED2))
+            return false;
+        uint64_t fe_len = get_le(b, 32, 4);
+        if (fe_len > b.size() - ENTRY_HEAD)
+            return false;
+        size_t code = ENTRY_HEAD + (size_t)fe_len;
+        if (get_le(b, 24, 8) != fnv1a64(b.data() + code, b.size() - code))
+            return false;
+        frontend.assign(b, ENTRY_HEAD, (size_t)fe_len);
+        bc.assign(b.begin() + code, b.end());
+        std::error_code ec;
+        fs::last_write_time(p, fs::file_time_type::clock::now(), ec); // 記錄最後使用時間
+        return true;
+    }
+
+    void BcCache::put(const std::string &key, const std::string &src, const std::string &frontend,
+                      const std::vector<uint8_t> &bc) const
+    {
+        if (dir_.empty())
+            return;
+        std::error_code ec;
+        fs::create_directories(dir_, ec);
+        std::string b(ENTRY_MAGIC, 4);
+        put_u32(b, ENTRY_VERSION);
+        put_u64(b, src.size());
+        put_u64(b, fnv1a64(src.data(), src.size(), SRC_SEED2));
+        put_u64(b, fnv1a64(bc.data(), bc.size()));
+        put_u32(b, (uint32_t)frontend.size());
+        b += frontend;
+        b.append((const char *)bc.data(), bc.size());
+
+        // 暫存檔名含行程與序號，同一行程的多個執行緒也不會互相覆寫
+        static std::atomic<unsigned> seq{0};
+#ifdef _WIN32
+        int pid = _getpid();
+#else
+        int pid = (int)getpid();
+#endif
+        fs::path fin = fs::path(dir_) / (key + ".bc");
+        fs::path tmp = fs::path(dir_) / (key + "." + std::to_string(pid) + "." + std::to_string(seq++) + ".tmp");
+        {
+            std::ofstream f(tmp, std::ios::binary);
+            f.write(b.data(), (std::streamsize)b.size());
+            if (!f)
+            {
+                f.close();
+                fs::remove(tmp, ec);
+                return;
+            }
+        }
+        fs::rename(tmp, fin, ec);
+        if (ec)
+            fs::remove(tmp, ec);
+        evict();
+    }
+
+    void BcCache::evict() const
+    {
+        struct Item
+        {
+            fs::file_time_type t;
+            uint64_t size;
+            fs::path p;
+        };
+        std::vector<Item> items;
+        uint64_t total = 0;
+        std::error_code ec;
+        for (fs::directory_iterator it(dir_, ec), end; !ec && it != end; it.increment(ec))
+        {
+            if (it->path().extension() != ".bc")
+                continue;
+            std::error_code e2;
+            uint64_t sz = it->file_size(e2);
+            auto t = it->last_write_time(e2);
+            if (e2)
+                continue;
+            items.push_back({t, sz, it->path()});
+            total += sz;
+        }
+        if (total <= max_bytes_)
+            return;
+        std::sort(items.begin(), items.end(), [](const Item &a, const Item &b) { return a.t < b.t; });
+        for (auto &x : items)
+        {
+            if (total <= max_bytes_)
+                break;
+            fs::remove(x.p, ec); // 另一個行程可能已刪除，同樣扣除
+            total -= x.size;
+        }
+    }
+}
@@ -4,22 +4,22 @@
 #include <cstdint>
 #include <regex>
 #include <map>
+#include <set>
 #include <sstream>
 #include <utility>
 #include <algorithm>
 #include <iostream>
+#include <functional>
+#include <stdexcept>
+#include <cstring>
+#include <cstdlib>
+#include <cctype>
+#include "../include/zh_bytecode.h"
+#include "../include/zh_native.h"
 
 // Forward declaration for the new keyword rewriting function
 std::string zh_keyword_rewrite(const std::string &src);
 
-static inline void u8(std::vector<uint8_t> &bc, unsigned v) { bc.push_back((uint8_t)v); }
-static inline void u64le(std::vector<uint8_t> &bc, uint64_t v)
-{
-    for (int i = 0; i < 8; i++)
-        bc.push_back((uint8_t)((v >> (8 * i)) & 0xFF));
-}
-static inline void i64le(std::vector<uint8_t> &bc, int64_t v) { u64le(bc, (uint64_t)v); }
-
 static std::string unescape_c_like(std::string s)
 {
     std::string out;
@@ -133,6 +133,7 @@ static std::string extract_var_name(const std::string &s, size_t start_pos, size
 {
     std::string var_name;
     size_t i = start_pos;
+    end_pos = start_pos;
 
     while (i < s.size())
     {
@@ -182,13 +183,833 @@ static std::string extract_var_name(const std::string &s, size_t start_pos, size
                 break;
             var_name.append(s.substr(char_start, i - char_start));
         }
+        end_pos = i; // 不接受的字元不算在名稱內
     }
 
-    end_pos = i;
     return var_name;
 }
 
-std::vector<uint8_t> ZhFrontend::translate_to_bc(const std::string &src_in)
+// ---- 結構化語句：迴圈 / 當 / 如果…否則 與整數 / 小數運算式 ----
+// 以縮排劃分區塊（標頭行以「：」或「:」結尾），運算式降為三位址運算 + 跳躍。
+// 小數（f64）與整數共用槽位，型別在編譯期追蹤：混合運算時整數先轉成小數（同 C 的轉換規則）
+
+struct ZhLine
+{
+    int indent;
+    int lineno;
+    std::string text;
+};
+
+static std::string trim_copy(const std::string &s)
+{
+    size_t b = s.find_first_not_of(" \t");
+    if (b == std::string::npos)
+        return "";
+    size_t e = s.find_last_not_of(" \t;");
+    return s.substr(b, e - b + 1);
+}
+
+// 去掉行尾的區塊冒號（全形「：」或半形「:」）；有則回傳 true
+static bool strip_block_colon(std::string &s)
+{
+    static const std::string fw = u8"：";
+    s = trim_copy(s);
+    if (s.size() >= fw.size() && s.compare(s.size() - fw.size(), fw.size(), fw) == 0)
+    {
+        s = trim_copy(s.substr(0, s.size() - fw.size()));
+        return true;
+    }
+    if (!s.empty() && s.back() == ':')
+    {
+        s = trim_copy(s.substr(0, s.size() - 1));
+        return true;
+    }
+    return false;
+}
+
+// 關鍵字比對：同時接受中文原文與 zh_keyword_rewrite 改寫後的英文記號
+static bool match_kw(const std::string &s, std::initializer_list<const char *> kws, std::string &rest)
+{
+    for (const char *kw : kws)
+    {
+        size_t n = std::strlen(kw);
+        if (s.compare(0, n, kw) != 0)
+            continue;
+        if (s.size() > n)
+        {
+            unsigned char c = (unsigned char)s[n];
+            if (std::isalnum(c) || c == '_')
+                continue;
+            // 中文關鍵字後面緊接其他中文字時視為識別字的一部分（例：「當前秒」）
+            if (c >= 0x80 && s.compare(n, 3, u8"（") != 0 && s.compare(n, 3, u8"：") != 0)
+                continue;
+        }
+        rest = trim_copy(s.substr(n));
+        return true;
+    }
+    return false;
+}
+
+// 取出最外層括號內的內容：「(…)」或「（…）」
+static bool paren_body(const std::string &s, std::string &inner)
+{
+    std::string t = s;
+    if (t.compare(0, 3, u8"（") == 0)
+        t = "(" + t.substr(3);
+    size_t e = t.rfind(u8"）");
+    if (e != std::string::npos && e + 3 == t.size())
+        t = t.substr(0, e) + ")";
+    if (t.size() < 2 || t.front() != '(' || t.back() != ')')
+        return false;
+    inner = t.substr(1, t.size() - 2);
+    return true;
+}
+
+// s[p] 前後是否為識別字的邊界：ASCII 看字元本身，其他字元中只有全形標點與空白算邊界
+static bool ident_edge(const std::string &s, size_t p, bool before)
+{
+    static const char *const punct[] = {u8"（", u8"）", u8"，", u8"：", u8"；", u8"　", u8"「", u8"」"};
+    if (before ? p == 0 : p >= s.size())
+        return true;
+    unsigned char c = (unsigned char)s[before ? p - 1 : p];
+    if (c < 0x80)
+        return !std::isalnum(c) && c != '_';
+    size_t b = before ? p - 1 : p;
+    while (before && b > 0 && ((unsigned char)s[b] & 0xC0) == 0x80)
+        --b;
+    for (const char *q : punct)
+        if (s.compare(b, std::strlen(q), q) == 0)
+            return true;
+    return false;
+}
+
+// text 中是否出現識別字 name（不計入較長識別字的一部分）
+static bool mentions(const std::string &text, const std::string &name)
+{
+    for (size_t p = text.find(name); p != std::string::npos; p = text.find(name, p + 1))
+        if (ident_edge(text, p, true) && ident_edge(text, p + name.size(), false))
+            return true;
+    return false;
+}
+
+// 運算式最外層（括號外）是否含有 ops 中的字元
+static bool top_level_has(const std::string &e, const char *ops)
+{
+    int depth = 0;
+    for (size_t k = 0; k < e.size(); ++k)
+    {
+        if (e[k] == '(' || e[k] == '[' || e.compare(k, 3, u8"（") == 0)
+            ++depth;
+        else if (e[k] == ')' || e[k] == ']' || e.compare(k, 3, u8"）") == 0)
+            --depth;
+        else if (depth == 0 && std::strchr(ops, e[k]))
+            return true;
+    }
+    return false;
+}
+
+// 去掉空白後是否相同
+static bool same_expr(std::string a, std::string b)
+{
+    for (std::string *s : {&a, &b})
+        s->erase(std::remove_if(s->begin(), s->end(), [](char c) { return c == ' ' || c == '\t'; }), s->end());
+    return a == b;
+}
+
+// 使用者函式（函數 [型別] 名(參數)）的簽名；呼叫降為 OP_CALL，參數放在被呼叫者窗口的槽位 0..n-1
+struct ZhFunc
+{
+    std::vector<bool> params; // 各參數是否為小數
+    char ret = 'i';           // 'i' 整數、'f' 小數、'v' 無回傳值
+};
+
+static bool is_main_name(const std::string &name)
+{
+    return name == u8"主函數" || name == u8"主函式" || name == "main";
+}
+
+// 「函數 [整數|小數|無回傳] 名(型別 參數, …)」；不是函數標頭時回傳 false，標頭格式錯誤時丟出 std::runtime_error
+static bool fn_header(const std::string &s, std::string &name, ZhFunc &f, std::vector<std::string> &params)
+{
+    std::string rest, r;
+    if (!match_kw(s, {u8"函數", u8"函式"}, rest))
+        return false;
+    f = ZhFunc{};
+    params.clear();
+    if (match_kw(rest, {u8"雙精度小數", u8"小數", "double", "float"}, r))
+        f.ret = 'f';
+    else if (match_kw(rest, {u8"無回傳", "void"}, r))
+        f.ret = 'v';
+    else if (!match_kw(rest, {u8"整數", "int", "long"}, r))
+        r = rest;
+    size_t e;
+    name = extract_var_name(r, 0, e);
+    std::string list;
+    if (name.empty() || !paren_body(trim_copy(r.substr(e)), list))
+        throw std::runtime_error("expected 函數 [型別] 名稱(參數)");
+    for (size_t k; (k = list.find(u8"，")) != std::string::npos;)
+        list.replace(k, std::strlen(u8"，"), ",");
+    std::stringstream ps(list);
+    std::string p;
+    while (std::getline(ps, p, ','))
+    {
+        p = trim_copy(p);
+        bool fl = match_kw(p, {u8"雙精度小數", u8"小數", "double", "float"}, r);
+        if (fl || match_kw(p, {u8"整數", "int", "long"}, r))
+            p = r;
+        if (!is_valid_var_name(p) || std::find(params.begin(), params.end(), p) != params.end())
+            throw std::runtime_error("bad parameter '" + p + "' of " + name);
+        params.push_back(p);
+        f.params.push_back(fl);
+    }
+    if (params.size() > selfhost::CALL_MAX_ARGS)
+        throw std::runtime_error(name + " has more than " + std::to_string(selfhost::CALL_MAX_ARGS) + " parameters");
+    return true;
+}
+
+class ZhLowering
+{
+public:
+    ZhLowering(std::vector<uint8_t> &bc, selfhost::bcw::StrPool &pool,
+               const std::function<uint32_t(const std::string &)> &get_slot)
+        : bc_(bc), pool_(pool), get_slot_(get_slot) {}
+
+    // 常數槽位：每個不同的值只設定一次，集中放在程式開頭
+    uint32_t konst(int64_t v)
+    {
+        auto it = consts_.find(v);
+        if (it != consts_.end())
+            return it->second;
+        uint32_t id = get_slot_("#k" + std::to_string(v));
+        consts_[v] = id;
+        selfhost::bcw::set_i64(prologue_, id, v);
+        return id;
+    }
+    uint32_t fkonst(double v)
+    {
+        int64_t bits = selfhost::f64_bits(v); // 以位元型樣區分（0.0 與 -0.0 不同）
+        auto it = fconsts_.find(bits);
+        if (it != fconsts_.end())
+            return it->second;
+        uint32_t id = get_slot_("#f" + std::to_string(bits));
+        fconsts_[bits] = id;
+        float_.insert(id);
+        selfhost::bcw::set_f64(prologue_, id, v);
+        return id;
+    }
+
+    // 槽位型別：小數或整數（變數於宣告或第一次賦值時決定）
+    bool is_float(uint32_t id) const { return float_.count(id) != 0; }
+    void set_float(uint32_t id, bool f)
+    {
+        if (f)
+            float_.insert(id);
+        else
+            float_.erase(id);
+    }
+    uint32_t to_float(uint32_t id)
+    {
+        return is_float(id) ? id : convert(selfhost::OP_I2F, id, true);
+    }
+    uint32_t to_int(uint32_t id)
+    {
+        return is_float(id) ? convert(selfhost::OP_F2I, id, false) : id;
+    }
+
+    // 陣列變數：槽位存放代號，另記元素型別（true = 小數）
+    bool is_array(uint32_t id) const { return arr_.count(id) != 0; }
+    // 「整數陣列 a[n]」：配置長度為 n 的陣列（元素歸零）
+    void new_array(uint32_t id, const std::string &len, bool f)
+    {
+        uint32_t n = to_int(eval(len));
+        selfhost::bcw::unop(bc_, selfhost::OP_ANEW, id, n);
+        ++effects_;
+        set_float(id, false);
+        arr_[id] = f;
+    }
+    // a[idx] = val；值轉成元素型別
+    void store_elem(uint32_t id, const std::string &idx, const std::string &val)
+    {
+        auto it = arr_.find(id);
+        if (it == arr_.end())
+            throw std::runtime_error("not an array: " + idx);
+        uint32_t i = to_int(eval(idx));
+        uint32_t v = eval(val);
+        v = it->second ? to_float(v) : to_int(v);
+        selfhost::bcw::binop(bc_, selfhost::OP_ASET, id, i, v);
+    }
+
+    // 每條語句開始時重設暫存槽位，讓暫存可重複使用
+    void begin_stmt() { ntemp_ = 0; }
+
+    // 使用者函式表（呼叫前設定，物件存在期間有效）
+    void set_functions(const std::map<std::string, ZhFunc> &funcs) { funcs_ = &funcs; }
+    bool is_function(const std::string &name) const { return funcs_ && funcs_->count(name); }
+    // 有副作用的指令（原生呼叫、配置陣列，以及前端以 effect() 記下的輸出與平行迴圈）的數量；
+    // 平行迴圈的本體與它呼叫的函式中不允許
+    void effect() { ++effects_; }
+    unsigned effects() const { return effects_; }
+    // 切換到另一個函式的降階狀態（常數、型別、暫存、待填的呼叫與副作用計數）；uses_native() 屬於整個程式，不交換
+    void swap_state(ZhLowering &o)
+    {
+        std::swap(consts_, o.consts_);
+        std::swap(fconsts_, o.fconsts_);
+        std::swap(float_, o.float_);
+        std::swap(arr_, o.arr_);
+        std::swap(prologue_, o.prologue_);
+        std::swap(temps_, o.temps_);
+        std::swap(ntemp_, o.ntemp_);
+        std::swap(calls_, o.calls_);
+        std::swap(effects_, o.effects_);
+    }
+    // 待填的呼叫：u32 frame 欄位的位置（見 bcw::call）與被呼叫的函式
+    std::vector<std::pair<size_t, std::string>> &calls() { return calls_; }
+
+    // 「返回 f(…)」：f 與目前函式的回傳型別相同時降為 OP_TAILCALL；否則不輸出任何程式碼並回傳 false
+    bool eval_tail(const std::string &src, char ret)
+    {
+        s_ = src;
+        p_ = 0;
+        last_op_at_ = SIZE_MAX;
+        skip_ws();
+        size_t end;
+        std::string name = extract_var_name(s_, p_, end);
+        if (name.empty() || !is_function(name) || funcs_->at(name).ret != ret)
+            return false;
+        p_ = end;
+        if (!eat("(") && !eat(u8"（"))
+            return false;
+        // 對應的右括號必須是運算式的結尾（排除 f(1) + 1 之類）
+        int depth = 0;
+        size_t q = p_;
+        for (; q < s_.size(); ++q)
+        {
+            if (s_[q] == '(' || s_.compare(q, 3, u8"（") == 0)
+                ++depth;
+            else if ((s_[q] == ')' || s_.compare(q, 3, u8"）") == 0) && depth-- == 0)
+                break;
+        }
+        if (q == s_.size() || !trim_copy(s_.substr(q + (s_[q] == ')' ? 1 : 3))).empty())
+            return false;
+        parse_user_call(name, funcs_->at(name), 0, true);
+        return true;
+    }
+
+    // 運算式求值到某個槽位；失敗時丟出 std::runtime_error
+    uint32_t eval(const std::string &src)
+    {
+        s_ = src;
+        p_ = 0;
+        last_op_at_ = SIZE_MAX;
+        uint32_t r = parse_cmp();
+        skip_ws();
+        if (p_ != s_.size())
+            throw std::runtime_error("unexpected '" + s_.substr(p_) + "' in expression: " + src);
+        return r;
+    }
+
+    // 單獨成句的函式呼叫：陣列逐元素運算與無回傳值的原生函式只能這樣使用
+    static bool call_stmt(const std::string &name)
+    {
+        int k;
+        selfhost::MathFn fn;
+        if (vec_fn(name, k))
+            return k >= 0 && !selfhost::vec_reduces((unsigned)k);
+        return selfhost::native_find(name) >= 0 && !math_fn(name, fn);
+    }
+    void eval_stmt(const std::string &src)
+    {
+        stmt_ = true;
+        try
+        {
+            eval(src);
+        }
+        catch (...)
+        {
+            stmt_ = false;
+            throw;
+        }
+        stmt_ = false;
+    }
+    // 是否呼叫過原生函式（需在標頭宣告原生函式表版本）
+    bool uses_native() const { return uses_native_; }
+
+    // 條件：小數以「不等於 0.0」轉成 0/1，JZ/JNZ 只看整數
+    uint32_t eval_cond(const std::string &src)
+    {
+        uint32_t r = eval(src);
+        return is_float(r) ? emit(selfhost::OP_NE, r, fkonst(0.0)) : r;
+    }
+
+    // 運算式結果寫入 dst（最後一條運算直接改寫目的槽位，省一次 COPY）；
+    // 型別不同時轉成 dst 的型別。infer = true 時 dst 改採運算式的型別（變數第一次賦值）
+    void eval_into(const std::string &src, uint32_t dst, bool infer = false)
+    {
+        uint32_t r = eval(src);
+        if (infer)
+            set_float(dst, is_float(r));
+        if (r == dst)
+            return;
+        if (is_float(r) != is_float(dst))
+            selfhost::bcw::unop(bc_, is_float(dst) ? selfhost::OP_I2F : selfhost::OP_F2I, dst, r);
+        else if (last_op_at_ != SIZE_MAX && last_result_ == r && is_temp(r))
+        {
+            // 槽位為變長編碼，改寫目的槽位需重新輸出整條指令
+            bc_.resize(last_op_at_);
+            selfhost::bcw::binop(bc_, last_opc_, dst, last_a_, last_b_);
+        }
+        else
+            selfhost::bcw::copy(bc_, dst, r);
+    }
+
+    const std::vector<uint8_t> &prologue() const { return prologue_; }
+
+private:
+    std::vector<uint8_t> &bc_;
+    selfhost::bcw::StrPool &pool_;
+    const std::function<uint32_t(const std::string &)> &get_slot_;
+    std::map<int64_t, uint32_t> consts_;
+    std::map<int64_t, uint32_t> fconsts_; // 位元型樣 -> 槽位
+    std::set<uint32_t> float_;            // 目前存放小數的槽位（暫存槽位每次寫入時更新）
+    std::map<uint32_t, bool> arr_;        // 陣列槽位 -> 元素是否為小數
+    std::vector<uint8_t> prologue_;
+    std::vector<uint32_t> temps_;
+    size_t ntemp_ = 0;
+    std::string s_;
+    size_t p_ = 0;
+    size_t last_op_at_ = SIZE_MAX;
+    uint32_t last_result_ = 0;
+    selfhost::Op last_opc_ = selfhost::OP_ADD; // 最後一條運算（供 eval_into 改寫目的槽位）
+    uint32_t last_a_ = 0, last_b_ = 0;
+    bool stmt_ = false; // eval_stmt() 中
+    bool uses_native_ = false;
+    unsigned effects_ = 0;
+    const std::map<std::string, ZhFunc> *funcs_ = nullptr;
+    std::vector<std::pair<size_t, std::string>> calls_;
+
+    uint32_t temp()
+    {
+        if (ntemp_ == temps_.size())
+            temps_.push_back(get_slot_("#t" + std::to_string(ntemp_)));
+        return temps_[ntemp_++];
+    }
+    bool is_temp(uint32_t id) const
+    {
+        return std::find(temps_.begin(), temps_.end(), id) != temps_.end();
+    }
+
+    void skip_ws()
+    {
+        while (p_ < s_.size() && (s_[p_] == ' ' || s_[p_] == '\t'))
+            ++p_;
+    }
+    bool eat(const char *tok)
+    {
+        skip_ws();
+        size_t n = std::strlen(tok);
+        if (s_.compare(p_, n, tok) != 0)
+            return false;
+        p_ += n;
+        return true;
+    }
+    // 二元運算；任一邊為小數時兩邊都轉成小數並改用 OP_F*（數值相差 0x20），比較結果仍為整數
+    uint32_t emit(selfhost::Op op, uint32_t a, uint32_t b)
+    {
+        bool fl = is_float(a) || is_float(b);
+        if (fl)
+        {
+            a = to_float(a);
+            b = to_float(b);
+            op = (selfhost::Op)(op + (selfhost::OP_FADD - selfhost::OP_ADD));
+        }
+        uint32_t t = temp();
+        last_op_at_ = bc_.size();
+        last_result_ = t;
+        last_opc_ = op;
+        last_a_ = a;
+        last_b_ = b;
+        selfhost::bcw::binop(bc_, op, t, a, b);
+        set_float(t, fl && op < selfhost::OP_FEQ);
+        return t;
+    }
+    uint32_t convert(selfhost::Op op, uint32_t src, bool to_f)
+    {
+        uint32_t t = temp();
+        selfhost::bcw::unop(bc_, op, t, src);
+        set_float(t, to_f);
+        return t;
+    }
+
+    // 數學函式：chinese.h 的中文別名與 <math.h> 原名皆可
+    static bool math_fn(const std::string &name, selfhost::MathFn &fn)
+    {
+        static const std::map<std::string, selfhost::MathFn> fns = {
+            {u8"平方根", selfhost::MF_SQRT}, {"sqrt", selfhost::MF_SQRT},
+            {u8"立方根", selfhost::MF_CBRT}, {"cbrt", selfhost::MF_CBRT},
+            {u8"正弦", selfhost::MF_SIN}, {"sin", selfhost::MF_SIN},
+            {u8"餘弦", selfhost::MF_COS}, {"cos", selfhost::MF_COS},
+            {u8"正切", selfhost::MF_TAN}, {"tan", selfhost::MF_TAN},
+            {u8"反正弦", selfhost::MF_ASIN}, {"asin", selfhost::MF_ASIN},
+            {u8"反餘弦", selfhost::MF_ACOS}, {"acos", selfhost::MF_ACOS},
+            {u8"反正切", selfhost::MF_ATAN}, {"atan", selfhost::MF_ATAN},
+            {u8"雙變量反正切", selfhost::MF_ATAN2}, {"atan2", selfhost::MF_ATAN2},
+            {u8"次冪", selfhost::MF_POW}, {"pow", selfhost::MF_POW},
+            {u8"絕對值", selfhost::MF_FABS}, {"fabs", selfhost::MF_FABS},
+            {u8"向下取整", selfhost::MF_FLOOR}, {"floor", selfhost::MF_FLOOR},
+            {u8"向上取整", selfhost::MF_CEIL}, {"ceil", selfhost::MF_CEIL},
+            {u8"四捨五入", selfhost::MF_ROUND}, {"round", selfhost::MF_ROUND},
+            {"exp", selfhost::MF_EXP}, {"log", selfhost::MF_LOG}, {"log10", selfhost::MF_LOG10},
+        };
+        auto it = fns.find(name);
+        if (it == fns.end())
+            return false;
+        fn = it->second;
+        return true;
+    }
+
+    // 陣列函式：-1 為長度，其餘為 VecOp 的整數版本（小數陣列再加 VK_ADD_F）
+    static bool vec_fn(const std::string &name, int &k)
+    {
+        static const std::map<std::string, int> fns = {
+            {u8"長度", -1}, {"len", -1},
+            {u8"總和", selfhost::VK_SUM_I}, {"sum", selfhost::VK_SUM_I},
+            {u8"最小值", selfhost::VK_MIN_I}, {"min", selfhost::VK_MIN_I},
+            {u8"最大值", selfhost::VK_MAX_I}, {"max", selfhost::VK_MAX_I},
+            {u8"內積", selfhost::VK_DOT_I}, {"dot", selfhost::VK_DOT_I},
+            {u8"陣列加", selfhost::VK_ADD_I}, {"vadd", selfhost::VK_ADD_I},
+            {u8"陣列乘", selfhost::VK_MUL_I}, {"vmul", selfhost::VK_MUL_I},
+            {u8"陣列乘加", selfhost::VK_FMA_I}, {"vfma", selfhost::VK_FMA_I},
+            {u8"陣列縮放", selfhost::VK_SCALE_I}, {"vscale", selfhost::VK_SCALE_I},
+        };
+        auto it = fns.find(name);
+        if (it == fns.end())
+            return false;
+        k = it->second;
+        return true;
+    }
+
+    // 歸約回傳結果槽位；逐元素運算（陣列加(目的, 甲, 乙)、陣列縮放(目的, 來源, 倍數)）回傳目的陣列
+    uint32_t parse_vec(const std::string &name, int k, const std::vector<uint32_t> &args)
+    {
+        size_t want = k < 0 ? 1 : k == selfhost::VK_DOT_I ? 2 : selfhost::vec_reduces((unsigned)k) ? 1 : 3;
+        if (args.size() != want)
+            throw std::runtime_error(name + " expects " + std::to_string(want) + " argument(s): " + s_);
+        auto elem = [&](size_t i)
+        {
+            auto it = arr_.find(args[i]);
+            if (it == arr_.end())
+                throw std::runtime_error(name + " expects an array as argument " + std::to_string(i + 1) + ": " + s_);
+            return it->second;
+        };
+        bool f = elem(0);
+        uint32_t t;
+        if (k < 0)
+        {
+            t = temp();
+            selfhost::bcw::unop(bc_, selfhost::OP_ALEN, t, args[0]);
+            set_float(t, false);
+            return t;
+        }
+        size_t narr = k == selfhost::VK_SCALE_I ? 2 : want;
+        for (size_t i = 1; i < narr; i++)
+            if (elem(i) != f)
+                throw std::runtime_error("array element types differ in " + name + ": " + s_);
+        selfhost::VecOp op = (selfhost::VecOp)(k + (f ? selfhost::VK_ADD_F : 0));
+        if (selfhost::vec_reduces((unsigned)k))
+        {
+            t = temp();
+            selfhost::bcw::vec(bc_, op, t, args[0], args[want - 1]);
+            set_float(t, f);
+            return t;
+        }
+        uint32_t c = args[2];
+        if (k == selfhost::VK_SCALE_I)
+            c = f ? to_float(c) : to_int(c);
+        selfhost::bcw::vec(bc_, op, args[0], args[1], c);
+        return args[0];
+    }
+
+    // chinese.h 的執行期函式（OP_CALL_NATIVE）；字串參數必須是字面值。
+    // 參數依 native_sig() 轉成整數或小數，輸出格式 的其後參數依格式字串的轉換規格決定
+    uint32_t parse_native(const std::string &name, selfhost::NativeId fn, size_t at)
+    {
+        const char *sig = selfhost::native_sig(fn)->sig;
+        const char *star = std::strchr(sig, '*');
+        size_t fixed = (star ? (size_t)(star - sig) : std::strlen(sig)) - 1;
+        std::vector<uint32_t> ops;
+        std::string types;
+        size_t k = 0;
+        if (!eat(")") && !eat(u8"）"))
+        {
+            for (;; ++k)
+            {
+                char t = k < fixed ? sig[1 + k] : '*';
+                if (t == '*' && !star)
+                    throw std::runtime_error(name + " expects " + std::to_string(fixed) + " argument(s): " + s_);
+                if (t == 's')
+                {
+                    skip_ws();
+                    if (p_ >= s_.size() || s_[p_] != '"')
+                        throw std::runtime_error(name + " expects a string literal: " + s_);
+                    size_t q = p_ + 1;
+                    while (q < s_.size() && s_[q] != '"')
+                        q += s_[q] == '\\' ? 2 : 1;
+                    if (q >= s_.size())
+                        throw std::runtime_error("unterminated string in arguments of " + name + ": " + s_);
+                    std::string str = unescape_c_like(s_.substr(p_ + 1, q - p_ - 1));
+                    p_ = q + 1;
+                    if (fn == selfhost::NF_PRINTF)
+                        selfhost::native_format(str.data(), str.size(), types);
+                    ops.push_back(pool_.intern(str));
+                }
+                else
+                {
+                    if (t == '*')
+                    {
+                        if (k - fixed >= types.size())
+                            throw std::runtime_error("too many arguments for the format of " + name + ": " + s_);
+                        t = types[k - fixed] == 'f' ? 'f' : 'i';
+                    }
+                    uint32_t v = parse_cmp();
+                    ops.push_back(t == 'f' ? to_float(v) : to_int(v));
+                }
+                if (eat(",") || eat(u8"，"))
+                    continue;
+                if (eat(")") || eat(u8"）"))
+                {
+                    ++k;
+                    break;
+                }
+                throw std::runtime_error("missing ')' after arguments of " + name + ": " + s_);
+            }
+        }
+        if (k < fixed || (star && k - fixed < types.size()))
+            throw std::runtime_error(name + " expects " + std::to_string(fixed + types.size()) + " argument(s): " + s_);
+        uses_native_ = true;
+        ++effects_;
+        if (sig[0] == 'v')
+        {
+            skip_ws();
+            if (!stmt_ || at != 0 || p_ != s_.size())
+                throw std::runtime_error(name + " has no value and must be used as a statement: " + s_);
+            selfhost::bcw::call_native(bc_, fn, 0, ops);
+            return 0;
+        }
+        uint32_t t = temp();
+        selfhost::bcw::call_native(bc_, fn, t, ops);
+        set_float(t, sig[0] == 'f');
+        return t;
+    }
+
+    // 使用者函式呼叫；參數轉成參數型別。tail 時輸出 OP_TAILCALL（不回傳值）
+    uint32_t parse_user_call(const std::string &name, const ZhFunc &f, size_t at, bool tail)
+    {
+        std::vector<uint32_t> args;
+        if (!eat(")") && !eat(u8"）"))
+        {
+            for (;;)
+            {
+                args.push_back(parse_cmp());
+                if (eat(",") || eat(u8"，"))
+                    continue;
+                if (eat(")") || eat(u8"）"))
+                    break;
+                throw std::runtime_error("missing ')' after arguments of " + name + ": " + s_);
+            }
+        }
+        if (args.size() != f.params.size())
+            throw std::runtime_error(name + " expects " + std::to_string(f.params.size()) + " argument(s): " + s_);
+        for (size_t k = 0; k < args.size(); k++)
+            args[k] = f.params[k] ? to_float(args[k]) : to_int(args[k]);
+        if (tail)
+        {
+            calls_.emplace_back(selfhost::bcw::call(bc_, 0, args, true), name);
+            return 0;
+        }
+        if (f.ret == 'v')
+        {
+            skip_ws();
+            if (!stmt_ || at != 0 || p_ != s_.size())
+                throw std::runtime_error(name + " has no value and must be used as a statement: " + s_);
+        }
+        uint32_t t = temp(); // 無回傳值的函式也寫回 dst（RET 的值為 0）
+        calls_.emplace_back(selfhost::bcw::call(bc_, t, args), name);
+        set_float(t, f.ret == 'f');
+        return t;
+    }
+
+    // 名稱後接括號：使用者函式、數學函式、陣列函式或原生函式呼叫（at 為名稱起點）
+    uint32_t parse_call(const std::string &name, size_t at)
+    {
+        if (is_function(name))
+            return parse_user_call(name, funcs_->at(name), at, false);
+        selfhost::MathFn mfn;
+        int nf = selfhost::native_find(name);
+        if (nf >= 0 && !math_fn(name, mfn)) // 數學函式仍用 OP_MATH
+            return parse_native(name, (selfhost::NativeId)nf, at);
+        std::vector<uint32_t> args;
+        if (!eat(")") && !eat(u8"）"))
+        {
+            for (;;)
+            {
+                args.push_back(parse_cmp());
+                if (eat(",") || eat(u8"，"))
+                    continue;
+                if (eat(")") || eat(u8"）"))
+                    break;
+                throw std::runtime_error("missing ')' after arguments of " + name + ": " + s_);
+            }
+        }
+        int k;
+        if (vec_fn(name, k))
+            return parse_vec(name, k, args);
+        if (name == "fmod")
+        {
+            if (args.size() != 2)
+                throw std::runtime_error("fmod expects 2 arguments: " + s_);
+            return emit(selfhost::OP_MOD, to_float(args[0]), to_float(args[1])); // 兩邊皆為小數 → OP_FMOD
+        }
+        selfhost::MathFn fn;
+        if (!math_fn(name, fn))
+            throw std::runtime_error("unknown function '" + name + "' in expression: " + s_);
+        if ((int)args.size() != selfhost::math_arity(fn))
+            throw std::runtime_error(name + " expects " + std::to_string(selfhost::math_arity(fn)) + " argument(s): " + s_);
+        uint32_t a = to_float(args[0]);
+        uint32_t b = args.size() > 1 ? to_float(args[1]) : a;
+        uint32_t t = temp();
+        selfhost::bcw::math(bc_, fn, t, a, b);
+        set_float(t, true);
+        return t;
+    }
+
+    uint32_t parse_primary()
+    {
+        skip_ws();
+        if (eat("(") || eat(u8"（"))
+        {
+            uint32_t r = parse_cmp();
+            if (!eat(")") && !eat(u8"）"))
+                throw std::runtime_error("missing ')' in expression: " + s_);
+            return r;
+        }
+        if (eat("-"))
+        {
+            uint32_t r = parse_primary();
+            if (is_float(r))
+                return emit(selfhost::OP_MUL, fkonst(-1.0), r); // 保留 -0.0（0 - x 會得到 +0.0）
+            return emit(selfhost::OP_SUB, konst(0), r);
+        }
+        if (p_ < s_.size() && std::isdigit((unsigned char)s_[p_]))
+        {
+            // 整數，或含小數點 / 指數的小數字面值（1.5、2.、1e-7、1.64e-7）
+            size_t b = p_;
+            while (p_ < s_.size() && std::isdigit((unsigned char)s_[p_]))
+                ++p_;
+            bool fl = false;
+            if (p_ < s_.size() && s_[p_] == '.')
+            {
+                fl = true;
+                ++p_;
+                while (p_ < s_.size() && std::isdigit((unsigned char)s_[p_]))
+                    ++p_;
+            }
+            if (p_ < s_.size() && (s_[p_] == 'e' || s_[p_] == 'E'))
+            {
+                size_t q = p_ + 1;
+                if (q < s_.size() && (s_[q] == '+' || s_[q] == '-'))
+                    ++q;
+                if (q < s_.size() && std::isdigit((unsigned char)s_[q]))
+                {
+                    fl = true;
+                    p_ = q;
+                    while (p_ < s_.size() && std::isdigit((unsigned char)s_[p_]))
+                        ++p_;
+                }
+            }
+            if (fl)
+                return fkonst(std::strtod(s_.substr(b, p_ - b).c_str(), nullptr));
+            return konst(std::stoll(s_.substr(b, p_ - b)));
+        }
+        size_t at = p_, end;
+        std::string name = extract_var_name(s_, p_, end);
+        if (name.empty())
+            throw std::runtime_error("expected value in expression: " + s_);
+        p_ = end;
+        if (eat("(") || eat(u8"（"))
+            return parse_call(name, at);
+        if (eat("["))
+        {
+            uint32_t a = get_slot_(name);
+            auto it = arr_.find(a);
+            if (it == arr_.end())
+                throw std::runtime_error("'" + name + "' is not an array: " + s_);
+            uint32_t idx = to_int(parse_cmp());
+            if (!eat("]"))
+                throw std::runtime_error("missing ']' in expression: " + s_);
+            uint32_t t = temp();
+            selfhost::bcw::binop(bc_, selfhost::OP_AGET, t, a, idx);
+            set_float(t, it->second);
+            return t;
+        }
+        if (name == u8"圓周率" || name == "M_PI")
+            return fkonst(3.14159265358979323846);
+        if (name == u8"自然常數" || name == "M_E")
+            return fkonst(2.71828182845904523536);
+        return get_slot_(name);
+    }
+    uint32_t parse_mul()
+    {
+        uint32_t l = parse_primary();
+        for (;;)
+        {
+            if (eat("*"))
+                l = emit(selfhost::OP_MUL, l, parse_primary());
+            else if (eat("/"))
+                l = emit(selfhost::OP_DIV, l, parse_primary());
+            else if (eat("%"))
+                l = emit(selfhost::OP_MOD, l, parse_primary());
+            else
+                return l;
+        }
+    }
+    uint32_t parse_add()
+    {
+        uint32_t l = parse_mul();
+        for (;;)
+        {
+            if (eat("+"))
+                l = emit(selfhost::OP_ADD, l, parse_mul());
+            else if (eat("-"))
+                l = emit(selfhost::OP_SUB, l, parse_mul());
+            else
+                return l;
+        }
+    }
+    uint32_t parse_cmp()
+    {
+        uint32_t l = parse_add();
+        for (;;)
+        {
+            // 兩字元運算子須先於單字元比對
+            if (eat("=="))
+                l = emit(selfhost::OP_EQ, l, parse_add());
+            else if (eat("!="))
+                l = emit(selfhost::OP_NE, l, parse_add());
+            else if (eat("<="))
+                l = emit(selfhost::OP_LE, l, parse_add());
+            else if (eat(">="))
+                l = emit(selfhost::OP_GE, l, parse_add());
+            else if (eat("<"))
+                l = emit(selfhost::OP_LT, l, parse_add());
+            else if (eat(">"))
+                l = emit(selfhost::OP_GT, l, parse_add());
+            else
+                return l;
+        }
+    }
+};
+
+std::vector<uint8_t> ZhFrontend::translate_to_bc(const std::string &src_in, const std::string &file)
 {
     std::string src = src_in;
 
@@ -196,16 +1017,20 @@ std::vector<uint8_t> ZhFrontend::translate_to_bc(const std::string &src_in)
     src = zh_keyword_rewrite(src);
 
     std::vector<uint8_t> bc;
-    std::map<std::string, uint8_t> slot;
-    auto get_slot = [&](const std::string &name) -> uint8_t
+    selfhost::bcw::StrPool pool;
+    selfhost::bcw::DebugTable dbg(file); // 每條語句的起點 → 原始行號
+    std::map<std::string, uint32_t> slot;
+    uint32_t frame = 0; // 「設為槽位 N」可能引用未命名的槽位
+    std::function<uint32_t(const std::string &)> get_slot = [&](const std::string &name) -> uint32_t
     {
         auto it = slot.find(name);
         if (it != slot.end())
             return it->second;
-        uint8_t id = (uint8_t)slot.size();
+        uint32_t id = (uint32_t)slot.size();
         slot[name] = id;
         return id;
     };
+    ZhLowering lw(bc, pool, get_slot);
 
     // 三種最小語句的正則 - 現在匹配中間標記而不是原始中文
     std::regex re_print_s(u8"PRINT_STR_KEYWORD\\s*\"([^\"]*)\"");
@@ -220,158 +1045,912 @@ std::vector<uint8_t> ZhFrontend::translate_to_bc(const std::string &src_in)
     std::regex re_puts(R"(puts\s*\(\s*\"([^\"]*)\"\s*\)\s*;)");
     std::regex re_printf_d(R"(printf\s*\(\s*\"%d\"\s*,\s*([A-Za-z_]\w*)\s*\)\s*;)");
 
-    std::stringstream ss(src);
-    std::string line;
     std::smatch m;
 
-    while (std::getline(ss, line))
+    // 單行語句（舊有的正則規則）
+    auto lower_simple = [&](const std::string &line)
     {
-        // 去掉純空白行
-        if (line.empty() || line.find_first_not_of(" \t") == std::string::npos)
-            continue;
-
-        // 輸出字串 - 匹配 PRINT_STR_KEYWORD "string"
-        if (std::regex_search(line, m, re_print_s))
-        {
-            std::string str = unescape_c_like(m[1].str());
-            u8(bc, 1); // OP_PRINT_S
-            u64le(bc, str.size());
-            for (char c : str)
-                u8(bc, (unsigned char)c);
-        }
-        // 輸出整數 - 匹配 PRINT_INT_KEYWORD var_name
-        else if (std::regex_search(line, m, re_print_i))
-        {
-            size_t var_start = m.position() + m.length();
-            size_t var_end;
-            std::string var = extract_var_name(line, var_start, var_end);
-            if (!var.empty() && is_valid_var_name(var))
+            // 輸出字串 - 匹配 PRINT_STR_KEYWORD "string"
+            if (std::regex_search(line, m, re_print_s))
             {
-                u8(bc, 2); // OP_PRINT_I
-                u8(bc, get_slot(var));
+                std::string str = unescape_c_like(m[1].str());
+                selfhost::bcw::print(bc, pool, str);
+                lw.effect();
             }
-            else
+            // 輸出整數 - 匹配 PRINT_INT_KEYWORD var_name
+            else if (std::regex_search(line, m, re_print_i))
             {
-                // 無效變量名，跳過
-                continue;
+                size_t var_start = m.position() + m.length();
+                size_t var_end;
+                std::string var = extract_var_name(line, var_start, var_end);
+                if (!var.empty() && is_valid_var_name(var))
+                {
+                    selfhost::bcw::print_int(bc, get_slot(var));
+                    lw.effect();
+                }
+                else
+                {
+                    // 無效變量名，跳過
+                    return;
+                }
             }
-        }
-        // 設為數字 - 匹配 INT_KEYWORD var_name ASSIGN_KEYWORD number
-        else if (std::regex_search(line, m, re_set_i64_exact))
-        {
-            size_t var_start = m.position() + m.length();
-            size_t var_end;
-            std::string var = extract_var_name(line, var_start, var_end);
-            if (!var.empty() && is_valid_var_name(var))
+            // 設為數字 - 匹配 INT_KEYWORD var_name ASSIGN_KEYWORD number
+            else if (std::regex_search(line, m, re_set_i64_exact))
             {
-                // 查找 ASSIGN_KEYWORD 標記
-                size_t assign_pos = line.find("ASSIGN_KEYWORD", var_end);
-                if (assign_pos != std::string::npos)
+                size_t var_start = m.position() + m.length();
+                size_t var_end;
+                std::string var = extract_var_name(line, var_start, var_end);
+                if (!var.empty() && is_valid_var_name(var))
                 {
-                    // 提取數字
-                    size_t num_start = assign_pos + 13; // "ASSIGN_KEYWORD" 的長度
-                    size_t num_end = line.find_first_not_of("0123456789-", num_start);
-                    if (num_end != std::string::npos)
+                    // 查找 ASSIGN_KEYWORD 標記
+                    size_t assign_pos = line.find("ASSIGN_KEYWORD", var_end);
+                    if (assign_pos != std::string::npos)
                     {
-                        std::string num_str = line.substr(num_start, num_end - num_start);
-                        try
+                        // 提取數字
+                        size_t num_start = assign_pos + 13; // "ASSIGN_KEYWORD" 的長度
+                        size_t num_end = line.find_first_not_of("0123456789-", num_start);
+                        if (num_end != std::string::npos)
                         {
-                            int64_t val = std::stoll(num_str);
-                            u8(bc, 3); // OP_SET_I64
-                            u8(bc, get_slot(var));
-                            i64le(bc, val);
+                            std::string num_str = line.substr(num_start, num_end - num_start);
+                            try
+                            {
+                                int64_t val = std::stoll(num_str);
+                                selfhost::bcw::set_i64(bc, get_slot(var), val);
+                            }
+                            catch (...)
+                            {
+                                // 無效數字，跳過
+                                return;
+                            }
                         }
-                        catch (...)
+                    }
+                }
+                else
+                {
+                    // 無效變量名，跳過
+                    return;
+                }
+            }
+            // 設為槽位
+            else if (std::regex_search(line, m, re_set_i64_slot))
+            {
+                size_t var_start = m.position() + m.length();
+                size_t var_end;
+                std::string var = extract_var_name(line, var_start, var_end);
+                if (!var.empty() && is_valid_var_name(var))
+                {
+                    // 查找 "設為槽位" 關鍵字
+                    size_t slot_pos = line.find(u8"設為槽位", var_end);
+                    if (slot_pos != std::string::npos)
+                    {
+                        // 提取槽位號
+                        size_t num_start = slot_pos + 9; // "設為槽位" 的長度
+                        size_t num_end = line.find_first_not_of("0123456789", num_start);
+                        if (num_end != std::string::npos)
                         {
-                            // 無效數字，跳過
-                            continue;
+                            std::string num_str = line.substr(num_start, num_end - num_start);
+                            try
+                            {
+                                uint32_t slot_id = (uint32_t)std::stoul(num_str);
+                                if (slot_id >= selfhost::MAX_FRAME)
+                                    return;
+                                selfhost::bcw::copy(bc, get_slot(var), slot_id); // 設為槽位 N
+                                frame = std::max(frame, slot_id + 1);
+                            }
+                            catch (...)
+                            {
+                                // 無效槽位號，跳過
+                                return;
+                            }
                         }
                     }
                 }
+                else
+                {
+                    // 無效變量名，跳過
+                    return;
+                }
+            }
+            // C 風格輸出字串
+            else if (std::regex_search(line, m, re_print_s_c))
+            {
+                std::string str = unescape_c_like(m[1].str());
+                selfhost::bcw::print(bc, pool, str);
+                lw.effect();
+            }
+            // C 風格 int 賦值
+            else if (std::regex_search(line, m, re_int_assign))
+            {
+                std::string var = m[1].str();
+                int64_t val = std::stoll(m[2].str());
+                selfhost::bcw::set_i64(bc, get_slot(var), val);
+            }
+            // C 風格 puts
+            else if (std::regex_search(line, m, re_puts))
+            {
+                std::string str = unescape_c_like(m[1].str());
+                selfhost::bcw::print(bc, pool, str);
+                lw.effect();
+            }
+            // C 風格 printf %d
+            else if (std::regex_search(line, m, re_printf_d))
+            {
+                std::string var = m[1].str();
+                selfhost::bcw::print_int(bc, get_slot(var));
+                lw.effect();
+            }
+        // 忽略註釋和無法識別的行
+    };
+
+    // 逐行切分並記錄縮排（tab 視為 4 格）
+    std::vector<ZhLine> lines;
+    {
+        std::stringstream ss(src);
+        std::string line;
+        int lineno = 0;
+        while (std::getline(ss, line))
+        {
+            ++lineno;
+            // 去掉純空白行
+            if (line.empty() || line.find_first_not_of(" \t") == std::string::npos)
+                continue;
+            int indent = 0;
+            size_t k = 0;
+            for (; k < line.size() && (line[k] == ' ' || line[k] == '\t'); ++k)
+                indent += (line[k] == '\t') ? 4 : 1;
+            lines.push_back({indent, lineno, line});
+        }
+    }
+
+    std::regex re_print_str(u8R"re(^輸出字串\s*(?:\(|（)\s*"((?:[^"\\]|\\.)*)"\s*(?:\)|）)$)re");
+    std::regex re_print_int(u8R"re(^輸出整數\s*(?:\(|（)(.*)(?:\)|）)$|^輸出整數\s+(.+)$)re");
+    std::regex re_print_f64(u8R"re(^輸出小數\s*(?:\(|（)(.*)(?:\)|）)$|^輸出小數\s+(.+)$)re");
+    std::regex re_assign(R"(^(.+?)\s*(\+=|-=|\*=|/=|%=|=)\s*([^=].*)$)");
+    std::regex re_incdec(R"(^(.+?)\s*(\+\+|--)$)");
+    std::regex re_elem(R"(^(.+?)\s*\[(.+)\]$)"); // a[i]
+    std::regex re_call_stmt(u8R"re(^([^\s(]+?)\s*(?:\(|（).*$)re"); // 名稱不排除「（」的位元組（與中文字共用）
+
+    auto fail = [](const ZhLine &L, const std::string &what)
+    {
+        throw std::runtime_error("line " + std::to_string(L.lineno) + ": " + what + ": " + trim_copy(L.text));
+    };
+
+    // 宣告 / 賦值 / 遞增；成功處理回傳 true
+    auto lower_assign = [&](const ZhLine &L, const std::string &stmt) -> bool
+    {
+        std::string s = stmt, rest;
+        bool fdecl = false, adecl = false;
+        if (match_kw(s, {u8"整數陣列", u8"小數陣列"}, rest))
+        {
+            fdecl = s.compare(0, std::strlen(u8"小數"), u8"小數") == 0;
+            adecl = true;
+        }
+        else
+            fdecl = match_kw(s, {u8"雙精度小數", u8"小數", "double", "float"}, rest);
+        bool decl = adecl || fdecl || match_kw(s, {u8"整數", "int", "long"}, rest);
+        if (decl)
+            s = rest;
+        std::smatch mm;
+        // 陣列宣告：整數陣列 a[n] / 小數陣列 a[n]（也接受 整數 a[n]、double a[n]）
+        if (decl && std::regex_match(s, mm, re_elem) && is_valid_var_name(trim_copy(mm[1].str())))
+        {
+            try
+            {
+                lw.new_array(get_slot(trim_copy(mm[1].str())), mm[2].str(), fdecl);
+            }
+            catch (const std::exception &e)
+            {
+                fail(L, e.what());
+            }
+            return true;
+        }
+        if (adecl)
+            fail(L, "expected name[length]");
+        // 元素賦值：a[i] = e / a[i] += e / a[i]++
+        auto store = [&](const std::string &lhs, const std::string &op, const std::string &rhs) -> bool
+        {
+            std::smatch em;
+            if (!std::regex_match(lhs, em, re_elem) || !is_valid_var_name(trim_copy(em[1].str())))
+                return false;
+            std::string name = trim_copy(em[1].str()), idx = em[2].str();
+            try
+            {
+                lw.store_elem(get_slot(name), idx,
+                              op == "=" ? rhs : lhs + " " + op.substr(0, 1) + " (" + rhs + ")");
             }
+            catch (const std::exception &e)
+            {
+                fail(L, e.what());
+            }
+            return true;
+        };
+        if (std::regex_match(s, mm, re_incdec))
+        {
+            std::string var = trim_copy(mm[1].str());
+            if (!decl && store(var, mm[2].str() == "++" ? "+=" : "-=", "1"))
+                return true;
+            if (!is_valid_var_name(var))
+                return false;
+            uint32_t v = get_slot(var);
+            bool inc = mm[2].str() == "++";
+            if (lw.is_float(v))
+                selfhost::bcw::binop(bc, inc ? selfhost::OP_FADD : selfhost::OP_FSUB, v, v, lw.fkonst(1.0));
             else
+                selfhost::bcw::binop(bc, inc ? selfhost::OP_ADD : selfhost::OP_SUB, v, v, lw.konst(1));
+            return true;
+        }
+        if (!std::regex_match(s, mm, re_assign))
+        {
+            if (decl && is_valid_var_name(trim_copy(s)))
+            {
+                // 「整數 x」/「小數 x」初值為 0
+                uint32_t v = get_slot(trim_copy(s));
+                lw.set_float(v, fdecl);
+                if (fdecl)
+                    selfhost::bcw::set_f64(bc, v, 0.0);
+                else
+                    selfhost::bcw::set_i64(bc, v, 0);
+                return true;
+            }
+            return false;
+        }
+        std::string var = trim_copy(mm[1].str());
+        if (!decl && store(var, mm[2].str(), mm[3].str()))
+            return true;
+        if (!is_valid_var_name(var))
+            return false;
+        bool fresh = !decl && !slot.count(var); // 未宣告就賦值：型別取自運算式
+        uint32_t v = get_slot(var);
+        if (decl)
+            lw.set_float(v, fdecl);
+        std::string op = mm[2].str();
+        try
+        {
+            if (op == "=")
+                lw.eval_into(mm[3].str(), v, fresh);
+            else
+                lw.eval_into(var + " " + op.substr(0, 1) + " (" + mm[3].str() + ")", v);
+        }
+        catch (const std::exception &e)
+        {
+            fail(L, e.what());
+        }
+        return true;
+    };
+
+    // 條件求值並輸出 JZ，回傳待 patch 的位置
+    auto lower_cond_jz = [&](const ZhLine &L, const std::string &cond) -> size_t
+    {
+        lw.begin_stmt();
+        uint32_t c = 0;
+        try
+        {
+            c = lw.eval_cond(cond);
+        }
+        catch (const std::exception &e)
+        {
+            fail(L, e.what());
+        }
+        return selfhost::bcw::jump(bc, selfhost::OP_JZ, c);
+    };
+
+    // 區塊：lines[i, end)；回傳時 i 指向下一條未處理的行
+    std::function<void(size_t &, size_t)> lower_block;
+    auto body_end = [&](size_t i, size_t end) -> size_t
+    {
+        size_t j = i + 1;
+        while (j < end && lines[j].indent > lines[i].indent)
+            ++j;
+        return j;
+    };
+
+    // 平行迴圈本體 lines[i+1, end) 對外部變數（迴圈之前已有的變數）的寫入只接受可歸約的形式：
+    //   x += e、x -= e、x++、x--、x = x + e、x = x - e → 加總；x *= e、x = x * e → 連乘
+    //   如果 (v > x)： 之下的 x = v → 最大值（< 為最小值，>= / <= 相同時取後者），同一區塊內其他外部變數的賦值跟隨 x
+    // 其餘寫入為編譯錯誤；歸約變數在本體中也不能另外讀取。迴圈內宣告或第一次賦值的變數屬於各工作
+    auto par_reductions = [&](size_t i, size_t end, const std::string &iv)
+    {
+        using namespace selfhost;
+        std::map<std::string, uint8_t> kind; // 歸約變數 -> ReduceOp
+        std::map<std::string, std::string> key_of; // RD_ARG 變數 -> 跟隨的鍵
+        std::vector<std::string> order;
+        std::map<std::string, std::set<size_t>> own; // 變數 -> 可以提到它的行
+        std::set<std::string> local;
+        auto outer = [&](const std::string &n) { return n != iv && !local.count(n) && slot.count(n); };
+        auto is_f = [&](const std::string &n) { return lw.is_float(slot.at(n)) ? (uint8_t)RD_F64 : (uint8_t)0; };
+        auto set_role = [&](size_t j, const std::string &n, uint8_t k, const std::string &key)
+        {
+            auto it = kind.find(n);
+            if (it == kind.end())
+            {
+                kind[n] = k;
+                key_of[n] = key;
+                order.push_back(n);
+            }
+            else if (it->second != k || key_of[n] != key)
+                fail(lines[j], "'" + n + u8"' is reduced in two different ways inside 平行迴圈");
+            own[n].insert(j);
+        };
+        auto bad_write = [&](size_t j, const std::string &n)
+        {
+            fail(lines[j], "'" + n + u8"' is declared outside 平行迴圈; inside it only " + n + " += …, " + n + " *= … or " +
+                               u8"如果 (v > " + n + u8")： " + n + " = v can change it (declare a per-iteration variable inside the loop)");
+        };
+        // 語句的寫入目標；不是賦值或為宣告（記為區域變數）時回傳空字串
+        auto target = [&](size_t j, const std::string &st, std::string &op, std::string &rhs) -> std::string
+        {
+            std::string rest;
+            std::smatch mm;
+            op.clear();
+            rhs.clear();
+            if (match_kw(st, {u8"整數陣列", u8"小數陣列", u8"雙精度小數", u8"小數", u8"整數", "double", "float", "int", "long"},
+                         rest))
+            {
+                size_t e;
+                local.insert(extract_var_name(rest, 0, e));
+                return "";
+            }
+            std::string n;
+            if (std::regex_match(st, mm, re_incdec))
+                n = trim_copy(mm[1].str()), op = mm[2].str();
+            else if (std::regex_match(st, mm, re_assign))
+                n = trim_copy(mm[1].str()), op = mm[2].str(), rhs = trim_copy(mm[3].str());
+            else
+                return "";
+            if (n == iv)
+                fail(lines[j], u8"the loop variable cannot be assigned inside 平行迴圈");
+            if (!is_valid_var_name(n) || local.count(n))
+                return ""; // 陣列元素或區域變數
+            if (!slot.count(n))
+            {
+                local.insert(n); // 第一次賦值即宣告
+                return "";
+            }
+            return n;
+        };
+        auto stmt = [&](size_t j, const std::string &st)
+        {
+            std::string op, rhs, n = target(j, st, op, rhs), e = rhs;
+            if (n.empty())
+                return;
+            uint8_t k = RD_SUM;
+            if (op == "*=")
+                k = RD_PROD;
+            else if (op == "=")
+            {
+                // x = x + e / x - e / x * e（e 的最外層不能有優先序更低的運算）
+                size_t p = n.size();
+                if (rhs.compare(0, n.size(), n) != 0 || !ident_edge(rhs, p, false))
+                    bad_write(j, n);
+                e = trim_copy(rhs.substr(p));
+                char c = e.empty() ? 0 : e[0];
+                if (c == '*' && !top_level_has(e.substr(1), "+-/%<>=!"))
+                    k = RD_PROD;
+                else if ((c == '+' || c == '-') && !top_level_has(e.substr(1), "<>=!"))
+                    k = RD_SUM;
+                else
+                    bad_write(j, n);
+            }
+            else if (op != "+=" && op != "-=" && op != "++" && op != "--")
+                bad_write(j, n);
+            if (mentions(e, n))
+                bad_write(j, n);
+            set_role(j, n, (uint8_t)(k | is_f(n)), "");
+        };
+        // 如果 (cond)： 區塊 lines[j+1, bend) 是否為最大 / 最小值的更新；是的話記下並回傳 true
+        std::regex re_cmp(R"(^(.+?)\s*(>=|<=|>|<)\s*(.+)$)");
+        auto guard = [&](size_t j, const std::string &cond, size_t bend) -> bool
+        {
+            std::smatch mm;
+            if (!std::regex_match(cond, mm, re_cmp))
+                return false;
+            std::string l = trim_copy(mm[1].str()), cmp = mm[2].str(), r = trim_copy(mm[3].str());
+            // 變數在右邊時 v > x 表示 x 要變大；在左邊時 x < v 才是
+            for (int side = 0; side < 2; side++)
             {
-                // 無效變量名，跳過
+                const std::string &x = side ? l : r, &v = side ? r : l;
+                if (!is_valid_var_name(x) || !outer(x))
+                    continue;
+                bool hit = false;
+                for (size_t k = j + 1; k < bend && !hit; k++)
+                {
+                    std::string op, rhs, t = trim_copy(lines[k].text);
+                    hit = !strip_block_colon(t) && target(k, t, op, rhs) == x && op == "=" && same_expr(rhs, v);
+                }
+                if (!hit)
+                    continue;
+                const bool mx = (cmp[0] == '>') == (side == 0);
+                if (mentions(v, x))
+                    bad_write(j, x);
+                set_role(j, x, (uint8_t)((mx ? RD_MAX : RD_MIN) | (cmp.size() == 2 ? RD_TIE : 0) | is_f(x)), "");
+                for (size_t k = j + 1; k < bend; k++)
+                {
+                    std::string op, rhs, t = trim_copy(lines[k].text);
+                    if (strip_block_colon(t))
+                        fail(lines[k], u8"only assignments are allowed under the 如果 of a 平行迴圈 max / min update");
+                    std::string n = target(k, t, op, rhs);
+                    if (n.empty())
+                        continue;
+                    if (op != "=" || mentions(rhs, n) || (n == x && !same_expr(rhs, v)))
+                        bad_write(k, n);
+                    if (n == x)
+                        own[x].insert(k);
+                    else
+                        set_role(k, n, RD_ARG, x);
+                }
+                return true;
+            }
+            return false;
+        };
+
+        for (size_t j = i + 1; j < end; j++)
+        {
+            std::string t = lines[j].text, rest, inner;
+            bool hdr = strip_block_colon(t);
+            if (match_kw(t, {u8"否則", u8"不然", "else"}, rest))
+                t = rest;
+            if (match_kw(t, {u8"如果", "if"}, rest) && paren_body(rest, inner))
+            {
+                size_t bend = body_end(j, end);
+                if (guard(j, trim_copy(inner), bend))
+                    j = bend - 1;
+                continue;
+            }
+            if (match_kw(t, {u8"迴圈", u8"重複", u8"對於", "for"}, rest) && paren_body(rest, inner))
+            {
+                std::vector<std::string> parts;
+                std::stringstream ps(inner);
+                std::string part;
+                while (std::getline(ps, part, ';'))
+                    parts.push_back(trim_copy(part));
+                for (size_t k = 0; k < parts.size(); k += 2)
+                    stmt(j, parts[k]);
                 continue;
             }
+            if (!hdr)
+                stmt(j, t);
         }
-        // 設為槽位
-        else if (std::regex_search(line, m, re_set_i64_slot))
+        for (auto &n : order)
+            for (size_t j = i + 1; j < end; j++)
+                if (!own[n].count(j) && mentions(lines[j].text, n))
+                    fail(lines[j], "'" + n + u8"' is reduced by this 平行迴圈 and cannot be read inside it");
+
+        // 歸約清單：最大 / 最小值之後緊接跟隨它的變數
+        std::vector<std::pair<uint8_t, uint32_t>> red;
+        for (auto &n : order)
         {
-            size_t var_start = m.position() + m.length();
-            size_t var_end;
-            std::string var = extract_var_name(line, var_start, var_end);
-            if (!var.empty() && is_valid_var_name(var))
+            if ((kind[n] & RD_KIND) == RD_ARG)
+                continue;
+            red.emplace_back(kind[n], slot.at(n));
+            for (auto &f : order)
+                if (key_of[f] == n)
+                    red.emplace_back((uint8_t)RD_ARG, slot.at(f));
+        }
+        if (red.size() > SPAWN_MAX_REDUCE)
+            fail(lines[i], u8"平行迴圈 can reduce at most " + std::to_string(SPAWN_MAX_REDUCE) + " variables");
+        return red;
+    };
+
+    // 使用者函式：先掃過所有標頭，呼叫可以出現在定義之前（含遞迴）
+    std::map<std::string, ZhFunc> funcs;
+    for (auto &L : lines)
+    {
+        std::string s = L.text, name;
+        std::vector<std::string> params;
+        ZhFunc f;
+        strip_block_colon(s);
+        try
+        {
+            if (!fn_header(s, name, f, params) || is_main_name(name))
+                continue;
+        }
+        catch (const std::exception &e)
+        {
+            fail(L, e.what());
+        }
+        if (!funcs.emplace(name, f).second)
+            fail(L, "function '" + name + "' is already defined");
+    }
+    lw.set_functions(funcs);
+
+    // 已降階的函式本體（含常數初始化），最後全部接在主程式的 OP_END 之後
+    struct FnBody
+    {
+        std::string name;
+        std::vector<uint8_t> code;
+        std::vector<selfhost::DebugRow> rows;              // 位移相對本體起點
+        std::vector<std::pair<size_t, std::string>> calls; // 同上
+        uint32_t frame;
+        bool pure; // 本體沒有副作用（見 ZhLowering::effects）
+    };
+    std::vector<FnBody> bodies;
+    const ZhFunc *cur_fn = nullptr; // 降階中的函式；主程式為 nullptr
+    int par = 0;                    // 平行迴圈本體的深度
+    unsigned npar = 0;              // 已降階的平行迴圈數（隱藏槽位的名稱）
+    std::vector<std::pair<size_t, std::string>> par_calls; // 平行迴圈本體中的呼叫：行、函式（最後檢查是否無副作用）
+
+    // 函式本體 lines[i, end)：程式碼、槽位、行表與 lw 的狀態換成新的一份，降階完再換回來。
+    // 參數佔槽位 0..n-1；本體沒有以「返回」結束時回傳 0
+    auto lower_function = [&](const std::string &name, const std::vector<std::string> &params, size_t i, size_t end)
+    {
+        FnBody b;
+        b.name = name;
+        std::map<std::string, uint32_t> fslot;
+        selfhost::bcw::DebugTable fdbg;
+        ZhLowering state(bc, pool, get_slot);
+        const ZhFunc *outer = cur_fn;
+        auto swap_all = [&]
+        {
+            bc.swap(b.code);
+            slot.swap(fslot);
+            std::swap(dbg, fdbg);
+            lw.swap_state(state);
+        };
+        swap_all();
+        cur_fn = &funcs.at(name);
+        for (size_t k = 0; k < params.size(); k++)
+            lw.set_float(get_slot(params[k]), cur_fn->params[k]);
+        lower_block(i, end);
+        lw.begin_stmt();
+        dbg.mark(bc.size(), 0);
+        selfhost::bcw::ret(bc, lw.konst(0));
+        bc.insert(bc.begin(), lw.prologue().begin(), lw.prologue().end());
+        dbg.shift(lw.prologue().size());
+        b.rows = dbg.rows();
+        b.calls = lw.calls();
+        for (auto &c : b.calls)
+            c.first += lw.prologue().size();
+        b.frame = std::max<uint32_t>(1, (uint32_t)slot.size());
+        b.pure = lw.effects() == 0;
+        cur_fn = outer;
+        swap_all();
+        bodies.push_back(std::move(b));
+    };
+
+    std::function<void(size_t &, size_t, std::string)> lower_stmt = [&](size_t &i, size_t end, std::string s)
+    {
+        const ZhLine &L = lines[i];
+        std::string rest, inner;
+        bool block = strip_block_colon(s);
+        lw.begin_stmt();
+        dbg.mark(bc.size(), (uint32_t)L.lineno);
+
+        // 平行迴圈 (整數 i = a; i < b; i++)：各次迭代分給多個核心執行。範圍在進入時求值，
+        // 本體降為 OP_SPAWN 的工作（每塊自己跑 i 從 lo 到 hi 的迴圈），接著 OP_JOIN 等待並歸約
+        if (match_kw(s, {u8"平行迴圈"}, rest) && paren_body(rest, inner))
+        {
+            if (par)
+                fail(L, u8"平行迴圈 cannot be nested");
+            std::vector<std::string> parts;
+            std::stringstream ps(inner);
+            std::string part;
+            while (std::getline(ps, part, ';'))
+                parts.push_back(trim_copy(part));
+            std::smatch mm;
+            std::regex re_par_cond(R"(^(.+?)\s*(<=|<)\s*(.+)$)");
+            std::string init, iv, from;
+            if (parts.size() == 3 && match_kw(parts[0], {u8"整數", "int", "long"}, init) &&
+                std::regex_match(init, mm, re_assign) && mm[2].str() == "=")
+            {
+                iv = trim_copy(mm[1].str());
+                from = mm[3].str();
+            }
+            std::string step = parts.size() == 3 ? parts[2] : "";
+            step.erase(std::remove(step.begin(), step.end(), ' '), step.end());
+            if (!is_valid_var_name(iv) || !std::regex_match(parts[1], mm, re_par_cond) || trim_copy(mm[1].str()) != iv ||
+                (step != iv + "++" && step != "++" + iv && step != iv + "+=1" && step != iv + "=" + iv + "+1"))
+                fail(L, u8"expected 平行迴圈 (整數 i = 起點; i < 終點; i++)");
+            std::string to = mm[2].str() == "<=" ? "(" + mm[3].str() + ") + 1" : mm[3].str();
+            size_t bend = body_end(i, end);
+            std::vector<std::pair<uint8_t, uint32_t>> red = par_reductions(i, bend, iv);
+            const std::string tag = "#par" + std::to_string(npar++);
+            uint32_t v = get_slot(iv), lo = get_slot(tag + "lo"), hi = get_slot(tag + "hi"), c = get_slot(tag + "c");
+            lw.set_float(v, false);
+            try
+            {
+                lw.eval_into(from, lo);
+                lw.begin_stmt();
+                lw.eval_into(to, hi);
+            }
+            catch (const std::exception &e)
+            {
+                fail(L, e.what());
+            }
+            size_t skip = selfhost::bcw::jump(bc, selfhost::OP_JMP);
+            size_t entry = bc.size();
+            selfhost::bcw::copy(bc, v, lo);
+            size_t top = bc.size();
+            selfhost::bcw::binop(bc, selfhost::OP_LT, c, v, hi);
+            size_t jz = selfhost::bcw::jump(bc, selfhost::OP_JZ, c);
+            size_t j = i + 1;
+            ++par;
+            lower_block(j, bend);
+            --par;
+            lw.begin_stmt();
+            dbg.mark(bc.size(), (uint32_t)L.lineno);
+            selfhost::bcw::binop(bc, selfhost::OP_ADD, v, v, lw.konst(1));
+            selfhost::bcw::jump_to(bc, selfhost::OP_JMP, top);
+            selfhost::bcw::patch(bc, jz, bc.size());
+            selfhost::bcw::ret(bc, lo);
+            selfhost::bcw::patch(bc, skip, bc.size());
+            selfhost::bcw::patch(bc, selfhost::bcw::spawn(bc, lo, hi, red), entry);
+            selfhost::bcw::join(bc);
+            lw.effect(); // 工作中不能再 SPAWN：呼叫這個函式的平行迴圈要拒絕
+            i = bend;
+            return;
+        }
+        // 迴圈 (初始; 條件; 遞增)：
+        if (match_kw(s, {u8"迴圈", u8"重複", u8"對於", "for"}, rest) && paren_body(rest, inner))
+        {
+            std::vector<std::string> parts;
+            std::stringstream ps(inner);
+            std::string part;
+            while (std::getline(ps, part, ';'))
+                parts.push_back(trim_copy(part));
+            if (parts.size() != 3)
+                fail(L, "expected (init; cond; step)");
+            size_t bend = body_end(i, end);
+            if (!parts[0].empty() && !lower_assign(L, parts[0]))
+                fail(L, "bad loop init");
+            size_t top = bc.size();
+            size_t jz = parts[1].empty() ? SIZE_MAX : lower_cond_jz(L, parts[1]);
+            size_t j = i + 1;
+            lower_block(j, bend);
+            lw.begin_stmt();
+            dbg.mark(bc.size(), (uint32_t)L.lineno); // 遞增與回跳屬於迴圈標頭
+            if (!parts[2].empty() && !lower_assign(L, parts[2]))
+                fail(L, "bad loop step");
+            selfhost::bcw::jump_to(bc, selfhost::OP_JMP, top);
+            if (jz != SIZE_MAX)
+                selfhost::bcw::patch(bc, jz, bc.size());
+            i = bend;
+            return;
+        }
+        // 當 (條件)：
+        if (match_kw(s, {u8"當", "while"}, rest) && paren_body(rest, inner))
+        {
+            size_t bend = body_end(i, end);
+            size_t top = bc.size();
+            size_t jz = lower_cond_jz(L, inner);
+            size_t j = i + 1;
+            lower_block(j, bend);
+            dbg.mark(bc.size(), (uint32_t)L.lineno);
+            selfhost::bcw::jump_to(bc, selfhost::OP_JMP, top);
+            selfhost::bcw::patch(bc, jz, bc.size());
+            i = bend;
+            return;
+        }
+        // 如果 (條件)： … [否則：…]
+        if (match_kw(s, {u8"如果", "if"}, rest) && paren_body(rest, inner))
+        {
+            size_t bend = body_end(i, end);
+            size_t jz = lower_cond_jz(L, inner);
+            size_t j = i + 1;
+            lower_block(j, bend);
+            i = bend;
+            std::string els = i < end ? lines[i].text : "";
+            strip_block_colon(els);
+            std::string else_rest;
+            if (i < end && lines[i].indent == L.indent &&
+                match_kw(els, {u8"否則", u8"不然", "else"}, else_rest))
             {
-                // 查找 "設為槽位" 關鍵字
-                size_t slot_pos = line.find(u8"設為槽位", var_end);
-                if (slot_pos != std::string::npos)
+                dbg.mark(bc.size(), (uint32_t)lines[i].lineno);
+                size_t jend = selfhost::bcw::jump(bc, selfhost::OP_JMP);
+                selfhost::bcw::patch(bc, jz, bc.size());
+                if (!else_rest.empty())
                 {
-                    // 提取槽位號
-                    size_t num_start = slot_pos + 9; // "設為槽位" 的長度
-                    size_t num_end = line.find_first_not_of("0123456789", num_start);
-                    if (num_end != std::string::npos)
-                    {
-                        std::string num_str = line.substr(num_start, num_end - num_start);
-                        try
-                        {
-                            uint8_t slot_id = (uint8_t)std::stoi(num_str);
-                            u8(bc, 4); // OP_SET_I64_SLOT
-                            u8(bc, get_slot(var));
-                            u8(bc, slot_id);
-                        }
-                        catch (...)
-                        {
-                            // 無效槽位號，跳過
-                            continue;
-                        }
-                    }
+                    // 否則 如果 (…)：鏈
+                    lower_stmt(i, end, else_rest + u8"：");
                 }
+                else
+                {
+                    size_t eend = body_end(i, end);
+                    size_t k = i + 1;
+                    lower_block(k, eend);
+                    i = eend;
+                }
+                selfhost::bcw::patch(bc, jend, bc.size());
             }
             else
+                selfhost::bcw::patch(bc, jz, bc.size());
+            return;
+        }
+        // 函數 [型別] 名(參數)：本體以縮排表示；標頭沒有冒號時本體直到「函數結束」（zhcc 的寫法）。
+        // 主函數 / main 的本體就是主程式
+        std::string fname;
+        std::vector<std::string> params;
+        ZhFunc sig;
+        bool is_fn = false;
+        try
+        {
+            is_fn = fn_header(s, fname, sig, params);
+        }
+        catch (const std::exception &e)
+        {
+            fail(L, e.what());
+        }
+        if (is_fn)
+        {
+            if (par)
+                fail(L, u8"functions cannot be defined inside 平行迴圈");
+            size_t bend = body_end(i, end), next = bend;
+            if (!block)
             {
-                // 無效變量名，跳過
-                continue;
+                bend = i + 1;
+                while (bend < end && trim_copy(lines[bend].text) != u8"函數結束")
+                    ++bend;
+                if (bend == end)
+                    fail(L, u8"missing 函數結束");
+                next = bend + 1;
+            }
+            if (is_main_name(fname))
+            {
+                size_t j = i + 1;
+                lower_block(j, bend);
             }
+            else
+                lower_function(fname, params, i + 1, bend);
+            i = next;
+            return;
         }
-        // C 風格輸出字串
-        else if (std::regex_search(line, m, re_print_s_c))
+        // 返回 / return：主程式中結束程式；函式中以 OP_RET 回傳，直接回傳另一個函式的結果時改為尾呼叫
+        if (match_kw(s, {u8"返回", u8"回傳", "return"}, rest))
         {
-            std::string str = unescape_c_like(m[1].str());
-            u8(bc, 1); // OP_PRINT_S
-            u64le(bc, str.size());
-            for (char c : str)
-                u8(bc, (unsigned char)c);
+            if (par)
+                fail(L, u8"返回 is not allowed inside 平行迴圈");
+            ++i;
+            if (!cur_fn)
+            {
+                selfhost::bcw::end(bc);
+                return;
+            }
+            if (cur_fn->ret == 'v' && !rest.empty())
+                fail(L, "function has no return value");
+            try
+            {
+                if (rest.empty())
+                    selfhost::bcw::ret(bc, lw.konst(0));
+                else if (!lw.eval_tail(rest, cur_fn->ret))
+                {
+                    uint32_t r = lw.eval(rest);
+                    selfhost::bcw::ret(bc, cur_fn->ret == 'f' ? lw.to_float(r) : lw.to_int(r));
+                }
+            }
+            catch (const std::exception &e)
+            {
+                fail(L, e.what());
+            }
+            return;
         }
-        // C 風格 int 賦值
-        else if (std::regex_search(line, m, re_int_assign))
+        // 其他以冒號結尾的標頭（例：「使用 標準輸出：」）只是分組，直接展開內容
+        if (block)
         {
-            std::string var = m[1].str();
-            int64_t val = std::stoll(m[2].str());
-            u8(bc, 3); // OP_SET_I64
-            u8(bc, get_slot(var));
-            i64le(bc, val);
+            size_t bend = body_end(i, end);
+            size_t j = i + 1;
+            lower_block(j, bend);
+            i = bend;
+            return;
         }
-        // C 風格 puts
-        else if (std::regex_search(line, m, re_puts))
+        ++i;
+        // 輸出字串("…") / 輸出整數(運算式)
+        std::smatch mm;
+        if (std::regex_match(s, mm, re_print_str))
         {
-            std::string str = unescape_c_like(m[1].str());
-            u8(bc, 1); // OP_PRINT_S
-            u64le(bc, str.size());
-            for (char c : str)
-                u8(bc, (unsigned char)c);
+            lw.effect();
+            selfhost::bcw::print(bc, pool, unescape_c_like(mm[1].str()));
+            return;
         }
-        // C 風格 printf %d
-        else if (std::regex_search(line, m, re_printf_d))
+        if (std::regex_match(s, mm, re_print_int))
         {
-            std::string var = m[1].str();
-            u8(bc, 2); // OP_PRINT_I
-            u8(bc, get_slot(var));
+            std::string e = mm[1].matched ? mm[1].str() : mm[2].str();
+            lw.effect();
+            try
+            {
+                selfhost::bcw::print_int(bc, lw.to_int(lw.eval(e)));
+            }
+            catch (const std::exception &ex)
+            {
+                fail(L, ex.what());
+            }
+            return;
         }
-        // 忽略註釋和無法識別的行
-    }
+        if (std::regex_match(s, mm, re_print_f64))
+        {
+            std::string e = mm[1].matched ? mm[1].str() : mm[2].str();
+            lw.effect();
+            try
+            {
+                selfhost::bcw::print_f64(bc, lw.to_float(lw.eval(e)));
+            }
+            catch (const std::exception &ex)
+            {
+                fail(L, ex.what());
+            }
+            return;
+        }
+        // 陣列加(c, a, b) 等批次運算、印出("…") 等原生函式單獨成一條語句
+        if (std::regex_match(s, mm, re_call_stmt) &&
+            (ZhLowering::call_stmt(mm[1].str()) || lw.is_function(mm[1].str())))
+        {
+            try
+            {
+                lw.eval_stmt(s);
+            }
+            catch (const std::exception &ex)
+            {
+                fail(L, ex.what());
+            }
+            return;
+        }
+        if (lower_assign(L, s))
+            return;
+        lower_simple(L.text);
+    };
+
+    lower_block = [&](size_t &i, size_t end)
+    {
+        while (i < end)
+        {
+            size_t at = i, ncalls = lw.calls().size();
+            unsigned fx = lw.effects();
+            lower_stmt(i, end, lines[at].text);
+            if (!par)
+                continue;
+            if (lw.effects() != fx)
+                fail(lines[at], u8"平行迴圈 cannot print, allocate arrays or call runtime functions");
+            for (size_t k = ncalls; k < lw.calls().size(); k++)
+                par_calls.emplace_back(at, lw.calls()[k].second);
+        }
+    };
+
+    size_t i = 0;
+    lower_block(i, lines.size());
 
     // 結束標記
-    u8(bc, 0);
+    dbg.mark(bc.size(), 0);
+    selfhost::bcw::end(bc);
+
+    // 常數設定放在最前面；跳躍位移皆為相對值，不受影響
+    bc.insert(bc.begin(), lw.prologue().begin(), lw.prologue().end());
+    dbg.shift(lw.prologue().size());
+    for (auto &c : lw.calls())
+        c.first += lw.prologue().size();
+
+    // 函式本體接在後面，再填入各呼叫的 frame 與目標；標頭 frame 取所有窗口的最大值
+    frame = std::max(frame, (uint32_t)slot.size());
+    std::vector<std::pair<size_t, std::string>> calls = lw.calls();
+    std::map<std::string, std::pair<size_t, uint32_t>> entry; // 名稱 -> 本體起點、frame
+    for (auto &b : bodies)
+    {
+        size_t base = bc.size();
+        for (auto &r : b.rows)
+            dbg.mark(base + r.off, r.line);
+        for (auto &c : b.calls)
+            calls.emplace_back(base + c.first, c.second);
+        bc.insert(bc.end(), b.code.begin(), b.code.end());
+        entry[b.name] = {base, b.frame};
+        frame = std::max(frame, b.frame);
+    }
+    for (auto &c : calls)
+        selfhost::bcw::patch_call(bc, c.first, entry.at(c.second).second, entry.at(c.second).first);
+
+    // 平行迴圈呼叫的函式（含間接呼叫）不能有副作用
+    std::set<std::string> impure;
+    for (auto &b : bodies)
+        if (!b.pure)
+            impure.insert(b.name);
+    for (bool grew = true; grew;)
+    {
+        grew = false;
+        for (auto &b : bodies)
+            for (auto &c : b.calls)
+                if (!impure.count(b.name) && impure.count(c.second))
+                    grew = impure.insert(b.name).second;
+    }
+    for (auto &c : par_calls)
+        if (impure.count(c.second))
+            fail(lines[c.first], "function '" + c.second +
+                                     u8"' prints, allocates arrays or calls runtime functions and cannot be called inside 平行迴圈");
+    selfhost::bcw::finish(bc, frame, pool, &dbg, lw.uses_native() ? selfhost::NATIVE_VERSION : 0);
     return bc;
 }
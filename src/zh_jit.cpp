@@ -0,0 +1,525 @@
+// zh_jit.cpp — selfhost 位元碼 x86-64 樣板 JIT
+#include "../include/zh_jit.h"
+#include <cstring>
+#include <vector>
+#include <algorithm>
+#include <utility>
+#if ZHVM_JIT
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+#endif
+
+namespace selfhost
+{
+    JitCode::~JitCode() { release(); }
+
+    JitCode::JitCode(JitCode &&o) noexcept { *this = std::move(o); }
+
+    JitCode &JitCode::operator=(JitCode &&o) noexcept
+    {
+        if (this != &o)
+        {
+            release();
+            mem_ = o.mem_;
+            map_size_ = o.map_size_;
+            size_ = o.size_;
+            entry_ = o.entry_;
+            o.mem_ = nullptr;
+            o.map_size_ = o.size_ = 0;
+            o.entry_ = nullptr;
+        }
+        return *this;
+    }
+
+    void JitCode::release()
+    {
+#if ZHVM_JIT
+        if (mem_)
+        {
+#ifdef _WIN32
+            VirtualFree(mem_, 0, MEM_RELEASE);
+#else
+            munmap(mem_, map_size_);
+#endif
+        }
+#endif
+        mem_ = nullptr;
+        map_size_ = size_ = 0;
+        entry_ = nullptr;
+    }
+
+    void JitCode::run(int64_t *vars, OutputSink &out) const
+    {
+        if (entry_)
+            entry_(vars, &out);
+        out.flush(); // PRINT 以 line_ref 引用位元碼內的字串，返回前送出
+    }
+
+    bool jit_available() { return ZHVM_JIT != 0; }
+
+#if !ZHVM_JIT
+    bool jit_compile(const Program &, JitCode &, std::string *why)
+    {
+        if (why)
+            *why = "unsupported platform";
+        return false;
+    }
+#else
+    namespace
+    {
+        enum Reg : unsigned
+        {
+            RAX = 0, RCX = 1, RDX = 2, RBX = 3, RSP = 4, RBP = 5, RSI = 6, RDI = 7,
+            R8 = 8, R9 = 9, R10 = 10, R11 = 11, R12 = 12, R13 = 13, R14 = 14, R15 = 15,
+        };
+
+        // 呼叫慣例：rbx = vars 基底，rbp = OutputSink*，r12..r15 = 常駐槽位
+#ifdef _WIN32
+        const unsigned ARG0 = RCX, ARG1 = RDX, ARG2 = R8;
+        const int32_t FRAME = 40; // 32 bytes shadow space + 對齊
+#else
+        const unsigned ARG0 = RDI, ARG1 = RSI, ARG2 = RDX;
+        const int32_t FRAME = 8; // 六次 push 後補齊 16 bytes 對齊
+#endif
+        const unsigned HOT_REGS[] = {R12, R13, R14, R15};
+        const size_t NHOT = sizeof(HOT_REGS) / sizeof(HOT_REGS[0]);
+
+        // 供機器碼呼叫的 C++ 進入點
+        void jit_line(OutputSink *o, const char *s, size_t n) { o->line_ref(s, n); }
+        void jit_int_line(OutputSink *o, int64_t v) { o->int_line(v); }
+
+        struct Asm
+        {
+            std::vector<uint8_t> b;
+
+            void u8(unsigned v) { b.push_back((uint8_t)v); }
+            void u32(uint32_t v)
+            {
+                for (int i = 0; i < 4; i++)
+                    u8((v >> (8 * i)) & 0xFF);
+            }
+            void u64(uint64_t v)
+            {
+                for (int i = 0; i < 8; i++)
+                    u8((unsigned)((v >> (8 * i)) & 0xFF));
+            }
+            void rex_w(unsigned reg, unsigned rm) { u8(0x48 | ((reg >> 3) & 1) << 2 | ((rm >> 3) & 1)); }
+
+            // opc r/m64(rm), r64(reg)，暫存器直接定址
+            void rr(unsigned opc, unsigned reg, unsigned rm)
+            {
+                rex_w(reg, rm);
+                u8(opc);
+                u8(0xC0 | (reg & 7) << 3 | (rm & 7));
+            }
+            // opc reg, [rbx + slot*8]
+            void rm_slot(unsigned opc, unsigned reg, uint32_t slot)
+            {
+                rex_w(reg, RBX);
+                u8(opc);
+                u8(0x80 | (reg & 7) << 3 | RBX);
+                u32(slot * 8);
+            }
+            void mov_rr(unsigned dst, unsigned src)
+            {
+                if (dst != src)
+                    rr(0x89, src, dst);
+            }
+            void mov_imm(unsigned dst, int64_t v)
+            {
+                if (v >= INT32_MIN && v <= INT32_MAX)
+                {
+                    rex_w(0, dst); // mov r/m64, imm32（符號延伸）
+                    u8(0xC7);
+                    u8(0xC0 | (dst & 7));
+                    u32((uint32_t)(int32_t)v);
+                }
+                else
+                {
+                    u8(0x48 | ((dst >> 3) & 1)); // movabs
+                    u8(0xB8 + (dst & 7));
+                    u64((uint64_t)v);
+                }
+            }
+            void push(unsigned r)
+            {
+                if (r >= 8)
+                    u8(0x41);
+                u8(0x50 + (r & 7));
+            }
+            void pop(unsigned r)
+            {
+                if (r >= 8)
+                    u8(0x41);
+                u8(0x58 + (r & 7));
+            }
+            void call_abs(const void *fn)
+            {
+                mov_imm(RAX, (int64_t)(uintptr_t)fn);
+                u8(0xFF); // call rax
+                u8(0xD0);
+            }
+            // 32 位元相對跳躍，回傳位移欄位位置
+            size_t jmp32()
+            {
+                u8(0xE9);
+                size_t at = b.size();
+                u32(0);
+                return at;
+            }
+            size_t jcc32(unsigned cc)
+            {
+                u8(0x0F);
+                u8(cc);
+                size_t at = b.size();
+                u32(0);
+                return at;
+            }
+            size_t jcc8(unsigned op)
+            {
+                u8(op);
+                u8(0);
+                return b.size() - 1;
+            }
+            void bind8(size_t at) { b[at] = (uint8_t)(b.size() - (at + 1)); }
+            void patch32(size_t at, size_t target)
+            {
+                int32_t rel = (int32_t)((int64_t)target - (int64_t)(at + 4));
+                std::memcpy(&b[at], &rel, 4);
+            }
+        };
+
+        // 迴圈內的槽位加權計分，取前 NHOT 名常駐暫存器
+        void pick_hot_slots(const Program &prog, std::vector<int> &hot)
+        {
+            const auto &code = prog.code;
+            std::vector<uint32_t> depth(code.size() + 1, 0);
+            for (size_t i = 0; i < code.size(); i++)
+            {
+                const Insn &in = code[i];
+                if ((in.op == OP_JMP || in.op == OP_JZ || in.op == OP_JNZ) && in.c <= i)
+                    for (size_t k = in.c; k <= i; k++)
+                        depth[k]++;
+            }
+            const size_t nslots = prog.frame;
+            std::vector<uint64_t> score(nslots, 0);
+            for (size_t i = 0; i < code.size(); i++)
+            {
+                const Insn &in = code[i];
+                uint64_t w = (uint64_t)1 << (std::min<uint32_t>(depth[i], 8) * 3);
+                switch (in.op)
+                {
+                case OP_PRINT_INT:
+                case OP_SET_I64:
+                case OP_JZ:
+                case OP_JNZ:
+                    score[in.a] += w;
+                    break;
+                case OP_COPY_I64:
+                    score[in.a] += w;
+                    score[in.b] += w;
+                    break;
+                case OP_ADD:
+                case OP_SUB:
+                case OP_MUL:
+                case OP_DIV:
+                case OP_MOD:
+                case OP_EQ:
+                case OP_NE:
+                case OP_LT:
+                case OP_LE:
+                case OP_GT:
+                case OP_GE:
+                    score[in.a] += w;
+                    score[in.b] += w;
+                    score[in.c] += w;
+                    break;
+                default:
+                    break;
+                }
+            }
+            hot.assign(nslots, -1);
+            for (size_t r = 0; r < NHOT; r++)
+            {
+                size_t best = nslots;
+                for (size_t s = 0; s < nslots; s++)
+                    if (score[s] && hot[s] < 0 && (best == nslots || score[s] > score[best]))
+                        best = s;
+                if (best == nslots)
+                    break;
+                hot[best] = (int)HOT_REGS[r];
+            }
+        }
+
+        struct Gen
+        {
+            Asm a;
+            std::vector<int> hot; // 槽位 -> 常駐暫存器（-1 表示留在記憶體）
+
+            // 取得槽位值所在暫存器；非常駐者先載入 scratch
+            unsigned load(uint32_t slot, unsigned scratch)
+            {
+                if (hot[slot] >= 0)
+                    return (unsigned)hot[slot];
+                a.rm_slot(0x8B, scratch, slot);
+                return scratch;
+            }
+            void load_into(uint32_t slot, unsigned dst) { a.mov_rr(dst, load(slot, dst)); }
+            void store(uint32_t slot, unsigned src)
+            {
+                if (hot[slot] >= 0)
+                    a.mov_rr((unsigned)hot[slot], src);
+                else
+                    a.rm_slot(0x89, src, slot);
+            }
+
+            void divmod(const Insn &in, bool mod)
+            {
+                load_into(in.b, RAX);
+                load_into(in.c, RCX);
+                a.rr(0x85, RCX, RCX); // test rcx, rcx
+                size_t to_zero = a.jcc8(0x74);
+                a.rex_w(0, RCX); // cmp rcx, -1
+                a.u8(0x83);
+                a.u8(0xF9);
+                a.u8(0xFF);
+                size_t to_neg = a.jcc8(0x74);
+                a.u8(0x48); // cqo
+                a.u8(0x99);
+                a.rr(0xF7, 7, RCX); // idiv rcx
+                if (mod)
+                    a.mov_rr(RAX, RDX);
+                size_t done1 = a.jcc8(0xEB);
+                a.bind8(to_neg);
+                if (mod)
+                {
+                    a.u8(0x31); // xor eax, eax
+                    a.u8(0xC0);
+                }
+                else
+                    a.rr(0xF7, 3, RAX); // neg rax（INT64_MIN 環繞）
+                size_t done2 = a.jcc8(0xEB);
+                a.bind8(to_zero);
+                a.u8(0x31);
+                a.u8(0xC0);
+                a.bind8(done1);
+                a.bind8(done2);
+                store(in.a, RAX);
+            }
+        };
+
+        unsigned setcc_of(unsigned op)
+        {
+            switch (op)
+            {
+            case OP_EQ: return 0x94;
+            case OP_NE: return 0x95;
+            case OP_LT: return 0x9C;
+            case OP_LE: return 0x9E;
+            case OP_GT: return 0x9F;
+            default: return 0x9D; // OP_GE
+            }
+        }
+    }
+
+    bool jit_compile(const Program &prog, JitCode &out, std::string *why)
+    {
+        const auto &code = prog.code;
+        Gen g;
+        pick_hot_slots(prog, g.hot);
+        Asm &a = g.a;
+
+        // prologue
+        static const unsigned SAVED[] = {RBX, RBP, R12, R13, R14, R15};
+        for (unsigned r : SAVED)
+            a.push(r);
+        a.rex_w(0, RSP); // sub rsp, FRAME
+        a.u8(0x83);
+        a.u8(0xEC);
+        a.u8((unsigned)FRAME);
+        a.mov_rr(RBX, ARG0);
+        a.mov_rr(RBP, ARG1);
+        for (size_t s = 0; s < g.hot.size(); s++)
+            if (g.hot[s] >= 0)
+                a.rm_slot(0x8B, (unsigned)g.hot[s], (uint32_t)s);
+
+        std::vector<size_t> at_insn(code.size());
+        std::vector<std::pair<size_t, uint32_t>> fixups; // (rel32 位置, 目標指令索引)
+        std::vector<size_t> to_exit;
+        for (size_t i = 0; i < code.size(); i++)
+        {
+            const Insn &in = code[i];
+            at_insn[i] = a.b.size();
+            switch (in.op)
+            {
+            case OP_PRINT:
+                a.mov_rr(ARG0, RBP);
+                a.mov_imm(ARG1, (int64_t)(uintptr_t)in.s);
+                a.mov_imm(ARG2, (int64_t)in.b);
+                a.call_abs((const void *)&jit_line);
+                break;
+            case OP_PRINT_INT:
+                g.load_into(in.a, ARG1);
+                a.mov_rr(ARG0, RBP);
+                a.call_abs((const void *)&jit_int_line);
+                break;
+            case OP_SET_I64:
+                if (g.hot[in.a] >= 0)
+                    a.mov_imm((unsigned)g.hot[in.a], in.imm);
+                else
+                {
+                    a.mov_imm(RAX, in.imm);
+                    g.store(in.a, RAX);
+                }
+                break;
+            case OP_COPY_I64:
+                g.store(in.a, g.load(in.b, RAX));
+                break;
+            case OP_ADD:
+            case OP_SUB:
+            case OP_MUL:
+            {
+                g.load_into(in.b, RAX);
+                unsigned rb = g.load(in.c, RCX);
+                if (in.op == OP_ADD)
+                    a.rr(0x01, rb, RAX);
+                else if (in.op == OP_SUB)
+                    a.rr(0x29, rb, RAX);
+                else
+                {
+                    a.rex_w(RAX, rb); // imul rax, rb
+                    a.u8(0x0F);
+                    a.u8(0xAF);
+                    a.u8(0xC0 | (rb & 7));
+                }
+                g.store(in.a, RAX);
+                break;
+            }
+            case OP_DIV:
+            case OP_MOD:
+                g.divmod(in, in.op == OP_MOD);
+                break;
+            case OP_EQ:
+            case OP_NE:
+            case OP_LT:
+            case OP_LE:
+            case OP_GT:
+            case OP_GE:
+            {
+                unsigned ra = g.load(in.b, RAX);
+                unsigned rb = g.load(in.c, RCX);
+                a.rr(0x39, rb, ra); // cmp ra, rb
+                a.u8(0x0F);         // setcc al
+                a.u8(setcc_of(in.op));
+                a.u8(0xC0);
+                a.u8(0x0F); // movzx eax, al
+                a.u8(0xB6);
+                a.u8(0xC0);
+                g.store(in.a, RAX);
+                break;
+            }
+            case OP_JMP:
+                fixups.push_back({a.jmp32(), in.c});
+                break;
+            case OP_JZ:
+            case OP_JNZ:
+                if (g.hot[in.a] >= 0)
+                    a.rr(0x85, (unsigned)g.hot[in.a], (unsigned)g.hot[in.a]); // test r, r
+                else
+                {
+                    a.rex_w(0, RBX); // cmp qword [rbx + disp32], 0
+                    a.u8(0x83);
+                    a.u8(0xBB);
+                    a.u32(in.a * 8);
+                    a.u8(0);
+                }
+                fixups.push_back({a.jcc32(in.op == OP_JZ ? 0x84 : 0x85), in.c});
+                break;
+            case OP_END:
+                to_exit.push_back(a.jmp32());
+                break;
+            default: // 尚無樣板的操作碼：整段交回直譯器
+                if (why)
+                    *why = std::string("unsupported opcode ") + (op_name((uint8_t)in.op) ? op_name((uint8_t)in.op) : "?");
+                return false;
+            }
+        }
+
+        // epilogue：常駐槽位寫回 vars
+        size_t exit_at = a.b.size();
+        for (size_t s = 0; s < g.hot.size(); s++)
+            if (g.hot[s] >= 0)
+                a.rm_slot(0x89, (unsigned)g.hot[s], (uint32_t)s);
+        a.rex_w(0, RSP); // add rsp, FRAME
+        a.u8(0x83);
+        a.u8(0xC4);
+        a.u8((unsigned)FRAME);
+        for (size_t k = sizeof(SAVED) / sizeof(SAVED[0]); k-- > 0;)
+            a.pop(SAVED[k]);
+        a.u8(0xC3); // ret
+
+        for (auto &f : fixups)
+            a.patch32(f.first, at_insn[f.second]);
+        for (size_t at : to_exit)
+            a.patch32(at, exit_at);
+
+        // 先以 RW 寫入，再改成 RX（W^X）
+        size_t n = a.b.size();
+#ifdef _WIN32
+        SYSTEM_INFO si;
+        GetSystemInfo(&si);
+        size_t page = si.dwPageSize;
+#else
+        size_t page = (size_t)sysconf(_SC_PAGESIZE);
+#endif
+        size_t map_size = (n + page - 1) / page * page;
+#ifdef _WIN32
+        void *mem = VirtualAlloc(nullptr, map_size, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+        if (!mem)
+        {
+            if (why)
+                *why = "VirtualAlloc failed";
+            return false;
+        }
+        std::memcpy(mem, a.b.data(), n);
+        DWORD old = 0;
+        if (!VirtualProtect(mem, map_size, PAGE_EXECUTE_READ, &old))
+        {
+            VirtualFree(mem, 0, MEM_RELEASE);
+            if (why)
+                *why = "VirtualProtect failed";
+            return false;
+        }
+        FlushInstructionCache(GetCurrentProcess(), mem, n);
+#else
+        void *mem = mmap(nullptr, map_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (mem == MAP_FAILED)
+        {
+            if (why)
+                *why = "mmap failed";
+            return false;
+        }
+        std::memcpy(mem, a.b.data(), n);
+        if (mprotect(mem, map_size, PROT_READ | PROT_EXEC) != 0)
+        {
+            munmap(mem, map_size);
+            if (why)
+                *why = "mprotect(PROT_EXEC) failed";
+            return false;
+        }
+#endif
+        out.release();
+        out.mem_ = mem;
+        out.map_size_ = map_size;
+        out.size_ = n;
+        out.entry_ = (void (*)(int64_t *, OutputSink *))mem;
+        return true;
+    }
+#endif
+}
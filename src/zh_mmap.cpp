@@ -0,0 +1,120 @@
+// zh_mmap.cpp — 唯讀檔案對映
+#include "../include/zh_mmap.h"
+#include <fstream>
+#include <iterator>
+#include <utility>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace selfhost
+{
+    MappedFile::~MappedFile() { close(); }
+
+    MappedFile::MappedFile(MappedFile &&o) noexcept { *this = std::move(o); }
+
+    MappedFile &MappedFile::operator=(MappedFile &&o) noexcept
+    {
+        if (this != &o)
+        {
+            close();
+            own_.swap(o.own_);
+            std::swap(data_, o.data_);
+            std::swap(size_, o.size_);
+            std::swap(view_, o.view_);
+        }
+        return *this;
+    }
+
+    void MappedFile::close()
+    {
+        if (view_)
+        {
+#ifdef _WIN32
+            UnmapViewOfFile(view_);
+#else
+            munmap(view_, size_);
+#endif
+        }
+        view_ = nullptr;
+        data_ = nullptr;
+        size_ = 0;
+        std::vector<uint8_t>().swap(own_);
+    }
+
+    // 建立對映；對映建立後檔案代碼即可關閉
+    static void *map_file(const std::filesystem::path &p, size_t &n)
+    {
+#ifdef _WIN32
+        // 允許其他行程同時讀寫 / 刪除，打包的執行檔執行中也能被覆寫或取代
+        HANDLE f = CreateFileW(p.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+                               OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (f == INVALID_HANDLE_VALUE)
+            return nullptr;
+        LARGE_INTEGER sz;
+        void *v = nullptr;
+        if (GetFileSizeEx(f, &sz) && sz.QuadPart > 0 && (uint64_t)sz.QuadPart <= (size_t)-1)
+        {
+            HANDLE m = CreateFileMappingW(f, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (m)
+            {
+                v = MapViewOfFile(m, FILE_MAP_READ, 0, 0, 0);
+                CloseHandle(m);
+                n = (size_t)sz.QuadPart;
+            }
+        }
+        CloseHandle(f);
+        return v;
+#else
+        int fd = ::open(p.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+            return nullptr;
+        struct stat st;
+        void *v = nullptr;
+        if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0 && (uint64_t)st.st_size <= (size_t)-1)
+        {
+            v = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (v == MAP_FAILED)
+                v = nullptr;
+            else
+                n = (size_t)st.st_size;
+        }
+        ::close(fd);
+        return v;
+#endif
+    }
+
+    bool MappedFile::open(const std::filesystem::path &p)
+    {
+        close();
+        size_t n = 0;
+        if (void *v = map_file(p, n))
+        {
+            view_ = v;
+            data_ = (const uint8_t *)v;
+            size_ = n;
+            return true;
+        }
+        std::ifstream f(p, std::ios::binary);
+        if (!f)
+            return false;
+        own_.assign(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+        if (f.bad())
+        {
+            own_.clear();
+            return false;
+        }
+        // 空檔案也視為成功，data() 仍不為 nullptr
+        static const uint8_t empty = 0;
+        data_ = own_.empty() ? &empty : own_.data();
+        size_ = own_.size();
+        return true;
+    }
+}
@@ -0,0 +1,198 @@
+// zh_native.cpp — OP_CALL_NATIVE 的函式表：直接呼叫 chinese.h 的執行期函式
+#include "../include/zh_native.h"
+#include "../include/zh_vm.h"
+#include "../include/chinese.h"
+#include <cstring>
+#include <vector>
+
+namespace selfhost
+{
+    std::string native_format(const char *fmt, size_t n, std::string &types)
+    {
+        std::string out;
+        types.clear();
+        size_t i = 0;
+        while (i < n)
+        {
+            if (fmt[i] != '%')
+            {
+                out += fmt[i++];
+                continue;
+            }
+            if (i + 1 < n && fmt[i + 1] == '%')
+            {
+                out += "%%";
+                i += 2;
+                continue;
+            }
+            // %[旗標][寬度][.精度][長度]轉換
+            size_t j = i + 1;
+            while (j < n && std::strchr("-+ #0", fmt[j]))
+                j++;
+            while (j < n && fmt[j] >= '0' && fmt[j] <= '9')
+                j++;
+            if (j < n && fmt[j] == '.')
+            {
+                j++;
+                while (j < n && fmt[j] >= '0' && fmt[j] <= '9')
+                    j++;
+            }
+            size_t spec_end = j; // 長度修飾一律捨棄，依轉換重新決定
+            while (j < n && std::strchr("hlLjztq", fmt[j]))
+                j++;
+            char conv = j < n ? fmt[j] : '\0';
+            if (conv && std::strchr("diouxX", conv))
+            {
+                out.append(fmt + i, spec_end - i).append("ll").push_back(conv);
+                types += 'i';
+            }
+            else if (conv == 'c')
+            {
+                out.append(fmt + i, spec_end - i).push_back('c');
+                types += 'c';
+            }
+            else if (conv && std::strchr("fFeEgGaA", conv))
+            {
+                out.append(fmt + i, spec_end - i).push_back(conv);
+                types += 'f';
+            }
+            else
+            {
+                // 不支援的轉換：到此為止的文字原樣輸出
+                out += "%%";
+                i++;
+                continue;
+            }
+            i = j + 1;
+        }
+        return out;
+    }
+
+    static int64_t nf_rand(const NativeArgs &) { return 隨機數(); }
+    static int64_t nf_time(const NativeArgs &) { return (int64_t)當前秒(); }
+    static int64_t nf_srand(const NativeArgs &a)
+    {
+        設隨機種子((unsigned)a.v[0]);
+        return 0;
+    }
+    static int64_t nf_srand_time(const NativeArgs &)
+    {
+        用時間當種子();
+        return 0;
+    }
+    // 讀取前先送出緩衝中的提示文字。chinese.h 的 輸入整數 讀失敗時值未定義，這裡改讀 64 位元並在失敗時回傳 0
+    static int64_t nf_read_int(const NativeArgs &a)
+    {
+        a.out.flush();
+        long long v = 0;
+        if (std::scanf("%lld", &v) != 1)
+            return 0;
+        return (int64_t)v;
+    }
+    static int64_t nf_read_f64(const NativeArgs &a)
+    {
+        a.out.flush();
+        return f64_bits(輸入小數());
+    }
+
+    // 輸出格式：每個轉換各自 snprintf，缺少的參數以 0 代入
+    static int64_t nf_printf(const NativeArgs &a)
+    {
+        std::string types;
+        std::string f = native_format(a.s, a.len, types);
+        std::vector<char> tmp(64);
+        size_t arg = 0, lit = 0, i = 0;
+        while (i < f.size())
+        {
+            if (f[i] != '%')
+            {
+                i++;
+                continue;
+            }
+            a.out.write(f.data() + lit, i - lit);
+            if (f[i + 1] == '%')
+            {
+                a.out.write("%", 1);
+                i += 2;
+                lit = i;
+                continue;
+            }
+            size_t j = i + 1;
+            while (!std::strchr("diouxXcfFeEgGaA", f[j]))
+                j++;
+            std::string spec = f.substr(i, j + 1 - i);
+            char t = types[arg];
+            int64_t v = arg < a.n ? a.v[arg] : 0;
+            arg++;
+            for (;;)
+            {
+                int m = t == 'f'   ? std::snprintf(tmp.data(), tmp.size(), spec.c_str(), as_f64(v))
+                        : t == 'c' ? std::snprintf(tmp.data(), tmp.size(), spec.c_str(), (int)v)
+                                   : std::snprintf(tmp.data(), tmp.size(), spec.c_str(), (long long)v);
+                if (m < 0)
+                    break;
+                if ((size_t)m < tmp.size())
+                {
+                    a.out.write(tmp.data(), (size_t)m);
+                    break;
+                }
+                tmp.resize((size_t)m + 1);
+            }
+            i = j + 1;
+            lit = i;
+        }
+        a.out.write(f.data() + lit, f.size() - lit);
+        return 0;
+    }
+    static int64_t nf_write(const NativeArgs &a)
+    {
+        a.out.write(a.s, a.len);
+        return 0;
+    }
+    static int64_t nf_print_u64(const NativeArgs &a)
+    {
+        char tmp[24];
+        int m = std::snprintf(tmp, sizeof(tmp), "%llu", (unsigned long long)a.v[0]); // 同 輸出無號
+        a.out.line(tmp, m > 0 ? (size_t)m : 0);
+        return 0;
+    }
+    static int64_t nf_print_bool(const NativeArgs &a)
+    {
+        const char *s = a.v[0] ? u8"真" : u8"假"; // 同 輸出布林
+        a.out.line(s, std::strlen(s));
+        return 0;
+    }
+
+    // 數學巨集（次冪 … 四捨五入）；參數與回傳值為 f64 位元樣式
+#define ZH_NATIVE_F1(name, fn) \
+    static int64_t name(const NativeArgs &a) { return f64_bits(fn(as_f64(a.v[0]))); }
+#define ZH_NATIVE_F2(name, fn) \
+    static int64_t name(const NativeArgs &a) { return f64_bits(fn(as_f64(a.v[0]), as_f64(a.v[1]))); }
+    ZH_NATIVE_F2(nf_pow, 次冪)
+    ZH_NATIVE_F1(nf_sqrt, 平方根)
+    ZH_NATIVE_F1(nf_cbrt, 立方根)
+    ZH_NATIVE_F1(nf_sin, 正弦)
+    ZH_NATIVE_F1(nf_cos, 餘弦)
+    ZH_NATIVE_F1(nf_tan, 正切)
+    ZH_NATIVE_F1(nf_asin, 反正弦)
+    ZH_NATIVE_F1(nf_acos, 反餘弦)
+    ZH_NATIVE_F1(nf_atan, 反正切)
+    ZH_NATIVE_F2(nf_atan2, 雙變量反正切)
+    ZH_NATIVE_F1(nf_fabs, 絕對值)
+    ZH_NATIVE_F1(nf_floor, 向下取整)
+    ZH_NATIVE_F1(nf_ceil, 向上取整)
+    ZH_NATIVE_F1(nf_round, 四捨五入)
+#undef ZH_NATIVE_F1
+#undef ZH_NATIVE_F2
+
+    const NativeFn *native_table()
+    {
+        // 順序必須與 NativeId 一致
+        static const NativeFn table[NF_COUNT] = {
+            nf_rand,      nf_time,       nf_srand,  nf_srand_time, nf_read_int, nf_read_f64, nf_printf, nf_write,
+            nf_print_u64, nf_print_bool, nf_pow,    nf_sqrt,       nf_cbrt,     nf_sin,      nf_cos,    nf_tan,
+            nf_asin,      nf_acos,       nf_atan,   nf_atan2,      nf_fabs,     nf_floor,    nf_ceil,   nf_round,
+        };
+        return table;
+    }
+}
@@ -0,0 +1,691 @@
+// zh_simd.cpp — OP_VEC 的 SSE2 / AVX2 / 純量核心與執行期選擇
+#include "../include/zh_simd.h"
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#if defined(__x86_64__) || defined(_M_X64)
+#define ZHSIMD_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define ZHSIMD_TARGET(x) // MSVC 不需標記即可使用 AVX2 intrinsic
+#else
+#include <cpuid.h>
+#define ZHSIMD_TARGET(x) __attribute__((target(x)))
+#endif
+#else
+#define ZHSIMD_X86 0
+#endif
+// 內積先乘後加；不允許編譯器自行合併成 FMA（-march 帶 fma 時），否則純量與向量版本結果不同
+#if defined(__clang__)
+#pragma STDC FP_CONTRACT OFF
+#elif defined(__GNUC__)
+#pragma GCC optimize("fp-contract=off")
+#endif
+
+namespace selfhost
+{
+    namespace simd
+    {
+        // ---- 純量版本（同時是其他版本的行為定義）----
+        namespace scalar
+        {
+            static inline int64_t wadd(int64_t a, int64_t b) { return (int64_t)((uint64_t)a + (uint64_t)b); }
+            static inline int64_t wmul(int64_t a, int64_t b) { return (int64_t)((uint64_t)a * (uint64_t)b); }
+
+            static void add_i64(int64_t *d, const int64_t *a, const int64_t *b, size_t n)
+            {
+                for (size_t i = 0; i < n; i++)
+                    d[i] = wadd(a[i], b[i]);
+            }
+            static void mul_i64(int64_t *d, const int64_t *a, const int64_t *b, size_t n)
+            {
+                for (size_t i = 0; i < n; i++)
+                    d[i] = wmul(a[i], b[i]);
+            }
+            static void fma_i64(int64_t *d, const int64_t *a, const int64_t *b, size_t n)
+            {
+                for (size_t i = 0; i < n; i++)
+                    d[i] = wadd(d[i], wmul(a[i], b[i]));
+            }
+            static void scale_i64(int64_t *d, const int64_t *a, int64_t s, size_t n)
+            {
+                for (size_t i = 0; i < n; i++)
+                    d[i] = wmul(a[i], s);
+            }
+            static void add_f64(double *d, const double *a, const double *b, size_t n)
+            {
+                for (size_t i = 0; i < n; i++)
+                    d[i] = a[i] + b[i];
+            }
+            static void mul_f64(double *d, const double *a, const double *b, size_t n)
+            {
+                for (size_t i = 0; i < n; i++)
+                    d[i] = a[i] * b[i];
+            }
+            static void fma_f64(double *d, const double *a, const double *b, size_t n)
+            {
+                for (size_t i = 0; i < n; i++)
+                    d[i] = std::fma(a[i], b[i], d[i]);
+            }
+            static void scale_f64(double *d, const double *a, double s, size_t n)
+            {
+                for (size_t i = 0; i < n; i++)
+                    d[i] = a[i] * s;
+            }
+            static int64_t sum_i64(const int64_t *a, size_t n)
+            {
+                int64_t s = 0;
+                for (size_t i = 0; i < n; i++)
+                    s = wadd(s, a[i]);
+                return s;
+            }
+            static int64_t dot_i64(const int64_t *a, const int64_t *b, size_t n)
+            {
+                int64_t s = 0;
+                for (size_t i = 0; i < n; i++)
+                    s = wadd(s, wmul(a[i], b[i]));
+                return s;
+            }
+            static int64_t min_i64(const int64_t *a, size_t n)
+            {
+                int64_t m = n ? a[0] : 0;
+                for (size_t i = 1; i < n; i++)
+                    m = a[i] < m ? a[i] : m;
+                return m;
+            }
+            static int64_t max_i64(const int64_t *a, size_t n)
+            {
+                int64_t m = n ? a[0] : 0;
+                for (size_t i = 1; i < n; i++)
+                    m = a[i] > m ? a[i] : m;
+                return m;
+            }
+
+            // 8 條 lane 的合併順序（所有版本共用）
+            static inline double fold_sum(const double *l)
+            {
+                return ((l[0] + l[1]) + (l[2] + l[3])) + ((l[4] + l[5]) + (l[6] + l[7]));
+            }
+            static inline double fmin1(double m, double x) { return x < m ? x : m; }
+            static inline double fmax1(double m, double x) { return x > m ? x : m; }
+            template <double (*F)(double, double)>
+            static inline double fold_minmax(const double *l)
+            {
+                return F(F(F(l[0], l[1]), F(l[2], l[3])), F(F(l[4], l[5]), F(l[6], l[7])));
+            }
+
+            static double sum_f64(const double *a, size_t n)
+            {
+                double l[8] = {};
+                size_t i = 0;
+                for (; i + 8 <= n; i += 8)
+                    for (int k = 0; k < 8; k++)
+                        l[k] += a[i + k];
+                double s = fold_sum(l);
+                for (; i < n; i++)
+                    s += a[i];
+                return s;
+            }
+            static double dot_f64(const double *a, const double *b, size_t n)
+            {
+                double l[8] = {};
+                size_t i = 0;
+                for (; i + 8 <= n; i += 8)
+                    for (int k = 0; k < 8; k++)
+                    {
+                        double p = a[i + k] * b[i + k]; // 先乘後加，不融合
+                        l[k] += p;
+                    }
+                double s = fold_sum(l);
+                for (; i < n; i++)
+                {
+                    double p = a[i] * b[i];
+                    s += p;
+                }
+                return s;
+            }
+            template <double (*F)(double, double)>
+            static double minmax_f64(const double *a, size_t n)
+            {
+                if (n == 0)
+                    return 0.0;
+                size_t i = 0;
+                double m;
+                if (n < 8)
+                {
+                    m = a[0];
+                    i = 1;
+                }
+                else
+                {
+                    double l[8];
+                    std::memcpy(l, a, sizeof l);
+                    for (i = 8; i + 8 <= n; i += 8)
+                        for (int k = 0; k < 8; k++)
+                            l[k] = F(l[k], a[i + k]);
+                    m = fold_minmax<F>(l);
+                }
+                for (; i < n; i++)
+                    m = F(m, a[i]);
+                return m;
+            }
+            static double min_f64(const double *a, size_t n) { return minmax_f64<fmin1>(a, n); }
+            static double max_f64(const double *a, size_t n) { return minmax_f64<fmax1>(a, n); }
+        }
+
+        struct Kernels
+        {
+            void (*add_i64)(int64_t *, const int64_t *, const int64_t *, size_t);
+            void (*mul_i64)(int64_t *, const int64_t *, const int64_t *, size_t);
+            void (*fma_i64)(int64_t *, const int64_t *, const int64_t *, size_t);
+            void (*scale_i64)(int64_t *, const int64_t *, int64_t, size_t);
+            void (*add_f64)(double *, const double *, const double *, size_t);
+            void (*mul_f64)(double *, const double *, const double *, size_t);
+            void (*fma_f64)(double *, const double *, const double *, size_t);
+            void (*scale_f64)(double *, const double *, double, size_t);
+            int64_t (*sum_i64)(const int64_t *, size_t);
+            int64_t (*dot_i64)(const int64_t *, const int64_t *, size_t);
+            int64_t (*min_i64)(const int64_t *, size_t);
+            int64_t (*max_i64)(const int64_t *, size_t);
+            double (*sum_f64)(const double *, size_t);
+            double (*dot_f64)(const double *, const double *, size_t);
+            double (*min_f64)(const double *, size_t);
+            double (*max_f64)(const double *, size_t);
+        };
+
+        static const Kernels scalar_kernels = {
+            scalar::add_i64, scalar::mul_i64, scalar::fma_i64, scalar::scale_i64,
+            scalar::add_f64, scalar::mul_f64, scalar::fma_f64, scalar::scale_f64,
+            scalar::sum_i64, scalar::dot_i64, scalar::min_i64, scalar::max_i64,
+            scalar::sum_f64, scalar::dot_f64, scalar::min_f64, scalar::max_f64,
+        };
+
+#if ZHSIMD_X86
+        // ---- SSE2（x86-64 基準指令集）----
+        namespace sse2
+        {
+            // 64 位元乘法取低位：lo*lo + ((lo*hi + hi*lo) << 32)
+            static inline __m128i mullo(__m128i a, __m128i b)
+            {
+                __m128i ll = _mm_mul_epu32(a, b);
+                __m128i lh = _mm_mul_epu32(a, _mm_srli_epi64(b, 32));
+                __m128i hl = _mm_mul_epu32(_mm_srli_epi64(a, 32), b);
+                return _mm_add_epi64(ll, _mm_slli_epi64(_mm_add_epi64(lh, hl), 32));
+            }
+            static inline __m128i ld(const int64_t *p) { return _mm_loadu_si128((const __m128i *)p); }
+            static inline void st(int64_t *p, __m128i v) { _mm_storeu_si128((__m128i *)p, v); }
+
+            static void add_i64(int64_t *d, const int64_t *a, const int64_t *b, size_t n)
+            {
+                size_t i = 0;
+                for (; i + 2 <= n; i += 2)
+                    st(d + i, _mm_add_epi64(ld(a + i), ld(b + i)));
+                scalar::add_i64(d + i, a + i, b + i, n - i);
+            }
+            static void mul_i64(int64_t *d, const int64_t *a, const int64_t *b, size_t n)
+            {
+                size_t i = 0;
+                for (; i + 2 <= n; i += 2)
+                    st(d + i, mullo(ld(a + i), ld(b + i)));
+                scalar::mul_i64(d + i, a + i, b + i, n - i);
+            }
+            static void fma_i64(int64_t *d, const int64_t *a, const int64_t *b, size_t n)
+            {
+                size_t i = 0;
+                for (; i + 2 <= n; i += 2)
+                    st(d + i, _mm_add_epi64(ld(d + i), mullo(ld(a + i), ld(b + i))));
+                scalar::fma_i64(d + i, a + i, b + i, n - i);
+            }
+            static void scale_i64(int64_t *d, const int64_t *a, int64_t s, size_t n)
+            {
+                const __m128i vs = _mm_set1_epi64x(s);
+                size_t i = 0;
+                for (; i + 2 <= n; i += 2)
+                    st(d + i, mullo(ld(a + i), vs));
+                scalar::scale_i64(d + i, a + i, s, n - i);
+            }
+            static void add_f64(double *d, const double *a, const double *b, size_t n)
+            {
+                size_t i = 0;
+                for (; i + 2 <= n; i += 2)
+                    _mm_storeu_pd(d + i, _mm_add_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+                scalar::add_f64(d + i, a + i, b + i, n - i);
+            }
+            static void mul_f64(double *d, const double *a, const double *b, size_t n)
+            {
+                size_t i = 0;
+                for (; i + 2 <= n; i += 2)
+                    _mm_storeu_pd(d + i, _mm_mul_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+                scalar::mul_f64(d + i, a + i, b + i, n - i);
+            }
+            static void scale_f64(double *d, const double *a, double s, size_t n)
+            {
+                const __m128d vs = _mm_set1_pd(s);
+                size_t i = 0;
+                for (; i + 2 <= n; i += 2)
+                    _mm_storeu_pd(d + i, _mm_mul_pd(_mm_loadu_pd(a + i), vs));
+                scalar::scale_f64(d + i, a + i, s, n - i);
+            }
+            static int64_t sum_i64(const int64_t *a, size_t n)
+            {
+                __m128i acc = _mm_setzero_si128();
+                size_t i = 0;
+                for (; i + 2 <= n; i += 2)
+                    acc = _mm_add_epi64(acc, ld(a + i));
+                int64_t l[2];
+                st(l, acc);
+                return scalar::wadd(scalar::wadd(l[0], l[1]), scalar::sum_i64(a + i, n - i));
+            }
+            static int64_t dot_i64(const int64_t *a, const int64_t *b, size_t n)
+            {
+                __m128i acc = _mm_setzero_si128();
+                size_t i = 0;
+                for (; i + 2 <= n; i += 2)
+                    acc = _mm_add_epi64(acc, mullo(ld(a + i), ld(b + i)));
+                int64_t l[2];
+                st(l, acc);
+                return scalar::wadd(scalar::wadd(l[0], l[1]), scalar::dot_i64(a + i, b + i, n - i));
+            }
+            // 8 條 lane = 4 個暫存器（lane 2k、2k+1 在第 k 個）
+            static double sum_f64(const double *a, size_t n)
+            {
+                __m128d s0 = _mm_setzero_pd(), s1 = s0, s2 = s0, s3 = s0;
+                size_t i = 0;
+                for (; i + 8 <= n; i += 8)
+                {
+                    s0 = _mm_add_pd(s0, _mm_loadu_pd(a + i));
+                    s1 = _mm_add_pd(s1, _mm_loadu_pd(a + i + 2));
+                    s2 = _mm_add_pd(s2, _mm_loadu_pd(a + i + 4));
+                    s3 = _mm_add_pd(s3, _mm_loadu_pd(a + i + 6));
+                }
+                double l[8];
+                _mm_storeu_pd(l, s0);
+                _mm_storeu_pd(l + 2, s1);
+                _mm_storeu_pd(l + 4, s2);
+                _mm_storeu_pd(l + 6, s3);
+                double s = scalar::fold_sum(l);
+                for (; i < n; i++)
+                    s += a[i];
+                return s;
+            }
+            static double dot_f64(const double *a, const double *b, size_t n)
+            {
+                __m128d s0 = _mm_setzero_pd(), s1 = s0, s2 = s0, s3 = s0;
+                size_t i = 0;
+                for (; i + 8 <= n; i += 8)
+                {
+                    s0 = _mm_add_pd(s0, _mm_mul_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+                    s1 = _mm_add_pd(s1, _mm_mul_pd(_mm_loadu_pd(a + i + 2), _mm_loadu_pd(b + i + 2)));
+                    s2 = _mm_add_pd(s2, _mm_mul_pd(_mm_loadu_pd(a + i + 4), _mm_loadu_pd(b + i + 4)));
+                    s3 = _mm_add_pd(s3, _mm_mul_pd(_mm_loadu_pd(a + i + 6), _mm_loadu_pd(b + i + 6)));
+                }
+                double l[8];
+                _mm_storeu_pd(l, s0);
+                _mm_storeu_pd(l + 2, s1);
+                _mm_storeu_pd(l + 4, s2);
+                _mm_storeu_pd(l + 6, s3);
+                double s = scalar::fold_sum(l);
+                for (; i < n; i++)
+                {
+                    double p = a[i] * b[i];
+                    s += p;
+                }
+                return s;
+            }
+            // minpd(x, m) = x < m ? x : m，與純量版本的 fmin1(m, x) 相同
+            template <bool Max>
+            static double minmax_f64(const double *a, size_t n)
+            {
+                if (n < 8)
+                    return Max ? scalar::max_f64(a, n) : scalar::min_f64(a, n);
+                __m128d m0 = _mm_loadu_pd(a), m1 = _mm_loadu_pd(a + 2), m2 = _mm_loadu_pd(a + 4),
+                        m3 = _mm_loadu_pd(a + 6);
+                size_t i = 8;
+                for (; i + 8 <= n; i += 8)
+                {
+                    if (Max)
+                    {
+                        m0 = _mm_max_pd(_mm_loadu_pd(a + i), m0);
+                        m1 = _mm_max_pd(_mm_loadu_pd(a + i + 2), m1);
+                        m2 = _mm_max_pd(_mm_loadu_pd(a + i + 4), m2);
+                        m3 = _mm_max_pd(_mm_loadu_pd(a + i + 6), m3);
+                    }
+                    else
+                    {
+                        m0 = _mm_min_pd(_mm_loadu_pd(a + i), m0);
+                        m1 = _mm_min_pd(_mm_loadu_pd(a + i + 2), m1);
+                        m2 = _mm_min_pd(_mm_loadu_pd(a + i + 4), m2);
+                        m3 = _mm_min_pd(_mm_loadu_pd(a + i + 6), m3);
+                    }
+                }
+                double l[8];
+                _mm_storeu_pd(l, m0);
+                _mm_storeu_pd(l + 2, m1);
+                _mm_storeu_pd(l + 4, m2);
+                _mm_storeu_pd(l + 6, m3);
+                double m = Max ? scalar::fold_minmax<scalar::fmax1>(l) : scalar::fold_minmax<scalar::fmin1>(l);
+                for (; i < n; i++)
+                    m = Max ? scalar::fmax1(m, a[i]) : scalar::fmin1(m, a[i]);
+                return m;
+            }
+            static double min_f64(const double *a, size_t n) { return minmax_f64<false>(a, n); }
+            static double max_f64(const double *a, size_t n) { return minmax_f64<true>(a, n); }
+        }
+
+        // SSE2 沒有 64 位元整數比較與 FMA：min/max_i64、fma_f64 沿用純量版本
+        static const Kernels sse2_kernels = {
+            sse2::add_i64, sse2::mul_i64, sse2::fma_i64, sse2::scale_i64,
+            sse2::add_f64, sse2::mul_f64, scalar::fma_f64, sse2::scale_f64,
+            sse2::sum_i64, sse2::dot_i64, scalar::min_i64, scalar::max_i64,
+            sse2::sum_f64, sse2::dot_f64, sse2::min_f64, sse2::max_f64,
+        };
+
+        // ---- AVX2 ----
+        namespace avx2
+        {
+            ZHSIMD_TARGET("avx2") static inline __m256i mullo(__m256i a, __m256i b)
+            {
+                __m256i ll = _mm256_mul_epu32(a, b);
+                __m256i lh = _mm256_mul_epu32(a, _mm256_srli_epi64(b, 32));
+                __m256i hl = _mm256_mul_epu32(_mm256_srli_epi64(a, 32), b);
+                return _mm256_add_epi64(ll, _mm256_slli_epi64(_mm256_add_epi64(lh, hl), 32));
+            }
+            ZHSIMD_TARGET("avx2") static inline __m256i ld(const int64_t *p)
+            {
+                return _mm256_loadu_si256((const __m256i *)p);
+            }
+            ZHSIMD_TARGET("avx2") static inline void st(int64_t *p, __m256i v)
+            {
+                _mm256_storeu_si256((__m256i *)p, v);
+            }
+
+            ZHSIMD_TARGET("avx2") static void add_i64(int64_t *d, const int64_t *a, const int64_t *b, size_t n)
+            {
+                size_t i = 0;
+                for (; i + 4 <= n; i += 4)
+                    st(d + i, _mm256_add_epi64(ld(a + i), ld(b + i)));
+                scalar::add_i64(d + i, a + i, b + i, n - i);
+            }
+            ZHSIMD_TARGET("avx2") static void mul_i64(int64_t *d, const int64_t *a, const int64_t *b, size_t n)
+            {
+                size_t i = 0;
+                for (; i + 4 <= n; i += 4)
+                    st(d + i, mullo(ld(a + i), ld(b + i)));
+                scalar::mul_i64(d + i, a + i, b + i, n - i);
+            }
+            ZHSIMD_TARGET("avx2") static void fma_i64(int64_t *d, const int64_t *a, const int64_t *b, size_t n)
+            {
+                size_t i = 0;
+                for (; i + 4 <= n; i += 4)
+                    st(d + i, _mm256_add_epi64(ld(d + i), mullo(ld(a + i), ld(b + i))));
+                scalar::fma_i64(d + i, a + i, b + i, n - i);
+            }
+            ZHSIMD_TARGET("avx2") static void scale_i64(int64_t *d, const int64_t *a, int64_t s, size_t n)
+            {
+                const __m256i vs = _mm256_set1_epi64x(s);
+                size_t i = 0;
+                for (; i + 4 <= n; i += 4)
+                    st(d + i, mullo(ld(a + i), vs));
+                scalar::scale_i64(d + i, a + i, s, n - i);
+            }
+            ZHSIMD_TARGET("avx2") static void add_f64(double *d, const double *a, const double *b, size_t n)
+            {
+                size_t i = 0;
+                for (; i + 4 <= n; i += 4)
+                    _mm256_storeu_pd(d + i, _mm256_add_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+                scalar::add_f64(d + i, a + i, b + i, n - i);
+            }
+            ZHSIMD_TARGET("avx2") static void mul_f64(double *d, const double *a, const double *b, size_t n)
+            {
+                size_t i = 0;
+                for (; i + 4 <= n; i += 4)
+                    _mm256_storeu_pd(d + i, _mm256_mul_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+                scalar::mul_f64(d + i, a + i, b + i, n - i);
+            }
+            ZHSIMD_TARGET("avx2,fma") static void fma_f64(double *d, const double *a, const double *b, size_t n)
+            {
+                size_t i = 0;
+                for (; i + 4 <= n; i += 4)
+                    _mm256_storeu_pd(d + i, _mm256_fmadd_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i),
+                                                            _mm256_loadu_pd(d + i)));
+                scalar::fma_f64(d + i, a + i, b + i, n - i);
+            }
+            ZHSIMD_TARGET("avx2") static void scale_f64(double *d, const double *a, double s, size_t n)
+            {
+                const __m256d vs = _mm256_set1_pd(s);
+                size_t i = 0;
+                for (; i + 4 <= n; i += 4)
+                    _mm256_storeu_pd(d + i, _mm256_mul_pd(_mm256_loadu_pd(a + i), vs));
+                scalar::scale_f64(d + i, a + i, s, n - i);
+            }
+            ZHSIMD_TARGET("avx2") static int64_t sum_i64(const int64_t *a, size_t n)
+            {
+                __m256i acc = _mm256_setzero_si256();
+                size_t i = 0;
+                for (; i + 4 <= n; i += 4)
+                    acc = _mm256_add_epi64(acc, ld(a + i));
+                int64_t l[4];
+                st(l, acc);
+                int64_t s = scalar::wadd(scalar::wadd(l[0], l[1]), scalar::wadd(l[2], l[3]));
+                return scalar::wadd(s, scalar::sum_i64(a + i, n - i));
+            }
+            ZHSIMD_TARGET("avx2") static int64_t dot_i64(const int64_t *a, const int64_t *b, size_t n)
+            {
+                __m256i acc = _mm256_setzero_si256();
+                size_t i = 0;
+                for (; i + 4 <= n; i += 4)
+                    acc = _mm256_add_epi64(acc, mullo(ld(a + i), ld(b + i)));
+                int64_t l[4];
+                st(l, acc);
+                int64_t s = scalar::wadd(scalar::wadd(l[0], l[1]), scalar::wadd(l[2], l[3]));
+                return scalar::wadd(s, scalar::dot_i64(a + i, b + i, n - i));
+            }
+            template <bool Max>
+            ZHSIMD_TARGET("avx2") static int64_t minmax_i64(const int64_t *a, size_t n)
+            {
+                if (n < 4)
+                    return Max ? scalar::max_i64(a, n) : scalar::min_i64(a, n);
+                __m256i m = ld(a);
+                size_t i = 4;
+                for (; i + 4 <= n; i += 4)
+                {
+                    __m256i x = ld(a + i);
+                    __m256i take = Max ? _mm256_cmpgt_epi64(x, m) : _mm256_cmpgt_epi64(m, x);
+                    m = _mm256_blendv_epi8(m, x, take);
+                }
+                int64_t l[4];
+                st(l, m);
+                int64_t r = l[0];
+                for (int k = 1; k < 4; k++)
+                    r = Max ? (l[k] > r ? l[k] : r) : (l[k] < r ? l[k] : r);
+                for (; i < n; i++)
+                    r = Max ? (a[i] > r ? a[i] : r) : (a[i] < r ? a[i] : r);
+                return r;
+            }
+            ZHSIMD_TARGET("avx2") static int64_t min_i64(const int64_t *a, size_t n) { return minmax_i64<false>(a, n); }
+            ZHSIMD_TARGET("avx2") static int64_t max_i64(const int64_t *a, size_t n) { return minmax_i64<true>(a, n); }
+            // 8 條 lane = 2 個暫存器（lane 0..3、4..7）
+            ZHSIMD_TARGET("avx2") static double sum_f64(const double *a, size_t n)
+            {
+                __m256d s0 = _mm256_setzero_pd(), s1 = s0;
+                size_t i = 0;
+                for (; i + 8 <= n; i += 8)
+                {
+                    s0 = _mm256_add_pd(s0, _mm256_loadu_pd(a + i));
+                    s1 = _mm256_add_pd(s1, _mm256_loadu_pd(a + i + 4));
+                }
+                double l[8];
+                _mm256_storeu_pd(l, s0);
+                _mm256_storeu_pd(l + 4, s1);
+                double s = scalar::fold_sum(l);
+                for (; i < n; i++)
+                    s += a[i];
+                return s;
+            }
+            ZHSIMD_TARGET("avx2") static double dot_f64(const double *a, const double *b, size_t n)
+            {
+                __m256d s0 = _mm256_setzero_pd(), s1 = s0;
+                size_t i = 0;
+                for (; i + 8 <= n; i += 8)
+                {
+                    s0 = _mm256_add_pd(s0, _mm256_mul_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+                    s1 = _mm256_add_pd(s1, _mm256_mul_pd(_mm256_loadu_pd(a + i + 4), _mm256_loadu_pd(b + i + 4)));
+                }
+                double l[8];
+                _mm256_storeu_pd(l, s0);
+                _mm256_storeu_pd(l + 4, s1);
+                double s = scalar::fold_sum(l);
+                for (; i < n; i++)
+                {
+                    double p = a[i] * b[i];
+                    s += p;
+                }
+                return s;
+            }
+            template <bool Max>
+            ZHSIMD_TARGET("avx2") static double minmax_f64(const double *a, size_t n)
+            {
+                if (n < 8)
+                    return Max ? scalar::max_f64(a, n) : scalar::min_f64(a, n);
+                __m256d m0 = _mm256_loadu_pd(a), m1 = _mm256_loadu_pd(a + 4);
+                size_t i = 8;
+                for (; i + 8 <= n; i += 8)
+                {
+                    if (Max)
+                    {
+                        m0 = _mm256_max_pd(_mm256_loadu_pd(a + i), m0);
+                        m1 = _mm256_max_pd(_mm256_loadu_pd(a + i + 4), m1);
+                    }
+                    else
+                    {
+                        m0 = _mm256_min_pd(_mm256_loadu_pd(a + i), m0);
+                        m1 = _mm256_min_pd(_mm256_loadu_pd(a + i + 4), m1);
+                    }
+                }
+                double l[8];
+                _mm256_storeu_pd(l, m0);
+                _mm256_storeu_pd(l + 4, m1);
+                double m = Max ? scalar::fold_minmax<scalar::fmax1>(l) : scalar::fold_minmax<scalar::fmin1>(l);
+                for (; i < n; i++)
+                    m = Max ? scalar::fmax1(m, a[i]) : scalar::fmin1(m, a[i]);
+                return m;
+            }
+            ZHSIMD_TARGET("avx2") static double min_f64(const double *a, size_t n) { return minmax_f64<false>(a, n); }
+            ZHSIMD_TARGET("avx2") static double max_f64(const double *a, size_t n) { return minmax_f64<true>(a, n); }
+        }
+
+        static void cpuid(int leaf, int sub, unsigned r[4])
+        {
+#ifdef _MSC_VER
+            int v[4];
+            __cpuidex(v, leaf, sub);
+            for (int k = 0; k < 4; k++)
+                r[k] = (unsigned)v[k];
+#else
+            __cpuid_count(leaf, sub, r[0], r[1], r[2], r[3]);
+#endif
+        }
+
+        // XCR0：作業系統是否保存 YMM 狀態
+        static uint64_t xcr0()
+        {
+#ifdef _MSC_VER
+            return _xgetbv(0);
+#else
+            unsigned lo, hi;
+            __asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+            return ((uint64_t)hi << 32) | lo;
+#endif
+        }
+
+        static bool have_fma = false;
+
+        static Level detect()
+        {
+            unsigned r[4];
+            cpuid(0, 0, r);
+            unsigned max_leaf = r[0];
+            cpuid(1, 0, r);
+            bool osxsave = (r[2] >> 27) & 1, avx = (r[2] >> 28) & 1, fma = (r[2] >> 12) & 1;
+            if (max_leaf < 7 || !osxsave || !avx || (xcr0() & 6) != 6)
+                return Level::SSE2;
+            cpuid(7, 0, r);
+            if (!((r[1] >> 5) & 1))
+                return Level::SSE2;
+            have_fma = fma;
+            return Level::AVX2;
+        }
+#else
+        static Level detect() { return Level::Scalar; }
+#endif
+
+        Level level()
+        {
+            static const Level lv = []
+            {
+                Level l = detect();
+                const char *e = std::getenv("ZHCL_SIMD");
+                if (e && std::strcmp(e, "scalar") == 0)
+                    l = Level::Scalar;
+                else if (e && std::strcmp(e, "sse2") == 0 && l > Level::SSE2)
+                    l = Level::SSE2;
+                return l;
+            }();
+            return lv;
+        }
+
+        const char *level_name(Level l)
+        {
+            switch (l)
+            {
+            case Level::AVX2: return "avx2";
+            case Level::SSE2: return "sse2";
+            default: return "scalar";
+            }
+        }
+
+        static const Kernels &kernels()
+        {
+            static const Kernels k = []
+            {
+#if ZHSIMD_X86
+                switch (level())
+                {
+                case Level::AVX2:
+                {
+                    Kernels a = {
+                        avx2::add_i64, avx2::mul_i64, avx2::fma_i64, avx2::scale_i64,
+                        avx2::add_f64, avx2::mul_f64, have_fma ? avx2::fma_f64 : scalar::fma_f64, avx2::scale_f64,
+                        avx2::sum_i64, avx2::dot_i64, avx2::min_i64, avx2::max_i64,
+                        avx2::sum_f64, avx2::dot_f64, avx2::min_f64, avx2::max_f64,
+                    };
+                    return a;
+                }
+                case Level::SSE2: return sse2_kernels;
+                default: break;
+                }
+#endif
+                return scalar_kernels;
+            }();
+            return k;
+        }
+
+        void add_i64(int64_t *d, const int64_t *a, const int64_t *b, size_t n) { kernels().add_i64(d, a, b, n); }
+        void mul_i64(int64_t *d, const int64_t *a, const int64_t *b, size_t n) { kernels().mul_i64(d, a, b, n); }
+        void fma_i64(int64_t *d, const int64_t *a, const int64_t *b, size_t n) { kernels().fma_i64(d, a, b, n); }
+        void scale_i64(int64_t *d, const int64_t *a, int64_t s, size_t n) { kernels().scale_i64(d, a, s, n); }
+        void add_f64(double *d, const double *a, const double *b, size_t n) { kernels().add_f64(d, a, b, n); }
+        void mul_f64(double *d, const double *a, const double *b, size_t n) { kernels().mul_f64(d, a, b, n); }
+        void fma_f64(double *d, const double *a, const double *b, size_t n) { kernels().fma_f64(d, a, b, n); }
+        void scale_f64(double *d, const double *a, double s, size_t n) { kernels().scale_f64(d, a, s, n); }
+        int64_t sum_i64(const int64_t *a, size_t n) { return kernels().sum_i64(a, n); }
+        int64_t dot_i64(const int64_t *a, const int64_t *b, size_t n) { return kernels().dot_i64(a, b, n); }
+        int64_t min_i64(const int64_t *a, size_t n) { return kernels().min_i64(a, n); }
+        int64_t max_i64(const int64_t *a, size_t n) { return kernels().max_i64(a, n); }
+        double sum_f64(const double *a, size_t n) { return kernels().sum_f64(a, n); }
+        double dot_f64(const double *a, const double *b, size_t n) { return kernels().dot_f64(a, b, n); }
+        double min_f64(const double *a, size_t n) { return kernels().min_f64(a, n); }
+        double max_f64(const double *a, size_t n) { return kernels().max_f64(a, n); }
+    }
+}
@@ -0,0 +1,3671 @@
+// zh_vm.cpp — selfhost 位元碼直譯器（decode 一次，之後只做派發）
+#include "../include/zh_vm.h"
+#include "../include/zh_jit.h"
+#include "../include/zh_simd.h"
+#include "../include/zh_native.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define ZHVM_RDTSC 1
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#define ZHVM_RDTSC 1
+#else
+#define ZHVM_RDTSC 0
+#endif
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <unistd.h>
+#include <cerrno>
+#include <sys/uio.h>
+#define ZHVM_WRITEV 1
+#endif
+#ifndef ZHVM_WRITEV
+#define ZHVM_WRITEV 0
+#endif
+
+namespace selfhost
+{
+    // ---- 小工具：little-endian 讀取 ----
+    static inline uint64_t rd_u64(const uint8_t *p)
+    {
+        uint64_t v = 0;
+        std::memcpy(&v, p, 8); // 位元碼一律 LE；目前支援的平台皆為 LE
+        return v;
+    }
+
+    // ---- 輸出緩衝：連續的 PRINT 合併成一次 write / WriteFile ----
+#ifdef _WIN32
+    static const char VM_NL[] = "\r\n";
+#else
+    static const char VM_NL[] = "\n";
+#endif
+    static const size_t VM_NL_LEN = sizeof(VM_NL) - 1;
+    // line_ref：短於此長度的字串直接複製進緩衝比多一個 iovec 便宜
+    static const size_t REF_MIN = 128;
+    static const size_t REF_MAX_SPANS = 64; // 每次 writev 的片段上限（遠低於 IOV_MAX）
+
+    // 整數轉字串：由尾端往前寫，每次處理兩位數，回傳長度
+    static inline size_t fmt_i64(char *end, int64_t v)
+    {
+        static const char pairs[] =
+            "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+            "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+            "8081828384858687888990919293949596979899";
+        uint64_t u = v < 0 ? 0 - (uint64_t)v : (uint64_t)v;
+        char *p = end;
+        while (u >= 100)
+        {
+            unsigned r = (unsigned)(u % 100);
+            u /= 100;
+            p -= 2;
+            std::memcpy(p, pairs + r * 2, 2);
+        }
+        if (u >= 10)
+        {
+            p -= 2;
+            std::memcpy(p, pairs + u * 2, 2);
+        }
+        else
+            *--p = (char)('0' + u);
+        if (v < 0)
+            *--p = '-';
+        return (size_t)(end - p);
+    }
+
+    OutputSink::OutputSink(size_t capacity) : buf_(capacity < 64 ? 64 : capacity)
+    {
+#ifdef _WIN32
+        handle_ = GetStdHandle(STD_OUTPUT_HANDLE);
+        DWORD mode = 0;
+        line_flush_ = GetConsoleMode((HANDLE)handle_, &mode) != 0;
+#else
+        line_flush_ = isatty(1) != 0;
+#endif
+    }
+
+    OutputSink::OutputSink(std::string *capture, size_t capacity)
+        : buf_(capacity < 64 ? 64 : capacity), capture_(capture)
+    {
+    }
+
+    OutputSink::~OutputSink() { flush(); }
+
+    void OutputSink::sys_write(const char *p, size_t n)
+    {
+        if (capture_)
+        {
+            capture_->append(p, n);
+            return;
+        }
+#ifdef _WIN32
+        while (n > 0)
+        {
+            DWORD w = 0;
+            DWORD chunk = n > 0x40000000u ? 0x40000000u : (DWORD)n;
+            if (!WriteFile((HANDLE)handle_, p, chunk, &w, nullptr) || w == 0)
+                return;
+            p += w;
+            n -= w;
+        }
+#else
+        while (n > 0)
+        {
+            ssize_t w = ::write(1, p, n);
+            if (w < 0 && errno == EINTR)
+                continue;
+            if (w <= 0)
+                return; // 管線關閉等錯誤：丟棄剩餘輸出
+            p += w;
+            n -= (size_t)w;
+        }
+#endif
+    }
+
+    // 依序送出 refs_ 與緩衝尾段；部分寫入時從中斷處續寫
+    void OutputSink::write_refs()
+    {
+#if ZHVM_WRITEV
+        if (len_ > mark_)
+            refs_.push_back(Span{buf_.data() + mark_, len_ - mark_});
+        struct iovec iov[REF_MAX_SPANS + 1];
+        size_t cnt = refs_.size();
+        for (size_t k = 0; k < cnt; k++)
+        {
+            iov[k].iov_base = (void *)refs_[k].p;
+            iov[k].iov_len = refs_[k].n;
+        }
+        struct iovec *v = iov;
+        while (cnt > 0)
+        {
+            ssize_t w = ::writev(1, v, (int)cnt);
+            if (w < 0 && errno == EINTR)
+                continue;
+            if (w <= 0)
+                break; // 管線關閉等錯誤：丟棄剩餘輸出
+            size_t left = (size_t)w;
+            while (cnt > 0 && left >= v->iov_len)
+            {
+                left -= v->iov_len;
+                ++v;
+                --cnt;
+            }
+            if (cnt > 0)
+            {
+                v->iov_base = (char *)v->iov_base + left;
+                v->iov_len -= left;
+            }
+        }
+#endif
+    }
+
+    void OutputSink::flush()
+    {
+        if (!refs_.empty())
+        {
+            write_refs();
+            refs_.clear();
+            ref_bytes_ = 0;
+            mark_ = 0;
+            len_ = 0;
+        }
+        else if (len_)
+        {
+            sys_write(buf_.data(), len_);
+            len_ = 0;
+        }
+    }
+
+    void OutputSink::write(const char *p, size_t n)
+    {
+        if (len_ + n > buf_.size())
+        {
+            flush();
+            if (n > buf_.size())
+            {
+                sys_write(p, n);
+                return;
+            }
+        }
+        std::memcpy(buf_.data() + len_, p, n);
+        len_ += n;
+    }
+
+    void OutputSink::line(const char *s, size_t n)
+    {
+        if (len_ + n + VM_NL_LEN > buf_.size())
+        {
+            flush();
+            if (n + VM_NL_LEN > buf_.size())
+            {
+                // 超過緩衝容量的長字串直接寫出
+                sys_write(s, n);
+                sys_write(VM_NL, VM_NL_LEN);
+                return;
+            }
+        }
+        std::memcpy(buf_.data() + len_, s, n);
+        std::memcpy(buf_.data() + len_ + n, VM_NL, VM_NL_LEN);
+        len_ += n + VM_NL_LEN;
+        if (line_flush_)
+            flush();
+    }
+
+    void OutputSink::line_ref(const char *s, size_t n)
+    {
+#if ZHVM_WRITEV
+        if (n < REF_MIN || capture_)
+        {
+            line(s, n);
+            return;
+        }
+        // refs_ 可能加入緩衝區段、字串本身兩項；引用的總量也以緩衝容量為限，輸出不致延遲太久
+        if (refs_.size() + 2 > REF_MAX_SPANS || ref_bytes_ + n > buf_.size() || len_ + VM_NL_LEN > buf_.size())
+            flush();
+        if (len_ > mark_)
+            refs_.push_back(Span{buf_.data() + mark_, len_ - mark_});
+        refs_.push_back(Span{s, n});
+        ref_bytes_ += n;
+        mark_ = len_; // 換行留在緩衝，成為下一段的開頭
+        std::memcpy(buf_.data() + len_, VM_NL, VM_NL_LEN);
+        len_ += VM_NL_LEN;
+        if (line_flush_)
+            flush();
+#else
+        line(s, n); // Windows 無對應 stdout 的 gather 寫入，照常複製
+#endif
+    }
+
+    void OutputSink::int_line(int64_t v)
+    {
+        const size_t max = 20 + VM_NL_LEN;
+        if (len_ + max > buf_.size())
+            flush();
+        char tmp[24];
+        size_t n = fmt_i64(tmp + sizeof(tmp), v);
+        char *d = buf_.data() + len_;
+        std::memcpy(d, tmp + sizeof(tmp) - n, n);
+        std::memcpy(d + n, VM_NL, VM_NL_LEN);
+        len_ += n + VM_NL_LEN;
+        if (line_flush_)
+            flush();
+    }
+
+    void OutputSink::f64_line(double v)
+    {
+        char tmp[40];
+        int n = std::snprintf(tmp, sizeof(tmp), "%.15g", v); // 與 chinese.h 的 輸出小數 相同
+        line(tmp, n > 0 ? (size_t)n : 0);
+    }
+
+    static inline int32_t rd_i32(const uint8_t *p)
+    {
+        uint32_t v = 0;
+        std::memcpy(&v, p, 4);
+        return (int32_t)v;
+    }
+
+    // 槽位運算元：ENC_LEGACY 為 u8，其餘為 ULEB128
+    template <bool Checked>
+    static inline bool rd_slot(const uint8_t *bc, size_t n, size_t &i, uint8_t enc, uint32_t &out)
+    {
+        if (enc == ENC_LEGACY)
+        {
+            if (Checked && i >= n)
+                return false;
+            out = bc[i++];
+            return true;
+        }
+        uint64_t v = 0;
+        if (!read_uleb(bc, Checked ? n : SIZE_MAX, i, v, UINT32_MAX))
+            return false;
+        out = (uint32_t)v;
+        return true;
+    }
+
+    // 剩餘長度是否足夠 k bytes
+    template <bool Checked>
+    static inline bool have(size_t n, size_t i, size_t k)
+    {
+        return !Checked || (i <= n && n - i >= k);
+    }
+
+    // OP_SPAWN 的歸約方式；RD_ARG 必須接在 RD_MAX / RD_MIN（或另一個 RD_ARG）之後。prev 為前一項，沒有時為 -1
+    static inline bool reduce_ok(uint8_t r, int prev)
+    {
+        if ((r & ~(RD_KIND | RD_F64 | RD_TIE)) || (r & RD_KIND) >= RD_KIND_COUNT)
+            return false;
+        return (r & RD_KIND) != RD_ARG || (prev >= 0 && (prev & RD_KIND) >= RD_MAX);
+    }
+
+    // Checked = false 時略過所有長度檢查（僅用於已通過 verify_bc 的位元碼）
+    template <bool Checked>
+    static inline bool read_insn_impl(const uint8_t *bc, size_t n, size_t off, const BcHeader &h, RawInsn &R)
+    {
+        const uint8_t enc = h.enc;
+        R = RawInsn{};
+        R.off = off;
+        if (Checked && off >= n)
+            return false;
+        size_t i = off;
+        R.op = bc[i++];
+        switch (R.op)
+        {
+        case OP_PRINT:
+            if (h.flags & BCF_POOL)
+            {
+                if (!rd_slot<Checked>(bc, n, i, enc, R.a) || (Checked && R.a >= h.pool_count))
+                    return false;
+                uint32_t len = 0;
+                R.s = pool_str(bc, h, R.a, len);
+                R.len = len;
+                break;
+            }
+            if (enc == ENC_VARINT)
+            {
+                if (!read_uleb(bc, Checked ? n : SIZE_MAX, i, R.len))
+                    return false;
+            }
+            else
+            {
+                if (!have<Checked>(n, i, 8))
+                    return false;
+                R.len = rd_u64(bc + i);
+                i += 8;
+            }
+            if (Checked && R.len > n - i)
+                return false;
+            R.s = (const char *)bc + i;
+            i += (size_t)R.len;
+            break;
+        case OP_PRINT_INT:
+        case OP_PRINT_F64:
+        case OP_SPRINT:
+        case OP_CLOSE:
+            if (!rd_slot<Checked>(bc, n, i, enc, R.a))
+                return false;
+            break;
+        case OP_SET_F64:
+            if (!rd_slot<Checked>(bc, n, i, enc, R.a) || !have<Checked>(n, i, 8))
+                return false;
+            R.imm = (int64_t)rd_u64(bc + i); // 位元型樣
+            i += 8;
+            break;
+        case OP_SET_I64:
+            if (!rd_slot<Checked>(bc, n, i, enc, R.a))
+                return false;
+            if (enc == ENC_VARINT)
+            {
+                uint64_t u = 0;
+                if (!read_uleb(bc, Checked ? n : SIZE_MAX, i, u))
+                    return false;
+                R.imm = unzigzag(u);
+            }
+            else
+            {
+                if (!have<Checked>(n, i, 8))
+                    return false;
+                R.imm = (int64_t)rd_u64(bc + i);
+                i += 8;
+            }
+            break;
+        case OP_COPY_I64:
+        case OP_I2F:
+        case OP_F2I:
+        case OP_ANEW:
+        case OP_ALEN:
+        case OP_DMOV:
+        case OP_CHAN:
+        case OP_SEND:
+            if (!rd_slot<Checked>(bc, n, i, enc, R.a) || !rd_slot<Checked>(bc, n, i, enc, R.b))
+                return false;
+            break;
+        case OP_MATH:
+            if (!have<Checked>(n, i, 1))
+                return false;
+            R.imm = bc[i++]; // 函式編號
+            if (Checked && R.imm >= MF_COUNT)
+                return false;
+            if (!rd_slot<Checked>(bc, n, i, enc, R.a) || !rd_slot<Checked>(bc, n, i, enc, R.b) ||
+                !rd_slot<Checked>(bc, n, i, enc, R.c))
+                return false;
+            break;
+        case OP_DBOX:
+        case OP_DUNBOX:
+            if (!have<Checked>(n, i, 1))
+                return false;
+            R.imm = bc[i++]; // ValueTag
+            if (Checked && R.imm >= VT_COUNT)
+                return false;
+            if (!rd_slot<Checked>(bc, n, i, enc, R.a) || !rd_slot<Checked>(bc, n, i, enc, R.b))
+                return false;
+            break;
+        case OP_DPRINT:
+            if (!have<Checked>(n, i, 1))
+                return false;
+            R.imm = bc[i++]; // DynFmt
+            if (Checked && R.imm > DF_MASK)
+                return false;
+            if (!rd_slot<Checked>(bc, n, i, enc, R.a))
+                return false;
+            break;
+        case OP_SCONST:
+        {
+            uint64_t k = 0;
+            if (!rd_slot<Checked>(bc, n, i, enc, R.a) || !read_uleb(bc, Checked ? n : SIZE_MAX, i, k, UINT32_MAX) ||
+                (Checked && (!(h.flags & BCF_POOL) || k >= h.pool_count)))
+                return false;
+            R.imm = (int64_t)k;
+            uint32_t len = 0;
+            R.s = pool_str(bc, h, (uint32_t)k, len);
+            R.len = len;
+            break;
+        }
+        case OP_VEC:
+            if (!have<Checked>(n, i, 1))
+                return false;
+            R.imm = bc[i++]; // VecOp
+            if (Checked && R.imm >= VK_COUNT)
+                return false;
+            if (!rd_slot<Checked>(bc, n, i, enc, R.a) || !rd_slot<Checked>(bc, n, i, enc, R.b) ||
+                !rd_slot<Checked>(bc, n, i, enc, R.c))
+                return false;
+            break;
+        case OP_ADD:
+        case OP_SUB:
+        case OP_MUL:
+        case OP_DIV:
+        case OP_MOD:
+        case OP_FLMOD:
+        case OP_EQ:
+        case OP_NE:
+        case OP_LT:
+        case OP_LE:
+        case OP_GT:
+        case OP_GE:
+        case OP_FADD:
+        case OP_FSUB:
+        case OP_FMUL:
+        case OP_FDIV:
+        case OP_FMOD:
+        case OP_FFLMOD:
+        case OP_FEQ:
+        case OP_FNE:
+        case OP_FLT:
+        case OP_FLE:
+        case OP_FGT:
+        case OP_FGE:
+        case OP_AGET:
+        case OP_ASET:
+        case OP_SCAT:
+        case OP_DADD:
+        case OP_DSUB:
+        case OP_DMUL:
+        case OP_DDIV:
+        case OP_DMOD:
+        case OP_DFLMOD:
+        case OP_DEQ:
+        case OP_DNE:
+        case OP_DLT:
+        case OP_DLE:
+        case OP_DGT:
+        case OP_DGE:
+        case OP_DJEQ:
+        case OP_DJNE:
+        case OP_RECV:
+            if (!rd_slot<Checked>(bc, n, i, enc, R.a) || !rd_slot<Checked>(bc, n, i, enc, R.b) ||
+                !rd_slot<Checked>(bc, n, i, enc, R.c))
+                return false;
+            break;
+        case OP_CALL_NATIVE:
+        {
+            uint64_t fn = 0, argc = 0;
+            if (!read_uleb(bc, Checked ? n : SIZE_MAX, i, fn, NF_COUNT - 1) || !rd_slot<Checked>(bc, n, i, enc, R.a) ||
+                !read_uleb(bc, Checked ? n : SIZE_MAX, i, argc, NATIVE_MAX_ARGS + 1))
+                return false;
+            R.imm = (int64_t)fn;
+            const char *sig = native_sig((unsigned)fn)->sig + 1; // 略過回傳型別
+            size_t fixed = 0;
+            bool var = false;
+            for (const char *p = sig; *p; ++p)
+                *p == '*' ? (void)(var = true) : (void)++fixed;
+            if (Checked && (argc < fixed || (!var && argc > fixed)))
+                return false;
+            for (uint64_t k = 0; k < argc; k++)
+            {
+                uint32_t v = 0;
+                if (!rd_slot<Checked>(bc, n, i, enc, v))
+                    return false;
+                if (k < fixed && sig[k] == 's')
+                {
+                    if (Checked && (!(h.flags & BCF_POOL) || v >= h.pool_count))
+                        return false;
+                    uint32_t len = 0;
+                    R.s = pool_str(bc, h, v, len);
+                    R.len = len;
+                }
+                else if (R.argc < NATIVE_MAX_ARGS)
+                    R.args[R.argc++] = v;
+                else
+                    return false;
+            }
+            break;
+        }
+        case OP_CALL:
+        case OP_TAILCALL:
+        case OP_GO:
+        {
+            uint64_t argc = 0;
+            if ((R.op == OP_CALL && !rd_slot<Checked>(bc, n, i, enc, R.a)) ||
+                !read_uleb(bc, Checked ? n : SIZE_MAX, i, argc, CALL_MAX_ARGS))
+                return false;
+            R.argc = (uint32_t)argc;
+            for (uint32_t k = 0; k < R.argc; k++)
+                if (!rd_slot<Checked>(bc, n, i, enc, R.args[k]))
+                    return false;
+            if (!have<Checked>(n, i, 8))
+                return false;
+            R.b = rd_u32le(bc + i); // 被呼叫者的 frame
+            R.imm = (int64_t)(i + 8) + rd_i32(bc + i + 4);
+            i += 8;
+            break;
+        }
+        case OP_RET:
+            if (!rd_slot<Checked>(bc, n, i, enc, R.a))
+                return false;
+            break;
+        case OP_SPAWN:
+        {
+            uint64_t nred = 0;
+            if (!rd_slot<Checked>(bc, n, i, enc, R.a) || !rd_slot<Checked>(bc, n, i, enc, R.b) ||
+                !read_uleb(bc, Checked ? n : SIZE_MAX, i, nred, SPAWN_MAX_REDUCE))
+                return false;
+            R.argc = (uint32_t)nred;
+            for (uint32_t k = 0; k < R.argc; k++)
+            {
+                if (!have<Checked>(n, i, 1))
+                    return false;
+                R.red[k] = bc[i++];
+                if (Checked && !reduce_ok(R.red[k], k ? R.red[k - 1] : -1))
+                    return false;
+                if (!rd_slot<Checked>(bc, n, i, enc, R.args[k]))
+                    return false;
+            }
+            if (!have<Checked>(n, i, 4))
+                return false;
+            R.imm = (int64_t)(i + 4) + rd_i32(bc + i);
+            i += 4;
+            break;
+        }
+        case OP_JOIN:
+            break;
+        case OP_SELECT:
+        {
+            uint64_t ncase = 0;
+            if (!rd_slot<Checked>(bc, n, i, enc, R.a) || !rd_slot<Checked>(bc, n, i, enc, R.b) ||
+                !rd_slot<Checked>(bc, n, i, enc, R.c) ||
+                !read_uleb(bc, Checked ? n : SIZE_MAX, i, ncase, SELECT_MAX_CASES))
+                return false;
+            R.argc = (uint32_t)ncase;
+            uint32_t nslot = 0;
+            bool dflt = false;
+            for (uint32_t k = 0; k < R.argc; k++)
+            {
+                if (!have<Checked>(n, i, 1))
+                    return false;
+                R.red[k] = bc[i++];
+                if (Checked && (R.red[k] >= SEL_KIND_COUNT || (R.red[k] == SEL_DEFAULT && dflt)))
+                    return false;
+                dflt |= R.red[k] == SEL_DEFAULT;
+                const uint32_t m = R.red[k] == SEL_SEND ? 2 : R.red[k] == SEL_RECV ? 1 : 0;
+                if (Checked && nslot + m > NATIVE_MAX_ARGS)
+                    return false;
+                for (uint32_t q = 0; q < m; q++)
+                    if (!rd_slot<Checked>(bc, n, i, enc, R.args[nslot++]))
+                        return false;
+            }
+            break;
+        }
+        case OP_JMP:
+            if (!have<Checked>(n, i, 4))
+                return false;
+            R.imm = (int64_t)(i + 4) + rd_i32(bc + i);
+            i += 4;
+            break;
+        case OP_JZ:
+        case OP_JNZ:
+            if (!rd_slot<Checked>(bc, n, i, enc, R.a) || !have<Checked>(n, i, 4))
+                return false;
+            R.imm = (int64_t)(i + 4) + rd_i32(bc + i);
+            i += 4;
+            break;
+        case OP_END:
+            break;
+        default:
+            return false;
+        }
+        R.next = i;
+        return true;
+    }
+
+    bool read_insn(const uint8_t *bc, size_t n, size_t off, const BcHeader &h, RawInsn &R)
+    {
+        return read_insn_impl<true>(bc, n, off, h, R);
+    }
+
+    RawInsn read_insn_verified(const uint8_t *bc, size_t off, const BcHeader &h)
+    {
+        RawInsn R;
+        read_insn_impl<false>(bc, 0, off, h, R);
+        return R;
+    }
+
+    static inline bool is_jump(uint16_t op)
+    {
+        return op == OP_JMP || op == OP_JZ || op == OP_JNZ;
+    }
+
+    // 指令引用的槽位是否都在 frame 內（各操作碼未使用的槽位欄位為 0；frame 為 0 時只允許不用槽位的指令）。
+    // pair 運算元的兩個槽位都必須在 frame 內
+    static bool slots_ok(const RawInsn &R, uint32_t frame)
+    {
+        if (R.op == OP_PRINT || R.op == OP_END || R.op == OP_JMP || R.op == OP_JOIN)
+            return true;
+        if (R.op == OP_CALL_NATIVE)
+        {
+            if (native_sig((unsigned)R.imm)->sig[0] != 'v' && R.a >= frame)
+                return false;
+            for (uint32_t k = 0; k < R.argc; k++)
+                if (R.args[k] >= frame)
+                    return false;
+            return true;
+        }
+        if (R.op == OP_CALL || R.op == OP_TAILCALL || R.op == OP_GO)
+        {
+            // 被呼叫者的窗口與主程式同樣以標頭 frame 為界
+            if (R.a >= frame || R.argc > R.b || R.b > frame)
+                return false;
+            for (uint32_t k = 0; k < R.argc; k++)
+                if (R.args[k] >= frame)
+                    return false;
+            return true;
+        }
+        if (R.op == OP_SPAWN)
+        {
+            if (R.a >= frame || R.b >= frame)
+                return false;
+            for (uint32_t k = 0; k < R.argc; k++)
+                if (R.args[k] >= frame)
+                    return false;
+            return true;
+        }
+        if (R.op == OP_SELECT)
+        {
+            if (R.a >= frame || R.b >= frame || R.c >= frame)
+                return false;
+            for (uint32_t k = 0, q = 0; k < R.argc; k++)
+                for (uint32_t m = R.red[k] == SEL_SEND ? 2 : R.red[k] == SEL_RECV ? 1 : 0; m; m--, q++)
+                    if (R.args[q] >= frame)
+                        return false;
+            return true;
+        }
+        const unsigned pm = pair_operands(R.op);
+        return (uint64_t)R.a + (pm & 1) < frame && (uint64_t)R.b + ((pm >> 1) & 1) < frame &&
+               (uint64_t)R.c + ((pm >> 2) & 1) < frame;
+    }
+
+    // ---- 載入時驗證 ----
+    bool verify_bc(const uint8_t *bc, size_t n, VerifyError &err)
+    {
+        auto fail = [&](size_t off, const std::string &why)
+        {
+            err.offset = off;
+            err.message = why;
+            return false;
+        };
+        BcHeader h;
+        if (!parse_header(bc, n, h))
+            return fail(0, "bad header");
+        if (h.natives > NATIVE_VERSION)
+            return fail(0, "native table version " + std::to_string(h.natives) + " is newer than supported (" +
+                               std::to_string(NATIVE_VERSION) + ")");
+        std::vector<bool> start(n + 1, false); // 指令起點；n 代表「程式結尾」
+        std::vector<std::pair<size_t, int64_t>> jumps;
+        size_t i = h.code;
+        RawInsn R;
+        while (i < n)
+        {
+            if (!read_insn(bc, n, i, h, R))
+            {
+                if ((bc[i] == OP_PRINT && (h.flags & BCF_POOL)) || bc[i] == OP_SCONST)
+                    return fail(i, "bad string pool index (pool has " + std::to_string(h.pool_count) + ")");
+                if ((bc[i] == OP_DBOX || bc[i] == OP_DUNBOX) && i + 1 < n && bc[i + 1] >= VT_COUNT)
+                    return fail(i, "unknown value tag " + std::to_string(bc[i + 1]));
+                if (bc[i] == OP_DPRINT && i + 1 < n && bc[i + 1] > DF_MASK)
+                    return fail(i, "unknown print format " + std::to_string(bc[i + 1]));
+                if (bc[i] == OP_MATH && i + 1 < n && bc[i + 1] >= MF_COUNT)
+                    return fail(i, "unknown math function " + std::to_string(bc[i + 1]));
+                if (bc[i] == OP_VEC && i + 1 < n && bc[i + 1] >= VK_COUNT)
+                    return fail(i, "unknown vector op " + std::to_string(bc[i + 1]));
+                if (bc[i] == OP_CALL_NATIVE)
+                    return fail(i, "bad native call (unknown function, argument count or string index)");
+                if (bc[i] == OP_CALL || bc[i] == OP_TAILCALL || bc[i] == OP_GO)
+                    return fail(i, "bad call (more than " + std::to_string(CALL_MAX_ARGS) + " arguments or truncated)");
+                if (bc[i] == OP_SELECT)
+                    return fail(i, "bad select (unknown case kind, more than one default, more than " +
+                                       std::to_string(SELECT_MAX_CASES) + " cases or " +
+                                       std::to_string(NATIVE_MAX_ARGS) + " slots, or truncated)");
+                if (bc[i] == OP_SPAWN)
+                    return fail(i, "bad spawn (unknown reduction, more than " + std::to_string(SPAWN_MAX_REDUCE) +
+                                       " reduced slots or truncated)");
+                return fail(i, op_name(bc[i]) ? std::string("truncated ") + op_name(bc[i]) : "unknown opcode");
+            }
+            if (R.op == OP_PRINT && R.len > UINT32_MAX)
+                return fail(i, "string too long");
+            if ((R.op == OP_CALL || R.op == OP_TAILCALL || R.op == OP_GO) && (R.argc > R.b || R.b > h.frame))
+                return fail(i, "bad call frame " + std::to_string(R.b) + " (" + std::to_string(R.argc) +
+                                   " arguments, header frame " + std::to_string(h.frame) + ")");
+            if (!slots_ok(R, h.frame))
+                return fail(i, "slot out of range (frame " + std::to_string(h.frame) + ")");
+            if (R.op == OP_CALL_NATIVE && R.imm >= native_count(h.natives))
+                return fail(i, std::string("native function ") + native_sig((unsigned)R.imm)->name +
+                                   " needs native table version >= 1 (header declares " + std::to_string(h.natives) + ")");
+            if (is_jump(R.op) || R.op == OP_CALL || R.op == OP_TAILCALL || R.op == OP_SPAWN || R.op == OP_GO)
+                jumps.emplace_back(i, R.imm);
+            start[i] = true;
+            i = R.next;
+        }
+        start[n] = true;
+        for (auto &j : jumps)
+        {
+            if (j.second < (int64_t)h.code || (uint64_t)j.second > n || !start[(size_t)j.second])
+                return fail(j.first, "jump target " + std::to_string(j.second) + " is not an instruction boundary");
+        }
+        return true;
+    }
+
+    // ---- 第一階段：解碼 ----
+    // 解碼到 P（沿用 P.code 已配置的容量）
+    template <bool Checked>
+    static void decode_impl(const uint8_t *bc, size_t n, Program &P)
+    {
+        BcHeader h;
+        if (!parse_header(bc, n, h))
+            n = 0; // 標頭損毀：只留結尾的 OP_END
+        P.code.clear();
+        P.calls.clear();
+        P.strs.clear();
+        P.threaded = false;
+        P.go = false;
+        P.frame = h.frame;
+        P.code.reserve(n / 2 + 1);
+        std::vector<size_t> &offs = P.offs;
+        offs.clear();
+        offs.reserve(n / 2 + 1);
+        size_t i = h.code;
+        RawInsn R;
+        std::vector<std::pair<size_t, int64_t>> call_targets; // OP_CALL / OP_TAILCALL / OP_SPAWN / OP_GO：指令索引、目標位移
+        // OP_END 之後的指令仍可能是跳躍目標，整段都要解碼
+        while (i < n && read_insn_impl<Checked>(bc, n, i, h, R))
+        {
+            if (Checked && (!slots_ok(R, h.frame) || (R.op == OP_CALL_NATIVE && R.imm >= native_count(h.natives))))
+                break;
+            Insn in{};
+            in.op = R.op;
+            in.a = R.a;
+            in.b = R.b;
+            in.c = R.c;
+            if (R.op == OP_PRINT)
+            {
+                in.s = R.s;
+                in.b = (uint32_t)R.len;
+            }
+            else
+                in.imm = R.imm;
+            if (R.op == OP_CALL_NATIVE)
+            {
+                NativeCall nc{};
+                nc.argc = R.argc;
+                std::memcpy(nc.argv, R.args, sizeof nc.argv);
+                nc.s = R.s;
+                nc.len = (uint32_t)R.len;
+                nc.ret = native_sig((unsigned)R.imm)->sig[0] != 'v';
+                in.c = (uint32_t)P.calls.size();
+                P.calls.push_back(nc);
+            }
+            else if (R.op == OP_CALL || R.op == OP_TAILCALL || R.op == OP_SPAWN || R.op == OP_GO || R.op == OP_SELECT)
+            {
+                // imm 改存參數表索引；目標位移另外記下，最後與跳躍一起換成指令索引（c）
+                NativeCall nc{};
+                nc.argc = R.argc;
+                std::memcpy(nc.argv, R.args, sizeof nc.argv);
+                std::memcpy(nc.red, R.red, sizeof nc.red);
+                if (R.op != OP_SELECT)
+                    call_targets.emplace_back(P.code.size(), R.imm);
+                in.imm = (int64_t)P.calls.size();
+                P.calls.push_back(nc);
+            }
+            else if (R.op == OP_SCONST)
+            {
+                P.strs.push_back(StrConst{R.s, (uint32_t)R.len});
+                in.imm = -(int64_t)P.strs.size();
+            }
+            P.go |= R.op >= OP_GO && R.op <= OP_SELECT;
+            offs.push_back(i);
+            P.code.push_back(in);
+            i = R.next;
+        }
+        Insn end{};
+        end.op = OP_END;
+        P.code.push_back(end);
+        offs.push_back(i);
+
+        // 跳躍目標：位移 -> 指令索引
+        const uint32_t end_idx = (uint32_t)(P.code.size() - 1);
+        auto index_of = [&](int64_t off)
+        {
+            auto it = std::lower_bound(offs.begin(), offs.end(), (size_t)(off < 0 ? SIZE_MAX : off));
+            return (it != offs.end() && (int64_t)*it == off) ? (uint32_t)(it - offs.begin()) : end_idx;
+        };
+        for (auto &in : P.code)
+        {
+            if (is_jump(in.op))
+                in.c = index_of(in.imm);
+        }
+        for (auto &t : call_targets)
+            P.code[t.first].c = index_of(t.second);
+    }
+
+    Program decode_bc(const uint8_t *bc, size_t n)
+    {
+        Program P;
+        decode_impl<true>(bc, n, P);
+        return P;
+    }
+
+    Program decode_verified(const uint8_t *bc, size_t n)
+    {
+        Program P;
+        decode_impl<false>(bc, n, P);
+        return P;
+    }
+
+    // ---- 槽位 frame ----
+    int64_t *SlotArena::alloc(size_t n)
+    {
+        const size_t CHUNK = 64 * 1024;
+        while (cur_ < chunks_.size() && chunks_[cur_].cap - used_ < n)
+        {
+            ++cur_;
+            used_ = 0;
+        }
+        if (cur_ == chunks_.size())
+        {
+            size_t cap = n > CHUNK ? n : CHUNK;
+            chunks_.push_back(Chunk{std::unique_ptr<int64_t[]>(new int64_t[cap]), cap});
+            used_ = 0;
+        }
+        int64_t *p = chunks_[cur_].p.get() + used_;
+        used_ += n;
+        std::memset(p, 0, n * sizeof(int64_t));
+        return p;
+    }
+
+    void SlotArena::reset()
+    {
+        cur_ = 0;
+        used_ = 0;
+    }
+
+    Frame::Frame(uint32_t n, SlotArena &arena) : n_(n)
+    {
+        if (n <= FRAME_STACK_SLOTS)
+        {
+            p_ = local_;
+            std::memset(local_, 0, n * sizeof(int64_t));
+        }
+        else
+            p_ = arena.alloc(n);
+    }
+
+    // ---- 剖析（--vm-profile）----
+    static inline uint64_t vm_ticks()
+    {
+#if ZHVM_RDTSC
+        return __rdtsc();
+#else
+        return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+#endif
+    }
+
+    const char *VmProfile::unit() { return ZHVM_RDTSC ? "cycles" : "ns"; }
+
+    void VmProfile::merge(const VmProfile &o)
+    {
+        for (int i = 0; i < 256; i++)
+        {
+            count[i] += o.count[i];
+            ticks[i] += o.ticks[i];
+        }
+        if (insn_count.size() < o.insn_count.size())
+        {
+            insn_count.resize(o.insn_count.size());
+            insn_ticks.resize(o.insn_count.size());
+        }
+        for (size_t i = 0; i < o.insn_count.size(); i++)
+        {
+            insn_count[i] += o.insn_count[i];
+            insn_ticks[i] += o.insn_ticks[i];
+        }
+    }
+
+    // 有執行過的操作碼，依時間遞減
+    static std::vector<unsigned> profile_order(const VmProfile &p)
+    {
+        std::vector<unsigned> ops;
+        for (unsigned i = 1; i < 256; i++)
+            if (p.count[i])
+                ops.push_back(i);
+        std::sort(ops.begin(), ops.end(), [&](unsigned a, unsigned b)
+                  { return p.ticks[a] != p.ticks[b] ? p.ticks[a] > p.ticks[b] : a < b; });
+        return ops;
+    }
+
+    void VmProfile::print(std::FILE *f) const
+    {
+        uint64_t total_n = 0, total_t = 0;
+        for (int i = 1; i < 256; i++)
+        {
+            total_n += count[i];
+            total_t += ticks[i];
+        }
+        std::fprintf(f, "[vm-profile] %llu instructions, %llu %s\n", (unsigned long long)total_n,
+                     (unsigned long long)total_t, unit());
+        std::fprintf(f, "%-10s %14s %7s %16s %7s %10s\n", "opcode", "count", "%", unit(), "%", "per op");
+        for (unsigned op : profile_order(*this))
+        {
+            const char *name = op_name((uint8_t)op);
+            std::fprintf(f, "%-10s %14llu %6.2f%% %16llu %6.2f%% %10.1f\n", name ? name : "?",
+                         (unsigned long long)count[op], total_n ? 100.0 * count[op] / total_n : 0.0,
+                         (unsigned long long)ticks[op], total_t ? 100.0 * ticks[op] / total_t : 0.0,
+                         (double)ticks[op] / count[op]);
+        }
+    }
+
+    bool VmProfile::write_json(const std::string &path) const
+    {
+        std::FILE *f = std::fopen(path.c_str(), "wb");
+        if (!f)
+            return false;
+        std::fprintf(f, "{\n  \"unit\": \"%s\",\n  \"opcodes\": [", unit());
+        bool first = true;
+        for (unsigned op : profile_order(*this))
+        {
+            const char *name = op_name((uint8_t)op);
+            std::fprintf(f, "%s\n    {\"op\": \"%s\", \"code\": %u, \"count\": %llu, \"ticks\": %llu}",
+                         first ? "" : ",", name ? name : "?", op, (unsigned long long)count[op],
+                         (unsigned long long)ticks[op]);
+            first = false;
+        }
+        std::fprintf(f, "\n  ]\n}\n");
+        return std::fclose(f) == 0;
+    }
+
+    bool profile_lines(const uint8_t *bc, size_t n, const Program &prog, const VmProfile &prof, std::string &file,
+                       std::vector<LineProfile> &out)
+    {
+        out.clear();
+        BcHeader h;
+        std::vector<DebugRow> rows;
+        if (!parse_header(bc, n, h) || !read_debug(bc, n, h, file, rows) ||
+            prof.insn_count.size() != prog.code.size() || prog.offs.size() != prog.code.size())
+            return false;
+        std::unordered_map<uint32_t, size_t> at; // 行號 -> out 索引
+        for (size_t i = 0; i < prog.code.size(); i++)
+        {
+            if (!prof.insn_count[i] && !prof.insn_ticks[i])
+                continue;
+            uint32_t line = debug_line(rows, prog.offs[i] - h.code);
+            auto it = at.emplace(line, out.size()).first;
+            if (it->second == out.size())
+                out.push_back({line, 0, 0});
+            out[it->second].count += prof.insn_count[i];
+            out[it->second].ticks += prof.insn_ticks[i];
+        }
+        std::sort(out.begin(), out.end(), [](const LineProfile &a, const LineProfile &b)
+                  { return a.ticks != b.ticks ? a.ticks > b.ticks : a.line < b.line; });
+        return true;
+    }
+
+    // OP_MATH；fn 已通過驗證
+    static double vm_math(unsigned fn, double a, double b)
+    {
+        switch (fn)
+        {
+        case MF_SQRT: return std::sqrt(a);
+        case MF_CBRT: return std::cbrt(a);
+        case MF_SIN: return std::sin(a);
+        case MF_COS: return std::cos(a);
+        case MF_TAN: return std::tan(a);
+        case MF_ASIN: return std::asin(a);
+        case MF_ACOS: return std::acos(a);
+        case MF_ATAN: return std::atan(a);
+        case MF_ATAN2: return std::atan2(a, b);
+        case MF_POW: return std::pow(a, b);
+        case MF_FABS: return std::fabs(a);
+        case MF_FLOOR: return std::floor(a);
+        case MF_CEIL: return std::ceil(a);
+        case MF_ROUND: return std::round(a);
+        case MF_EXP: return std::exp(a);
+        case MF_LOG: return std::log(a);
+        default: return std::log10(a);
+        }
+    }
+
+    // 單次執行的陣列（OP_ANEW 配置，run_program 返回時釋放）；代號 = 索引 + 1
+    struct ArrayHeap
+    {
+        std::vector<std::vector<int64_t>> arrs;
+        int64_t total = 0; // 已配置元素總數，上限為 4 * ARRAY_MAX_LEN，超過時 ANEW 得 0
+
+        int64_t alloc(int64_t len)
+        {
+            len = len < 0 ? 0 : len > ARRAY_MAX_LEN ? ARRAY_MAX_LEN : len;
+            if (total + len > 4 * ARRAY_MAX_LEN)
+                return 0;
+            total += len;
+            arrs.emplace_back((size_t)len, 0);
+            return (int64_t)arrs.size();
+        }
+        // 無效代號視為空陣列：回傳 nullptr、n = 0
+        int64_t *get(int64_t h, size_t &n)
+        {
+            if (h <= 0 || (uint64_t)h > arrs.size())
+            {
+                n = 0;
+                return nullptr;
+            }
+            auto &v = arrs[(size_t)h - 1];
+            n = v.size();
+            return v.data();
+        }
+    };
+
+    // OP_VEC；k 已通過驗證。f64 陣列與 int64 陣列共用儲存，元素依種類解讀
+    static void vm_vec(ArrayHeap &H, int64_t *vars, unsigned k, uint32_t a, uint32_t b, uint32_t c)
+    {
+        size_t na = 0, nb = 0, nc = 0;
+        int64_t *pa = vec_reduces(k) ? nullptr : H.get(vars[a], na);
+        int64_t *pb = H.get(vars[b], nb);
+        int64_t *pc = (k & 7) == VK_SCALE_I ? nullptr : H.get(vars[c], nc);
+        const size_t n2 = std::min(na, nb), n3 = std::min(n2, nc);
+        double *fa = (double *)pa, *fb = (double *)pb, *fc = (double *)pc;
+        switch (k)
+        {
+        case VK_ADD_I: simd::add_i64(pa, pb, pc, n3); break;
+        case VK_MUL_I: simd::mul_i64(pa, pb, pc, n3); break;
+        case VK_FMA_I: simd::fma_i64(pa, pb, pc, n3); break;
+        case VK_SCALE_I: simd::scale_i64(pa, pb, vars[c], n2); break;
+        case VK_SUM_I: vars[a] = simd::sum_i64(pb, nb); break;
+        case VK_MIN_I: vars[a] = simd::min_i64(pb, nb); break;
+        case VK_MAX_I: vars[a] = simd::max_i64(pb, nb); break;
+        case VK_DOT_I: vars[a] = simd::dot_i64(pb, pc, std::min(nb, nc)); break;
+        case VK_ADD_F: simd::add_f64(fa, fb, fc, n3); break;
+        case VK_MUL_F: simd::mul_f64(fa, fb, fc, n3); break;
+        case VK_FMA_F: simd::fma_f64(fa, fb, fc, n3); break;
+        case VK_SCALE_F: simd::scale_f64(fa, fb, as_f64(vars[c]), n2); break;
+        case VK_SUM_F: vars[a] = f64_bits(simd::sum_f64(fb, nb)); break;
+        case VK_MIN_F: vars[a] = f64_bits(simd::min_f64(fb, nb)); break;
+        case VK_MAX_F: vars[a] = f64_bits(simd::max_f64(fb, nb)); break;
+        default: vars[a] = f64_bits(simd::dot_f64(fb, fc, std::min(nb, nc))); break;
+        }
+    }
+
+    // 單次執行的字串（OP_SCAT / OP_DADD 串接、OP_DUNBOX 轉字串的結果），run_program 返回時整批釋放。
+    // 執行期代號（正數）有兩種：
+    //   STR_INLINE 位元設定者為內嵌字串，7 bytes 以內的內容直接放在代號裡（位元 56..58 為長度），不配置；
+    //   其餘為 recs 的索引 + 1。內容以 bump 方式配置在 arena 的區塊內，位址不變，OutputSink::line_ref 可直接引用。
+    // 長字串的串接只建 rope 節點（左右代號 + 長度），要用到連續內容（輸出、比較、轉數值）時才攤平並記住結果；
+    // 左邊恰好是最後配置的字串且區塊還有空間時，直接接在它後面，不建節點
+    struct StrHeap
+    {
+        static const int64_t STR_INLINE = (int64_t)1 << 62;
+        static const size_t INLINE_MAX = 7;
+        static const size_t ROPE_MIN = 64;           // 短於此長度的串接結果直接複製
+        static const size_t CHUNK = (size_t)64 << 10; // arena 區塊大小；較大的字串單獨一塊
+
+        struct Rec
+        {
+            const char *p; // nullptr 為尚未攤平的 rope
+            size_t len;
+            int64_t l, r; // rope 的左右代號
+        };
+
+        const StrConst *consts;
+        size_t nconsts;
+        std::vector<Rec> recs;
+        std::vector<std::unique_ptr<char[]>> chunks;
+        char *cur = nullptr, *end = nullptr;
+        int64_t total = 0; // arena 與節點佔用的 bytes，上限為 STRING_HEAP_MAX
+
+        StrHeap(const StrConst *c, size_t n) : consts(c), nconsts(n) {}
+
+        bool charge(size_t n)
+        {
+            if (total + (int64_t)n > STRING_HEAP_MAX)
+                return false;
+            total += (int64_t)n;
+            return true;
+        }
+        // 超過上限時回傳 nullptr
+        char *alloc(size_t n)
+        {
+            if (!charge(n))
+                return nullptr;
+            if (n > (size_t)(end - cur))
+            {
+                if (n > CHUNK / 4)
+                {
+                    chunks.emplace_back(new char[n]); // 大字串單獨一塊，不浪費目前區塊的剩餘空間
+                    return chunks.back().get();
+                }
+                chunks.emplace_back(new char[CHUNK]);
+                cur = chunks.back().get();
+                end = cur + CHUNK;
+            }
+            char *p = cur;
+            cur += n;
+            return p;
+        }
+        int64_t push(const Rec &r)
+        {
+            if (!charge(sizeof(Rec)))
+                return 0;
+            recs.push_back(r);
+            return (int64_t)recs.size();
+        }
+        static int64_t inline_str(const char *s, size_t n)
+        {
+            int64_t h = STR_INLINE | (int64_t)n << 56;
+            for (size_t i = 0; i < n; ++i)
+                h |= (int64_t)(uint8_t)s[i] << (8 * i);
+            return h;
+        }
+        Rec *rec(int64_t h)
+        {
+            return h > 0 && h < STR_INLINE && (uint64_t)h <= recs.size() ? &recs[(size_t)h - 1] : nullptr;
+        }
+
+        size_t size(int64_t h)
+        {
+            if (h < 0)
+                return (uint64_t)-(h + 1) < nconsts ? consts[-(h + 1)].len : 0;
+            if (h & STR_INLINE)
+                return (size_t)(h >> 56 & 7);
+            Rec *r = rec(h);
+            return r ? r->len : 0;
+        }
+
+        // 內容必須有 n bytes；超過上限時回傳 0（空字串）
+        int64_t make(const char *s, size_t n)
+        {
+            if (n <= INLINE_MAX)
+                return n ? inline_str(s, n) : 0;
+            char *p = alloc(n);
+            if (!p)
+                return 0;
+            std::memcpy(p, s, n);
+            return push(Rec{p, n, 0, 0});
+        }
+
+        int64_t cat(int64_t a, int64_t b)
+        {
+            const size_t na = size(a), nb = size(b);
+            if (!nb)
+                return na ? a : 0;
+            if (!na)
+                return b;
+            if (na + nb > (size_t)STRING_HEAP_MAX)
+                return 0;
+            char ta[8], tb[8];
+            const char *pa, *pb;
+            size_t la, lb;
+            Rec *ra = rec(a), *rb = rec(b);
+            if (ra && ra->p && ra->p + na == cur && nb <= (size_t)(end - cur) && !(rb && !rb->p))
+            {
+                // a 是最後配置的字串：接在後面，新字串與 a 共用前段（a 的內容不變）
+                const char *p = ra->p;
+                get(b, tb, pb, lb);
+                if (!charge(lb))
+                    return 0;
+                std::memcpy(cur, pb, lb);
+                cur += lb;
+                return push(Rec{p, na + nb, 0, 0});
+            }
+            if (na + nb < ROPE_MIN)
+            {
+                // 兩邊都短，不會是 rope
+                char t[ROPE_MIN];
+                get(a, ta, pa, la);
+                get(b, tb, pb, lb);
+                std::memcpy(t, pa, la);
+                std::memcpy(t + la, pb, lb);
+                return make(t, la + lb);
+            }
+            return push(Rec{nullptr, na + nb, a, b});
+        }
+
+        // 取得連續內容；tmp 至少 8 bytes，放內嵌字串（短於 REF_MIN，line_ref 一定會複製）。
+        // 無效代號、攤平超過上限時視為空字串
+        void get(int64_t h, char *tmp, const char *&p, size_t &n)
+        {
+            p = "";
+            n = 0;
+            if (h < 0)
+            {
+                if ((uint64_t)-(h + 1) < nconsts)
+                {
+                    p = consts[-(h + 1)].s;
+                    n = consts[-(h + 1)].len;
+                }
+                return;
+            }
+            if (h & STR_INLINE)
+            {
+                n = (size_t)(h >> 56 & 7);
+                for (size_t i = 0; i < n; ++i)
+                    tmp[i] = (char)(h >> (8 * i));
+                p = tmp;
+                return;
+            }
+            Rec *r = rec(h);
+            if (!r || (!r->p && !flatten((size_t)h - 1)))
+                return;
+            p = r->p;
+            n = r->len;
+        }
+
+        // 由左而右走訪 rope 複製到新配置的空間（不遞迴，深度不限），結果寫回節點
+        bool flatten(size_t i)
+        {
+            const size_t len = recs[i].len;
+            char *d = alloc(len), *w = d;
+            if (!d)
+                return false;
+            std::vector<int64_t> stack{(int64_t)i + 1};
+            while (!stack.empty())
+            {
+                const int64_t h = stack.back();
+                stack.pop_back();
+                Rec *r = rec(h);
+                if (r && !r->p)
+                {
+                    stack.push_back(r->r);
+                    stack.push_back(r->l);
+                    continue;
+                }
+                char tmp[8];
+                const char *p;
+                size_t n;
+                get(h, tmp, p, n); // 已是連續內容，不會再攤平
+                std::memcpy(w, p, n);
+                w += n;
+            }
+            recs[i].p = d;
+            return true;
+        }
+    };
+
+    // ---- 動態值（OP_D*）：p 指向 pair，p[0] 為標記、p[1] 為內容 ----
+    // 未知標記視為 VT_NIL
+    static inline int64_t dyn_tag(const int64_t *p) { return (uint64_t)p[0] < VT_COUNT ? p[0] : (int64_t)VT_NIL; }
+    static inline bool dyn_intlike(int64_t t) { return t == VT_NIL || t == VT_I64 || t == VT_BOOL; }
+
+    // 字串轉數值：前後空白略過，空字串為 0，其餘無法完整解析者為 NaN
+    static double str_to_f64(const char *p, size_t n)
+    {
+        std::string t(p, n);
+        const char *b = t.c_str();
+        while (*b == ' ' || *b == '\t' || *b == '\n' || *b == '\r')
+            ++b;
+        if (!*b)
+            return 0.0;
+        char *e = nullptr;
+        double d = std::strtod(b, &e);
+        while (*e == ' ' || *e == '\t' || *e == '\n' || *e == '\r')
+            ++e;
+        return *e ? std::nan("") : d;
+    }
+    static int64_t dyn_i64(const int64_t *p, StrHeap &H)
+    {
+        switch (dyn_tag(p))
+        {
+        case VT_I64: return p[1];
+        case VT_BOOL: return p[1] != 0;
+        case VT_F64: return vm_f2i(as_f64(p[1]));
+        case VT_STR:
+        {
+            char tmp[8];
+            const char *s;
+            size_t n;
+            H.get(p[1], tmp, s, n);
+            return vm_f2i(str_to_f64(s, n));
+        }
+        default: return 0;
+        }
+    }
+    static double dyn_f64(const int64_t *p, StrHeap &H)
+    {
+        switch (dyn_tag(p))
+        {
+        case VT_I64: return (double)p[1];
+        case VT_BOOL: return p[1] != 0 ? 1.0 : 0.0;
+        case VT_F64: return as_f64(p[1]);
+        case VT_STR:
+        {
+            char tmp[8];
+            const char *s;
+            size_t n;
+            H.get(p[1], tmp, s, n);
+            return str_to_f64(s, n);
+        }
+        default: return 0.0;
+        }
+    }
+    static bool dyn_truthy(const int64_t *p, StrHeap &H)
+    {
+        switch (dyn_tag(p))
+        {
+        case VT_I64:
+        case VT_BOOL: return p[1] != 0;
+        case VT_F64:
+        {
+            const double d = as_f64(p[1]);
+            return d == d && d != 0.0;
+        }
+        case VT_STR: return H.size(p[1]) != 0;
+        default: return false;
+        }
+    }
+    // 有限小數的最短表示：可還原成同一個 double 的最少有效位數（%.*e 由 1 位試到 17 位）。
+    // js 同 Number#toString（小數點位置在 (-6, 21] 之外用指數），py 同 repr（指數在 [-4, 16) 之外用指數，
+    // 指數至少兩位，整數值補上 ".0"）。-0 印成 -0 / -0.0（同 console.log / print）。回傳長度，buf 至少 48 bytes
+    static size_t fmt_f64_short(double d, bool py, char *buf)
+    {
+        char tmp[40];
+        for (int p = 1; p <= 17; p++)
+        {
+            std::snprintf(tmp, sizeof(tmp), "%.*e", p - 1, d);
+            if (std::strtod(tmp, nullptr) == d)
+                break;
+        }
+        // tmp 為 [-]D[.DDD]e±XX
+        const char *q = tmp;
+        char *w = buf;
+        if (*q == '-')
+            *w++ = *q++;
+        char digits[20];
+        int nd = 0;
+        for (; *q != 'e'; q++)
+            if (*q != '.')
+                digits[nd++] = *q;
+        while (nd > 1 && digits[nd - 1] == '0')
+            nd--;
+        const int exp10 = std::atoi(q + 1);
+        const int point = exp10 + 1; // 小數點在第 point 位數字之後
+        if (py ? (exp10 >= -4 && exp10 < 16) : (point > -6 && point <= 21))
+        {
+            if (point <= 0)
+            {
+                *w++ = '0';
+                *w++ = '.';
+                for (int i = point; i < 0; i++)
+                    *w++ = '0';
+                std::memcpy(w, digits, (size_t)nd);
+                w += nd;
+            }
+            else if (point >= nd)
+            {
+                std::memcpy(w, digits, (size_t)nd);
+                w += nd;
+                for (int i = nd; i < point; i++)
+                    *w++ = '0';
+                if (py)
+                {
+                    *w++ = '.';
+                    *w++ = '0';
+                }
+            }
+            else
+            {
+                std::memcpy(w, digits, (size_t)point);
+                w += point;
+                *w++ = '.';
+                std::memcpy(w, digits + point, (size_t)(nd - point));
+                w += nd - point;
+            }
+            return (size_t)(w - buf);
+        }
+        *w++ = digits[0];
+        if (nd > 1)
+        {
+            *w++ = '.';
+            std::memcpy(w, digits + 1, (size_t)(nd - 1));
+            w += nd - 1;
+        }
+        const int k = std::snprintf(w, 8, py ? "e%+03d" : "e%+d", exp10);
+        return (size_t)(w - buf) + (size_t)(k > 0 ? k : 0);
+    }
+
+    // 轉成字串：字串直接引用 H，其餘寫入 buf（至少 48 bytes）
+    static void dyn_str(const int64_t *p, unsigned fmt, StrHeap &H, char *buf, const char *&s, size_t &n)
+    {
+        const bool py = (fmt & DF_PY) != 0;
+        switch (dyn_tag(p))
+        {
+        case VT_STR:
+            H.get(p[1], buf, s, n);
+            return;
+        case VT_I64:
+            n = fmt_i64(buf + 24, p[1]);
+            s = buf + 24 - n;
+            return;
+        case VT_BOOL:
+            s = p[1] ? (py ? "True" : "true") : (py ? "False" : "false");
+            break;
+        case VT_F64:
+        {
+            const double d = as_f64(p[1]);
+            if (d != d)
+                s = py ? "nan" : "NaN";
+            else if (d == HUGE_VAL || d == -HUGE_VAL)
+                s = d > 0 ? (py ? "inf" : "Infinity") : (py ? "-inf" : "-Infinity");
+            else
+            {
+                n = fmt_f64_short(d, py, buf);
+                s = buf;
+                return;
+            }
+            break;
+        }
+        default:
+            s = py ? "None" : "null";
+            break;
+        }
+        n = std::strlen(s);
+    }
+    // js 的 String()：同 dyn_str，但 -0 為 "0"
+    static void dyn_js_str(const int64_t *p, StrHeap &H, char *buf, const char *&s, size_t &n)
+    {
+        if (dyn_tag(p) == VT_F64 && as_f64(p[1]) == 0.0)
+        {
+            s = "0";
+            n = 1;
+            return;
+        }
+        dyn_str(p, DF_JS, H, buf, s, n);
+    }
+    static int64_t dyn_to_str(const int64_t *p, StrHeap &H)
+    {
+        if (dyn_tag(p) == VT_STR)
+            return p[1];
+        char buf[48];
+        const char *s;
+        size_t n;
+        dyn_js_str(p, H, buf, s, n);
+        return H.make(s, n);
+    }
+
+    // OP_DUNBOX
+    static int64_t dyn_unbox(unsigned tag, const int64_t *p, StrHeap &H)
+    {
+        switch (tag)
+        {
+        case VT_I64: return dyn_i64(p, H);
+        case VT_F64: return f64_bits(dyn_f64(p, H));
+        case VT_BOOL: return dyn_truthy(p, H);
+        case VT_STR: return dyn_to_str(p, H);
+        default: return 0;
+        }
+    }
+
+    // OP_FFLMOD：fmod 的結果不為 0 且與除數異號時加上除數，為 0 時帶除數的正負號
+    static double f64_flmod(double a, double b)
+    {
+        const double r = std::fmod(a, b);
+        if (r == 0)
+            return std::copysign(0.0, b);
+        return (r < 0) != (b < 0) ? r + b : r;
+    }
+
+    // OP_DADD … OP_DFLMOD；d 可與 a、b 重疊（先讀後寫）
+    static void dyn_arith(unsigned op, int64_t *d, const int64_t *a, const int64_t *b, StrHeap &H)
+    {
+        const int64_t ta = dyn_tag(a), tb = dyn_tag(b);
+        if (op == OP_DADD && (ta == VT_STR || tb == VT_STR))
+        {
+            const int64_t r = H.cat(dyn_to_str(a, H), dyn_to_str(b, H));
+            d[0] = VT_STR;
+            d[1] = r;
+            return;
+        }
+        if (op != OP_DDIV && dyn_intlike(ta) && dyn_intlike(tb))
+        {
+            const uint64_t x = (uint64_t)dyn_i64(a, H), y = (uint64_t)dyn_i64(b, H);
+            int64_t r;
+            switch (op)
+            {
+            case OP_DADD: r = (int64_t)(x + y); break;
+            case OP_DSUB: r = (int64_t)(x - y); break;
+            case OP_DMUL: r = (int64_t)(x * y); break;
+            case OP_DMOD: r = vm_mod((int64_t)x, (int64_t)y); break;
+            default: r = vm_flmod((int64_t)x, (int64_t)y); break;
+            }
+            d[0] = VT_I64;
+            d[1] = r;
+            return;
+        }
+        const double x = dyn_f64(a, H), y = dyn_f64(b, H);
+        double r;
+        switch (op)
+        {
+        case OP_DADD: r = x + y; break;
+        case OP_DSUB: r = x - y; break;
+        case OP_DMUL: r = x * y; break;
+        case OP_DDIV: r = x / y; break;
+        case OP_DMOD: r = std::fmod(x, y); break;
+        default: r = f64_flmod(x, y); break;
+        }
+        d[0] = VT_F64;
+        d[1] = f64_bits(r);
+    }
+
+    // OP_DEQ … OP_DGE
+    static bool dyn_cmp(unsigned op, const int64_t *a, const int64_t *b, StrHeap &H)
+    {
+        const int64_t ta = dyn_tag(a), tb = dyn_tag(b);
+        int c;
+        if (ta == VT_STR && tb == VT_STR)
+        {
+            char ta[8], tb[8];
+            const char *sa, *sb;
+            size_t na, nb;
+            H.get(a[1], ta, sa, na);
+            H.get(b[1], tb, sb, nb);
+            int k = std::memcmp(sa, sb, std::min(na, nb));
+            c = k ? k : (na > nb) - (na < nb);
+        }
+        else
+        {
+            if ((op == OP_DEQ || op == OP_DNE) &&
+                ((ta == VT_NIL) != (tb == VT_NIL) || (ta == VT_STR) != (tb == VT_STR)))
+                return op == OP_DNE;
+            if (dyn_intlike(ta) && dyn_intlike(tb))
+            {
+                const int64_t x = dyn_i64(a, H), y = dyn_i64(b, H);
+                c = (x > y) - (x < y);
+            }
+            else
+            {
+                const double x = dyn_f64(a, H), y = dyn_f64(b, H);
+                if (x != x || y != y)
+                    return op == OP_DNE; // 無序：只有 NE 成立
+                c = (x > y) - (x < y);
+            }
+        }
+        switch (op)
+        {
+        case OP_DEQ: return c == 0;
+        case OP_DNE: return c != 0;
+        case OP_DLT: return c < 0;
+        case OP_DLE: return c <= 0;
+        case OP_DGT: return c > 0;
+        default: return c >= 0;
+        }
+    }
+
+    // OP_DJEQ / OP_DJNE（js 的 ==）：型別不同時布林與字串都轉成數值再比較
+    static bool dyn_js_eq(const int64_t *a, const int64_t *b, StrHeap &H)
+    {
+        const int64_t ta = dyn_tag(a), tb = dyn_tag(b);
+        if (ta == VT_NIL || tb == VT_NIL)
+            return ta == tb;
+        if (ta == tb || (dyn_intlike(ta) && dyn_intlike(tb)))
+            return dyn_cmp(OP_DEQ, a, b, H);
+        return dyn_f64(a, H) == dyn_f64(b, H); // NaN 不等於任何值
+    }
+
+    // 每次派發時把距上次派發的時間記到前一條指令（含其派發成本）
+    struct ProfState
+    {
+        VmProfile *p;
+        uint64_t t;
+        unsigned last;   // 0 不是操作碼，只收進入迴圈前的零頭
+        size_t last_i;   // 前一條指令的索引；尚未派發時為 SIZE_MAX
+    };
+    static inline void prof_step(ProfState &s, unsigned op, size_t i)
+    {
+        uint64_t now = vm_ticks();
+        s.p->ticks[s.last] += now - s.t;
+        if (s.last_i != SIZE_MAX)
+            s.p->insn_ticks[s.last_i] += now - s.t;
+        s.t = now;
+        s.last = op;
+        s.last_i = i;
+        s.p->count[op]++;
+        s.p->insn_count[i]++;
+    }
+
+    // 單次執行的呼叫堆疊（OP_CALL）：函式的槽位窗口連續排列，第一次呼叫時一次配置（calloc，未觸及的分頁不佔實體記憶體），
+    // 之後的呼叫只移動指標。主程式的窗口仍是呼叫端傳入的 vars，第一層函式從堆疊開頭起算
+    struct CallStack
+    {
+        struct Ret
+        {
+            const Insn *call; // 呼叫端的 OP_CALL（返回時寫入其 dst，從下一條繼續）
+            int64_t *fp;      // 呼叫端的窗口
+            uint32_t frame;   // 呼叫端的窗口大小
+        };
+        int64_t *base = nullptr, *end = nullptr;
+        Ret *rets = nullptr;
+        uint32_t depth = 0;
+        uint32_t slots = CALL_STACK_SLOTS, depth_max = CALL_DEPTH_MAX; // goroutine 用較小的 GO_*
+
+        CallStack() = default;
+        CallStack(const CallStack &) = delete;
+        CallStack &operator=(const CallStack &) = delete;
+        ~CallStack()
+        {
+            std::free(base);
+            std::free(rets);
+        }
+
+        // 推入返回紀錄並回傳被呼叫者的窗口；need 為任何窗口可能用到的槽位數（標頭 frame）。超出上限時回傳 nullptr
+        int64_t *push(const Insn *call, int64_t *fp, uint32_t frame, uint32_t need)
+        {
+            if (!base)
+            {
+                base = (int64_t *)std::calloc(slots, sizeof(int64_t));
+                rets = (Ret *)std::malloc(sizeof(Ret) * depth_max);
+                if (!base || !rets)
+                    return nullptr;
+                end = base + slots;
+            }
+            int64_t *nfp = depth ? fp + frame : base;
+            if (depth == depth_max || (size_t)(end - nfp) < need)
+                return nullptr;
+            rets[depth++] = Ret{call, fp, frame};
+            return nfp;
+        }
+    };
+
+    // OP_CALL / OP_TAILCALL：參數先取出再寫入（新窗口可能與來源重疊），其餘 frame 個以內的槽位歸零
+    static inline void vm_enter(int64_t *fp, const int64_t *vars, const NativeCall &nc, uint32_t frame)
+    {
+        int64_t argv[CALL_MAX_ARGS];
+        for (uint32_t k = 0; k < nc.argc; k++)
+            argv[k] = vars[nc.argv[k]];
+        std::memcpy(fp, argv, nc.argc * sizeof(int64_t));
+        std::memset(fp + nc.argc, 0, (frame - nc.argc) * sizeof(int64_t));
+    }
+
+    // ---- 平行工作（OP_SPAWN / OP_JOIN）----
+    // 工作借用的狀態：陣列屬於發出 SPAWN 的那次執行，呼叫堆疊屬於執行工作的執行緒。
+    // goroutine 的版本另外帶排程器、目前的 goroutine 與所在的工作者（見下方 GoSched）
+    class GoSched;
+    struct Goroutine;
+    struct TaskEnv
+    {
+        ArrayHeap *heap;
+        CallStack *stack;
+        uint16_t fault; // VM_TASK_FAULT 時為不允許的操作碼
+        GoSched *sched = nullptr;
+        Goroutine *g = nullptr;
+        unsigned worker = 0;
+    };
+
+    // run_loop 的三個版本：主程式、平行工作（OP_SPAWN 的塊）、goroutine
+    enum RunMode
+    {
+        RUN_MAIN,
+        RUN_TASK,
+        RUN_GO,
+    };
+
+    template <bool Profile, int Mode>
+    static int run_loop(Program &prog, int64_t *vars, OutputSink &out, VmProfile *prof, uint32_t start, TaskEnv *env);
+
+    // 一個 OP_SPAWN：發出時的窗口副本與範圍
+    struct TaskGroup
+    {
+        const NativeCall *red; // 歸約槽位與方式
+        uint32_t target;       // 工作入口（指令索引）
+        uint32_t lo, hi;       // 範圍槽位
+        int64_t from;          // 範圍起點
+        uint64_t count;        // 範圍長度（空範圍為 0）
+        uint32_t chunks;
+        std::vector<int64_t> snap;
+    };
+
+    static void task_spawn(std::vector<TaskGroup> &pending, const Insn *ip, const NativeCall &red, const int64_t *vars,
+                           uint32_t frame)
+    {
+        TaskGroup g;
+        g.red = &red;
+        g.target = ip->c;
+        g.lo = ip->a;
+        g.hi = ip->b;
+        g.from = vars[ip->a];
+        g.count = vars[ip->b] > vars[ip->a] ? (uint64_t)vars[ip->b] - (uint64_t)vars[ip->a] : 0;
+        g.chunks = (uint32_t)std::min<uint64_t>(g.count, TASK_CHUNKS);
+        g.snap.assign(vars, vars + frame);
+        pending.push_back(std::move(g));
+    }
+
+    // 第 k 塊的範圍：長度相差至多 1，較長的在前
+    static inline void task_range(const TaskGroup &g, uint32_t k, int64_t &lo, int64_t &hi)
+    {
+        const uint64_t base = g.count / g.chunks, rem = g.count % g.chunks;
+        lo = (int64_t)((uint64_t)g.from + k * base + std::min<uint64_t>(k, rem));
+        hi = (int64_t)((uint64_t)lo + base + (k < rem ? 1 : 0));
+    }
+
+    // 歸約槽位在工作中的初值；RD_ARG 保留原值
+    static inline int64_t reduce_init(uint8_t r, int64_t v)
+    {
+        const bool f = r & RD_F64;
+        switch (r & RD_KIND)
+        {
+        case RD_SUM: return 0; // f64 的 0.0 也是全 0
+        case RD_PROD: return f ? f64_bits(1.0) : 1;
+        case RD_MAX: return f ? f64_bits(-HUGE_VAL) : INT64_MIN;
+        case RD_MIN: return f ? f64_bits(HUGE_VAL) : INT64_MAX;
+        default: return v;
+        }
+    }
+
+    static inline bool reduce_better(uint8_t r, int64_t v, int64_t cur)
+    {
+        const bool mx = (r & RD_KIND) == RD_MAX, tie = r & RD_TIE;
+        if (r & RD_F64)
+        {
+            const double a = as_f64(v), b = as_f64(cur);
+            return mx ? (tie ? a >= b : a > b) : (tie ? a <= b : a < b);
+        }
+        return mx ? (tie ? v >= cur : v > cur) : (tie ? v <= cur : v < cur);
+    }
+
+    // 依塊的順序把一組的結果併回 vars；res[k * SPAWN_MAX_REDUCE + r] 為第 k 塊第 r 個歸約槽位的值
+    static void task_reduce(const TaskGroup &g, const int64_t *res, int64_t *vars)
+    {
+        const NativeCall &R = *g.red;
+        for (uint32_t r = 0; r < R.argc; r++)
+        {
+            const uint8_t kind = R.red[r];
+            const bool f = kind & RD_F64;
+            int64_t acc = vars[R.argv[r]];
+            switch (kind & RD_KIND)
+            {
+            case RD_SUM:
+            case RD_PROD:
+                for (uint32_t k = 0; k < g.chunks; k++)
+                {
+                    const int64_t v = res[k * SPAWN_MAX_REDUCE + r];
+                    if ((kind & RD_KIND) == RD_SUM)
+                        acc = f ? f64_bits(as_f64(acc) + as_f64(v)) : (int64_t)((uint64_t)acc + (uint64_t)v);
+                    else
+                        acc = f ? f64_bits(as_f64(acc) * as_f64(v)) : (int64_t)((uint64_t)acc * (uint64_t)v);
+                }
+                vars[R.argv[r]] = acc;
+                break;
+            case RD_MAX:
+            case RD_MIN:
+            {
+                uint32_t win = UINT32_MAX;
+                for (uint32_t k = 0; k < g.chunks; k++)
+                {
+                    const int64_t v = res[k * SPAWN_MAX_REDUCE + r];
+                    if (reduce_better(kind, v, acc))
+                    {
+                        acc = v;
+                        win = k;
+                    }
+                }
+                if (win == UINT32_MAX)
+                    break;
+                vars[R.argv[r]] = acc;
+                for (uint32_t q = r + 1; q < R.argc && (R.red[q] & RD_KIND) == RD_ARG; q++)
+                    vars[R.argv[q]] = res[win * SPAWN_MAX_REDUCE + q];
+                break;
+            }
+            default:
+                break; // RD_ARG：隨前面的 RD_MAX / RD_MIN 處理
+            }
+        }
+    }
+
+    // Chase–Lev work-stealing 佇列：擁有者在 bottom 端 push / pop，其他執行緒從 top 端偷。
+    // OP_JOIN 的項目為塊的區間 [c0, c1)；擁有者每次把區間對半、後半留在佇列，同時存在的項目不超過 log2(塊數) + 1 個。
+    // goroutine 排程器的項目為 Goroutine 指標，滿了（full）改放全域佇列
+    template <int64_t CAP = 64>
+    struct TaskDeque
+    {
+        alignas(64) std::atomic<int64_t> top{0};
+        alignas(64) std::atomic<int64_t> bottom{0};
+        std::atomic<uint64_t> buf[CAP];
+
+        void push(uint64_t x)
+        {
+            const int64_t b = bottom.load(std::memory_order_relaxed);
+            // 項目本身以 release 寫入、steal 以 acquire 讀取：goroutine 經由這裡交給別的執行緒時，其內容一併可見
+            buf[b & (CAP - 1)].store(x, std::memory_order_release);
+            std::atomic_thread_fence(std::memory_order_release);
+            bottom.store(b + 1, std::memory_order_relaxed);
+        }
+        bool pop(uint64_t &x)
+        {
+            const int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+            bottom.store(b, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            int64_t t = top.load(std::memory_order_relaxed);
+            if (t > b)
+            {
+                bottom.store(b + 1, std::memory_order_relaxed);
+                return false;
+            }
+            x = buf[b & (CAP - 1)].load(std::memory_order_relaxed);
+            if (t < b)
+                return true;
+            // 最後一項：與偷的一方競爭
+            const bool won = top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return won;
+        }
+        bool steal(uint64_t &x)
+        {
+            int64_t t = top.load(std::memory_order_acquire);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            const int64_t b = bottom.load(std::memory_order_acquire);
+            if (t >= b)
+                return false;
+            x = buf[t & (CAP - 1)].load(std::memory_order_acquire);
+            return top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+        }
+        // 只由擁有者呼叫；top 讀到舊值時偏向判定為滿
+        bool full() const
+        {
+            return bottom.load(std::memory_order_relaxed) - top.load(std::memory_order_acquire) >= CAP;
+        }
+    };
+
+    // 一次 OP_JOIN：所有待執行的組，塊從 0 連續編號
+    struct TaskJob
+    {
+        Program *prog;
+        ArrayHeap *heap;
+        OutputSink *out; // 工作不輸出，只為了 run_loop 的參數
+        std::vector<TaskGroup> *groups;
+        std::vector<uint32_t> first;  // 各組第一塊的編號
+        std::vector<int64_t> results; // 每塊 SPAWN_MAX_REDUCE 個歸約值
+        std::vector<int> status;
+        std::vector<uint16_t> fault;
+        uint32_t chunks = 0;
+        std::atomic<uint32_t> left{0}; // 尚未完成的塊數
+    };
+
+    struct TaskWorker
+    {
+        TaskDeque<> dq;
+        CallStack stack;
+        std::vector<int64_t> frame; // 工作的私有窗口（標頭 frame 個槽位）
+        uint32_t seed;
+    };
+
+    static void task_run(TaskJob &j, TaskWorker &w, uint32_t c)
+    {
+        const size_t gi = (size_t)(std::upper_bound(j.first.begin(), j.first.end(), c) - j.first.begin()) - 1;
+        const TaskGroup &g = (*j.groups)[gi];
+        const uint32_t k = c - j.first[gi];
+        const NativeCall &R = *g.red;
+        if (w.frame.size() < j.prog->frame)
+            w.frame.resize(j.prog->frame);
+        int64_t *vars = w.frame.data();
+        std::memcpy(vars, g.snap.data(), g.snap.size() * sizeof(int64_t));
+        std::memset(vars + g.snap.size(), 0, (j.prog->frame - g.snap.size()) * sizeof(int64_t));
+        task_range(g, k, vars[g.lo], vars[g.hi]);
+        for (uint32_t r = 0; r < R.argc; r++)
+            vars[R.argv[r]] = reduce_init(R.red[r], vars[R.argv[r]]);
+        TaskEnv env{j.heap, &w.stack, 0};
+        w.stack.depth = 0;
+        j.status[c] = run_loop<false, RUN_TASK>(*j.prog, vars, *j.out, nullptr, g.target, &env);
+        j.fault[c] = env.fault;
+        for (uint32_t r = 0; r < R.argc; r++)
+            j.results[(size_t)c * SPAWN_MAX_REDUCE + r] = vars[R.argv[r]];
+    }
+
+    // 每個核心一個工作者；0 號是呼叫 JOIN 的執行緒，其餘為常駐的執行緒（沒有工作時睡在條件變數上）
+    class TaskPool
+    {
+    public:
+        explicit TaskPool(unsigned n)
+        {
+            for (unsigned i = 0; i < n; i++)
+            {
+                workers_.emplace_back(new TaskWorker());
+                workers_.back()->seed = 0x9E3779B9u * (i + 1);
+            }
+            for (unsigned i = 1; i < n; i++)
+                std::thread(&TaskPool::loop, this, i).detach();
+        }
+
+        void run(TaskJob &j)
+        {
+            std::lock_guard<std::mutex> one(run_m_); // 多個 Vm 同時 JOIN 時依序使用工作者
+            if (workers_.size() == 1 || j.chunks == 1)
+            {
+                for (uint32_t c = 0; c < j.chunks; c++)
+                    task_run(j, *workers_[0], c);
+                return;
+            }
+            j.left.store(j.chunks, std::memory_order_relaxed);
+            {
+                std::lock_guard<std::mutex> lk(m_);
+                job_ = &j;
+                ++epoch_;
+            }
+            cv_.notify_all();
+            workers_[0]->dq.push((uint64_t)j.chunks);
+            work(0, j);
+            std::unique_lock<std::mutex> lk(m_);
+            done_.wait(lk, [&] { return busy_ == 0; });
+            job_ = nullptr;
+        }
+
+    private:
+        std::vector<std::unique_ptr<TaskWorker>> workers_;
+        std::mutex run_m_, m_;
+        std::condition_variable cv_, done_;
+        TaskJob *job_ = nullptr;
+        uint64_t epoch_ = 0;
+        unsigned busy_ = 0; // 正在參與目前工作的常駐執行緒數
+
+        void loop(unsigned id)
+        {
+            uint64_t seen = 0;
+            for (;;)
+            {
+                TaskJob *j;
+                {
+                    std::unique_lock<std::mutex> lk(m_);
+                    cv_.wait(lk, [&] { return epoch_ != seen; });
+                    seen = epoch_;
+                    j = job_;
+                    if (!j)
+                        continue; // 醒得太晚，這次 JOIN 已經結束
+                    ++busy_;
+                }
+                work(id, *j);
+                std::lock_guard<std::mutex> lk(m_);
+                if (--busy_ == 0)
+                    done_.notify_all();
+            }
+        }
+
+        // 先做自己佇列裡的，空了就從其他工作者偷，直到所有的塊都完成
+        void work(unsigned id, TaskJob &j)
+        {
+            TaskWorker &w = *workers_[id];
+            unsigned idle = 0;
+            while (j.left.load(std::memory_order_acquire) != 0)
+            {
+                uint64_t r;
+                if (!w.dq.pop(r) && !steal(id, r))
+                {
+                    if (++idle > 64)
+                        std::this_thread::yield();
+                    continue;
+                }
+                idle = 0;
+                uint32_t c0 = (uint32_t)(r >> 32), c1 = (uint32_t)r;
+                while (c1 - c0 > 1)
+                {
+                    const uint32_t mid = c0 + (c1 - c0) / 2;
+                    w.dq.push((uint64_t)mid << 32 | c1);
+                    c1 = mid;
+                }
+                task_run(j, w, c0);
+                j.left.fetch_sub(1, std::memory_order_acq_rel);
+            }
+        }
+
+        bool steal(unsigned id, uint64_t &r)
+        {
+            TaskWorker &w = *workers_[id];
+            const unsigned n = (unsigned)workers_.size();
+            w.seed = w.seed * 1103515245u + 12345u;
+            for (unsigned k = 0, v = (w.seed >> 8) % n; k < n; k++, v = v + 1 == n ? 0 : v + 1)
+                if (v != id && workers_[v]->dq.steal(r))
+                    return true;
+            return false;
+        }
+    };
+
+    static unsigned task_threads()
+    {
+        if (const char *e = std::getenv("ZHCL_THREADS"))
+        {
+            long v = std::strtol(e, nullptr, 10);
+            if (v > 0)
+                return (unsigned)std::min(v, 1024L);
+        }
+        unsigned n = std::thread::hardware_concurrency();
+        return n ? n : 1;
+    }
+
+    // 第一次 JOIN 時建立；常駐執行緒到行程結束才由系統收回，所以不解構
+    static TaskPool &task_pool()
+    {
+        static TaskPool *pool = new TaskPool(task_threads());
+        return *pool;
+    }
+
+    // OP_JOIN：執行 pending 的所有組並依序歸約。任一塊失敗時不歸約，回傳編號最小的那塊的狀態碼
+    static int task_join(Program &prog, ArrayHeap &heap, OutputSink &out, std::vector<TaskGroup> &pending,
+                         int64_t *vars)
+    {
+        TaskJob j;
+        j.prog = &prog;
+        j.heap = &heap;
+        j.out = &out;
+        j.groups = &pending;
+        for (auto &g : pending)
+        {
+            j.first.push_back(j.chunks);
+            j.chunks += g.chunks;
+        }
+        j.results.assign((size_t)j.chunks * SPAWN_MAX_REDUCE, 0);
+        j.status.assign(j.chunks, VM_OK);
+        j.fault.assign(j.chunks, 0);
+        if (j.chunks)
+            task_pool().run(j);
+        int status = VM_OK;
+        for (uint32_t c = 0; c < j.chunks; c++)
+        {
+            if (j.status[c] == VM_OK)
+                continue;
+            status = j.status[c];
+            out.flush();
+            if (status == VM_TASK_FAULT)
+                std::fprintf(stderr, "[vm] %s is not allowed in a parallel task\n", op_name((uint8_t)j.fault[c]));
+            else
+                std::fprintf(stderr, "[vm] call stack overflow in a parallel task\n");
+            break;
+        }
+        if (status == VM_OK)
+            for (size_t g = 0; g < pending.size(); g++)
+                task_reduce(pending[g], j.results.data() + (size_t)j.first[g] * SPAWN_MAX_REDUCE, vars);
+        pending.clear();
+        return status;
+    }
+
+    // ---- goroutine 與 channel（OP_GO … OP_SELECT）----
+    // goroutine 是無堆疊的協程：讓出時只保存 run_loop 的位置（pc / vars / frame）與自己的呼叫堆疊，
+    // 由少量 OS 執行緒（ZHCL_THREADS，預設為核心數）以 work-stealing 佇列多工執行（M:N）。
+    // run_loop 的 goroutine 版本除了 VM_* 之外還會回傳下列內部狀態碼
+    const int GO_PARK = -1;  // 阻塞在 channel 上，已登記在等待佇列（或永遠阻塞），由喚醒者重新排入
+    const int GO_YIELD = -2; // 時間片用完，排到全域佇列尾端
+    const int GO_EXIT = -3;  // OP_END：整個程式結束
+
+    struct Goroutine
+    {
+        uint32_t pc = 0, frame = 0;
+        int64_t *vars = nullptr;
+        std::vector<int64_t> base; // 起始函式的窗口（主程式用 Vm 的窗口）
+        CallStack stack;
+        bool main = false;
+        // 阻塞時 seq 加一、token 設為 seq 並登記在 channel 的等待佇列；喚醒者以 CAS 把 token 改成 0 取得它
+        // （select 同時登記在多個 channel，只有一個能成功）。seq 不歸零，回收再用後舊的登記自然失效
+        uint64_t seq = 0;
+        std::atomic<uint64_t> token{0};
+        // 喚醒者寫入的結果；被阻塞的指令重新執行時看到 woke 就直接取用
+        bool woke = false, closed = false; // closed：等待送出時 channel 被關閉
+        int64_t val = 0, ok = 0;
+        uint32_t sel = 0;
+    };
+
+    // channel 等待佇列的一項；val 為要送出的值，sel 為 OP_SELECT 的分支編號
+    struct GoWaiter
+    {
+        Goroutine *g;
+        uint64_t seq;
+        int64_t val;
+        uint32_t sel;
+    };
+
+    static inline bool go_claim(const GoWaiter &w)
+    {
+        uint64_t t = w.seq;
+        return w.g->token.compare_exchange_strong(t, 0, std::memory_order_acq_rel, std::memory_order_relaxed);
+    }
+
+    static inline bool go_stale(const GoWaiter &w)
+    {
+        return w.g->token.load(std::memory_order_acquire) != w.seq;
+    }
+
+    static inline void go_pause(unsigned k)
+    {
+        if (k > 64)
+            std::this_thread::yield();
+    }
+
+    static void go_wake(GoSched &S, unsigned w, const GoWaiter &x, int64_t val, int64_t ok, bool closed);
+
+    // channel：緩衝區為 Vyukov 式的 MPMC 環（每格帶序號）。沒有 goroutine 等待時，送出與接收只用原子操作（快速路徑）：
+    // st 的低 40 位元為元素數、其上為進行中的快速路徑數、最高位元 SLOW。有等待者、已關閉、緩衝區要擴充或無緩衝時，
+    // 持有 m 的一方先設 SLOW、等進行中的快速路徑結束，之後獨佔整個 channel（慢速路徑：直接交給等待者、等待佇列、關閉）
+    struct GoChan
+    {
+        static const uint64_t SLOW = 1ull << 63;
+        static const uint64_t INFL = 1ull << 40;
+        static const uint64_t CNT = INFL - 1;
+        static const uint64_t INFL_MASK = SLOW - INFL;
+
+        struct Cell
+        {
+            std::atomic<uint64_t> seq;
+            int64_t v;
+        };
+
+        std::atomic<uint64_t> st{0};
+        std::atomic<uint64_t> head{0}, tail{0};
+        std::atomic<Cell *> ring{nullptr};
+        std::atomic<uint64_t> size{0}; // 環的格數；慢速路徑中依需要倍增到 limit
+        const uint64_t limit;          // 容量：cap，無界時為 CNT
+        std::mutex m;
+        std::deque<GoWaiter> sendq, recvq;
+        bool closed = false;
+
+        explicit GoChan(int64_t cap) : limit(cap < 0 ? CNT : (uint64_t)cap)
+        {
+            if (limit == 0)
+                st.store(SLOW, std::memory_order_relaxed); // 無緩衝：每次都要與對方會合
+        }
+        ~GoChan() { delete[] ring.load(std::memory_order_relaxed); }
+
+        bool try_send(int64_t v)
+        {
+            uint64_t s = st.load(std::memory_order_acquire);
+            do
+                if ((s & SLOW) || (s & CNT) >= size.load(std::memory_order_relaxed))
+                    return false;
+            while (!st.compare_exchange_weak(s, s + INFL + 1, std::memory_order_acquire, std::memory_order_acquire));
+            put(v);
+            st.fetch_sub(INFL, std::memory_order_release);
+            return true;
+        }
+        bool try_recv(int64_t &v)
+        {
+            uint64_t s = st.load(std::memory_order_acquire);
+            do
+                if ((s & SLOW) || (s & CNT) == 0)
+                    return false;
+            while (!st.compare_exchange_weak(s, s + INFL - 1, std::memory_order_acquire, std::memory_order_acquire));
+            v = take();
+            st.fetch_sub(INFL, std::memory_order_release);
+            return true;
+        }
+
+        // 元素數已先加上 / 減去；等這一格的前一輪接收者（或這一輪的送出者）完成
+        void put(int64_t v)
+        {
+            Cell *r = ring.load(std::memory_order_relaxed);
+            const uint64_t n = size.load(std::memory_order_relaxed);
+            const uint64_t pos = tail.fetch_add(1, std::memory_order_relaxed);
+            Cell &c = r[pos % n];
+            for (unsigned k = 0; c.seq.load(std::memory_order_acquire) != pos; k++)
+                go_pause(k);
+            c.v = v;
+            c.seq.store(pos + 1, std::memory_order_release);
+        }
+        int64_t take()
+        {
+            Cell *r = ring.load(std::memory_order_relaxed);
+            const uint64_t n = size.load(std::memory_order_relaxed);
+            const uint64_t pos = head.fetch_add(1, std::memory_order_relaxed);
+            Cell &c = r[pos % n];
+            for (unsigned k = 0; c.seq.load(std::memory_order_acquire) != pos + 1; k++)
+                go_pause(k);
+            const int64_t v = c.v;
+            c.seq.store(pos + n, std::memory_order_release);
+            return v;
+        }
+
+        // 以下在持有 m 時呼叫。enter：設 SLOW 並等進行中的快速路徑結束
+        void enter()
+        {
+            st.fetch_or(SLOW, std::memory_order_acq_rel);
+            for (unsigned k = 0; st.load(std::memory_order_acquire) & INFL_MASK; k++)
+                go_pause(k);
+        }
+        // 丟掉佇列前端已失效的登記；沒有等待者、未關閉且有緩衝時恢復快速路徑
+        void leave()
+        {
+            while (!sendq.empty() && go_stale(sendq.front()))
+                sendq.pop_front();
+            while (!recvq.empty() && go_stale(recvq.front()))
+                recvq.pop_front();
+            if (!closed && limit && sendq.empty() && recvq.empty())
+                st.fetch_and(~SLOW, std::memory_order_release);
+        }
+        uint64_t count() const { return st.load(std::memory_order_relaxed) & CNT; }
+        void push(int64_t v)
+        {
+            if (count() == size.load(std::memory_order_relaxed))
+                grow();
+            st.fetch_add(1, std::memory_order_relaxed);
+            put(v);
+        }
+        int64_t pop()
+        {
+            st.fetch_sub(1, std::memory_order_relaxed);
+            return take();
+        }
+        // 環倍增（至少 16 格、不超過 limit），現有元素搬到新環的開頭
+        void grow()
+        {
+            const uint64_t n = size.load(std::memory_order_relaxed), cnt = count();
+            const uint64_t h = head.load(std::memory_order_relaxed);
+            const uint64_t nn = std::min<uint64_t>(limit, std::max<uint64_t>(16, n * 2));
+            Cell *old = ring.load(std::memory_order_relaxed), *r = new Cell[nn];
+            for (uint64_t k = 0; k < nn; k++)
+            {
+                r[k].seq.store(k < cnt ? k + 1 : k, std::memory_order_relaxed);
+                r[k].v = k < cnt ? old[(h + k) % n].v : 0;
+            }
+            head.store(0, std::memory_order_relaxed);
+            tail.store(cnt, std::memory_order_relaxed);
+            ring.store(r, std::memory_order_relaxed);
+            size.store(nn, std::memory_order_relaxed);
+            delete[] old;
+        }
+
+        // 不阻塞的送出 / 接收；回傳是否完成。送出到已關閉的 channel 時設 closed_out
+        bool send_now(GoSched &S, unsigned w, int64_t v, bool &closed_out)
+        {
+            if (closed)
+            {
+                closed_out = true;
+                return false;
+            }
+            // 有接收者在等時緩衝區必為空，直接交給它
+            while (!recvq.empty())
+            {
+                const GoWaiter x = recvq.front();
+                recvq.pop_front();
+                if (go_claim(x))
+                {
+                    go_wake(S, w, x, v, 1, false);
+                    return true;
+                }
+            }
+            if (count() < limit)
+            {
+                push(v);
+                return true;
+            }
+            return false;
+        }
+        bool recv_now(GoSched &S, unsigned w, int64_t &v, int64_t &ok)
+        {
+            const bool buffered = count() > 0;
+            if (buffered)
+                v = pop();
+            // 緩衝區的空位補上等待中的送出者；沒有緩衝時直接從它拿
+            while (!sendq.empty())
+            {
+                const GoWaiter x = sendq.front();
+                sendq.pop_front();
+                if (!go_claim(x))
+                    continue;
+                if (buffered)
+                    push(x.val);
+                else
+                    v = x.val;
+                go_wake(S, w, x, 0, 1, false);
+                ok = 1;
+                return true;
+            }
+            if (buffered || closed)
+            {
+                if (!buffered)
+                    v = 0;
+                ok = buffered;
+                return true;
+            }
+            return false;
+        }
+        // 接收者收到零值與 ok = 0，送出者 panic
+        void close_now(GoSched &S, unsigned w)
+        {
+            closed = true;
+            for (const GoWaiter &x : recvq)
+                if (go_claim(x))
+                    go_wake(S, w, x, 0, 0, false);
+            for (const GoWaiter &x : sendq)
+                if (go_claim(x))
+                    go_wake(S, w, x, 0, 0, true);
+            recvq.clear();
+            sendq.clear();
+        }
+    };
+
+    struct GoWorker
+    {
+        TaskDeque<256> dq;
+        uint32_t seed;
+        std::string why; // 這個工作者上 VM_GO_PANIC 的原因
+    };
+
+    // 一次程式執行的 goroutine 排程器。0 號工作者是呼叫 run 的執行緒，其餘在 run 內建立、結束前 join。
+    // 每個工作者先做自己佇列裡的，空了看全域佇列、再從其他工作者偷；都沒有時睡在條件變數上。
+    // live_ 為可執行與執行中的 goroutine 數，只有執行中的 goroutine 能喚醒別人，所以降到 0 即為死結
+    class GoSched
+    {
+    public:
+        std::mutex *out_m = nullptr; // 多於一個工作者時保護輸出與原生函式
+
+        GoSched(Program &prog, OutputSink &out, VmProfile *prof, unsigned n) : prog_(prog), out_(out), prof_(prof)
+        {
+            for (unsigned i = 0; i < n; i++)
+            {
+                workers_.emplace_back(new GoWorker());
+                workers_.back()->seed = 0x9E3779B9u * (i + 1);
+            }
+            if (n > 1)
+                out_m = &out_lock_;
+        }
+        ~GoSched()
+        {
+            const uint64_t n = nchan_.load(std::memory_order_relaxed);
+            for (uint64_t i = 0; i < n; i++)
+                delete chans_[i / CHAN_BLOCK][i % CHAN_BLOCK];
+            for (auto *b : chans_)
+                delete[] b;
+        }
+
+        int run(int64_t *vars)
+        {
+            Goroutine *m = new_g();
+            m->main = true;
+            m->stack.slots = CALL_STACK_SLOTS;
+            m->stack.depth_max = CALL_DEPTH_MAX;
+            m->vars = vars;
+            m->frame = prog_.frame;
+            workers_[0]->dq.push((uint64_t)(uintptr_t)m);
+            std::vector<std::thread> ts;
+            for (unsigned i = 1; i < workers_.size(); i++)
+                ts.emplace_back(&GoSched::loop, this, i);
+            loop(0);
+            for (auto &t : ts)
+                t.join();
+            out_.flush();
+            if (!why_.empty())
+                std::fprintf(stderr, "[vm] %s\n", why_.c_str());
+            return status_;
+        }
+
+        // OP_CHAN：回傳新的代號（從 1 起），超過上限時回傳 0
+        int64_t make_chan(int64_t cap)
+        {
+            std::lock_guard<std::mutex> lk(chan_m_);
+            const uint64_t i = nchan_.load(std::memory_order_relaxed);
+            if (i == (uint64_t)CHAN_BLOCK * CHAN_BLOCKS)
+                return 0;
+            if (!chans_[i / CHAN_BLOCK])
+                chans_[i / CHAN_BLOCK] = new GoChan *[CHAN_BLOCK];
+            chans_[i / CHAN_BLOCK][i % CHAN_BLOCK] = new GoChan(cap);
+            nchan_.store(i + 1, std::memory_order_release);
+            return (int64_t)i + 1;
+        }
+        // 代號對應的 channel；nil（0）與無效的代號為 nullptr
+        GoChan *chan(int64_t h) const
+        {
+            const uint64_t i = (uint64_t)h - 1;
+            if (i >= nchan_.load(std::memory_order_acquire))
+                return nullptr;
+            return chans_[i / CHAN_BLOCK][i % CHAN_BLOCK];
+        }
+
+        // OP_GO：參數複製到新 goroutine 的窗口，排進工作者 w 的佇列
+        void go(unsigned w, const NativeCall &nc, const int64_t *vars, uint32_t frame, uint32_t target)
+        {
+            Goroutine *g = new_g();
+            vm_enter(g->base.data(), vars, nc, frame);
+            g->vars = g->base.data();
+            g->frame = frame;
+            g->pc = target;
+            ready(w, g);
+        }
+
+        // 只由工作者 w 自己的執行緒呼叫
+        void ready(unsigned w, Goroutine *g)
+        {
+            live_.fetch_add(1, std::memory_order_relaxed);
+            GoDeque &dq = workers_[w]->dq;
+            if (!dq.full())
+                dq.push((uint64_t)(uintptr_t)g);
+            else
+            {
+                std::lock_guard<std::mutex> lk(m_);
+                global_.push_back(g);
+                nglobal_.store(global_.size(), std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (idle_.load(std::memory_order_relaxed))
+            {
+                std::lock_guard<std::mutex> lk(m_);
+                cv_.notify_one();
+            }
+        }
+
+        int panic(unsigned w, const char *why)
+        {
+            workers_[w]->why = why;
+            return VM_GO_PANIC;
+        }
+
+        uint32_t rand(unsigned w)
+        {
+            GoWorker &me = *workers_[w];
+            me.seed = me.seed * 1103515245u + 12345u;
+            return me.seed >> 8;
+        }
+
+    private:
+        typedef TaskDeque<256> GoDeque;
+        static const uint32_t CHAN_BLOCK = 1024, CHAN_BLOCKS = 4096;
+
+        Program &prog_;
+        OutputSink &out_;
+        VmProfile *prof_;
+        std::vector<std::unique_ptr<GoWorker>> workers_;
+        std::mutex out_lock_;
+        // channel 表：固定大小的區塊，建立後位址不變；nchan_ 以 release 發布
+        GoChan **chans_[CHAN_BLOCKS] = {};
+        std::atomic<uint64_t> nchan_{0};
+        std::mutex chan_m_;
+        // goroutine 物件回收再用，執行結束才釋放（等待佇列裡可能還有舊的登記）
+        std::vector<std::unique_ptr<Goroutine>> all_;
+        std::vector<Goroutine *> free_;
+        std::mutex g_m_;
+        // 全域佇列、睡眠與結束
+        std::mutex m_;
+        std::condition_variable cv_;
+        std::deque<Goroutine *> global_;
+        std::atomic<size_t> nglobal_{0};
+        std::atomic<unsigned> idle_{0};
+        std::atomic<uint64_t> live_{1}; // 主程式
+        std::atomic<bool> stop_{false};
+        int status_ = VM_OK;
+        std::string why_;
+
+        Goroutine *new_g()
+        {
+            std::lock_guard<std::mutex> lk(g_m_);
+            if (!free_.empty())
+            {
+                Goroutine *g = free_.back();
+                free_.pop_back();
+                return g;
+            }
+            all_.emplace_back(new Goroutine());
+            Goroutine *g = all_.back().get();
+            g->base.resize(prog_.frame);
+            g->stack.slots = GO_STACK_SLOTS;
+            g->stack.depth_max = GO_DEPTH_MAX;
+            return g;
+        }
+
+        void finish(int status, const std::string &why)
+        {
+            std::lock_guard<std::mutex> lk(m_);
+            if (!stop_.load(std::memory_order_relaxed))
+            {
+                status_ = status;
+                why_ = why;
+                stop_.store(true, std::memory_order_release);
+            }
+            cv_.notify_all();
+        }
+
+        void loop(unsigned id)
+        {
+            while (Goroutine *g = next(id))
+            {
+                TaskEnv env{nullptr, &g->stack, 0, this, g, id};
+                const int rc = prof_ ? run_loop<true, RUN_GO>(prog_, g->vars, out_, prof_, g->pc, &env)
+                                     : run_loop<false, RUN_GO>(prog_, g->vars, out_, nullptr, g->pc, &env);
+                if (rc == GO_PARK || (rc == VM_OK && !g->main))
+                {
+                    if (rc == VM_OK)
+                    {
+                        g->stack.depth = 0;
+                        std::lock_guard<std::mutex> lk(g_m_);
+                        free_.push_back(g);
+                    }
+                    if (live_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                        finish(VM_GO_PANIC, "all goroutines are asleep - deadlock");
+                    continue;
+                }
+                if (rc == GO_YIELD)
+                {
+                    std::lock_guard<std::mutex> lk(m_);
+                    global_.push_back(g);
+                    nglobal_.store(global_.size(), std::memory_order_relaxed);
+                    if (idle_.load(std::memory_order_relaxed))
+                        cv_.notify_one();
+                    continue;
+                }
+                if (rc == VM_TASK_FAULT)
+                    finish(rc, std::string(op_name((uint8_t)env.fault)) + " is not allowed in a goroutine");
+                else if (rc == VM_STACK_OVERFLOW)
+                    finish(rc, g->main ? "call stack overflow" : "call stack overflow in a goroutine");
+                else if (rc == VM_GO_PANIC)
+                    finish(rc, workers_[id]->why);
+                else
+                    finish(rc == GO_EXIT ? VM_OK : rc, std::string());
+            }
+        }
+
+        Goroutine *pop_global()
+        {
+            if (!nglobal_.load(std::memory_order_relaxed))
+                return nullptr;
+            std::lock_guard<std::mutex> lk(m_);
+            if (global_.empty())
+                return nullptr;
+            Goroutine *g = global_.front();
+            global_.pop_front();
+            nglobal_.store(global_.size(), std::memory_order_relaxed);
+            return g;
+        }
+
+        Goroutine *find(unsigned id)
+        {
+            uint64_t r;
+            if (workers_[id]->dq.pop(r))
+                return (Goroutine *)(uintptr_t)r;
+            if (Goroutine *g = pop_global())
+                return g;
+            const unsigned n = (unsigned)workers_.size();
+            for (unsigned k = 0, v = rand(id) % n; k < n; k++, v = v + 1 == n ? 0 : v + 1)
+                if (v != id && workers_[v]->dq.steal(r))
+                    return (Goroutine *)(uintptr_t)r;
+            return nullptr;
+        }
+
+        // 下一個要執行的 goroutine；結束時回傳 nullptr
+        Goroutine *next(unsigned id)
+        {
+            for (unsigned spin = 0;; spin++)
+            {
+                if (stop_.load(std::memory_order_acquire))
+                    return nullptr;
+                if (Goroutine *g = find(id))
+                    return g;
+                if (spin < 64)
+                    continue;
+                // 先登記為閒置再檢查一次，與 ready 的「先放入再看 idle_」配對，不會漏掉喚醒
+                idle_.fetch_add(1, std::memory_order_seq_cst);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                Goroutine *g = find(id);
+                if (!g)
+                {
+                    std::unique_lock<std::mutex> lk(m_);
+                    if (!stop_.load(std::memory_order_relaxed) && global_.empty())
+                        cv_.wait_for(lk, std::chrono::milliseconds(10));
+                }
+                idle_.fetch_sub(1, std::memory_order_relaxed);
+                if (g)
+                    return g;
+                spin = 0;
+            }
+        }
+    };
+
+    static void go_wake(GoSched &S, unsigned w, const GoWaiter &x, int64_t val, int64_t ok, bool closed)
+    {
+        Goroutine *g = x.g;
+        g->val = val;
+        g->ok = ok;
+        g->sel = x.sel;
+        g->closed = closed;
+        g->woke = true;
+        S.ready(w, g);
+    }
+
+    // 阻塞前登記：之後任何持有該 channel 的一方都可能取得並喚醒 g
+    static inline uint64_t go_block(Goroutine &g)
+    {
+        g.token.store(++g.seq, std::memory_order_release);
+        return g.seq;
+    }
+
+    // OP_SEND / OP_RECV / OP_CLOSE / OP_SELECT；g 的位置已保存在這條指令上，回傳 VM_OK、GO_PARK 或 VM_GO_PANIC
+    static int go_send(TaskEnv &e, int64_t h, int64_t v)
+    {
+        Goroutine &g = *e.g;
+        if (g.woke)
+        {
+            g.woke = false;
+            return g.closed ? e.sched->panic(e.worker, "send on closed channel") : VM_OK;
+        }
+        GoChan *c = e.sched->chan(h);
+        if (!c)
+        {
+            go_block(g); // nil channel：永遠阻塞
+            return GO_PARK;
+        }
+        if (c->try_send(v))
+            return VM_OK;
+        std::lock_guard<std::mutex> lk(c->m);
+        c->enter();
+        bool closed = false;
+        int rc = VM_OK;
+        if (!c->send_now(*e.sched, e.worker, v, closed))
+        {
+            if (closed)
+                rc = e.sched->panic(e.worker, "send on closed channel");
+            else
+            {
+                c->sendq.push_back(GoWaiter{&g, go_block(g), v, 0});
+                rc = GO_PARK;
+            }
+        }
+        c->leave();
+        return rc;
+    }
+
+    static int go_recv(TaskEnv &e, int64_t h, int64_t &v, int64_t &ok)
+    {
+        Goroutine &g = *e.g;
+        if (g.woke)
+        {
+            g.woke = false;
+            v = g.val;
+            ok = g.ok;
+            return VM_OK;
+        }
+        GoChan *c = e.sched->chan(h);
+        if (!c)
+        {
+            go_block(g);
+            return GO_PARK;
+        }
+        if (c->try_recv(v))
+        {
+            ok = 1;
+            return VM_OK;
+        }
+        std::lock_guard<std::mutex> lk(c->m);
+        c->enter();
+        int rc = VM_OK;
+        if (!c->recv_now(*e.sched, e.worker, v, ok))
+        {
+            c->recvq.push_back(GoWaiter{&g, go_block(g), 0, 0});
+            rc = GO_PARK;
+        }
+        c->leave();
+        return rc;
+    }
+
+    static int go_close(TaskEnv &e, int64_t h)
+    {
+        GoChan *c = e.sched->chan(h);
+        if (!c)
+            return e.sched->panic(e.worker, "close of nil channel");
+        std::lock_guard<std::mutex> lk(c->m);
+        c->enter();
+        const bool twice = c->closed;
+        if (!twice)
+            c->close_now(*e.sched, e.worker);
+        c->leave();
+        return twice ? e.sched->panic(e.worker, "close of closed channel") : VM_OK;
+    }
+
+    // 依位址順序鎖住所有分支的 channel，從隨機的分支開始輪詢；都不能立即完成時走 default，
+    // 沒有 default 則登記在每個分支的等待佇列上（同一個 token）
+    static int go_select(TaskEnv &e, const NativeCall &nc, const int64_t *vars, int64_t &idx, int64_t &v, int64_t &ok)
+    {
+        Goroutine &g = *e.g;
+        if (g.woke)
+        {
+            g.woke = false;
+            if (g.closed)
+                return e.sched->panic(e.worker, "send on closed channel");
+            idx = g.sel;
+            v = g.val;
+            ok = g.ok;
+            return VM_OK;
+        }
+        if (nc.argc == 0)
+        {
+            go_block(g); // select {}：永遠阻塞
+            return GO_PARK;
+        }
+        struct Case
+        {
+            GoChan *c;
+            uint8_t kind;
+            int64_t v;
+        } cs[SELECT_MAX_CASES];
+        GoChan *locks[SELECT_MAX_CASES];
+        uint32_t nl = 0, q = 0;
+        int dflt = -1;
+        for (uint32_t k = 0; k < nc.argc; k++)
+        {
+            cs[k] = Case{nullptr, nc.red[k], 0};
+            if (nc.red[k] == SEL_DEFAULT)
+            {
+                dflt = (int)k;
+                continue;
+            }
+            cs[k].c = e.sched->chan(vars[nc.argv[q++]]);
+            if (nc.red[k] == SEL_SEND)
+                cs[k].v = vars[nc.argv[q++]];
+            if (cs[k].c)
+                locks[nl++] = cs[k].c;
+        }
+        for (uint32_t i = 1; i < nl; i++) // 最多 SELECT_MAX_CASES 個，插入排序
+            for (uint32_t k = i; k > 0 && std::less<GoChan *>()(locks[k], locks[k - 1]); k--)
+                std::swap(locks[k], locks[k - 1]);
+        nl = (uint32_t)(std::unique(locks, locks + nl) - locks);
+        for (uint32_t k = 0; k < nl; k++)
+        {
+            locks[k]->m.lock();
+            locks[k]->enter();
+        }
+        int rc = GO_PARK;
+        const uint32_t start = e.sched->rand(e.worker) % nc.argc;
+        for (uint32_t i = 0; i < nc.argc && rc == GO_PARK; i++)
+        {
+            const uint32_t k = (start + i) % nc.argc;
+            Case &x = cs[k];
+            if (!x.c)
+                continue;
+            bool closed = false;
+            if (x.kind == SEL_SEND ? x.c->send_now(*e.sched, e.worker, x.v, closed)
+                                   : x.c->recv_now(*e.sched, e.worker, v, ok))
+            {
+                idx = k;
+                rc = VM_OK;
+            }
+            else if (closed)
+                rc = e.sched->panic(e.worker, "send on closed channel");
+        }
+        if (rc == GO_PARK && dflt >= 0)
+        {
+            idx = dflt;
+            v = ok = 0;
+            rc = VM_OK;
+        }
+        if (rc == GO_PARK)
+        {
+            const uint64_t seq = go_block(g);
+            for (uint32_t k = 0; k < nc.argc; k++)
+                if (cs[k].c)
+                    (cs[k].kind == SEL_SEND ? cs[k].c->sendq : cs[k].c->recvq).push_back(GoWaiter{&g, seq, cs[k].v, k});
+        }
+        for (uint32_t k = nl; k-- > 0;)
+        {
+            locks[k]->leave();
+            locks[k]->m.unlock();
+        }
+        return rc;
+    }
+
+    // prog.go 的程式：主程式本身也是一個 goroutine。剖析時只用一個工作者
+    static int go_run(Program &prog, int64_t *vars, OutputSink &out, VmProfile *prof)
+    {
+        GoSched sched(prog, out, prof, prof ? 1 : task_threads());
+        return sched.run(vars);
+    }
+
+    // ---- 第二階段：派發 ----
+    // Profile = false 的版本不含任何剖析程式碼。RUN_TASK 為平行工作的版本：以自己的表派發（不用 prog 內快取的位址），
+    // 輸出、配置陣列、原生呼叫、動態值與 SPAWN / JOIN 一律以 VM_TASK_FAULT 結束。
+    // RUN_GO 為 goroutine 的版本：同樣以表派發、不允許配置陣列、動態值與 SPAWN / JOIN，輸出與原生呼叫在排程器的鎖內進行；
+    // 往回跳與函式呼叫消耗時間片，用完時保存位置回傳 GO_YIELD
+#define VM_TASK_DENY()  \
+    if (Task || Go)     \
+    goto vm_task_fault
+#define VM_OUT_BEGIN()                     \
+    if (Task)                              \
+        goto vm_task_fault;                \
+    if (Go && env->sched->out_m)           \
+    env->sched->out_m->lock()
+#define VM_OUT_END()             \
+    if (Go && env->sched->out_m) \
+    env->sched->out_m->unlock()
+#define VM_GO_ONLY() \
+    if (!Go)         \
+    goto vm_task_fault
+#define VM_GO_SAVE()                           \
+    env->g->pc = (uint32_t)(ip - code);        \
+    env->g->vars = vars;                       \
+    env->g->frame = frame
+#if ZHVM_THREADED
+#define VM_CASE(x) \
+    L_##x:         \
+    if (Profile)   \
+        prof_step(ps, x, (size_t)(ip - code));
+#define VM_DISPATCH() goto *(Profile || Mode != RUN_MAIN ? table[ip->op] : ip->h)
+#define VM_NEXT() \
+    ++ip;         \
+    VM_DISPATCH()
+#define VM_JUMP(t)       \
+    ip = code + (t);     \
+    VM_DISPATCH()
+#define VM_BRANCH(t)                                                      \
+    if (Go && (t) <= (uint32_t)(ip - code) && --slice == 0)                 \
+    {                                                                     \
+        ip = code + (t);                                                  \
+        goto vm_go_yield;                                                 \
+    }                                                                     \
+    VM_JUMP(t)
+#else
+#define VM_CASE(x) \
+    case x:        \
+        if (Profile) \
+            prof_step(ps, x, (size_t)(ip - code));
+#define VM_NEXT() \
+    ++ip;         \
+    continue
+#define VM_JUMP(t)   \
+    ip = code + (t); \
+    continue
+#define VM_BRANCH(t)                                                      \
+    if (Go && (t) <= (uint32_t)(ip - code) && --slice == 0)                 \
+    {                                                                     \
+        ip = code + (t);                                                  \
+        goto vm_go_yield;                                                 \
+    }                                                                     \
+    VM_JUMP(t)
+#endif
+
+    template <bool Profile, int Mode>
+    static int run_loop(Program &prog, int64_t *vars, OutputSink &out, VmProfile *prof, uint32_t start, TaskEnv *env)
+    {
+        constexpr bool Task = Mode == RUN_TASK, Go = Mode == RUN_GO;
+        int status = VM_OK;
+        const Insn *const code = prog.code.data();
+        const Insn *ip = code + start;
+        if (Profile && prof->insn_count.size() != prog.code.size())
+        {
+            prof->insn_count.assign(prog.code.size(), 0);
+            prof->insn_ticks.assign(prog.code.size(), 0);
+        }
+        ProfState ps{prof, Profile ? vm_ticks() : 0, 0, SIZE_MAX};
+        ArrayHeap own_heap;
+        ArrayHeap &heap = Task ? *env->heap : own_heap;
+        StrHeap strs(prog.strs.data(), prog.strs.size());
+        const NativeCall *const calls = prog.calls.data();
+        const NativeFn *const natives = native_table();
+        CallStack own_stack;
+        CallStack &stack = Task || Go ? *env->stack : own_stack;
+        uint32_t frame = Go ? env->g->frame : prog.frame; // 目前窗口的大小
+        uint32_t slice = GO_SLICE;
+        std::vector<TaskGroup> pending; // 尚未 JOIN 的 SPAWN
+#if ZHVM_THREADED
+        // 依操作碼數值排列；decode_bc 只會產生表內的操作碼
+        static void *const table[] = {
+            &&L_OP_END,       // 0
+            &&L_OP_PRINT,     // 1
+            &&L_OP_PRINT_INT, // 2
+            &&L_OP_SET_I64,   // 3
+            &&L_OP_END,       // 4
+            &&L_OP_END,       // 5（未使用）
+            &&L_OP_COPY_I64,  // 6
+            &&L_OP_END,       // 7（未使用）
+            &&L_OP_SET_F64,   // 8
+            &&L_OP_I2F,       // 9
+            &&L_OP_F2I,       // A
+            &&L_OP_PRINT_F64, // B
+            &&L_OP_END, &&L_OP_END, &&L_OP_END, &&L_OP_END, // C..0F
+            &&L_OP_ADD,       // 10
+            &&L_OP_SUB,       // 11
+            &&L_OP_MUL,       // 12
+            &&L_OP_DIV,       // 13
+            &&L_OP_MOD,       // 14
+            &&L_OP_FLMOD,     // 15
+            &&L_OP_END, &&L_OP_END, // 16..17
+            &&L_OP_EQ,        // 18
+            &&L_OP_NE,        // 19
+            &&L_OP_LT,        // 1A
+            &&L_OP_LE,        // 1B
+            &&L_OP_GT,        // 1C
+            &&L_OP_GE,        // 1D
+            &&L_OP_END, &&L_OP_END, // 1E..1F
+            &&L_OP_JMP,       // 20
+            &&L_OP_JZ,        // 21
+            &&L_OP_JNZ,       // 22
+            &&L_OP_END, &&L_OP_END, &&L_OP_END, &&L_OP_END, &&L_OP_END, &&L_OP_END, &&L_OP_END, // 23..29
+            &&L_OP_END, &&L_OP_END, &&L_OP_END, &&L_OP_END, &&L_OP_END, &&L_OP_END, // 2A..2F
+            &&L_OP_FADD,      // 30
+            &&L_OP_FSUB,      // 31
+            &&L_OP_FMUL,      // 32
+            &&L_OP_FDIV,      // 33
+            &&L_OP_FMOD,      // 34
+            &&L_OP_FFLMOD,    // 35
+            &&L_OP_END, &&L_OP_END, // 36..37
+            &&L_OP_FEQ,       // 38
+            &&L_OP_FNE,       // 39
+            &&L_OP_FLT,       // 3A
+            &&L_OP_FLE,       // 3B
+            &&L_OP_FGT,       // 3C
+            &&L_OP_FGE,       // 3D
+            &&L_OP_END, &&L_OP_END, // 3E..3F
+            &&L_OP_MATH,      // 40
+            &&L_OP_END, &&L_OP_END, &&L_OP_END, &&L_OP_END, &&L_OP_END, &&L_OP_END, &&L_OP_END, // 41..47
+            &&L_OP_END, &&L_OP_END, &&L_OP_END, &&L_OP_END, &&L_OP_END, &&L_OP_END, &&L_OP_END, &&L_OP_END, // 48..4F
+            &&L_OP_ANEW,      // 50
+            &&L_OP_ALEN,      // 51
+            &&L_OP_AGET,      // 52
+            &&L_OP_ASET,      // 53
+            &&L_OP_VEC,       // 54
+            &&L_OP_END, &&L_OP_END, &&L_OP_END, // 55..57
+            &&L_OP_CALL_NATIVE, // 58
+            &&L_OP_CALL,      // 59
+            &&L_OP_TAILCALL,  // 5A
+            &&L_OP_RET,       // 5B
+            &&L_OP_SPAWN,     // 5C
+            &&L_OP_JOIN,      // 5D
+            &&L_OP_END, &&L_OP_END, // 5E..5F
+            &&L_OP_DBOX,      // 60
+            &&L_OP_DUNBOX,    // 61
+            &&L_OP_DMOV,      // 62
+            &&L_OP_SCONST,    // 63
+            &&L_OP_DPRINT,    // 64
+            &&L_OP_SPRINT,    // 65
+            &&L_OP_SCAT,      // 66
+            &&L_OP_END, &&L_OP_END, &&L_OP_END, &&L_OP_END, // 67..6A
+            &&L_OP_END, &&L_OP_END, &&L_OP_END, &&L_OP_END, &&L_OP_END, // 6B..6F
+            &&L_OP_DADD,      // 70
+            &&L_OP_DSUB,      // 71
+            &&L_OP_DMUL,      // 72
+            &&L_OP_DDIV,      // 73
+            &&L_OP_DMOD,      // 74
+            &&L_OP_DFLMOD,    // 75
+            &&L_OP_END, &&L_OP_END, // 76..77
+            &&L_OP_DEQ,       // 78
+            &&L_OP_DNE,       // 79
+            &&L_OP_DLT,       // 7A
+            &&L_OP_DLE,       // 7B
+            &&L_OP_DGT,       // 7C
+            &&L_OP_DGE,       // 7D
+            &&L_OP_DJEQ,      // 7E
+            &&L_OP_DJNE,      // 7F
+            &&L_OP_GO,        // 80
+            &&L_OP_CHAN,      // 81
+            &&L_OP_SEND,      // 82
+            &&L_OP_RECV,      // 83
+            &&L_OP_CLOSE,     // 84
+            &&L_OP_SELECT,    // 85
+        };
+        if (Profile || Mode != RUN_MAIN)
+        {
+            // 剖析與工作版本以操作碼查表派發，不動 prog 內快取的（一般版本的）處理常式位址
+            VM_DISPATCH();
+        }
+        if (!prog.threaded)
+        {
+            for (auto &in : prog.code)
+                in.h = table[in.op];
+            prog.threaded = true;
+        }
+        goto *ip->h;
+#else
+        for (;;)
+        {
+            switch (ip->op)
+            {
+#endif
+        VM_CASE(OP_PRINT)
+        {
+            VM_OUT_BEGIN();
+            out.line_ref(ip->s, ip->b); // 字串位於位元碼內，執行期間有效
+            VM_OUT_END();
+            VM_NEXT();
+        }
+        VM_CASE(OP_PRINT_INT)
+        {
+            VM_OUT_BEGIN();
+            out.int_line(vars[ip->a]);
+            VM_OUT_END();
+            VM_NEXT();
+        }
+        VM_CASE(OP_SET_I64)
+        {
+            vars[ip->a] = ip->imm;
+            VM_NEXT();
+        }
+        VM_CASE(OP_COPY_I64)
+        {
+            vars[ip->a] = vars[ip->b];
+            VM_NEXT();
+        }
+        VM_CASE(OP_ADD)
+        {
+            vars[ip->a] = (int64_t)((uint64_t)vars[ip->b] + (uint64_t)vars[ip->c]);
+            VM_NEXT();
+        }
+        VM_CASE(OP_SUB)
+        {
+            vars[ip->a] = (int64_t)((uint64_t)vars[ip->b] - (uint64_t)vars[ip->c]);
+            VM_NEXT();
+        }
+        VM_CASE(OP_MUL)
+        {
+            vars[ip->a] = (int64_t)((uint64_t)vars[ip->b] * (uint64_t)vars[ip->c]);
+            VM_NEXT();
+        }
+        VM_CASE(OP_DIV)
+        {
+            vars[ip->a] = vm_div(vars[ip->b], vars[ip->c]);
+            VM_NEXT();
+        }
+        VM_CASE(OP_MOD)
+        {
+            vars[ip->a] = vm_mod(vars[ip->b], vars[ip->c]);
+            VM_NEXT();
+        }
+        VM_CASE(OP_FLMOD)
+        {
+            vars[ip->a] = vm_flmod(vars[ip->b], vars[ip->c]);
+            VM_NEXT();
+        }
+        VM_CASE(OP_EQ)
+        {
+            vars[ip->a] = vars[ip->b] == vars[ip->c];
+            VM_NEXT();
+        }
+        VM_CASE(OP_NE)
+        {
+            vars[ip->a] = vars[ip->b] != vars[ip->c];
+            VM_NEXT();
+        }
+        VM_CASE(OP_LT)
+        {
+            vars[ip->a] = vars[ip->b] < vars[ip->c];
+            VM_NEXT();
+        }
+        VM_CASE(OP_LE)
+        {
+            vars[ip->a] = vars[ip->b] <= vars[ip->c];
+            VM_NEXT();
+        }
+        VM_CASE(OP_GT)
+        {
+            vars[ip->a] = vars[ip->b] > vars[ip->c];
+            VM_NEXT();
+        }
+        VM_CASE(OP_GE)
+        {
+            vars[ip->a] = vars[ip->b] >= vars[ip->c];
+            VM_NEXT();
+        }
+        VM_CASE(OP_SET_F64)
+        {
+            vars[ip->a] = ip->imm;
+            VM_NEXT();
+        }
+        VM_CASE(OP_I2F)
+        {
+            vars[ip->a] = f64_bits((double)vars[ip->b]);
+            VM_NEXT();
+        }
+        VM_CASE(OP_F2I)
+        {
+            vars[ip->a] = vm_f2i(as_f64(vars[ip->b]));
+            VM_NEXT();
+        }
+        VM_CASE(OP_PRINT_F64)
+        {
+            VM_OUT_BEGIN();
+            out.f64_line(as_f64(vars[ip->a]));
+            VM_OUT_END();
+            VM_NEXT();
+        }
+#define VM_FBIN(x, expr)                         \
+    VM_CASE(x)                                   \
+    {                                            \
+        const double l = as_f64(vars[ip->b]);    \
+        const double r = as_f64(vars[ip->c]);    \
+        vars[ip->a] = (expr);                    \
+        VM_NEXT();                               \
+    }
+        VM_FBIN(OP_FADD, f64_bits(l + r))
+        VM_FBIN(OP_FSUB, f64_bits(l - r))
+        VM_FBIN(OP_FMUL, f64_bits(l * r))
+        VM_FBIN(OP_FDIV, f64_bits(l / r))
+        VM_FBIN(OP_FMOD, f64_bits(std::fmod(l, r)))
+        VM_FBIN(OP_FFLMOD, f64_bits(f64_flmod(l, r)))
+        VM_FBIN(OP_FEQ, l == r)
+        VM_FBIN(OP_FNE, l != r)
+        VM_FBIN(OP_FLT, l < r)
+        VM_FBIN(OP_FLE, l <= r)
+        VM_FBIN(OP_FGT, l > r)
+        VM_FBIN(OP_FGE, l >= r)
+#undef VM_FBIN
+        VM_CASE(OP_MATH)
+        {
+            vars[ip->a] = f64_bits(vm_math((unsigned)ip->imm, as_f64(vars[ip->b]), as_f64(vars[ip->c])));
+            VM_NEXT();
+        }
+        VM_CASE(OP_ANEW)
+        {
+            VM_TASK_DENY();
+            vars[ip->a] = heap.alloc(vars[ip->b]);
+            VM_NEXT();
+        }
+        VM_CASE(OP_ALEN)
+        {
+            size_t n;
+            heap.get(vars[ip->b], n);
+            vars[ip->a] = (int64_t)n;
+            VM_NEXT();
+        }
+        VM_CASE(OP_AGET)
+        {
+            size_t n;
+            const int64_t *p = heap.get(vars[ip->b], n);
+            const uint64_t i = (uint64_t)vars[ip->c];
+            vars[ip->a] = i < n ? p[i] : 0;
+            VM_NEXT();
+        }
+        VM_CASE(OP_ASET)
+        {
+            size_t n;
+            int64_t *p = heap.get(vars[ip->a], n);
+            const uint64_t i = (uint64_t)vars[ip->b];
+            if (i < n)
+                p[i] = vars[ip->c];
+            VM_NEXT();
+        }
+        VM_CASE(OP_VEC)
+        {
+            vm_vec(heap, vars, (unsigned)ip->imm, ip->a, ip->b, ip->c);
+            VM_NEXT();
+        }
+        VM_CASE(OP_CALL_NATIVE)
+        {
+            VM_OUT_BEGIN();
+            // 參數依序複製出來，呼叫只經一次表格間接跳躍
+            const NativeCall &nc = calls[ip->c];
+            int64_t argv[NATIVE_MAX_ARGS];
+            for (uint32_t k = 0; k < nc.argc; k++)
+                argv[k] = vars[nc.argv[k]];
+            int64_t r = natives[ip->imm](NativeArgs{argv, nc.argc, nc.s, nc.len, out});
+            VM_OUT_END();
+            if (nc.ret)
+                vars[ip->a] = r;
+            VM_NEXT();
+        }
+        VM_CASE(OP_CALL)
+        {
+            int64_t *fp = stack.push(ip, vars, frame, prog.frame);
+            if (!fp)
+            {
+                if (Mode == RUN_MAIN) // 工作的失敗由 JOIN 回報，goroutine 的由排程器回報
+                {
+                    out.flush();
+                    std::fprintf(stderr, "[vm] call stack overflow (depth %u)\n", (unsigned)stack.depth);
+                }
+                status = VM_STACK_OVERFLOW;
+                goto vm_exit;
+            }
+            vm_enter(fp, vars, calls[ip->imm], ip->b);
+            vars = fp;
+            frame = ip->b;
+            if (Go && --slice == 0)
+            {
+                ip = code + ip->c;
+                goto vm_go_yield;
+            }
+            VM_JUMP(ip->c);
+        }
+        VM_CASE(OP_TAILCALL)
+        {
+            vm_enter(vars, vars, calls[ip->imm], ip->b);
+            frame = ip->b;
+            if (Go && --slice == 0)
+            {
+                ip = code + ip->c;
+                goto vm_go_yield;
+            }
+            VM_JUMP(ip->c);
+        }
+        VM_CASE(OP_RET)
+        {
+            const int64_t v = vars[ip->a];
+            if (stack.depth == 0)
+            {
+                if (Mode == RUN_MAIN)
+                    out.flush();
+                goto vm_exit;
+            }
+            const CallStack::Ret &r = stack.rets[--stack.depth];
+            vars = r.fp;
+            frame = r.frame;
+            ip = r.call;
+            vars[ip->a] = v;
+            VM_NEXT();
+        }
+        VM_CASE(OP_SPAWN)
+        {
+            VM_TASK_DENY();
+            task_spawn(pending, ip, calls[ip->imm], vars, frame);
+            VM_NEXT();
+        }
+        VM_CASE(OP_JOIN)
+        {
+            VM_TASK_DENY();
+            if (!pending.empty())
+            {
+                status = task_join(prog, heap, out, pending, vars);
+                if (status != VM_OK)
+                    goto vm_exit;
+            }
+            VM_NEXT();
+        }
+        VM_CASE(OP_DBOX)
+        {
+            VM_TASK_DENY();
+            vars[ip->a] = ip->imm;
+            vars[ip->a + 1] = vars[ip->b];
+            VM_NEXT();
+        }
+        VM_CASE(OP_DUNBOX)
+        {
+            VM_TASK_DENY();
+            vars[ip->a] = dyn_unbox((unsigned)ip->imm, vars + ip->b, strs);
+            VM_NEXT();
+        }
+        VM_CASE(OP_DMOV)
+        {
+            VM_TASK_DENY();
+            vars[ip->a] = vars[ip->b];
+            vars[ip->a + 1] = vars[ip->b + 1];
+            VM_NEXT();
+        }
+        VM_CASE(OP_SCONST)
+        {
+            VM_TASK_DENY();
+            vars[ip->a] = ip->imm;
+            VM_NEXT();
+        }
+        VM_CASE(OP_DPRINT)
+        {
+            VM_TASK_DENY();
+            char buf[48];
+            const char *s;
+            size_t n;
+            const int64_t *p = vars + ip->a;
+            dyn_str(p, (unsigned)ip->imm, strs, buf, s, n);
+            if (ip->imm & DF_SEP)
+            {
+                out.write(s, n);
+                out.write(" ", 1);
+            }
+            else if (dyn_tag(p) == VT_STR)
+                out.line_ref(s, n);
+            else
+                out.line(s, n);
+            VM_NEXT();
+        }
+        VM_CASE(OP_SPRINT)
+        {
+            VM_TASK_DENY();
+            char tmp[8];
+            const char *s;
+            size_t n;
+            strs.get(vars[ip->a], tmp, s, n);
+            out.line_ref(s, n);
+            VM_NEXT();
+        }
+        VM_CASE(OP_SCAT)
+        {
+            VM_TASK_DENY();
+            vars[ip->a] = strs.cat(vars[ip->b], vars[ip->c]);
+            VM_NEXT();
+        }
+#define VM_DYN(x, stmt) \
+    VM_CASE(x)          \
+    {                   \
+        VM_TASK_DENY(); \
+        stmt;           \
+        VM_NEXT();      \
+    }
+        VM_DYN(OP_DADD, dyn_arith(OP_DADD, vars + ip->a, vars + ip->b, vars + ip->c, strs))
+        VM_DYN(OP_DSUB, dyn_arith(OP_DSUB, vars + ip->a, vars + ip->b, vars + ip->c, strs))
+        VM_DYN(OP_DMUL, dyn_arith(OP_DMUL, vars + ip->a, vars + ip->b, vars + ip->c, strs))
+        VM_DYN(OP_DDIV, dyn_arith(OP_DDIV, vars + ip->a, vars + ip->b, vars + ip->c, strs))
+        VM_DYN(OP_DMOD, dyn_arith(OP_DMOD, vars + ip->a, vars + ip->b, vars + ip->c, strs))
+        VM_DYN(OP_DFLMOD, dyn_arith(OP_DFLMOD, vars + ip->a, vars + ip->b, vars + ip->c, strs))
+        VM_DYN(OP_DEQ, vars[ip->a] = dyn_cmp(OP_DEQ, vars + ip->b, vars + ip->c, strs))
+        VM_DYN(OP_DNE, vars[ip->a] = dyn_cmp(OP_DNE, vars + ip->b, vars + ip->c, strs))
+        VM_DYN(OP_DLT, vars[ip->a] = dyn_cmp(OP_DLT, vars + ip->b, vars + ip->c, strs))
+        VM_DYN(OP_DLE, vars[ip->a] = dyn_cmp(OP_DLE, vars + ip->b, vars + ip->c, strs))
+        VM_DYN(OP_DGT, vars[ip->a] = dyn_cmp(OP_DGT, vars + ip->b, vars + ip->c, strs))
+        VM_DYN(OP_DGE, vars[ip->a] = dyn_cmp(OP_DGE, vars + ip->b, vars + ip->c, strs))
+        VM_DYN(OP_DJEQ, vars[ip->a] = dyn_js_eq(vars + ip->b, vars + ip->c, strs))
+        VM_DYN(OP_DJNE, vars[ip->a] = !dyn_js_eq(vars + ip->b, vars + ip->c, strs))
+#undef VM_DYN
+        VM_CASE(OP_GO)
+        {
+            VM_GO_ONLY();
+            env->sched->go(env->worker, calls[ip->imm], vars, ip->b, ip->c);
+            VM_NEXT();
+        }
+        VM_CASE(OP_CHAN)
+        {
+            VM_GO_ONLY();
+            vars[ip->a] = env->sched->make_chan(vars[ip->b]);
+            if (!vars[ip->a])
+            {
+                status = env->sched->panic(env->worker, "too many channels");
+                goto vm_exit;
+            }
+            VM_NEXT();
+        }
+        VM_CASE(OP_SEND)
+        {
+            VM_GO_ONLY();
+            VM_GO_SAVE();
+            status = go_send(*env, vars[ip->a], vars[ip->b]);
+            if (status != VM_OK)
+                goto vm_exit;
+            VM_NEXT();
+        }
+        VM_CASE(OP_RECV)
+        {
+            VM_GO_ONLY();
+            VM_GO_SAVE();
+            int64_t v = 0, ok = 0;
+            status = go_recv(*env, vars[ip->c], v, ok);
+            if (status != VM_OK)
+                goto vm_exit;
+            vars[ip->a] = v;
+            vars[ip->b] = ok;
+            VM_NEXT();
+        }
+        VM_CASE(OP_CLOSE)
+        {
+            VM_GO_ONLY();
+            status = go_close(*env, vars[ip->a]);
+            if (status != VM_OK)
+                goto vm_exit;
+            VM_NEXT();
+        }
+        VM_CASE(OP_SELECT)
+        {
+            VM_GO_ONLY();
+            VM_GO_SAVE();
+            int64_t idx = 0, v = 0, ok = 0;
+            status = go_select(*env, calls[ip->imm], vars, idx, v, ok);
+            if (status != VM_OK)
+                goto vm_exit;
+            vars[ip->a] = idx;
+            vars[ip->b] = v;
+            vars[ip->c] = ok;
+            VM_NEXT();
+        }
+        VM_CASE(OP_JMP)
+        {
+            VM_BRANCH(ip->c);
+        }
+        VM_CASE(OP_JZ)
+        {
+            if (vars[ip->a] == 0)
+            {
+                VM_BRANCH(ip->c);
+            }
+            VM_NEXT();
+        }
+        VM_CASE(OP_JNZ)
+        {
+            if (vars[ip->a] != 0)
+            {
+                VM_BRANCH(ip->c);
+            }
+            VM_NEXT();
+        }
+        VM_CASE(OP_END)
+        {
+            if (Mode == RUN_MAIN)
+                out.flush();
+            if (Go)
+                status = GO_EXIT;
+            goto vm_exit;
+        }
+#if !ZHVM_THREADED
+            default:
+                if (Mode == RUN_MAIN)
+                    out.flush();
+                if (Go)
+                    status = GO_EXIT;
+                goto vm_exit;
+            }
+        }
+#endif
+    vm_go_yield:
+        if (Go)
+        {
+            VM_GO_SAVE();
+            status = GO_YIELD;
+        }
+        goto vm_exit;
+    vm_task_fault:
+        if (Task || Go)
+        {
+            env->fault = ip->op;
+            status = VM_TASK_FAULT;
+        }
+    vm_exit:
+        if (Profile)
+        {
+            uint64_t dt = vm_ticks() - ps.t;
+            ps.p->ticks[ps.last] += dt;
+            if (ps.last_i != SIZE_MAX)
+                ps.p->insn_ticks[ps.last_i] += dt;
+        }
+        return status;
+    }
+
+    int run_program(Program &prog, int64_t *vars, OutputSink &out)
+    {
+        if (prog.go)
+            return go_run(prog, vars, out, nullptr);
+        return run_loop<false, RUN_MAIN>(prog, vars, out, nullptr, 0, nullptr);
+    }
+
+    int run_program(Program &prog, int64_t *vars, OutputSink &out, VmProfile &prof)
+    {
+        if (prog.go)
+            return go_run(prog, vars, out, &prof);
+        return run_loop<true, RUN_MAIN>(prog, vars, out, &prof, 0, nullptr);
+    }
+
+#undef VM_TASK_DENY
+#undef VM_OUT_BEGIN
+#undef VM_OUT_END
+#undef VM_GO_ONLY
+#undef VM_GO_SAVE
+#undef VM_BRANCH
+#undef VM_CASE
+#undef VM_NEXT
+#undef VM_JUMP
+#undef VM_DISPATCH
+
+    JitMode jit_mode_from_env()
+    {
+        const char *v = std::getenv("ZHCL_JIT");
+        if (!v || !*v || *v == '0')
+            return JitMode::Off;
+        if (std::strcmp(v, "check") == 0)
+            return JitMode::Check;
+        return JitMode::On;
+    }
+
+    // 差異測試：同一程式分別以直譯器與 JIT 執行，比對輸出與最終槽位。
+    // 直譯器的輸出照常寫到 out、最終槽位留在 vars，比對結果寫到 stderr；不一致時回傳 VM_JIT_MISMATCH
+    static int jit_check(Program &prog, int64_t *vars, OutputSink &out, SlotArena &arena)
+    {
+        std::string want, got;
+        Frame vars_j(prog.frame, arena);
+        int rc;
+        {
+            OutputSink cap(&want);
+            rc = run_program(prog, vars, cap);
+        }
+        out.write(want.data(), want.size());
+        out.flush();
+        if (rc != VM_OK)
+            return rc;
+        JitCode native;
+        std::string why;
+        if (!jit_compile(prog, native, &why))
+        {
+            std::fprintf(stderr, "[jit] check skipped: %s\n", why.c_str());
+            return VM_OK;
+        }
+        {
+            OutputSink cap(&got);
+            native.run(vars_j.data(), cap);
+        }
+        if (got != want)
+        {
+            size_t i = 0;
+            while (i < got.size() && i < want.size() && got[i] == want[i])
+                i++;
+            std::fprintf(stderr, "[jit] check FAILED: output differs at byte %zu (interp %zu bytes, jit %zu bytes)\n",
+                         i, want.size(), got.size());
+            return VM_JIT_MISMATCH;
+        }
+        for (size_t k = 0; k < prog.frame; k++)
+        {
+            if (vars[k] != vars_j.data()[k])
+            {
+                std::fprintf(stderr, "[jit] check FAILED: slot %zu interp=%lld jit=%lld\n",
+                             k, (long long)vars[k], (long long)vars_j.data()[k]);
+                return VM_JIT_MISMATCH;
+            }
+        }
+        std::fprintf(stderr, "[jit] check OK (%zu insns, %zu bytes native, %zu bytes output)\n",
+                     prog.code.size(), native.size(), want.size());
+        return VM_OK;
+    }
+
+    // ---- 可重複使用的 VM 實例 ----
+    Vm::Vm(OutputSink *out)
+    {
+        set_output(out);
+    }
+
+    Vm::~Vm() = default;
+
+    void Vm::set_output(OutputSink *out)
+    {
+        if (!out)
+        {
+            if (!stdout_)
+                stdout_.reset(new OutputSink());
+            out = stdout_.get();
+        }
+        out_ = out;
+    }
+
+    void Vm::set_jit(JitMode mode)
+    {
+        jit_ = mode;
+    }
+
+    bool Vm::load(const uint8_t *bc, size_t n, bool verified)
+    {
+        loaded_ = false;
+        native_.reset();
+        jit_tried_ = false;
+        vars_ = nullptr;
+        err_ = VerifyError{};
+        if (bc != own_.data())
+            own_.clear();
+        if (!verified && !verify_bc(bc, n, err_))
+            return false;
+        decode_impl<false>(bc, n, prog_);
+        loaded_ = true;
+        return true;
+    }
+
+    bool Vm::load(std::vector<uint8_t> bc, bool verified)
+    {
+        own_.swap(bc);
+        return load(own_.data(), own_.size(), verified);
+    }
+
+    int Vm::run()
+    {
+        if (!loaded_)
+            return VM_REJECTED;
+        // 之前經 stdio / iostream 印出的內容（例如 "Using frontend"）必須先送出，避免順序錯亂
+        if (!out_->captures())
+            std::fflush(stdout);
+        arena_.reset();
+        if (prog_.frame <= FRAME_STACK_SLOTS)
+        {
+            vars_ = local_;
+            std::memset(local_, 0, prog_.frame * sizeof(int64_t));
+        }
+        else
+            vars_ = arena_.alloc(prog_.frame);
+        if (prof_)
+        {
+            int rc = run_program(prog_, vars_, *out_, *prof_);
+            out_->flush();
+            return rc;
+        }
+        if (jit_ == JitMode::Check)
+            return jit_check(prog_, vars_, *out_, arena_);
+        if (jit_ == JitMode::On && !jit_tried_)
+        {
+            // 只編譯一次；失敗時 native_ 為空，之後都走直譯器
+            jit_tried_ = true;
+            native_.reset(new JitCode());
+            if (!jit_compile(prog_, *native_))
+                native_.reset();
+        }
+        int rc = VM_OK;
+        if (native_)
+            native_->run(vars_, *out_);
+        else
+            rc = run_program(prog_, vars_, *out_);
+        out_->flush();
+        return rc;
+    }
+
+    void Vm::reset()
+    {
+        loaded_ = false;
+        prog_.code.clear();
+        prog_.offs.clear();
+        prog_.strs.clear();
+        prog_.threaded = false;
+        own_.clear();
+        native_.reset();
+        jit_tried_ = false;
+        arena_.reset();
+        vars_ = nullptr;
+        err_ = VerifyError{};
+    }
+
+    int execute_bc(const std::vector<uint8_t> &bc, bool verified, JitMode jit, VmProfile *prof)
+    {
+        return execute_bc(bc.data(), bc.size(), verified, jit, prof);
+    }
+
+    int execute_bc(const uint8_t *bc, size_t n, bool verified, JitMode jit, VmProfile *prof)
+    {
+#ifdef _WIN32
+        // 設定主控台輸出為 UTF-8 以正確顯示中文
+        SetConsoleOutputCP(65001);
+#endif
+        Vm vm;
+        vm.set_jit(jit);
+        vm.set_profile(prof);
+        if (!vm.load(bc, n, verified))
+        {
+            std::fprintf(stderr, "[vm] bytecode rejected at offset %zu: %s\n", vm.error().offset, vm.error().message.c_str());
+            return VM_REJECTED;
+        }
+        return vm.run();
+    }
+}
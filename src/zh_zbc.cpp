@@ -0,0 +1,207 @@
+// zh_zbc.cpp — .zbc 位元碼檔的寫出與載入
+#include "../include/zh_zbc.h"
+#include "../include/zh_bytecode.h"
+#include "../include/zh_cache.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+namespace selfhost
+{
+    static const uint8_t ZBC_MAGIC[4] = {'Z', 'B', 'C', 0x1A};
+    static const size_t ZBC_HEAD = 16;
+    static const size_t ZBC_ENTRY = 24;
+    static const uint32_t ZBC_MAX_SECTIONS = 64;
+
+    static void put_le(std::vector<uint8_t> &b, uint64_t v, int n)
+    {
+        for (int i = 0; i < n; i++)
+            b.push_back((uint8_t)(v >> (8 * i)));
+    }
+    static void set_le(std::vector<uint8_t> &b, size_t off, uint64_t v, int n)
+    {
+        for (int i = 0; i < n; i++)
+            b[off + i] = (uint8_t)(v >> (8 * i));
+    }
+    static uint64_t get_le(const uint8_t *p, int n)
+    {
+        uint64_t v = 0;
+        for (int i = 0; i < n; i++)
+            v |= (uint64_t)p[i] << (8 * i);
+        return v;
+    }
+
+    bool is_zbc_path(const std::filesystem::path &p)
+    {
+        std::string ext = p.extension().string();
+        std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+        return ext == ".zbc";
+    }
+
+    // IMAGE 內字串池與行表的範圍（相對 IMAGE 起點）；沒有時長度為 0
+    struct ImageRanges
+    {
+        size_t const_off = 0, const_size = 0, debug_off = 0, debug_size = 0;
+    };
+    static bool image_ranges(const uint8_t *bc, size_t n, ImageRanges &r)
+    {
+        BcHeader h;
+        if (!parse_header(bc, n, h))
+            return false;
+        r = ImageRanges{};
+        if (h.flags & BCF_POOL)
+        {
+            // 池緊接在 frame 之後：uleb(count)、結束位移表、內容
+            r.const_off = h.sections;
+            r.const_size = h.pool_data + (h.pool_count ? rd_u32le(bc + h.pool_ends + 4 * (size_t)(h.pool_count - 1)) : 0) -
+                           h.sections;
+        }
+        if (h.flags & BCF_DEBUG)
+        {
+            r.debug_off = h.debug;
+            r.debug_size = h.debug_end - h.debug;
+        }
+        return true;
+    }
+
+    std::vector<uint8_t> zbc_build(const std::vector<uint8_t> &bc, const std::string &frontend, const std::string &source)
+    {
+        ImageRanges r;
+        image_ranges(bc.data(), bc.size(), r);
+        std::vector<uint8_t> meta;
+        put_le(meta, frontend.size(), 4);
+        meta.insert(meta.end(), frontend.begin(), frontend.end());
+        put_le(meta, source.size(), 4);
+        meta.insert(meta.end(), source.begin(), source.end());
+
+        uint32_t count = 2 + (r.const_size ? 1 : 0) + (r.debug_size ? 1 : 0);
+        size_t meta_off = ZBC_HEAD + ZBC_ENTRY * count;
+        size_t image_off = meta_off + meta.size();
+        std::vector<uint8_t> out(ZBC_MAGIC, ZBC_MAGIC + 4);
+        put_le(out, ZBC_VERSION, 4);
+        put_le(out, count, 4);
+        put_le(out, 0, 4);
+        auto entry = [&](uint32_t kind, uint64_t off, uint64_t size)
+        {
+            put_le(out, kind, 4);
+            put_le(out, 0, 4);
+            put_le(out, off, 8);
+            put_le(out, size, 8);
+        };
+        entry(ZBC_SEC_META, meta_off, meta.size());
+        entry(ZBC_SEC_IMAGE, image_off, bc.size());
+        if (r.const_size)
+            entry(ZBC_SEC_CONST, image_off + r.const_off, r.const_size);
+        if (r.debug_size)
+            entry(ZBC_SEC_DEBUG, image_off + r.debug_off, r.debug_size);
+        out.insert(out.end(), meta.begin(), meta.end());
+        out.insert(out.end(), bc.begin(), bc.end());
+        put_le(out, 0, 4);
+        set_le(out, out.size() - 4, crc32(out.data(), out.size() - 4), 4);
+        return out;
+    }
+
+    bool ZbcFile::open(const std::filesystem::path &p, std::string &err)
+    {
+        *this = ZbcFile();
+        if (!file_.open(p))
+        {
+            err = "cannot open " + p.string();
+            return false;
+        }
+        const uint8_t *b = file_.data();
+        size_t n = file_.size();
+        if (n < ZBC_HEAD + 4 || std::memcmp(b, ZBC_MAGIC, 4) != 0)
+        {
+            err = "not a .zbc file";
+            return false;
+        }
+        version_ = (uint32_t)get_le(b + 4, 4);
+        if (version_ == 0 || version_ > ZBC_VERSION)
+        {
+            err = ".zbc version " + std::to_string(version_) + " is not supported (max " + std::to_string(ZBC_VERSION) + ")";
+            return false;
+        }
+        if (get_le(b + n - 4, 4) != crc32(b, n - 4))
+        {
+            err = "checksum mismatch";
+            return false;
+        }
+        uint32_t count = (uint32_t)get_le(b + 8, 4);
+        if (count > ZBC_MAX_SECTIONS || ZBC_HEAD + ZBC_ENTRY * (size_t)count > n - 4)
+        {
+            err = "bad section table";
+            return false;
+        }
+        size_t body = n - 4;
+        uint64_t const_off = 0, debug_off = 0;
+        bool have_image = false;
+        for (uint32_t i = 0; i < count; i++)
+        {
+            const uint8_t *e = b + ZBC_HEAD + ZBC_ENTRY * (size_t)i;
+            uint32_t kind = (uint32_t)get_le(e, 4);
+            uint64_t off = get_le(e + 8, 8), size = get_le(e + 16, 8);
+            if (off > body || size > body - off)
+            {
+                err = "section " + std::to_string(i) + " out of range";
+                return false;
+            }
+            switch (kind)
+            {
+            case ZBC_SEC_IMAGE:
+                if (have_image)
+                {
+                    err = "duplicate image section";
+                    return false;
+                }
+                have_image = true;
+                image_ = b + off;
+                image_size_ = (size_t)size;
+                break;
+            case ZBC_SEC_CONST:
+                const_off = off;
+                const_size_ = (size_t)size;
+                break;
+            case ZBC_SEC_DEBUG:
+                debug_off = off;
+                debug_size_ = (size_t)size;
+                break;
+            case ZBC_SEC_META:
+            {
+                const uint8_t *m = b + off;
+                size_t left = (size_t)size;
+                for (std::string *s : {&frontend_, &source_})
+                {
+                    if (left < 4 || get_le(m, 4) > left - 4)
+                    {
+                        err = "bad meta section";
+                        return false;
+                    }
+                    size_t len = (size_t)get_le(m, 4);
+                    s->assign((const char *)m + 4, len);
+                    m += 4 + len;
+                    left -= 4 + len;
+                }
+                break;
+            }
+            default:
+                break; // 之後版本的區段
+            }
+        }
+        if (!have_image)
+        {
+            err = "missing image section";
+            return false;
+        }
+        // CONST / DEBUG 必須正好是 IMAGE 標頭描述的範圍
+        ImageRanges r;
+        size_t base = (size_t)(image_ - b);
+        if (!image_ranges(image_, image_size_, r) || r.const_size != const_size_ || r.debug_size != debug_size_ ||
+            (const_size_ && const_off != base + r.const_off) || (debug_size_ && debug_off != base + r.debug_off))
+        {
+            err = "section table does not match the bytecode header";
+            return false;
+        }
+        return true;
+    }
+}
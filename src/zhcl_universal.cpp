@@ -1,3419 +1,4389 @@
-﻿// zhcl.cpp -- Universal Compiler & Build System Replacement
-// One CPP file to rule them all: C, C++, Java, Python, Go, Rust, JS/TS, and more
-// Replaces cl, gcc, g++, javac, cmake, make, and build systems
-
-#include <string>
-#include <vector>
-#include <cstdint>
-#include "../include/frontend.h"
-#include "../include/fe_clite.h"
-#include "../include/fe_cpplite.h"
-#include "../include/fe_jslite.h"
-#include "../include/fe_zh.h"
-#include "../include/zh_frontend.h"
-#include "../include/chinese_new.h"
-#include <iostream>
-#include <fstream>
-#include <sstream>
-#include <iterator>
-#include <iomanip>
-#include <algorithm>
-#include <cctype>
-#include <cstdio>
-#include <cstdlib>
-#include <ctime>
-#include <cmath>
-#include <map>
-#include <set>
-#include <filesystem>
-#include <regex>
-#include <thread>
-#include <mutex>
-#include <atomic>
-#include <unordered_map>
-#define WIN32_LEAN_AND_MEAN
-#define NOMINMAX
-#include <windows.h>
-
-// Use explicit std:: prefix instead of using namespace std
-namespace fs = std::filesystem;
-
-// 共用小工具：BOM/換行正規化
-static inline void strip_utf8_bom(std::string &s)
-{
-    if (s.size() >= 3 &&
-        (unsigned char)s[0] == 0xEF &&
-        (unsigned char)s[1] == 0xBB &&
-        (unsigned char)s[2] == 0xBF)
-    {
-        s.erase(0, 3);
-    }
-}
-
-static inline void normalize_newlines(std::string &s)
-{
-    // 把 CRLF/CR 全部正規化成 \n
-    std::string out;
-    out.reserve(s.size());
-    for (size_t i = 0; i < s.size(); ++i)
-    {
-        char c = s[i];
-        if (c == '\r')
-        {
-            if (i + 1 < s.size() && s[i + 1] == '\n')
-                ++i; // 吃掉 \r\n 的 \n
-            out.push_back('\n');
-        }
-        else
-        {
-            out.push_back(c);
-        }
-    }
-    s.swap(out);
-}
-
-// Forward declarations
-extern "C" int translate_zh_to_cpp(const std::string &input_path, const std::string &output_cpp_path, bool verbose);
-extern "C" void register_fe_clite();
-extern "C" void register_fe_cpplite();
-extern "C" void register_fe_jslite();
-extern "C" void register_fe_zh();
-extern "C" void register_fe_golite();
-extern "C" void register_fe_javalite();
-extern "C" void register_fe_pylite();
-
-// ======= SelfHost: payload trailer + runtime + packer (no external compilers) =======
-#ifdef _WIN32
-#include <windows.h>
-#endif
-#include <cstdint>
-#include <fstream>
-#include <sstream>
-
-namespace selfhost
-{
-
-    // ---- New: CRC32 (蝪∪?雲憭? ----
-    static uint32_t crc32(const uint8_t *data, size_t len)
-    {
-        uint32_t c = 0xFFFFFFFFu;
-        for (size_t i = 0; i < len; i++)
-        {
-            c ^= data[i];
-            for (int k = 0; k < 8; k++)
-            {
-                uint32_t m = -(int)(c & 1u);
-                c = (c >> 1) ^ (0xEDB88320u & m);
-            }
-        }
-        return ~c;
-    }
-
-    static const uint64_t SH_MAGIC = 0x305941505A48435Full; // ????
-    static const uint32_t SH_VERSION = 1;                   // <== New: ?
-
-#pragma pack(push, 1)
-    struct Trailer
-    {
-        uint64_t magic;          // SH_MAGIC
-        uint64_t payload_size;   // 雿?蝣潮摨?
-        uint64_t payload_offset; // 雿?蝣潸絲暺?
-        uint32_t version;        // <== New
-        uint32_t crc32;          // <== New (撠?payload 閮?)
-    };
-#pragma pack(pop)
-
-    // Move Op enum to global scope for visibility
-    enum Op : uint8_t
-    {
-        OP_PRINT = 1,
-        OP_PRINT_INT,
-        OP_SET_I64,
-        OP_COPY_I64,
-        OP_END
-    };
-
-    // === glue: .zh -> C++ using the new ZhFrontend (no Python needed) ===
-    static inline void emit_u64(std::vector<uint8_t> &bc, uint64_t v)
-    {
-        for (int i = 0; i < 8; i++)
-            bc.push_back((uint8_t)((v >> (8 * i)) & 0xFF)); // little-endian
-    }
-    static inline void emit_i64(std::vector<uint8_t> &bc, int64_t v)
-    {
-        emit_u64(bc, (uint64_t)v);
-    }
-
-    static void emit_PRINT_adapter(std::vector<uint8_t> &bc, const std::string &s)
-    {
-        bc.push_back((uint8_t)OP_PRINT);
-        emit_u64(bc, (uint64_t)s.size());
-        bc.insert(bc.end(), s.begin(), s.end());
-    }
-    static void emit_SET_I64_adapter(std::vector<uint8_t> &bc, uint8_t slot, long long v)
-    {
-        bc.push_back((uint8_t)OP_SET_I64);
-        bc.push_back(slot);
-        emit_i64(bc, v);
-    }
-    static void emit_PRINT_INT_adapter(std::vector<uint8_t> &bc, uint8_t slot)
-    {
-        bc.push_back((uint8_t)OP_PRINT_INT);
-        bc.push_back(slot);
-    }
-    static void emit_END_adapter(std::vector<uint8_t> &bc)
-    {
-        bc.push_back((uint8_t)OP_END);
-    }
-
-    // === glue: .zh -> C++ using the new ZhFrontend (no Python needed) ===
-
-    // 憒?瑼???恐??鋆?嚗歇摮撠梁??
-    extern std::string emit_cpp_from_bc(const std::vector<uint8_t> &bc);
-
-    // ---- ???脫? ----
-    static void disassemble_bc(const std::vector<uint8_t> &bc, std::ostream &out);
-    static int handle_selfhost_explain(int argc, char **argv);
-
-    // ---- 撠極??----
-    static std::string read_all(const fs::path &p)
-    {
-        std::ifstream f(p, std::ios::binary);
-        std::ostringstream ss;
-        ss << f.rdbuf();
-        return ss.str();
-    }
-    static bool write_all(const fs::path &p, const std::string &s)
-    {
-        fs::create_directories(p.parent_path());
-        std::ofstream f(p, std::ios::binary);
-        f.write(s.data(), (std::streamsize)s.size());
-        return (bool)f;
-    }
-    static bool file_copy(const fs::path &src, const fs::path &dst)
-    {
-        std::ifstream in(src, std::ios::binary);
-        if (!in)
-            return false;
-        std::ofstream out(dst, std::ios::binary);
-        if (!out)
-            return false;
-        out << in.rdbuf();
-        return (bool)out;
-    }
-    static std::vector<uint8_t> enc_print(const std::string &s)
-    {
-        std::vector<uint8_t> out;
-        uint64_t n = (uint64_t)s.size();
-        out.push_back((uint8_t)OP_PRINT);
-        for (int i = 0; i < 8; i++)
-            out.push_back((uint8_t)((n >> (8 * i)) & 0xFF)); // u64 LE
-        out.insert(out.end(), s.begin(), s.end());
-        return out;
-    }
-
-    // ---- ?渲陌?剁??瑁?雿?蝣潘?----
-    static void execute_bc(const std::vector<uint8_t> &bc)
-    {
-#ifdef _WIN32
-        // 閮剔蔭?批?唬誨蝣潮???UTF-8 隞交迤蝣粹＊蝷箔葉??
-        SetConsoleOutputCP(65001);
-        HANDLE hOut = GetStdHandle(STD_OUTPUT_HANDLE);
-        DWORD w = 0;
-        std::vector<int64_t> vars(256, 0); // 霈瑽賭?
-        size_t i = 0;
-        while (i < bc.size())
-        {
-            uint8_t op = bc[i++];
-            if (op == (uint8_t)OP_PRINT)
-            {
-                if (i + 8 > bc.size())
-                    break;
-                uint64_t n = 0;
-                for (int k = 0; k < 8; k++)
-                    n |= ((uint64_t)bc[i++]) << (8 * k);
-                if (i + n > bc.size())
-                    break;
-                const char *s = (const char *)&bc[i];
-                WriteFile(hOut, s, (DWORD)n, &w, nullptr);
-                WriteFile(hOut, "\r\n", 2, &w, nullptr);
-                i += (size_t)n;
-            }
-            else if (op == (uint8_t)OP_PRINT_INT)
-            {
-                if (i >= bc.size())
-                    break;
-                uint8_t id = bc[i++];
-                char buf[32];
-                sprintf(buf, "%lld\r\n", (long long)vars[id]);
-                WriteFile(hOut, buf, (DWORD)strlen(buf), &w, nullptr);
-            }
-            else if (op == (uint8_t)OP_SET_I64)
-            {
-                if (i + 9 > bc.size())
-                    break;
-                uint8_t id = bc[i++];
-                int64_t v = 0;
-                for (int k = 0; k < 8; k++)
-                    v |= ((int64_t)bc[i++]) << (8 * k);
-                vars[id] = v;
-            }
-            else if (op == (uint8_t)OP_COPY_I64)
-            {
-                if (i + 1 >= bc.size())
-                    break;
-                uint8_t dst = bc[i++];
-                uint8_t src = bc[i++];
-                vars[dst] = vars[src];
-            }
-            else if (op == (uint8_t)OP_END)
-            {
-                break;
-            }
-            else
-                break;
-        }
-        ExitProcess(0); // ?湔蝯?嚗???CLI
-#else
-        // POSIX ?啣?銋??fwrite/puts ?嚗??嚗?
-        std::vector<int64_t> vars(256, 0); // 霈瑽賭?
-        size_t i = 0;
-        while (i < bc.size())
-        {
-            uint8_t op = bc[i++];
-            if (op == (uint8_t)OP_PRINT)
-            {
-                if (i + 8 > bc.size())
-                    break;
-                uint64_t n = 0;
-                for (int k = 0; k < 8; k++)
-                    n |= ((uint64_t)bc[i++]) << (8 * k);
-                if (i + n > bc.size())
-                    break;
-                fwrite(&bc[i], 1, (size_t)n, stdout);
-                fputc('\n', stdout);
-                i += (size_t)n;
-            }
-            else if (op == (uint8_t)OP_PRINT_INT)
-            {
-                if (i >= bc.size())
-                    break;
-                uint8_t id = bc[i++];
-                fprintf(stdout, "%lld\n", (long long)vars[id]);
-            }
-            else if (op == (uint8_t)OP_SET_I64)
-            {
-                if (i + 9 > bc.size())
-                    break;
-                uint8_t id = bc[i++];
-                int64_t v = 0;
-                for (int k = 0; k < 8; k++)
-                    v |= ((int64_t)bc[i++]) << (8 * k);
-                vars[id] = v;
-            }
-            else if (op == (uint8_t)OP_COPY_I64)
-            {
-                if (i + 1 >= bc.size())
-                    break;
-                uint8_t dst = bc[i++];
-                uint8_t src = bc[i++];
-                vars[dst] = vars[src];
-            }
-            else if (op == (uint8_t)OP_END)
-            {
-                break;
-            }
-            else
-                break;
-        }
-        std::exit(0);
-#endif
-    }
-
-    // ---- ??霅臭??Ⅳ?箏霈?澆? ----
-
-    // ?芾?蝢拙?閬?摮?嚗??? UTF-8
-    static std::string quote_utf8_minimal(const std::string &s)
-    {
-        std::string out;
-        out.reserve(s.size() + 2);
-        out.push_back('\"');
-        for (unsigned char c : s)
-        {
-            switch (c)
-            {
-            case '\\':
-                out += "\\\\";
-                break;
-            case '\"':
-                out += "\\\"";
-                break;
-            case '\n':
-                out += "\\n";
-                break;
-            case '\r':
-                out += "\\r";
-                break;
-            case '\t':
-                out += "\\t";
-                break;
-            default:
-                // ??ASCII ?湔?見頛詨嚗TF-8嚗?
-                out.push_back((char)c);
-            }
-        }
-        out.push_back('\"');
-        return out;
-    }
-
-    static void disassemble_bc(const std::vector<uint8_t> &bc, std::ostream &out = std::cout)
-    {
-        out << "Bytecode disassembly:" << std::endl;
-        size_t i = 0;
-        while (i < bc.size())
-        {
-            out << std::setw(4) << std::setfill('0') << i << ": ";
-            uint8_t op = bc[i++];
-            switch (op)
-            {
-            case (uint8_t)OP_PRINT:
-            {
-                if (i + 8 > bc.size())
-                {
-                    out << "PRINT (incomplete)" << std::endl;
-                    return;
-                }
-                uint64_t n = 0;
-                for (int k = 0; k < 8; k++)
-                    n |= ((uint64_t)bc[i++]) << (8 * k);
-                if (i + n > bc.size())
-                {
-                    out << "PRINT (incomplete string)" << std::endl;
-                    return;
-                }
-                std::string s((const char *)&bc[i], (size_t)n);
-                out << "PRINT " << quote_utf8_minimal(s) << std::endl;
-                i += (size_t)n;
-                break;
-            }
-            case (uint8_t)OP_PRINT_INT:
-            {
-                if (i >= bc.size())
-                {
-                    out << "PRINT_INT (incomplete)" << std::endl;
-                    return;
-                }
-                uint8_t id = bc[i++];
-                out << "PRINT_INT v" << (int)id << std::endl;
-                break;
-            }
-            case (uint8_t)OP_SET_I64:
-            {
-                if (i + 9 > bc.size())
-                {
-                    out << "SET_I64 (incomplete)" << std::endl;
-                    return;
-                }
-                uint8_t id = bc[i++];
-                int64_t v = 0;
-                for (int k = 0; k < 8; k++)
-                    v |= ((int64_t)bc[i++]) << (8 * k);
-                out << "SET_I64 v" << (int)id << " = " << (long long)v << std::endl;
-                break;
-            }
-            case (uint8_t)OP_END:
-            {
-                out << "END" << std::endl;
-                return;
-            }
-            default:
-                out << "UNKNOWN_OP(0x" << std::setw(2) << std::setfill('0') << std::hex << (int)op << std::dec << ")" << std::endl;
-                return;
-            }
-        }
-        out << "End of bytecode" << std::endl;
-    }
-
-    // ---- New: 霈??+ 撽? trailer嚗???payload ??閮?----
-    struct PayloadInfo
-    {
-        std::vector<uint8_t> data;
-        Trailer tr{};
-        bool ok = false;
-        bool crc_ok = false;
-    };
-    static PayloadInfo read_payload_from_file(const fs::path &exe)
-    {
-        PayloadInfo R;
-        std::ifstream f(exe, std::ios::binary);
-        if (!f)
-            return R;
-        f.seekg(0, std::ios::end);
-        auto sz = (uint64_t)f.tellg();
-        if (sz < sizeof(Trailer))
-            return R;
-        f.seekg(sz - sizeof(Trailer));
-        f.read((char *)&R.tr, sizeof(Trailer));
-        if (!f || R.tr.magic != SH_MAGIC)
-            return R;
-        R.ok = true;
-        R.data.resize((size_t)R.tr.payload_size);
-        f.seekg((std::streamoff)R.tr.payload_offset);
-        f.read((char *)R.data.data(), (std::streamsize)R.tr.payload_size);
-        if (!f)
-        {
-            R.ok = false;
-            return R;
-        }
-        uint32_t c = crc32(R.data.data(), R.data.size());
-        R.crc_ok = (c == R.tr.crc32);
-        return R;
-    }
-
-    // ---- runtime嚗????亙葆 payload 撠勗?芾?璈怠? -> ?瑁? -> ???----
-    static bool maybe_run_embedded_payload()
-    {
-#ifdef _WIN32
-        wchar_t pathW[MAX_PATH]{0};
-        GetModuleFileNameW(nullptr, pathW, MAX_PATH);
-        fs::path self(pathW);
-#else
-        fs::path self = "/proc/self/exe";
-#endif
-        auto R = read_payload_from_file(self);
-        if (!R.ok)
-            return false;
-
-        // 霈??R 銋??璈怠?銋??嚗?
-        bool show_proof = false;
-
-// 1) ?賭誘???貉孛?潘??舀 --prove / --proof / --selfhost-info嚗?
-#ifdef _WIN32
-        {
-            std::wstring cmd = GetCommandLineW();
-            std::wstring lower = cmd;
-            std::transform(lower.begin(), lower.end(), lower.begin(), ::towlower);
-            if (lower.find(L"--prove") != std::wstring::npos ||
-                lower.find(L"--proof") != std::wstring::npos ||
-                lower.find(L"--selfhost-info") != std::wstring::npos)
-            {
-                show_proof = true;
-            }
-        }
-#else
-        {
-            // ??Windows ?舐 argc/argv ??/proc/self/cmdline嚗?雿??暹??嗆???嚗?
-            // 銝?舐?靘??乩??券?楝敺銝 argv嚗隞亙??仿?嚗??函憓??詨??剁?
-        }
-#endif
-
-        // 2) ?啣?霈閫貊嚗I/?單?剁?
-        if (const char *s = std::getenv("ZHCL_SELFHOST_SHOW"))
-        {
-            if (s[0] == '1' || s[0] == 'y' || s[0] == 'Y' || s[0] == 't' || s[0] == 'T')
-            {
-                show_proof = true;
-            }
-        }
-
-        // 3) ?乩?? Trailer.flags 閮剝??HF_SILENT_BANNER??甇方??臬??典蕭?亙?
-        //    ???券?閮剖停?舫?暺??芣?憿臬?閬??＊蝷箝?
-
-        // ????ㄐ?舐??printf 璈怠? ??
-        //    ?寞?嚗??show_proof ?
-        if (show_proof)
-        {
-            std::printf("[selfhost] payload v%u %s size=%llu crc=%s\n",
-                        R.tr.version,
-                        (R.ok ? "found" : "missing"),
-                        (unsigned long long)R.tr.payload_size,
-                        (R.crc_ok ? "OK" : "BAD"));
-        }
-
-        if (!R.crc_ok)
-        {
-            std::fprintf(stderr, "[selfhost] CRC mismatch, abort.\n");
-            std::exit(3);
-        }
-
-        execute_bc(R.data); // 銝???
-        return true;
-    }
-
-    // ---- 蝧餉陌?剁?JS ??雿?蝣潘?PoC嚗onsole.log("??) / ?嗡?敹賜嚗?---
-    static std::vector<uint8_t> translate_js_to_bc(const std::string &js)
-    {
-        std::vector<uint8_t> bc;
-        std::istringstream ss(js);
-        std::string line;
-        // ??????撓??
-        while (std::getline(ss, line))
-        {
-            // ?駁??蝛箇
-            size_t start = line.find_first_not_of(" \t");
-            if (start == std::string::npos)
-                continue;
-            line = line.substr(start);
-            if (line.empty())
-                continue;
-
-            auto pos = line.find("console.log");
-            if (pos != std::string::npos)
-            {
-                // ?曉 console.log( 銋??摰?
-                size_t paren_start = line.find('(', pos);
-                if (paren_start == std::string::npos)
-                    continue;
-                size_t paren_end = line.find(')', paren_start);
-                if (paren_end == std::string::npos)
-                    continue;
-
-                std::string arg = line.substr(paren_start + 1, paren_end - paren_start - 1);
-                // 蝪∪??嚗??隞亙???憪?蝯?嚗??摰?
-                if (arg.size() >= 2 && arg.front() == '"' && arg.back() == '"')
-                {
-                    std::string content = arg.substr(1, arg.size() - 2);
-                    auto v = enc_print(content);
-                    bc.insert(bc.end(), v.begin(), v.end());
-                }
-                // TODO: ??霈??憒?"x = " + x
-            }
-            // 敹賜?嗡?銵?霈?脫???貊?嚗?
-        }
-        // 憒?瘝?銵??泵嚗?閰西????蝚虫葡
-        if (bc.empty())
-        {
-            std::string content = js;
-            // ?駁??蝛箇
-            size_t start = content.find_first_not_of(" \t\r\n");
-            if (start != std::string::npos)
-            {
-                content = content.substr(start);
-                size_t end = content.find_last_not_of(" \t\r\n");
-                if (end != std::string::npos)
-                {
-                    content = content.substr(0, end + 1);
-                }
-            }
-
-            auto pos = content.find("console.log");
-            if (pos != std::string::npos)
-            {
-                // ?曉 console.log( 銋??摰?
-                size_t paren_start = content.find('(', pos);
-                if (paren_start != std::string::npos)
-                {
-                    size_t paren_end = content.find(')', paren_start);
-                    if (paren_end != std::string::npos)
-                    {
-                        std::string arg = content.substr(paren_start + 1, paren_end - paren_start - 1);
-                        // 蝪∪??嚗??隞亙???憪?蝯?嚗??摰?
-                        if (arg.size() >= 2 && arg.front() == '"' && arg.back() == '"')
-                        {
-                            std::string text = arg.substr(1, arg.size() - 2);
-                            auto v = enc_print(text);
-                            bc.insert(bc.end(), v.begin(), v.end());
-                        }
-                    }
-                }
-            }
-        }
-        return bc;
-    }
-
-    // ---- 蝧餉陌?剁?銝剜??芰隤? .zh ??雿?蝣潘?PoC嚗撓?箏?銝?"?? / ?嗡??見嚗?---
-
-    // 1) UTF-8 BOM ?駁 + ?典耦撘?/蝛箇甇????+ 蝜陛撠?
-    static inline void strip_bom_utf8(std::string &s)
-    {
-        if (s.size() >= 3 && (uint8_t)s[0] == 0xEF && (uint8_t)s[1] == 0xBB && (uint8_t)s[2] == 0xBF)
-            s.erase(0, 3);
-    }
-
-    static inline void replace_all(std::string &s, const std::string &a, const std::string &b)
-    {
-        if (a.empty())
-            return;
-        size_t pos = 0;
-        while ((pos = s.find(a, pos)) != std::string::npos)
-        {
-            s.replace(pos, a.size(), b);
-            pos += b.size();
-        }
-    }
-
-    // 嚗?賂?IR ??C++嚗??箝?蝯虫犖???Ｙ嚗?
-    std::string emit_cpp_from_bc(const std::vector<uint8_t> &bc)
-    {
-        std::ostringstream out;
-        out << "#include <cstdio>\n#include <cstdint>\nint main(){\n";
-
-        // First pass: collect all variable IDs that are used
-        std::set<uint8_t> used_vars;
-        size_t i = 0;
-        while (i < bc.size())
-        {
-            uint8_t op = bc[i++];
-            if (op == (uint8_t)OP_PRINT_INT)
-            {
-                if (i < bc.size())
-                {
-                    uint8_t id = bc[i++];
-                    used_vars.insert(id);
-                }
-            }
-            else if (op == (uint8_t)OP_SET_I64)
-            {
-                if (i < bc.size())
-                {
-                    uint8_t id = bc[i++];
-                    used_vars.insert(id);
-                    i += 8; // skip the value
-                }
-            }
-            else if (op == (uint8_t)OP_PRINT)
-            {
-                if (i + 8 <= bc.size())
-                {
-                    uint64_t n = 0;
-                    for (int k = 0; k < 8; k++)
-                        n |= ((uint64_t)bc[i++]) << (8 * k);
-                    i += (size_t)n;
-                }
-            }
-            else if (op == (uint8_t)OP_END)
-            {
-                break;
-            }
-        }
-
-        // Declare all variables at the beginning
-        for (uint8_t id : used_vars)
-        {
-            out << "  long long v" << (int)id << " = 0;\n";
-        }
-
-        // Second pass: generate operations
-        i = 0;
-        while (i < bc.size())
-        {
-            uint8_t op = bc[i++];
-            if (op == (uint8_t)OP_PRINT)
-            {
-                uint64_t n = 0;
-                for (int k = 0; k < 8; k++)
-                    n |= ((uint64_t)bc[i++]) << (8 * k);
-                std::string s((const char *)&bc[i], (size_t)n);
-                i += (size_t)n;
-                out << "  std::puts(\"";
-                for (char c : s)
-                {
-                    if (c == '\\' || c == '"')
-                        out << '\\';
-                    out << c;
-                }
-                out << "\");\n";
-            }
-            else if (op == (uint8_t)OP_PRINT_INT)
-            {
-                uint8_t id = bc[i++];
-                out << "  std::printf(\"%lld\\n\", (long long)v" << (int)id << ");\n";
-            }
-            else if (op == (uint8_t)OP_SET_I64)
-            {
-                uint8_t id = bc[i++];
-                int64_t v = 0;
-                for (int k = 0; k < 8; k++)
-                    v |= ((int64_t)bc[i++]) << (8 * k);
-                out << "  v" << (int)id << " = " << (long long)v << ";\n";
-            }
-            else if (op == (uint8_t)OP_END)
-            {
-                break;
-            }
-            else
-            {
-                out << "  // OP_" << (int)op << "\n";
-                break;
-            }
-        }
-        out << "  return 0;\n}\n";
-        return out.str();
-    }
-
-    // ---- 蝧餉陌?剁?Python ??雿?蝣潘?PoC嚗rint("??) / ?嗡?敹賜嚗?---
-    static std::vector<uint8_t> translate_py_to_bc(const std::string &py)
-    {
-        std::vector<uint8_t> bc;
-        std::istringstream ss(py);
-        std::string line;
-        while (std::getline(ss, line))
-        {
-            // ?駁??蝛箇
-            size_t start = line.find_first_not_of(" \t");
-            if (start == std::string::npos)
-                continue;
-            line = line.substr(start);
-            if (line.empty())
-                continue;
-
-            auto pos = line.find("print(");
-            if (pos != std::string::npos)
-            {
-                // ?曉 print( 銋??摰?
-                size_t paren_start = line.find('(', pos);
-                if (paren_start == std::string::npos)
-                    continue;
-                size_t paren_end = line.find(')', paren_start);
-                if (paren_end == std::string::npos)
-                    continue;
-
-                std::string arg = line.substr(paren_start + 1, paren_end - paren_start - 1);
-                // 蝪∪??嚗??隞亙???憪?蝯?嚗??摰?
-                if (arg.size() >= 2 && arg.front() == '"' && arg.back() == '"')
-                {
-                    std::string content = arg.substr(1, arg.size() - 2);
-                    auto v = enc_print(content);
-                    bc.insert(bc.end(), v.begin(), v.end());
-                }
-            }
-            // 敹賜?嗡?銵?霈?脫???貊?嚗?
-        }
-        return bc;
-    }
-
-    // ---- 蝧餉陌?剁?Go ??雿?蝣潘?PoC嚗mt.Println("??) / ?嗡?敹賜嚗?---
-    static std::vector<uint8_t> translate_go_to_bc(const std::string &go)
-    {
-        std::vector<uint8_t> bc;
-        std::istringstream ss(go);
-        std::string line;
-        while (std::getline(ss, line))
-        {
-            // ?駁??蝛箇
-            size_t start = line.find_first_not_of(" \t");
-            if (start == std::string::npos)
-                continue;
-            line = line.substr(start);
-            if (line.empty())
-                continue;
-
-            auto pos = line.find("fmt.Println(");
-            if (pos != std::string::npos)
-            {
-                // ?曉 fmt.Println( 銋??摰?
-                size_t paren_start = line.find('(', pos);
-                if (paren_start == std::string::npos)
-                    continue;
-                size_t paren_end = line.find(')', paren_start);
-                if (paren_end == std::string::npos)
-                    continue;
-
-                std::string arg = line.substr(paren_start + 1, paren_end - paren_start - 1);
-                // 蝪∪??嚗??隞亙???憪?蝯?嚗??摰?
-                if (arg.size() >= 2 && arg.front() == '"' && arg.back() == '"')
-                {
-                    std::string content = arg.substr(1, arg.size() - 2);
-                    auto v = enc_print(content);
-                    bc.insert(bc.end(), v.begin(), v.end());
-                }
-            }
-            // 敹賜?嗡?銵?霈?脫???貊?嚗?
-        }
-        return bc;
-    }
-
-    // ---- 蝧餉陌?剁?Java ??雿?蝣潘?PoC嚗ystem.out.println("??) / ?嗡?敹賜嚗?---
-    static std::vector<uint8_t> translate_java_to_bc(const std::string &java)
-    {
-        std::vector<uint8_t> bc;
-        std::istringstream ss(java);
-        std::string line;
-        while (std::getline(ss, line))
-        {
-            // ?駁??蝛箇
-            size_t start = line.find_first_not_of(" \t");
-            if (start == std::string::npos)
-                continue;
-            line = line.substr(start);
-            if (line.empty())
-                continue;
-
-            auto pos = line.find("System.out.println(");
-            if (pos != std::string::npos)
-            {
-                // ?曉 System.out.println( 銋??摰?
-                size_t paren_start = line.find('(', pos);
-                if (paren_start == std::string::npos)
-                    continue;
-                size_t paren_end = line.find(')', paren_start);
-                if (paren_end == std::string::npos)
-                    continue;
-
-                std::string arg = line.substr(paren_start + 1, paren_end - paren_start - 1);
-                // 蝪∪??嚗??隞亙???憪?蝯?嚗??摰?
-                if (arg.size() >= 2 && arg.front() == '"' && arg.back() == '"')
-                {
-                    std::string content = arg.substr(1, arg.size() - 2);
-                    auto v = enc_print(content);
-                    bc.insert(bc.end(), v.begin(), v.end());
-                }
-            }
-            // 敹賜?嗡?銵?霈?脫???貊?嚗?
-        }
-        return bc;
-    }
-
-    // ---- pack嚗神??version ??CRC??芾?閮 ----
-    static int pack_payload_to_exe(const fs::path &output_exe, const std::vector<uint8_t> &bc,
-#ifdef _WIN32
-                                   const fs::path &self_exe = []
-                                   {
-                                   wchar_t pathW[MAX_PATH]{0};
-                                   GetModuleFileNameW(nullptr, pathW, MAX_PATH);
-                                   return fs::path(pathW); }()
-#else
-                                   const fs::path &self_exe = "/proc/self/exe"
-#endif
-    )
-    {
-        if (!file_copy(self_exe, output_exe))
-        {
-            std::fprintf(stderr, "[selfhost] copy self -> out failed\n");
-            return 4;
-        }
-        std::ofstream out(output_exe, std::ios::binary | std::ios::app);
-        if (!out)
-        {
-            std::fprintf(stderr, "[selfhost] open out for append failed\n");
-            return 5;
-        }
-        uint64_t off = (uint64_t)fs::file_size(output_exe);
-        out.write((const char *)bc.data(), (std::streamsize)bc.size());
-
-        Trailer tr{};
-        tr.magic = SH_MAGIC;
-        tr.payload_size = (uint64_t)bc.size();
-        tr.payload_offset = off;
-        tr.version = SH_VERSION;                // <== New
-        tr.crc32 = crc32(bc.data(), bc.size()); // <== New
-
-        out.write((const char *)&tr, sizeof(tr));
-        out.flush();
-
-        std::printf("[selfhost] packed -> %s (v%u, size=%llu, crc=%08X)\n",
-                    output_exe.string().c_str(),
-                    tr.version,
-                    (unsigned long long)tr.payload_size,
-                    tr.crc32);
-
-        return 0;
-    }
-
-    // ---- JAR格式打包 (JAR format packing) ----
-    static int pack_payload_to_jar(const fs::path &output_jar, const std::vector<uint8_t> &bc, const std::string &lang)
-    {
-        // 創建臨時目錄結構
-        fs::path temp_dir = output_jar;
-        temp_dir.replace_extension(".jar_temp");
-        fs::create_directories(temp_dir);
-
-        // 創建META-INF目錄
-        fs::path meta_inf = temp_dir / "META-INF";
-        fs::create_directories(meta_inf);
-
-        // 創建MANIFEST.MF
-        fs::path manifest_path = meta_inf / "MANIFEST.MF";
-        std::ofstream manifest(manifest_path, std::ios::binary);
-        if (!manifest)
-        {
-            std::fprintf(stderr, "[selfhost] create manifest failed\n");
-            return 6;
-        }
-        manifest << "Manifest-Version: 1.0\r\n";
-        manifest << "Main-Class: Main\r\n";
-        manifest << "Created-By: zhcl_universal\r\n";
-        manifest << "\r\n";
-        manifest.close();
-
-        // 保存字節碼文件
-        fs::path bytecode_path = temp_dir / ("Main." + lang + ".bc");
-        std::ofstream bc_file(bytecode_path, std::ios::binary);
-        if (!bc_file)
-        {
-            std::fprintf(stderr, "[selfhost] create bytecode file failed\n");
-            return 7;
-        }
-        bc_file.write((const char *)bc.data(), (std::streamsize)bc.size());
-        bc_file.close();
-
-        // 使用系統zip命令創建JAR文件
-        std::string zip_cmd = "cd \"" + temp_dir.parent_path().string() + "\" && zip -r \"" +
-                              output_jar.string() + "\" \"" + temp_dir.filename().string() + "\"";
-        int zip_result = std::system(zip_cmd.c_str());
-
-        // 清理臨時文件
-        fs::remove_all(temp_dir);
-
-        if (zip_result != 0)
-        {
-            std::fprintf(stderr, "[selfhost] zip command failed (code: %d)\n", zip_result);
-            return 8;
-        }
-
-        std::printf("[selfhost] packed -> %s (JAR format, size=%llu)\n",
-                    output_jar.string().c_str(),
-                    (unsigned long long)bc.size());
-
-        return 0;
-    }
-
-    // ---- 撠??亙嚗 CLI ?澆 ----
-
-    static int pack_from_file(const std::string &lang, const fs::path &in, const fs::path &out)
-    {
-        std::string src = read_all(in);
-        // BOM/換行正規化
-        strip_utf8_bom(src);
-        normalize_newlines(src);
-
-        std::vector<uint8_t> bc;
-        if (lang == "js" || lang == "javascript")
-            bc = translate_js_to_bc(src);
-        else if (lang == "py" || lang == "python")
-            bc = translate_py_to_bc(src);
-        else if (lang == "go")
-            bc = translate_go_to_bc(src);
-        else if (lang == "java")
-            bc = translate_java_to_bc(src);
-        else if (lang == "zh")
-        {
-            ZhFrontend fe;
-            bc = fe.translate_to_bc(src);
-        }
-        else
-        {
-            std::fprintf(stderr, "[selfhost] unsupported lang: %s\n", lang.c_str());
-            return 2;
-        }
-        return pack_payload_to_exe(out, bc);
-    }
-
-    // ---- 撠??亙銝?嚗ack_from_file嚗?銝??verify ??喳 ----
-    static int verify_exe(const fs::path &exe)
-    {
-        auto R = read_payload_from_file(exe);
-        if (!R.ok)
-        {
-            std::fprintf(stderr, "[selfhost] no payload in: %s\n", exe.string().c_str());
-            return 2;
-        }
-        std::printf("[selfhost] verify: %s\n", exe.string().c_str());
-        std::printf("  version : %u\n", R.tr.version);
-        std::printf("  size    : %llu bytes\n", (unsigned long long)R.tr.payload_size);
-        std::printf("  offset  : %llu\n", (unsigned long long)R.tr.payload_offset);
-        std::printf("  crc32   : %08X (%s)\n", R.tr.crc32, R.crc_ok ? "OK" : "BAD");
-        return R.crc_ok ? 0 : 3;
-    }
-
-    // ---- handle selfhost explain command ----
-    static int handle_selfhost_explain(int argc, char **argv)
-    {
-        if (argc < 4)
-        {
-            std::puts("Usage:\n  zhcl_universal selfhost explain <input.(js|py|go|java|zh)>");
-            return 2;
-        }
-        fs::path in = argv[3];
-        std::string src = read_all(in); // ??征??舐?亦
-        // BOM/換行正規化
-        strip_utf8_bom(src);
-        normalize_newlines(src);
-
-        std::vector<uint8_t> bc;
-        auto ext = in.extension().string();
-        if (ext == ".js")
-            bc = translate_js_to_bc(src);
-        else if (ext == ".py")
-            bc = translate_py_to_bc(src);
-        else if (ext == ".go")
-            bc = translate_go_to_bc(src);
-        else if (ext == ".java")
-            bc = translate_java_to_bc(src);
-        else if (ext == ".zh")
-        {
-            ZhFrontend fe;
-            bc = fe.translate_to_bc(src);
-        }
-        else
-        {
-            std::fprintf(stderr, "[selfhost] unsupported input: %s\n", ext.c_str());
-            return 2;
-        }
-        disassemble_bc(bc);
-        return 0;
-    }
-
-} // namespace selfhost
-
-// === glue: .zh -> C++ using the new ZhFrontend (no Python needed) ===
-static inline void emit_u64(std::vector<uint8_t> &bc, uint64_t v)
-{
-    for (int i = 0; i < 8; i++)
-        bc.push_back((uint8_t)((v >> (8 * i)) & 0xFF)); // little-endian
-}
-static inline void emit_i64(std::vector<uint8_t> &bc, int64_t v)
-{
-    emit_u64(bc, (uint64_t)v);
-}
-
-static void emit_PRINT_adapter(std::vector<uint8_t> &bc, const std::string &s)
-{
-    bc.push_back((uint8_t)selfhost::OP_PRINT);
-    emit_u64(bc, (uint64_t)s.size());
-    bc.insert(bc.end(), s.begin(), s.end());
-}
-static void emit_SET_I64_adapter(std::vector<uint8_t> &bc, uint8_t slot, long long v)
-{
-    bc.push_back((uint8_t)selfhost::OP_SET_I64);
-    bc.push_back(slot);
-    emit_i64(bc, v);
-}
-static void emit_PRINT_INT_adapter(std::vector<uint8_t> &bc, uint8_t slot)
-{
-    bc.push_back((uint8_t)selfhost::OP_PRINT_INT);
-    bc.push_back(slot);
-}
-static void emit_END_adapter(std::vector<uint8_t> &bc)
-{
-    bc.push_back((uint8_t)selfhost::OP_END);
-}
-
-// Forward declarations
-class CompilerRegistry;
-class LanguageProcessor;
-class CppProcessor;
-class JavaProcessor;
-class PythonProcessor;
-class GoProcessor;
-class RustProcessor;
-
-// JVM Bytecode Writer (Big-Endian)
-struct W
-{
-    std::vector<uint8_t> buf;
-    void u1(uint8_t x) { buf.push_back(x); }
-    void u2(uint16_t x)
-    {
-        buf.push_back((x >> 8) & 0xFF);
-        buf.push_back(x & 0xFF);
-    }
-    void u4(uint32_t x)
-    {
-        buf.push_back((x >> 24) & 0xFF);
-        buf.push_back((x >> 16) & 0xFF);
-        buf.push_back((x >> 8) & 0xFF);
-        buf.push_back(x & 0xFF);
-    }
-    void bytes(const void *p, size_t n)
-    {
-        auto c = (const uint8_t *)p;
-        buf.insert(buf.end(), c, c + n);
-    }
-    void utf8(const std::string &s)
-    {
-        u1(1);
-        u2((uint16_t)s.size());
-        bytes(s.data(), s.size());
-    }
-};
-
-// ============================================================================
-// LANGUAGE PROCESSORS - Handle compilation for each language
-// ============================================================================
-
-class LanguageProcessor
-{
-public:
-    virtual ~LanguageProcessor() = default;
-    virtual bool can_handle(const std::string &ext) = 0;
-    virtual int compile(const std::string &input, const std::string &output,
-                        const std::vector<std::string> &flags, bool verbose) = 0;
-    virtual int run(const std::string &executable, bool verbose) = 0;
-    virtual std::string get_default_output(const std::string &input) = 0;
-};
-
-// ============================================================================
-// COMPILER REGISTRY SYSTEM - Detects and manages all compilers
-// ============================================================================
-
-class CompilerRegistry
-{
-public:
-    struct Compiler
-    {
-        std::string name;
-        std::string command;
-        std::vector<std::string> flags;
-        std::set<std::string> supported_languages;
-        bool available = false;
-        int priority = 0; // Higher = preferred
-    };
-
-    std::map<std::string, Compiler> compilers;
-
-    void detect_compilers()
-    {
-        // C/C++ Compilers
-        detect_compiler("msvc", "cl", {"C", "C++"}, {"-nologo", "-utf-8", "-EHsc", "-std:c++17"}, 100);
-        detect_compiler("gcc", "gcc", {"C", "C++"}, {"-Wall", "-std=c++17"}, 90);
-        detect_compiler("g++", "g++", {"C++"}, {"-Wall", "-std=c++17"}, 90);
-        detect_compiler("clang", "clang", {"C", "C++"}, {"-Wall", "-std=c++17"}, 95);
-        detect_compiler("clang++", "clang++", {"C++"}, {"-Wall", "-std=c++17"}, 95);
-
-        // JVM Languages
-        detect_compiler("javac", "javac", {"Java"}, {"-g"}, 80);
-        detect_compiler("kotlin", "kotlinc", {"Kotlin"}, {}, 70);
-        detect_compiler("scala", "scalac", {"Scala"}, {}, 70);
-
-        // Systems Languages
-        detect_compiler("rustc", "rustc", {"Rust"}, {"-O"}, 85);
-        detect_compiler("go", "go", {"Go"}, {}, 85);
-        detect_compiler("swift", "swiftc", {"Swift"}, {}, 75);
-
-        // Scripting Languages
-        detect_compiler("python", "python", {"Python"}, {}, 60);
-        detect_compiler("node", "node", {"JavaScript"}, {}, 60);
-        detect_compiler("tsc", "tsc", {"TypeScript"}, {}, 65);
-        detect_compiler("ruby", "ruby", {"Ruby"}, {}, 60);
-        detect_compiler("perl", "perl", {"Perl"}, {}, 60);
-
-        // .NET
-        detect_compiler("dotnet", "dotnet", {"C#", "F#", "VB.NET"}, {}, 80);
-        detect_compiler("mono", "mcs", {"C#"}, {}, 70);
-
-        // Special cases
-        detect_compiler("zhcc", "zhcc_cpp.exe", {"Chinese"}, {"--cc"}, 50);
-    }
-
-private:
-    void detect_compiler(const std::string &name, const std::string &cmd, const std::set<std::string> &langs,
-                         const std::vector<std::string> &flags, int priority)
-    {
-        std::string test_cmd;
-        if (name == "msvc")
-        {
-            test_cmd = cmd + " /? >nul 2>&1";
-        }
-        else
-        {
-            test_cmd = cmd + " --version >nul 2>&1";
-        }
-        bool available = (system(test_cmd.c_str()) == 0);
-
-        compilers[name] = {name, cmd, flags, langs, available, priority};
-
-        if (!available)
-        {
-            // Try alternative test commands
-            std::vector<std::string> alt_tests;
-            if (name == "msvc")
-            {
-                alt_tests = {" /help", ""};
-            }
-            else
-            {
-                alt_tests = {" --help", " -v", " -version", ""};
-            }
-            for (const auto &alt : alt_tests)
-            {
-                if (system((cmd + alt + " >nul 2>&1").c_str()) == 0)
-                {
-                    compilers[name].available = true;
-                    break;
-                }
-            }
-
-            // Special handling for MSVC: search common installation paths
-            if (!compilers[name].available && name == "msvc")
-            {
-                // Try the exact path from compile_definitions.bat first
-                std::string exact_path = "C:\\Program Files (x86)\\Microsoft Visual Studio\\2019\\BuildTools\\VC\\Tools\\MSVC\\14.29.30133\\bin\\Hostx64\\x64\\cl.exe";
-                std::string test_exact = "\"" + exact_path + "\" /? >nul 2>&1";
-                if (system(test_exact.c_str()) == 0)
-                {
-                    compilers[name].available = true;
-                    compilers[name].command = "\"" + exact_path + "\"";
-                }
-                else
-                {
-                    // Fallback to path search
-                    std::vector<std::string> common_paths = {
-                        "C:\\Program Files\\Microsoft Visual Studio\\2022\\Professional\\VC\\Tools\\MSVC",
-                        "C:\\Program Files\\Microsoft Visual Studio\\2022\\Enterprise\\VC\\Tools\\MSVC",
-                        "C:\\Program Files\\Microsoft Visual Studio\\2022\\Community\\VC\\Tools\\MSVC",
-                        "C:\\Program Files (x86)\\Microsoft Visual Studio\\2019\\Professional\\VC\\Tools\\MSVC",
-                        "C:\\Program Files (x86)\\Microsoft Visual Studio\\2019\\Enterprise\\VC\\Tools\\MSVC",
-                        "C:\\Program Files (x86)\\Microsoft Visual Studio\\2019\\Community\\VC\\Tools\\MSVC",
-                        "C:\\Program Files (x86)\\Microsoft Visual Studio\\2019\\BuildTools\\VC\\Tools\\MSVC",
-                        "C:\\Program Files (x86)\\Microsoft Visual Studio\\2017\\Professional\\VC\\Tools\\MSVC",
-                        "C:\\Program Files (x86)\\Microsoft Visual Studio\\2017\\Enterprise\\VC\\Tools\\MSVC",
-                        "C:\\Program Files (x86)\\Microsoft Visual Studio\\2017\\Community\\VC\\Tools\\MSVC",
-                        "C:\\Program Files (x86)\\Microsoft Visual Studio\\2017\\BuildTools\\VC\\Tools\\MSVC"};
-
-                    for (const auto &base_path : common_paths)
-                    {
-                        if (fs::exists(base_path))
-                        {
-                            // Find the latest version directory
-                            std::vector<std::string> versions;
-                            for (const auto &entry : fs::directory_iterator(base_path))
-                            {
-                                if (fs::is_directory(entry))
-                                {
-                                    versions.push_back(entry.path().string());
-                                }
-                            }
-                            if (!versions.empty())
-                            {
-                                // Sort and take the latest version
-                                std::sort(versions.begin(), versions.end());
-                                std::string latest_version = versions.back();
-                                std::string cl_path = latest_version + "\\bin\\Hostx64\\x64\\cl.exe";
-                                std::string test_cl = "\"" + cl_path + "\" /? >nul 2>&1";
-                                if (system(test_cl.c_str()) == 0)
-                                {
-                                    compilers[name].available = true;
-                                    compilers[name].command = "\"" + cl_path + "\"";
-                                    break;
-                                }
-                            }
-                        }
-                    }
-                }
-            }
-        }
-    }
-};
-
-class CppProcessor : public LanguageProcessor
-{
-public:
-    CompilerRegistry *registry;
-
-    bool can_handle(const std::string &ext) override
-    {
-        return ext == ".c" || ext == ".cpp" || ext == ".cc" || ext == ".cxx";
-    }
-
-    int compile(const std::string &input, const std::string &output,
-                const std::vector<std::string> &flags, bool verbose) override
-    {
-        // Find best available C++ compiler
-        std::string compiler_cmd;
-        std::vector<std::string> default_flags;
-
-        if (registry->compilers["msvc"].available)
-        {
-            compiler_cmd = registry->compilers["msvc"].command;
-            default_flags = {"/nologo", "/utf-8", "/EHsc", "/std:c++17"};
-        }
-        else if (registry->compilers["clang++"].available)
-        {
-            compiler_cmd = registry->compilers["clang++"].command;
-            default_flags = {"-Wall", "-std=c++17"};
-        }
-        else if (registry->compilers["g++"].available)
-        {
-            compiler_cmd = registry->compilers["g++"].command;
-            default_flags = {"-Wall", "-std=c++17"};
-        }
-        else
-        {
-            // No compiler available
-            std::cerr << "Error: No C/C++ compiler found. Please install Visual Studio, GCC, or Clang." << std::endl;
-            return 1;
-        }
-
-        std::string cmd = compiler_cmd;
-        for (const auto &flag : default_flags)
-            cmd += " " + flag;
-        for (const auto &flag : flags)
-            cmd += " " + flag;
-        cmd += " \"" + input + "\"";
-
-        if (!output.empty())
-        {
-            if (compiler_cmd.find("cl") != std::string::npos)
-            {
-                cmd += " /Fe:\"" + output + "\"";
-            }
-            else
-            {
-                cmd += " -o \"" + output + "\"";
-            }
-        }
-
-        if (verbose)
-            std::cout << "Compiling C/C++: " << cmd << std::endl;
-        return system(cmd.c_str());
-    }
-
-    int run(const std::string &executable, bool verbose) override
-    {
-        std::string cmd = "\"" + executable + "\"";
-        if (verbose)
-            std::cout << "Running: " << cmd << std::endl;
-        return system(cmd.c_str());
-    }
-
-    std::string get_default_output(const std::string &input) override
-    {
-        return input.substr(0, input.find_last_of('.')) + ".exe";
-    }
-};
-
-class JavaProcessor : public LanguageProcessor
-{
-public:
-    CompilerRegistry *registry;
-
-    bool can_handle(const std::string &ext) override
-    {
-        return ext == ".java" || ext == ".jar";
-    }
-
-    int compile(const std::string &input, const std::string &output,
-                const std::vector<std::string> &flags, bool verbose) override
-    {
-        // Check if output is JAR
-        bool is_jar = !output.empty() && output.size() > 4 &&
-                      output.substr(output.size() - 4) == ".jar";
-
-        std::string class_output = output;
-        if (is_jar)
-        {
-            // For JAR output, first compile to .class
-            class_output = output.substr(0, output.size() - 4) + ".class";
-        }
-
-        // Try javac first
-        if (registry->compilers["javac"].available)
-        {
-            std::string cmd = "javac";
-            for (const auto &flag : flags)
-                cmd += " " + flag;
-            cmd += " \"" + input + "\"";
-            if (verbose)
-                std::cout << "Compiling Java with javac: " << cmd << std::endl;
-            int result = system(cmd.c_str());
-            if (result != 0)
-                return result;
-
-            // If JAR output requested, create JAR file
-            if (is_jar)
-            {
-                std::string class_file = input.substr(0, input.find_last_of('.')) + ".class";
-                std::string main_class = input.substr(0, input.find_last_of('.'));
-                int jar_result = create_jar_file(class_file, output, main_class, verbose);
-                if (jar_result == 0)
-                {
-                    return 0; // JAR created successfully
-                }
-                else
-                {
-                    // JAR creation failed, but class file exists - still return success
-                    if (verbose)
-                    {
-                        std::cout << "Note: JAR creation failed, but class file was created successfully" << std::endl;
-                    }
-                    return 0;
-                }
-            }
-            return 0;
-        }
-        else
-        {
-            // Fallback to embedded bytecode generator
-            int result = generate_bytecode(input, class_output, verbose);
-            if (result != 0)
-                return result;
-
-            // If JAR output requested, create JAR file
-            if (is_jar)
-            {
-                std::string class_file = class_output;
-                std::string main_class = input.substr(0, input.find_last_of('.'));
-                int jar_result = create_jar_file(class_file, output, main_class, verbose);
-                if (jar_result == 0)
-                {
-                    return 0; // JAR created successfully
-                }
-                else
-                {
-                    // JAR creation failed, but class file exists - still return success
-                    if (verbose)
-                    {
-                        std::cout << "Note: JAR creation failed, but class file was created successfully" << std::endl;
-                    }
-                    return 0;
-                }
-            }
-            return 0;
-        }
-    }
-
-    int run(const std::string &executable, bool verbose) override
-    {
-        // Check if it's a JAR file
-        if (executable.size() > 4 && executable.substr(executable.size() - 4) == ".jar")
-        {
-            std::string cmd = "java -jar \"" + executable + "\"";
-            if (verbose)
-                std::cout << "Running JAR: " << cmd << std::endl;
-            return system(cmd.c_str());
-        }
-        else
-        {
-            // Run class file
-            std::string class_name = executable.substr(0, executable.find_last_of('.'));
-            std::string cmd = "java " + class_name;
-            if (verbose)
-                std::cout << "Running Java: " << cmd << std::endl;
-            return system(cmd.c_str());
-        }
-    }
-
-    std::string get_default_output(const std::string &input) override
-    {
-        // Check if user wants JAR output
-        if (input.find(".jar") != std::string::npos ||
-            (input.size() > 4 && input.substr(input.size() - 4) == ".jar"))
-        {
-            return input.substr(0, input.find_last_of('.')) + ".jar";
-        }
-        return input.substr(0, input.find_last_of('.')) + ".class";
-    }
-
-private:
-    int generate_bytecode(const std::string &input, const std::string &output, bool verbose)
-    {
-        // Simple Java bytecode generator - only supports basic System.out.println("...");
-
-        std::ifstream in(input);
-        if (!in)
-        {
-            std::cerr << "Cannot open Java file: " << input << std::endl;
-            return 1;
-        }
-
-        std::string line;
-        std::string print_content;
-        bool found_println = false;
-
-        while (std::getline(in, line))
-        {
-            // Look for System.out.println("...");
-            size_t pos = line.find("System.out.println(");
-            if (pos != std::string::npos)
-            {
-                size_t start = line.find('"', pos);
-                size_t end = line.find('"', start + 1);
-                if (start != std::string::npos && end != std::string::npos)
-                {
-                    print_content = line.substr(start + 1, end - start - 1);
-                    found_println = true;
-                    break;
-                }
-            }
-        }
-
-        in.close();
-
-        if (!found_println)
-        {
-            // Fallback to Hello World
-            print_content = "Hello, World!";
-        }
-
-        // Generate bytecode for System.out.println(print_content);
-        std::vector<uint8_t> classfile;
-        generate_println_class(classfile, print_content);
-
-        std::string classfile_name = output.empty() ? input.substr(0, input.find_last_of('.')) + ".class" : output;
-
-        std::ofstream out(classfile_name, std::ios::binary);
-        out.write((char *)classfile.data(), classfile.size());
-        out.close();
-
-        if (verbose)
-            std::cout << "Generated Java bytecode: " << classfile_name << std::endl;
-        return 0;
-    }
-
-    // Embedded JVM bytecode generator (simplified)
-    void generate_println_class(std::vector<uint8_t> &out, const std::string &message)
-    {
-        // This is a simplified version - in reality you'd parse the Java file
-        // For now, just generate a Hello World class
-        W w;
-        // ... (same bytecode generation code as before)
-        w.u4(0xCAFEBABE);
-        w.u2(0);
-        w.u2(49);
-        w.u2(28);
-        // ... (rest of the bytecode)
-        w.utf8("HelloWorld");
-        w.u1(7);
-        w.u2(1);
-        w.utf8("java/lang/Object");
-        w.u1(7);
-        w.u2(3);
-        w.utf8("java/lang/System");
-        w.u1(7);
-        w.u2(5);
-        w.utf8("out");
-        w.utf8("Ljava/io/PrintStream;");
-        w.u1(12);
-        w.u2(7);
-        w.u2(8);
-        w.u1(9);
-        w.u2(6);
-        w.u2(9);
-        w.utf8("java/io/PrintStream");
-        w.u1(7);
-        w.u2(11);
-        w.utf8("println");
-        w.utf8("(Ljava/lang/string;)V");
-        w.u1(12);
-        w.u2(13);
-        w.u2(14);
-        w.u1(10);
-        w.u2(12);
-        w.u2(15);
-        w.utf8(message); // The message
-        w.u1(8);
-        w.u2(17);
-        w.utf8("<init>");
-        w.utf8("()V");
-        w.u1(12);
-        w.u2(19);
-        w.u2(20);
-        w.u1(10);
-        w.u2(4);
-        w.u2(21);
-        w.utf8("Code");
-        w.utf8("main");
-        w.utf8("([Ljava/lang/string;)V");
-        w.utf8("SourceFile");
-        w.utf8("HelloWorld.java");
-        w.u2(0x0021);
-        w.u2(2);
-        w.u2(4);
-        w.u2(0);
-        w.u2(0);
-        w.u2(2);
-        w.u2(0x0001);
-        w.u2(19);
-        w.u2(20);
-        w.u2(1);
-        w.u2(23);
-        w.u4(17);
-        w.u2(1);
-        w.u2(1);
-        w.u4(5);
-        w.u1(0x2a);
-        w.u1(0xb7);
-        w.u2(22);
-        w.u1(0xb1);
-        w.u2(0);
-        w.u2(0);
-        w.u2(0x0009);
-        w.u2(24);
-        w.u2(25);
-        w.u2(1);
-        w.u2(23);
-        w.u4(21);
-        w.u2(2);
-        w.u2(1);
-        w.u4(9);
-        w.u1(0xb2);
-        w.u2(10);
-        w.u1(0x12);
-        w.u1(18);
-        w.u1(0xb6);
-        w.u2(16);
-        w.u1(0xb1);
-        w.u2(0);
-        w.u2(0);
-        w.u2(1);
-        w.u2(26);
-        w.u4(2);
-        w.u2(27);
-        out.swap(w.buf);
-    }
-
-    // Create JAR file with manifest and class file
-    int create_jar_file(const std::string &class_file, const std::string &jar_file, const std::string &main_class, bool verbose)
-    {
-        // Check if jar command is available
-        int jar_check = system("jar --version >nul 2>&1");
-        if (jar_check != 0)
-        {
-            if (verbose)
-            {
-                std::cout << "Warning: jar command not available, skipping JAR creation" << std::endl;
-                std::cout << "Class file created: " << class_file << std::endl;
-            }
-            return 1; // Indicate JAR creation failed, but class file exists
-        }
-
-        // Create temporary directory for JAR contents
-        std::string temp_dir = class_file.substr(0, class_file.find_last_of('.')) + "_jar_temp";
-        fs::create_directories(temp_dir);
-
-        // Copy class file to temp directory with proper package structure
-        std::string class_name = fs::path(class_file).filename().string();
-        std::string class_in_jar = class_name; // For simple case, no package
-
-        std::string dest_path = temp_dir + "/" + class_in_jar;
-        // Copy class file to temp directory
-        {
-            std::ifstream in(class_file, std::ios::binary);
-            if (!in)
-            {
-                std::cerr << "Failed to open class file for copying" << std::endl;
-                return 1;
-            }
-            std::ofstream out(dest_path, std::ios::binary);
-            if (!out)
-            {
-                std::cerr << "Failed to create destination file" << std::endl;
-                return 1;
-            }
-            out << in.rdbuf();
-        }
-
-        // Create MANIFEST.MF
-        std::string manifest_path = temp_dir + "/META-INF/MANIFEST.MF";
-        fs::create_directories(temp_dir + "/META-INF");
-
-        std::ofstream manifest(manifest_path);
-        if (!manifest)
-        {
-            std::cerr << "Failed to create manifest file" << std::endl;
-            return 1;
-        }
-
-        manifest << "Manifest-Version: 1.0\n";
-        manifest << "Main-Class: " << main_class << "\n";
-        manifest << "Created-By: zhcl_universal\n";
-        manifest.close();
-
-        // Create JAR using jar command if available, otherwise create ZIP
-        std::string jar_cmd = "jar cfm \"" + jar_file + "\" \"" + manifest_path + "\" -C \"" + temp_dir + "\" .";
-        if (verbose)
-            std::cout << "Creating JAR: " << jar_cmd << std::endl;
-
-        int result = system(jar_cmd.c_str());
-
-        // Cleanup temp directory
-        try
-        {
-            fs::remove_all(temp_dir);
-        }
-        catch (...)
-        {
-            // Ignore cleanup errors
-        }
-
-        if (result == 0 && verbose)
-            std::cout << "Created JAR file: " << jar_file << std::endl;
-
-        return result;
-    }
-};
-
-class ChineseProcessor : public LanguageProcessor
-{
-public:
-    CompilerRegistry *registry;
-
-    bool can_handle(const std::string &ext) override
-    {
-        return ext == ".zh";
-    }
-
-    int compile(const std::string &input, const std::string &output,
-                const std::vector<std::string> &flags, bool verbose) override
-    {
-        // Translate .zh to .cpp using built-in translator
-        std::string cpp_file = output.empty() ? input.substr(0, input.find_last_of('.')) + ".cpp" : output.substr(0, output.find_last_of('.')) + ".cpp";
-
-        if (translate_zh_to_cpp(input, cpp_file, verbose) != 0)
-        {
-            return 1;
-        }
-
-        // Then compile the generated C++ file
-        CppProcessor cpp_processor;
-        cpp_processor.registry = registry;
-        std::string exe_output = output.empty() ? input.substr(0, input.find_last_of('.')) + ".exe" : output;
-
-        return cpp_processor.compile(cpp_file, exe_output, flags, verbose);
-    }
-
-    int run(const std::string &executable, bool verbose) override
-    {
-        // Check if it's a .zh file - if so, execute directly without compilation
-        if (executable.size() > 3 && executable.substr(executable.size() - 3) == ".zh")
-        {
-            return run_zh_file(executable, verbose);
-        }
-
-        // Otherwise, run as normal executable
-        std::string cmd = "\"" + executable + "\"";
-        if (verbose)
-            std::cout << "Running Chinese program: " << cmd << std::endl;
-        return system(cmd.c_str());
-    }
-
-    std::string get_default_output(const std::string &input) override
-    {
-        return input.substr(0, input.find_last_of('.')) + ".exe";
-    }
-
-private:
-    int run_zh_file(const std::string &zh_file, bool verbose)
-    {
-        if (verbose)
-            std::cout << "Running Chinese file directly: " << zh_file << std::endl;
-
-        // Read the .zh file
-        std::ifstream ifs(zh_file, std::ios::binary);
-        if (!ifs)
-        {
-            if (verbose)
-                std::fprintf(stderr, "[zhcl] cannot open %s\n", zh_file.c_str());
-            return 1;
-        }
-        std::string src((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
-
-        // Convert .zh to bytecode
-        std::vector<uint8_t> bc;
-        ZhFrontend fe;
-        try
-        {
-            bc = fe.translate_to_bc(src);
-        }
-        catch (const std::exception &e)
-        {
-            std::fprintf(stderr, "[zhcl] zh->bc failed: %s\n", e.what());
-            return 2;
-        }
-
-        // Execute bytecode directly
-        selfhost::execute_bc(bc);
-        return 0; // execute_bc doesn't return
-    }
-};
-
-class PythonProcessor : public LanguageProcessor
-{
-public:
-    CompilerRegistry *registry;
-
-    bool can_handle(const std::string &ext) override { return ext == ".py"; }
-
-    int compile(const std::string &input, const std::string &output,
-                const std::vector<std::string> &flags, bool verbose) override
-    {
-        // Translate .py to .cpp using built-in translator
-        std::string cpp_file = output.empty() ? input.substr(0, input.find_last_of('.')) + ".cpp" : output.substr(0, output.find_last_of('.')) + ".cpp";
-
-        if (translate_py_to_cpp(input, cpp_file, verbose) != 0)
-        {
-            return 1;
-        }
-
-        // Then compile the generated C++ file
-        CppProcessor cpp_processor;
-        cpp_processor.registry = registry;
-        std::string exe_output = output.empty() ? input.substr(0, input.find_last_of('.')) + ".exe" : output;
-
-        return cpp_processor.compile(cpp_file, exe_output, flags, verbose);
-    }
-
-    int run(const std::string &executable, bool verbose) override
-    {
-        std::string cmd = "\"" + executable + "\"";
-        if (verbose)
-            std::cout << "Running Python program: " << cmd << std::endl;
-        return system(cmd.c_str());
-    }
-
-    std::string get_default_output(const std::string &input) override
-    {
-        return input.substr(0, input.find_last_of('.')) + ".exe";
-    }
-
-private:
-    int translate_py_to_cpp(const std::string &py_file, const std::string &cpp_file, bool verbose)
-    {
-        std::ifstream in(py_file);
-        std::ofstream out(cpp_file);
-        std::string line;
-
-        out << "#include <iostream>\n";
-        out << "#include <string>\n";
-        out << "#include <vector>\n\n";
-
-        std::string main_code;
-
-        while (std::getline(in, line))
-        {
-            line = trim(line);
-
-            // Skip empty lines and comments
-            if (line.empty() || line.substr(0, 1) == "#")
-            {
-                continue;
-            }
-
-            // Basic Python to C++ translation (very simplified)
-            if (line.find("print(") != std::string::npos)
-            {
-                // print("hello") -> std::cout << "hello" << std::endl;
-                size_t start = line.find('"');
-                size_t end = line.find('"', start + 1);
-                if (start != std::string::npos && end != std::string::npos)
-                {
-                    std::string content = line.substr(start, end - start + 1);
-                    main_code += "    std::cout << " + content + " << std::endl;\n";
-                }
-            }
-            else if (line.find("=") != std::string::npos && line.find("int(") == std::string::npos)
-            {
-                // x = 5 -> int x = 5;
-                size_t eq_pos = line.find('=');
-                std::string var = trim(line.substr(0, eq_pos));
-                std::string value = trim(line.substr(eq_pos + 1));
-                main_code += "    int " + var + " = " + value + ";\n";
-            }
-            else
-            {
-                // Other lines, pass through with comment
-                main_code += "    // " + line + "\n";
-            }
-        }
-
-        out << "int main() {\n";
-        out << main_code;
-        out << "    return 0;\n";
-        out << "}\n";
-
-        in.close();
-        out.close();
-
-        if (verbose)
-            std::cout << "Translated " + py_file + " to " + cpp_file << std::endl;
-        return 0;
-    }
-
-    std::string trim(const std::string &str)
-    {
-        size_t first = str.find_first_not_of(" \t");
-        if (first == std::string::npos)
-            return "";
-        size_t last = str.find_last_not_of(" \t");
-        return str.substr(first, last - first + 1);
-    }
-};
-
-class GoProcessor : public LanguageProcessor
-{
-public:
-    CompilerRegistry *registry;
-
-    bool can_handle(const std::string &ext) override { return ext == ".go"; }
-
-    int compile(const std::string &input, const std::string &output,
-                const std::vector<std::string> &flags, bool verbose) override
-    {
-        // Translate .go to .cpp using built-in translator
-        std::string cpp_file = output.empty() ? input.substr(0, input.find_last_of('.')) + ".cpp" : output.substr(0, output.find_last_of('.')) + ".cpp";
-
-        if (translate_go_to_cpp(input, cpp_file, verbose) != 0)
-        {
-            return 1;
-        }
-
-        // Then compile the generated C++ file
-        CppProcessor cpp_processor;
-        cpp_processor.registry = registry;
-        std::string exe_output = output.empty() ? input.substr(0, input.find_last_of('.')) + ".exe" : output;
-
-        return cpp_processor.compile(cpp_file, exe_output, flags, verbose);
-    }
-
-    int run(const std::string &executable, bool verbose) override
-    {
-        std::string cmd = "\"" + executable + "\"";
-        if (verbose)
-            std::cout << "Running Go program: " << cmd << std::endl;
-        return system(cmd.c_str());
-    }
-
-    std::string get_default_output(const std::string &input) override
-    {
-        return input.substr(0, input.find_last_of('.')) + ".exe";
-    }
-
-private:
-    int translate_go_to_cpp(const std::string &go_file, const std::string &cpp_file, bool verbose)
-    {
-        std::ifstream in(go_file);
-        std::ofstream out(cpp_file);
-        std::string line;
-
-        out << "#include <iostream>\n";
-        out << "#include <string>\n";
-        out << "#include <vector>\n\n";
-
-        std::string main_code;
-        std::vector<std::string> functions;
-
-        while (std::getline(in, line))
-        {
-            line = trim(line);
-
-            // Skip empty lines and comments
-            if (line.empty() || line.substr(0, 2) == "//")
-            {
-                continue;
-            }
-
-            // Basic Go to C++ translation (very simplified)
-            if (line.find("fmt.Println(") != std::string::npos)
-            {
-                // fmt.Println("hello") -> std::cout << "hello" << std::endl;
-                size_t start = line.find('"');
-                size_t end = line.find('"', start + 1);
-                if (start != std::string::npos && end != std::string::npos)
-                {
-                    std::string content = line.substr(start, end - start + 1);
-                    main_code += "    std::cout << " + content + " << std::endl;\n";
-                }
-            }
-            else if (line.find("func ") != std::string::npos)
-            {
-                // Function declarations
-                functions.push_back(translate_function_declaration(line));
-                continue;
-            }
-
-            // Main code
-            main_code += translate_go_statement(line) + "\n";
-        }
-
-        // Write functions
-        for (const auto &func : functions)
-        {
-            out << func << "\n";
-        }
-
-        // Write main function
-        out << "int main() {\n";
-        out << main_code;
-        out << "    return 0;\n";
-        out << "}\n";
-
-        in.close();
-        out.close();
-
-        if (verbose)
-            std::cout << "Translated " << go_file << " to " << cpp_file << std::endl;
-        return 0;
-    }
-
-    std::string translate_function_declaration(const std::string &line)
-    {
-        // func main() -> void main()
-        // func add(a int, b int) int -> int add(int a, int b)
-        std::string result = line;
-        result = replace_all(result, "func ", "");
-        // Simple replacement - expand for full Go syntax
-        result = replace_all(result, "int", "int");
-        result = replace_all(result, "string", "std::string");
-        result = replace_all(result, "bool", "bool");
-        // Assume return type at end
-        size_t last_space = result.find_last_of(' ');
-        if (last_space != std::string::npos)
-        {
-            std::string return_type = result.substr(last_space + 1);
-            std::string func_sig = result.substr(0, last_space);
-            result = return_type + " " + func_sig;
-        }
-        return result + " {";
-    }
-
-    std::string translate_go_statement(const std::string &line)
-    {
-        std::string result = line;
-
-        // Variable declarations: var x int = 5 -> int x = 5;
-        if (result.substr(0, 4) == "var ")
-        {
-            result = result.substr(4);
-            // Assume format: name type = value
-            // Simple: replace with C++ style
-        }
-
-        // Print statements: fmt.Println("hello") -> std::cout << "hello" << std::endl;
-        if (result.find("fmt.Println") != std::string::npos)
-        {
-            size_t start = result.find('"');
-            size_t end = result.find('"', start + 1);
-            if (start != std::string::npos && end != std::string::npos)
-            {
-                std::string content = result.substr(start, end - start + 1);
-                result = "    std::cout << " + content + " << std::endl;";
-            }
-        }
-
-        // Basic replacements
-        result = replace_all(result, ":=", "="); // Short variable declaration
-
-        return result;
-    }
-
-    std::string trim(const std::string &str)
-    {
-        size_t first = str.find_first_not_of(" \t");
-        if (first == std::string::npos)
-            return "";
-        size_t last = str.find_last_not_of(" \t");
-        return str.substr(first, last - first + 1);
-    }
-
-    std::string replace_all(std::string str, const std::string &from, const std::string &to)
-    {
-        size_t start_pos = 0;
-        while ((start_pos = str.find(from, start_pos)) != std::string::npos)
-        {
-            str.replace(start_pos, from.length(), to);
-            start_pos += to.length();
-        }
-        return str;
-    }
-};
-
-class RustProcessor : public LanguageProcessor
-{
-public:
-    bool can_handle(const std::string &ext) override { return ext == ".rs"; }
-    int compile(const std::string &input, const std::string &output, const std::vector<std::string> &flags, bool verbose) override
-    {
-        std::string cmd = "rustc";
-        for (const auto &flag : flags)
-            cmd += " " + flag;
-        cmd += " \"" + input + "\"";
-        if (!output.empty())
-            cmd += " -o \"" + output + "\"";
-        if (verbose)
-            std::cout << "Compiling Rust: " << cmd << std::endl;
-        return system(cmd.c_str());
-    }
-    int run(const std::string &executable, bool verbose) override
-    {
-        std::string cmd = "\"" + executable + "\"";
-        if (verbose)
-            std::cout << "Running Rust: " << cmd << std::endl;
-        return system(cmd.c_str());
-    }
-    std::string get_default_output(const std::string &input) override
-    {
-        return input.substr(0, input.find_last_of('.')) + ".exe";
-    }
-};
-
-class JSProcessor : public LanguageProcessor
-{
-public:
-    CompilerRegistry *registry;
-
-    bool can_handle(const std::string &ext) override { return ext == ".js"; }
-
-    int compile(const std::string &input, const std::string &output,
-                const std::vector<std::string> &flags, bool verbose) override
-    {
-        // Translate .js to .cpp using built-in translator
-        std::string cpp_file = output.empty() ? input.substr(0, input.find_last_of('.')) + ".cpp" : output.substr(0, output.find_last_of('.')) + ".cpp";
-
-        if (translate_js_to_cpp(input, cpp_file, verbose) != 0)
-        {
-            return 1;
-        }
-
-        // Then compile the generated C++ file
-        CppProcessor cpp_processor;
-        cpp_processor.registry = registry;
-        return cpp_processor.compile(cpp_file, output, flags, verbose);
-    }
-
-    int run(const std::string &executable, bool verbose) override
-    {
-        std::string cmd = "node \"" + executable + "\"";
-        if (verbose)
-            std::cout << "Running JavaScript: " << cmd << std::endl;
-        return system(cmd.c_str());
-    }
-
-    std::string get_default_output(const std::string &input) override { return input; }
-
-private:
-    int translate_js_to_cpp(const std::string &js_file, const std::string &cpp_file, bool verbose)
-    {
-        std::ifstream in(js_file);
-        std::ofstream out(cpp_file);
-        std::string line;
-
-        out << "#include <iostream>\n";
-        out << "#include <string>\n";
-        out << "#include <vector>\n\n";
-
-        std::string main_code;
-
-        while (std::getline(in, line))
-        {
-            line = trim(line);
-
-            // Skip empty lines and comments
-            if (line.empty() || line.substr(0, 2) == "//")
-            {
-                continue;
-            }
-
-            // Basic JavaScript to C++ translation (very simplified)
-            if (line.find("console.log(") != std::string::npos)
-            {
-                // console.log("hello") -> std::cout << "hello" << std::endl;
-                size_t start = line.find('"');
-                size_t end = line.find('"', start + 1);
-                if (start != std::string::npos && end != std::string::npos)
-                {
-                    std::string content = line.substr(start, end - start + 1);
-                    main_code += "    std::cout << " + content + " << std::endl;\n";
-                }
-            }
-            else if (line.find("let ") != std::string::npos || line.find("const ") != std::string::npos || line.find("var ") != std::string::npos)
-            {
-                // let x = 5 -> int x = 5;
-                size_t eq_pos = line.find('=');
-                if (eq_pos != std::string::npos)
-                {
-                    std::string var_part = trim(line.substr(0, eq_pos));
-                    std::string value = trim(line.substr(eq_pos + 1));
-                    // Remove semicolon if present
-                    if (!value.empty() && value.back() == ';')
-                        value.pop_back();
-
-                    // Extract variable name (after let/const/var and space)
-                    size_t space_pos = var_part.find(' ');
-                    if (space_pos != std::string::npos)
-                    {
-                        std::string var_name = trim(var_part.substr(space_pos + 1));
-                        main_code += "    int " + var_name + " = " + value + ";\n";
-                    }
-                }
-            }
-            else
-            {
-                // Other lines, pass through with comment
-                main_code += "    // " + line + "\n";
-            }
-        }
-
-        out << "int main() {\n";
-        out << main_code;
-        out << "    return 0;\n";
-        out << "}\n";
-
-        in.close();
-        out.close();
-
-        if (verbose)
-            std::cout << "Translated " + js_file + " to " + cpp_file << std::endl;
-        return 0;
-    }
-
-    std::string trim(const std::string &str)
-    {
-        size_t first = str.find_first_not_of(" \t");
-        if (first == std::string::npos)
-            return "";
-        size_t last = str.find_last_not_of(" \t");
-        return str.substr(first, last - first + 1);
-    }
-};
-
-// ============================================================================
-// COMPILER COMPATIBILITY LAYER - Maintains traditional compiler habits
-// ============================================================================
-
-class CompilerCompatibilityLayer
-{
-public:
-    CompilerRegistry *registry;
-
-    // Parse traditional compiler arguments and translate to zhcl format
-    int handle_traditional_args(int argc, char **argv)
-    {
-        if (argc < 2)
-            return -1; // Not a traditional compiler call
-
-        std::string compiler_name = argv[0];
-        std::string basename = fs::path(compiler_name).filename().string();
-
-        // map common compiler names to our system
-        if (basename == "cl" || basename == "cl.exe")
-        {
-            return handle_msvc_args(argc, argv);
-        }
-        else if (basename == "gcc" || basename == "g++" || basename == "cc" || basename == "c++")
-        {
-            return handle_gcc_args(argc, argv);
-        }
-        else if (basename == "javac" || basename == "javac.exe")
-        {
-            return handle_javac_args(argc, argv);
-        }
-        else if (basename == "rustc" || basename == "rustc.exe")
-        {
-            return handle_rustc_args(argc, argv);
-        }
-        else if (basename == "go" || basename == "go.exe")
-        {
-            return handle_go_args(argc, argv);
-        }
-        else if (basename == "python" || basename == "python.exe" || basename == "python3")
-        {
-            return handle_python_args(argc, argv);
-        }
-
-        return -1; // Not recognized
-    }
-
-private:
-    // MSVC-style arguments: cl [options] file.cpp
-    int handle_msvc_args(int argc, char **argv)
-    {
-        std::vector<std::string> files;
-        std::string output;
-        std::vector<std::string> includes;
-        std::vector<std::string> defines;
-        std::vector<std::string> flags;
-        bool compile_only = false;
-        bool verbose = false;
-
-        for (int i = 1; i < argc; ++i)
-        {
-            std::string arg = argv[i];
-
-            if (arg == "/c")
-            {
-                compile_only = true;
-            }
-            else if (arg == "/Fe" && i + 1 < argc)
-            {
-                output = argv[++i];
-            }
-            else if (arg.substr(0, 2) == "/I")
-            {
-                includes.push_back(arg.substr(2));
-            }
-            else if (arg.substr(0, 2) == "/D")
-            {
-                defines.push_back(arg.substr(2));
-            }
-            else if (arg == "/nologo")
-            {
-                // Silent mode
-            }
-            else if (arg == "/utf-8")
-            {
-                flags.push_back("-utf-8");
-            }
-            else if (arg == "/EHsc")
-            {
-                flags.push_back("-EHsc");
-            }
-            else if (arg == "/std:c++17")
-            {
-                flags.push_back("-std=c++17");
-            }
-            else if (arg.substr(0, 1) != "/")
-            {
-                // Assume it's a file
-                files.push_back(arg);
-            }
-        }
-
-        if (files.empty())
-        {
-            std::cerr << "cl: no input files" << std::endl;
-            return 1;
-        }
-
-        // Compile each file
-        for (const auto &file : files)
-        {
-            std::string ext = fs::path(file).extension().string();
-            if (ext != ".cpp" && ext != ".c" && ext != ".cc")
-            {
-                std::cerr << "cl: unsupported file type: " << file << std::endl;
-                continue;
-            }
-
-            std::string actual_output = output;
-            if (actual_output.empty())
-            {
-                if (compile_only)
-                {
-                    actual_output = file.substr(0, file.find_last_of('.')) + ".obj";
-                }
-                else
-                {
-                    actual_output = file.substr(0, file.find_last_of('.')) + ".exe";
-                }
-            }
-
-            // Add include paths
-            for (const auto &inc : includes)
-            {
-                flags.push_back("-I" + inc);
-            }
-
-            // Add defines
-            for (const auto &def : defines)
-            {
-                flags.push_back("-D" + def);
-            }
-
-            CppProcessor processor;
-            processor.registry = registry;
-            int ret = processor.compile(file, actual_output, flags, verbose);
-
-            if (ret != 0)
-            {
-                return ret;
-            }
-        }
-
-        return 0;
-    }
-
-    // GCC-style arguments: gcc [options] file.c -o output
-    int handle_gcc_args(int argc, char **argv)
-    {
-        std::vector<std::string> files;
-        std::string output;
-        std::vector<std::string> includes;
-        std::vector<std::string> defines;
-        std::vector<std::string> flags;
-        bool compile_only = false;
-        bool verbose = false;
-
-        for (int i = 1; i < argc; ++i)
-        {
-            std::string arg = argv[i];
-
-            if (arg == "-c")
-            {
-                compile_only = true;
-            }
-            else if (arg == "-o" && i + 1 < argc)
-            {
-                output = argv[++i];
-            }
-            else if (arg.substr(0, 2) == "-I")
-            {
-                includes.push_back(arg.substr(2));
-            }
-            else if (arg.substr(0, 2) == "-D")
-            {
-                defines.push_back(arg.substr(2));
-            }
-            else if (arg == "-Wall" || arg == "-Wextra" || arg == "-g" || arg == "-O2")
-            {
-                flags.push_back(arg);
-            }
-            else if (arg.substr(0, 5) == "-std=")
-            {
-                flags.push_back(arg);
-            }
-            else if (arg.substr(0, 1) != "-")
-            {
-                // Assume it's a file
-                files.push_back(arg);
-            }
-        }
-
-        if (files.empty())
-        {
-            std::cerr << "gcc: no input files" << std::endl;
-            return 1;
-        }
-
-        // Compile each file
-        for (size_t idx = 0; idx < files.size(); ++idx)
-        {
-            const auto &file = files[idx];
-            std::string ext = fs::path(file).extension().string();
-
-            std::string actual_output;
-            if (output.empty())
-            {
-                if (compile_only)
-                {
-                    actual_output = file.substr(0, file.find_last_of('.')) + ".o";
-                }
-                else if (files.size() == 1)
-                {
-                    actual_output = "a.out";
-                }
-                else
-                {
-                    actual_output = file.substr(0, file.find_last_of('.')) + ".o";
-                }
-            }
-            else
-            {
-                if (files.size() > 1)
-                {
-                    // Multiple files with single output = link them
-                    if (idx == files.size() - 1)
-                    {
-                        // Last file, do the linking
-                        actual_output = output;
-                    }
-                    else
-                    {
-                        continue; // Skip intermediate files
-                    }
-                }
-                else
-                {
-                    actual_output = output;
-                }
-            }
-
-            // Add include paths
-            for (const auto &inc : includes)
-            {
-                flags.push_back("-I" + inc);
-            }
-
-            // Add defines
-            for (const auto &def : defines)
-            {
-                flags.push_back("-D" + def);
-            }
-
-            CppProcessor processor;
-            processor.registry = registry;
-            int ret = processor.compile(file, actual_output, flags, verbose);
-
-            if (ret != 0)
-            {
-                return ret;
-            }
-        }
-
-        return 0;
-    }
-
-    // JavaC-style arguments: javac [options] file.java
-    int handle_javac_args(int argc, char **argv)
-    {
-        std::vector<std::string> files;
-        std::string classpath;
-        std::string output_dir = ".";
-        std::vector<std::string> flags;
-
-        for (int i = 1; i < argc; ++i)
-        {
-            std::string arg = argv[i];
-
-            if (arg == "-cp" || arg == "-classpath")
-            {
-                if (i + 1 < argc)
-                {
-                    classpath = argv[++i];
-                }
-            }
-            else if (arg == "-d" && i + 1 < argc)
-            {
-                output_dir = argv[++i];
-            }
-            else if (arg.substr(0, 1) != "-")
-            {
-                files.push_back(arg);
-            }
-            else
-            {
-                flags.push_back(arg);
-            }
-        }
-
-        if (files.empty())
-        {
-            std::cerr << "javac: no input files" << std::endl;
-            return 1;
-        }
-
-        for (const auto &file : files)
-        {
-            std::string ext = fs::path(file).extension().string();
-            if (ext != ".java")
-            {
-                std::cerr << "javac: not a Java file: " << file << std::endl;
-                continue;
-            }
-
-            std::string output = output_dir + "/" + file.substr(0, file.find_last_of('.')) + ".class";
-
-            JavaProcessor processor;
-            processor.registry = registry;
-            int ret = processor.compile(file, output, flags, false);
-
-            if (ret != 0)
-            {
-                return ret;
-            }
-        }
-
-        return 0;
-    }
-
-    // RustC-style arguments: rustc [options] file.rs
-    int handle_rustc_args(int argc, char **argv)
-    {
-        std::vector<std::string> files;
-        std::string output;
-        std::string out_dir = ".";
-        std::vector<std::string> flags;
-        bool verbose = false;
-
-        for (int i = 1; i < argc; ++i)
-        {
-            std::string arg = argv[i];
-
-            if (arg == "-o" && i + 1 < argc)
-            {
-                output = argv[++i];
-            }
-            else if (arg == "--out-dir" && i + 1 < argc)
-            {
-                out_dir = argv[++i];
-            }
-            else if (arg == "-O" || arg == "-g")
-            {
-                flags.push_back(arg);
-            }
-            else if (arg.substr(0, 1) != "-")
-            {
-                files.push_back(arg);
-            }
-        }
-
-        if (files.empty())
-        {
-            std::cerr << "rustc: no input files" << std::endl;
-            return 1;
-        }
-
-        for (const auto &file : files)
-        {
-            std::string ext = fs::path(file).extension().string();
-            if (ext != ".rs")
-            {
-                std::cerr << "rustc: not a Rust file: " << file << std::endl;
-                continue;
-            }
-
-            std::string actual_output = output.empty() ? out_dir + "/" + file.substr(0, file.find_last_of('.')) + ".exe" : output;
-
-            RustProcessor processor;
-            int ret = processor.compile(file, actual_output, flags, verbose);
-
-            if (ret != 0)
-            {
-                return ret;
-            }
-        }
-
-        return 0;
-    }
-
-    // Go-style arguments: go build/run [options] file.go
-    int handle_go_args(int argc, char **argv)
-    {
-        if (argc < 2)
-            return -1;
-
-        std::string subcommand = argv[1];
-        std::vector<std::string> files;
-        std::string output;
-        std::vector<std::string> flags;
-
-        for (int i = 2; i < argc; ++i)
-        {
-            std::string arg = argv[i];
-
-            if (arg == "-o" && i + 1 < argc)
-            {
-                output = argv[++i];
-            }
-            else if (arg.substr(0, 1) == "-")
-            {
-                flags.push_back(arg);
-            }
-            else
-            {
-                files.push_back(arg);
-            }
-        }
-
-        if (files.empty())
-        {
-            std::cerr << "go: no input files" << std::endl;
-            return 1;
-        }
-
-        for (const auto &file : files)
-        {
-            std::string ext = fs::path(file).extension().string();
-            if (ext != ".go")
-            {
-                std::cerr << "go: not a Go file: " << file << std::endl;
-                continue;
-            }
-
-            std::string actual_output = output.empty() ? file.substr(0, file.find_last_of('.')) + ".exe" : output;
-
-            GoProcessor processor;
-            int ret;
-
-            if (subcommand == "run")
-            {
-                ret = processor.compile(file, actual_output, flags, false);
-                if (ret == 0)
-                {
-                    ret = processor.run(actual_output, false);
-                }
-            }
-            else
-            { // build or default
-                ret = processor.compile(file, actual_output, flags, false);
-            }
-
-            if (ret != 0)
-            {
-                return ret;
-            }
-        }
-
-        return 0;
-    }
-
-    // Python-style arguments: python [options] file.py
-    int handle_python_args(int argc, char **argv)
-    {
-        std::vector<std::string> args;
-
-        for (int i = 1; i < argc; ++i)
-        {
-            args.push_back(argv[i]);
-        }
-
-        if (args.empty())
-        {
-            // Start Python REPL
-            return system("python");
-        }
-
-        std::string file = args.back();
-        std::string ext = fs::path(file).extension().string();
-
-        if (ext != ".py")
-        {
-            // Not a Python file, pass through to python
-            std::string cmd = "python";
-            for (const auto &arg : args)
-            {
-                cmd += " \"" + arg + "\"";
-            }
-            return system(cmd.c_str());
-        }
-
-        PythonProcessor processor;
-        return processor.run(file, false);
-    }
-};
-
-// ============================================================================
-// BUILD SYSTEM - Replaces CMake, Make, etc.
-// ============================================================================
-
-class BuildSystem
-{
-public:
-    CompilerRegistry *registry;
-    std::map<std::string, std::unique_ptr<LanguageProcessor>> processors;
-
-    BuildSystem(CompilerRegistry *reg) : registry(reg)
-    {
-        // Register processors
-        processors["cpp"] = std::make_unique<CppProcessor>();
-        auto *cpp_processor = static_cast<CppProcessor *>(processors["cpp"].get());
-        cpp_processor->registry = registry;
-
-        processors["java"] = std::make_unique<JavaProcessor>();
-        auto *java_processor = static_cast<JavaProcessor *>(processors["java"].get());
-        java_processor->registry = registry;
-
-        processors["python"] = std::make_unique<PythonProcessor>();
-        auto *python_processor = static_cast<PythonProcessor *>(processors["python"].get());
-        python_processor->registry = registry;
-
-        processors["javascript"] = std::make_unique<JSProcessor>();
-        auto *js_processor = static_cast<JSProcessor *>(processors["javascript"].get());
-        js_processor->registry = registry;
-        processors["go"] = std::make_unique<GoProcessor>();
-        auto *go_processor = static_cast<GoProcessor *>(processors["go"].get());
-        go_processor->registry = registry;
-        processors["rust"] = std::make_unique<RustProcessor>();
-
-        processors["chinese"] = std::make_unique<ChineseProcessor>();
-        auto *chinese_processor = static_cast<ChineseProcessor *>(processors["chinese"].get());
-        chinese_processor->registry = registry;
-    }
-
-    int build_project(const std::string &project_dir, bool verbose)
-    {
-        if (verbose)
-            std::cout << "Building project in: " << project_dir << std::endl;
-
-        // Find all source files
-        std::vector<std::string> source_files;
-        for (const auto &entry : fs::recursive_directory_iterator(project_dir))
-        {
-            if (fs::is_regular_file(entry.path()))
-            {
-                std::string ext = entry.path().extension().string();
-                if (is_supported_extension(ext))
-                {
-                    source_files.push_back(entry.path().string());
-                }
-            }
-        }
-
-        if (source_files.empty())
-        {
-            std::cerr << "No supported source files found" << std::endl;
-            return 1;
-        }
-
-        // Group by language
-        std::map<std::string, std::vector<std::string>> files_by_lang;
-        for (const auto &file : source_files)
-        {
-            std::string ext = fs::path(file).extension().string();
-            files_by_lang[ext].push_back(file);
-        }
-
-        // Compile each group
-        std::vector<std::string> outputs;
-        for (const auto &[ext, files] : files_by_lang)
-        {
-            for (const auto &file : files)
-            {
-                std::string output = get_processor_by_ext(ext)->get_default_output(file);
-                if (get_processor_by_ext(ext)->compile(file, output, {}, verbose) == 0)
-                {
-                    outputs.push_back(output);
-                    if (verbose)
-                        std::cout << "Compiled: " << file << " -> " << output << std::endl;
-                }
-                else
-                {
-                    std::cerr << "Failed to compile: " << file << std::endl;
-                    return 1;
-                }
-            }
-        }
-
-        if (verbose)
-            std::cout << "Build completed successfully!" << std::endl;
-        return 0;
-    }
-
-    int compile_file(const std::string &input, const std::string &output, bool verbose, bool run_after)
-    {
-        std::string ext = fs::path(input).extension().string();
-        auto processor = get_processor_by_ext(ext);
-        if (!processor)
-        {
-            std::cerr << "Unsupported file type: " << ext << std::endl;
-            return 1;
-        }
-
-        std::string actual_output = output.empty() ? processor->get_default_output(input) : output;
-
-        int ret = processor->compile(input, actual_output, {}, verbose);
-        if (ret == 0 && run_after)
-        {
-            return processor->run(actual_output, verbose);
-        }
-        return ret;
-    }
-
-private:
-    LanguageProcessor *get_processor_by_ext(const std::string &ext)
-    {
-        for (auto &[name, processor] : processors)
-        {
-            if (processor->can_handle(ext))
-            {
-                return processor.get();
-            }
-        }
-        return nullptr;
-    }
-
-    bool is_supported_extension(const std::string &ext)
-    {
-        return get_processor_by_ext(ext) != nullptr;
-    }
-
-private:
-    std::string get_language_from_extension(const std::string &ext)
-    {
-        if (ext == ".cpp" || ext == ".c" || ext == ".cc" || ext == ".cxx")
-            return "cpp";
-        if (ext == ".java")
-            return "java";
-        if (ext == ".py")
-            return "python";
-        if (ext == ".js")
-            return "javascript";
-        if (ext == ".go")
-            return "go";
-        if (ext == ".rs")
-            return "rust";
-        if (ext == ".zh")
-            return "chinese";
-        return "unknown";
-    }
-
-    std::string get_output_path(const std::string &input, const std::string &lang)
-    {
-        std::string base = input.substr(0, input.find_last_of('.'));
-        if (lang == "cpp")
-            return base + ".exe";
-        if (lang == "java")
-            return base + ".class";
-        if (lang == "python")
-            return input;
-        if (lang == "javascript")
-            return base + ".exe";
-        if (lang == "go")
-            return base + ".exe";
-        if (lang == "rust")
-            return base + ".exe";
-        if (lang == "chinese")
-            return base + ".exe";
-        return base + ".out";
-    }
-
-    std::vector<std::string> get_default_flags(const std::string &lang)
-    {
-        if (lang == "cpp")
-            return {"-Wall", "-std=c++17"};
-        if (lang == "java")
-            return {};
-        if (lang == "python")
-            return {};
-        if (lang == "go")
-            return {};
-        if (lang == "rust")
-            return {};
-        if (lang == "chinese")
-            return {};
-        return {};
-    }
-};
-
-// ============================================================================
-// MAIN APPLICATION
-// ============================================================================
-
-// ---- NEW: Frontend-based commands (Self-Host Universal Runner)
-static bool read_file(const std::string &p, std::string &out)
-{
-    std::ifstream f(p, std::ios::binary);
-    if (!f)
-        return false;
-    out.assign((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
-    return true;
-}
-
-int cmd_list_frontends()
-{
-    for (auto &fe : FrontendRegistry::instance().all())
-        std::cout << "- " << fe->name() << "\n";
-    return 0;
-}
-
-int cmd_run(const std::string &path, const std::string &forced, const std::vector<std::string> &extra_args)
-{
-    std::string src;
-    if (!read_file(path, src))
-    {
-        std::cerr << "read fail: " << path << "\n";
-        return 1;
-    }
-
-    // BOM/換行正規化
-    strip_utf8_bom(src);
-    normalize_newlines(src);
-
-    auto fe = forced.empty() ? FrontendRegistry::instance().match(path, src) : FrontendRegistry::instance().by_name(forced);
-    if (!fe)
-    {
-        std::cerr << "no frontend: " << (forced.empty() ? path : forced) << "\n";
-        return 2;
-    }
-    std::cout << "Using frontend: " << fe->name() << "\n";
-    FrontendContext ctx{path, src, true};
-    Bytecode bc;
-    std::string err;
-    if (!fe->compile(ctx, bc, err))
-    {
-        std::cerr << "compile err: " << err << "\n";
-        return 3;
-    }
-
-    // 解析命令列參數並注入 SET_I64
-    std::vector<int64_t> args;
-    bool sep = false;
-    for (auto &a : extra_args)
-    {
-        if (a == "--")
-        {
-            sep = true;
-            continue;
-        }
-        if (!sep)
-            continue;
-        try
-        {
-            args.push_back(std::stoll(a));
-        }
-        catch (...)
-        {
-            std::cerr << "Invalid arg: " << a << "\n";
-            return 4;
-        }
-    }
-
-    // 在 bc.data 开头插入 SET_I64
-    for (size_t i = 0; i < args.size(); ++i)
-    {
-        bc.data.insert(bc.data.begin(), 0x03);           // OP_SET_I64
-        bc.data.insert(bc.data.begin() + 1, (uint8_t)i); // slot
-        int64_t v = args[i];
-        for (int k = 0; k < 8; ++k)
-        {
-            bc.data.insert(bc.data.begin() + 2 + k, (uint8_t)((uint64_t)v >> (k * 8)) & 0xFF);
-        }
-    }
-
-    // 確保 OP_END 在最後
-    if (bc.data.empty() || bc.data.back() != 0x04)
-        bc.data.push_back(0x04);
-
-    // ?瑁?嚗?怎?? VM
-    selfhost::execute_bc(bc.data);
-    return 0; // execute_bc doesn't return
-}
-
-// ---- Forward declarations for functions used by main/clean_project ----
-int initialize_project(bool verbose);
-int list_compilers(const CompilerRegistry &registry, bool verbose);
-int clean_project(bool verbose);
-bool matches_pattern(const std::string &filename, const std::string &pattern);
-
-// 新增：判斷此命令是否需要偵測外部編譯器
-static bool command_needs_compiler_detect(const std::string &cmd)
-{
-    return (cmd == "build" || cmd == "list" || cmd == "init" || cmd == "compile");
-}
-
-static bool skip_detect_from_env()
-{
-    const char *v = std::getenv("ZHCL_SKIP_DETECT");
-    return (v && *v && (*v != '0'));
-}
-
-int main(int argc, char **argv)
-{
-#ifdef _WIN32
-    SetConsoleOutputCP(CP_UTF8);
-    SetConsoleCP(CP_UTF8);
-#endif
-
-    initialize_chinese_environment();
-
-    // ★ 強制把所有前端拉進可執行檔並註冊
-    register_fe_clite();
-    register_fe_cpplite();
-    register_fe_jslite();
-    register_fe_zh();
-    register_fe_golite();
-    register_fe_javalite();
-    register_fe_pylite();
-
-    // Frontends are auto-registered via static initializers
-
-    // ??main() ?脣暺????
-    if (selfhost::maybe_run_embedded_payload())
-    {
-        return 0; // ?交?撠暹? payload嚗歇?瑁?銝?ExitProcess()嚗??芾絲閬?return
-    }
-
-    if (argc <= 1)
-    {
-        std::cout << "zhcl - Universal VM & Selfhost System v1.0" << std::endl;
-        std::cout << "Run any supported language via built-in VM, no external compilers needed" << std::endl;
-        std::cout << std::endl;
-        std::cout << "Usage: zhcl <command> [options]" << std::endl;
-        std::cout << std::endl;
-        std::cout << "Commands:" << std::endl;
-        std::cout << "  run <file>      Run file directly via VM (zh/c-lite/cpp-lite/js-lite)" << std::endl;
-        std::cout << "  list-frontends  List available language frontends" << std::endl;
-        std::cout << "  selfhost        Self-contained executable generation" << std::endl;
-        std::cout << std::endl;
-        std::cout << "Selfhost Commands:" << std::endl;
-        std::cout << "  selfhost pack <input.(js|py|go|java|zh)> -o <output.exe>    Pack source into self-contained exe" << std::endl;
-        std::cout << "  selfhost verify <exe>                                      Verify exe integrity" << std::endl;
-        std::cout << "  selfhost explain <input.(js|py|go|java|zh)>                Show bytecode disassembly" << std::endl;
-        std::cout << std::endl;
-        std::cout << "Options:" << std::endl;
-        std::cout << "  --frontend=<name>  Force specific frontend (zh|c-lite|cpp-lite|js-lite)" << std::endl;
-        std::cout << "  -- <args...>       Pass integer arguments to VM slots (0,1,2,...)" << std::endl;
-        std::cout << std::endl;
-        std::cout << "Examples:" << std::endl;
-        std::cout << "  zhcl run hello.zh" << std::endl;
-        std::cout << "  zhcl run --frontend=c-lite hello.c" << std::endl;
-        std::cout << "  zhcl run script.zh -- 2025 3 20 16 0 0 -5" << std::endl;
-        std::cout << "  zhcl selfhost pack hello.js -o hello.exe" << std::endl;
-        std::cout << std::endl;
-        std::cout << "Supported: C/C++, Java, Python, Go, JavaScript, Chinese (.zh)" << std::endl;
-        std::cout << "No external compilers required - everything runs via built-in VM" << std::endl;
-        return 0;
-    }
-
-    std::string cmd = argv[1];
-
-    // 完全 VM 的安全路徑
-    if (cmd == "--help" || cmd == "-h")
-    {
-        // 上面已經處理了 argc <= 1 的情況，這裡重複一下
-        std::cout << "zhcl - Universal VM & Selfhost System v1.0" << std::endl;
-        std::cout << "Run any supported language via built-in VM, no external compilers needed" << std::endl;
-        std::cout << std::endl;
-        std::cout << "Usage: zhcl <command> [options]" << std::endl;
-        std::cout << std::endl;
-        std::cout << "Commands:" << std::endl;
-        std::cout << "  run <file>           Run file directly via VM (zh/c-lite/cpp-lite/js-lite)" << std::endl;
-        std::cout << "  list-frontends       List available language frontends" << std::endl;
-        std::cout << "  selfhost             Self-contained executable generation" << std::endl;
-        std::cout << std::endl;
-        std::cout << "Selfhost Commands:" << std::endl;
-        std::cout << "  selfhost pack <input> -o <output.exe>    Pack source into self-contained exe" << std::endl;
-        std::cout << "  selfhost verify <exe>                   Verify exe integrity (CRC32 check)" << std::endl;
-        std::cout << "  selfhost explain <input>                Show bytecode disassembly" << std::endl;
-        std::cout << std::endl;
-        std::cout << "Options:" << std::endl;
-        std::cout << "  --frontend=<name>    Force specific frontend (zh|c-lite|cpp-lite|js-lite)" << std::endl;
-        std::cout << "  -- <args...>         Pass integer arguments to VM slots (0,1,2,...)" << std::endl;
-        std::cout << std::endl;
-        std::cout << "Examples:" << std::endl;
-        std::cout << "  zhcl run hello.zh" << std::endl;
-        std::cout << "  zhcl run --frontend=c-lite hello.c" << std::endl;
-        std::cout << "  zhcl run script.zh -- 2025 3 20 16 0 0 -5" << std::endl;
-        std::cout << "  zhcl selfhost pack hello.js -o hello.exe" << std::endl;
-        std::cout << "  zhcl selfhost verify hello.exe" << std::endl;
-        std::cout << std::endl;
-        std::cout << "Standards Compatibility:" << std::endl;
-        std::cout << "  System: C11/C17/C23 and C++17/C++20/C++23 compatible" << std::endl;
-        std::cout << "  Generated code: C89/C90 standard for maximum compatibility" << std::endl;
-        std::cout << "  Encoding: UTF-8 native support" << std::endl;
-        std::cout << std::endl;
-        std::cout << "Documentation:" << std::endl;
-        std::cout << "  README.md        - Quick start guide and examples" << std::endl;
-        std::cout << "  PARAMETERS.md    - Detailed parameter reference (Chinese)" << std::endl;
-        std::cout << "  PARAMETERS_EN.md - Detailed parameter reference (English)" << std::endl;
-        std::cout << "  LANGUAGE.md      - Chinese language specification" << std::endl;
-        std::cout << std::endl;
-        std::cout << "Environment Variables:" << std::endl;
-        std::cout << "  ZHCL_SELFHOST_QUIET=1  - Suppress selfhost banner output" << std::endl;
-        std::cout << std::endl;
-        std::cout << "No external compilers required - everything runs via built-in VM" << std::endl;
-        return 0;
-    }
-
-    if (cmd == "list-frontends")
-    {
-        return cmd_list_frontends();
-    }
-    if (cmd == "run")
-    {
-        if (argc < 3)
-        {
-            std::cerr << "Usage: zhcl run <file> [--frontend=name] [-- args...]\n";
-            return 1;
-        }
-        std::string file;
-        std::string forced;
-        std::vector<std::string> extra_args;
-        for (int i = 2; i < argc; ++i)
-        {
-            std::string a = argv[i];
-            if (a.rfind("--frontend=", 0) == 0)
-            {
-                forced = a.substr(11);
-            }
-            else if (a == "--")
-            {
-                for (int j = i + 1; j < argc; ++j)
-                {
-                    extra_args.push_back(argv[j]);
-                }
-                break;
-            }
-            else if (file.empty())
-            {
-                file = a;
-            }
-            else
-            {
-                // 不支援額外的參數，除非是 -- 之後的
-                std::cerr << "Unexpected argument: " << a << "\n";
-                std::cerr << "Usage: zhcl run <file> [--frontend=name] [-- args...]\n";
-                return 1;
-            }
-        }
-        if (file.empty())
-        {
-            std::cerr << "Usage: zhcl run <file> [--frontend=name] [-- args...]\n";
-            return 1;
-        }
-        return cmd_run(file, forced, extra_args);
-    }
-    if (cmd == "selfhost")
-    {
-        if (argc < 3)
-        {
-            std::puts("Usage:\n  zhcl selfhost pack <input.(js|py|go|java|zh)> -o <output.exe>\n"
-                      "  zhcl selfhost verify <exe>\n"
-                      "  zhcl selfhost explain <input.(js|py|go|java|zh)>                Show bytecode disassembly");
-            return 1;
-        }
-        std::string sub = argv[2];
-        if (sub == "pack")
-        {
-            if (argc < 6 || std::string(argv[4]) != "-o")
-            {
-                std::puts("Usage:\n  zhcl selfhost pack <input.(js|py|go|java|zh)> -o <output.exe>");
-                return 2;
-            }
-            fs::path in = argv[3];
-            fs::path out = argv[5];
-            std::string lang;
-            auto ext = in.extension().string();
-            if (ext == ".js")
-                lang = "js";
-            else if (ext == ".py")
-                lang = "py";
-            else if (ext == ".go")
-                lang = "go";
-            else if (ext == ".java")
-                lang = "java";
-            else if (ext == ".zh")
-                lang = "zh";
-            else
-            {
-                std::fprintf(stderr, "[selfhost] unsupported input: %s\n", ext.c_str());
-                return 2;
-            }
-            int rc = selfhost::pack_from_file(lang, in, out);
-            return rc;
-        }
-        else if (sub == "verify")
-        {
-            if (argc < 4)
-            {
-                std::puts("Usage:\n  zhcl selfhost verify <exe>");
-                return 2;
-            }
-            return selfhost::verify_exe(argv[3]);
-        }
-        else if (sub == "explain")
-        {
-            return selfhost::handle_selfhost_explain(argc, argv);
-        }
-        std::fprintf(stderr, "Unknown subcommand: selfhost %s\n", sub.c_str());
-        return 1;
-    }
-
-#if ZHCL_ENABLE_EXTERNAL_TOOLCHAIN
-    // （可選）外部編譯器相關子命令
-    // ... 保留舊邏輯 ...
-#else
-    // 關閉時，任何外部相關一律回覆提示
-    if (cmd == "list" || cmd == "build" || cmd == "compile" || cmd == "init" || cmd == "clean")
-    {
-        std::cerr << "External toolchain is disabled. Use `run` or `selfhost pack`.\n";
-        return 2;
-    }
-#endif
-
-    // 直呼檔名的舊行為→全部改導到 VM
-    if (cmd.size() > 2 && cmd.find('.') != std::string::npos)
-    {
-        // 舊用法: zhcl hello.c → 現在直接以 VM 跑
-        return cmd_run(cmd, "", {});
-    }
-
-    std::cerr << "Unknown command. Try --help.\n";
-    return 1;
-}
-
-// ============================================================================
-// UTILITY FUNCTIONS
-// ============================================================================
-
-int initialize_project(bool verbose)
-{
-    if (verbose)
-        std::cout << "Initializing new zhcl project..." << std::endl;
-
-    // Create zhcl.toml
-    std::ofstream config("zhcl.toml");
-    config << "[project]\n";
-    config << "name = \"my_project\"\n";
-    config << "version = \"0.1.0\"\n";
-    config << "type = \"exe\"\n";
-    config << "\n[build]\n";
-    config << "compiler = \"auto\"\n";
-    config << "flags = []\n";
-    config << "\n[dependencies]\n";
-    config << "# Add dependencies here\n";
-    config.close();
-
-    // Create main.cpp
-    std::ofstream main_cpp("main.cpp");
-    main_cpp << "#include <iostream>\n";
-    main_cpp << "\n";
-    main_cpp << "int main() {\n";
-    main_cpp << "    std::cout << \"Hello, zhcl!\" << std::endl;\n";
-    main_cpp << "    return 0;\n";
-    main_cpp << "}\n";
-    main_cpp.close();
-
-    // Create README.md
-    std::ofstream readme("README.md");
-    readme << "# My zhcl Project\n";
-    readme << "\n";
-    readme << "Built with zhcl - the universal compiler.\n";
-    readme << "\n";
-    readme << "## Building\n";
-    readme << "```\n";
-    readme << "zhcl build\n";
-    readme << "```\n";
-    readme << "\n";
-    readme << "## Running\n";
-    readme << "```\n";
-    readme << "zhcl run main.cpp\n";
-    readme << "```\n";
-    readme.close();
-
-    if (verbose)
-        std::cout << "Created zhcl.toml, main.cpp, and README.md" << std::endl;
-    return 0;
-}
-
-int list_compilers(const CompilerRegistry &registry, bool verbose)
-{
-    // Only show built-in supported languages (no external dependencies needed)
-    std::cout << "Built-in supported languages (no external dependencies):" << std::endl;
-    std::cout << "  ?批遣 C/C++ (via MSVC/gcc detection)" << std::endl;
-    std::cout << "  ?批遣 Java (bytecode generation)" << std::endl;
-    std::cout << "  ?批遣 Go (translation to C++)" << std::endl;
-    std::cout << "  ?批遣 Chinese (.zh files) - 蝜??芸?嚗撓??摮葡/?湔/閮剔/憒?/?血?/??蝯?" << std::endl;
-    std::cout << "  ?批遣 Python (translation to C++)" << std::endl;
-    std::cout << "  ?批遣 JavaScript (translation to C++)" << std::endl;
-
-    return 0;
-}
-
-int clean_project(bool verbose)
-{
-    if (verbose)
-        std::cout << "Cleaning build artifacts..." << std::endl;
-
-    std::vector<std::string> patterns = {"*.exe", "*.obj", "*.o", "*.class", "*.pyc", "__pycache__"};
-
-    for (const auto &pattern : patterns)
-    {
-        for (const auto &entry : fs::recursive_directory_iterator("."))
-        {
-            std::string filename = entry.path().filename().string();
-            if (fs::is_regular_file(entry.path()))
-            {
-                if (matches_pattern(filename, pattern))
-                {
-                    fs::remove(entry.path());
-                    if (verbose)
-                        std::cout << "Removed: " << entry.path() << std::endl;
-                }
-            }
-            else if (fs::is_directory(entry.path()) && filename == "__pycache__")
-            {
-                fs::remove_all(entry.path());
-                if (verbose)
-                    std::cout << "Removed directory: " << entry.path() << std::endl;
-            }
-        }
-    }
-
-    return 0;
-}
-
-bool matches_pattern(const std::string &filename, const std::string &pattern)
-{
-    if (pattern == "*.exe")
-        return filename.find(".exe") != std::string::npos;
-    if (pattern == "*.obj")
-        return filename.find(".obj") != std::string::npos;
-    if (pattern == "*.o")
-        return filename.find(".o") != std::string::npos;
-    if (pattern == "*.class")
-        return filename.find(".class") != std::string::npos;
-    if (pattern == "*.pyc")
-        return filename.find(".pyc") != std::string::npos;
-    return false;
-}
+﻿// zhcl.cpp -- Universal Compiler & Build System Replacement
+// One CPP file to rule them all: C, C++, Java, Python, Go, Rust, JS/TS, and more
+// Replaces cl, gcc, g++, javac, cmake, make, and build systems
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "../include/frontend.h"
+#include "../include/fe_clite.h"
+#include "../include/fe_cpplite.h"
+#include "../include/fe_jslite.h"
+#include "../include/fe_zh.h"
+#include "../include/zh_frontend.h"
+#include "../include/zh_vm.h"
+#include "../include/zh_native.h"
+#include "../include/zh_aot.h"
+#include "../include/zh_cache.h"
+#include "../include/zh_mmap.h"
+#include "../include/zh_zbc.h"
+#include "../include/chinese_new.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iterator>
+#include <iomanip>
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <cmath>
+#include <map>
+#include <set>
+#include <filesystem>
+#include <regex>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <unordered_map>
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+
+// Use explicit std:: prefix instead of using namespace std
+namespace fs = std::filesystem;
+
+// 共用小工具：BOM/換行正規化
+static inline void strip_utf8_bom(std::string &s)
+{
+    if (s.size() >= 3 &&
+        (unsigned char)s[0] == 0xEF &&
+        (unsigned char)s[1] == 0xBB &&
+        (unsigned char)s[2] == 0xBF)
+    {
+        s.erase(0, 3);
+    }
+}
+
+static inline void normalize_newlines(std::string &s)
+{
+    // 把 CRLF/CR 全部正規化成 \n
+    std::string out;
+    out.reserve(s.size());
+    for (size_t i = 0; i < s.size(); ++i)
+    {
+        char c = s[i];
+        if (c == '\r')
+        {
+            if (i + 1 < s.size() && s[i + 1] == '\n')
+                ++i; // 吃掉 \r\n 的 \n
+            out.push_back('\n');
+        }
+        else
+        {
+            out.push_back(c);
+        }
+    }
+    s.swap(out);
+}
+
+// Forward declarations
+extern "C" int translate_zh_to_cpp(const std::string &input_path, const std::string &output_cpp_path, bool verbose);
+
+// ======= SelfHost: payload trailer + runtime + packer (no external compilers) =======
+#ifdef _WIN32
+#include <windows.h>
+#endif
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+
+namespace selfhost
+{
+
+    static const uint64_t SH_MAGIC = 0x305941505A48435Full; // ????
+    static const uint32_t SH_VERSION = 2;                   // v2：payload 可用 varint 編碼（ENC_VARINT）；v1 payload 照常讀取
+
+#pragma pack(push, 1)
+    struct Trailer
+    {
+        uint64_t magic;          // SH_MAGIC
+        uint64_t payload_size;   // 雿?蝣潮摨?
+        uint64_t payload_offset; // 雿?蝣潸絲暺?
+        uint32_t version;        // <== New
+        uint32_t crc32;          // <== New (撠?payload 閮?)
+    };
+
+    // 緊接在 Trailer 之前的擴充欄位；舊版只讀最後 sizeof(Trailer) 仍可相容。
+    // 是否存在由 payload_offset + payload_size 與檔案大小推得。
+    struct TrailerExt
+    {
+        uint32_t flags; // SHF_*
+        uint32_t reserved;
+    };
+#pragma pack(pop)
+
+    enum : uint32_t
+    {
+        SHF_VERIFIED = 1u << 0, // 打包時已通過 verify_bc，啟動時可略過驗證
+    };
+
+    // 打包標記：原版 zhcl 的 packed 為 0，selfhost pack 在複製出的執行檔裡把它改成 1。
+    // 啟動時只讀這個變數，原版 zhcl 不必開啟自己的執行檔尋找 trailer。
+    // 放在可寫的資料區（volatile 避免被常數折疊），tag 在映像中只出現這一次，打包時以 tag 定位
+    struct PackMark
+    {
+        char tag[24];
+        uint32_t packed;
+    };
+    static volatile PackMark g_pack_mark = {"ZHCL\x01PACK-MARK\x02v1", 0};
+
+    static PackMark pack_mark_image(uint32_t packed)
+    {
+        PackMark m{};
+        for (size_t i = 0; i < sizeof(m.tag); i++)
+            m.tag[i] = g_pack_mark.tag[i];
+        m.packed = packed;
+        return m;
+    }
+
+    // === glue: .zh -> C++ using the new ZhFrontend (no Python needed) ===
+    static inline void emit_u64(std::vector<uint8_t> &bc, uint64_t v)
+    {
+        for (int i = 0; i < 8; i++)
+            bc.push_back((uint8_t)((v >> (8 * i)) & 0xFF)); // little-endian
+    }
+    static inline void emit_i64(std::vector<uint8_t> &bc, int64_t v)
+    {
+        emit_u64(bc, (uint64_t)v);
+    }
+
+    static void emit_PRINT_adapter(std::vector<uint8_t> &bc, const std::string &s)
+    {
+        bc.push_back((uint8_t)OP_PRINT);
+        emit_u64(bc, (uint64_t)s.size());
+        bc.insert(bc.end(), s.begin(), s.end());
+    }
+    static void emit_SET_I64_adapter(std::vector<uint8_t> &bc, uint8_t slot, long long v)
+    {
+        bc.push_back((uint8_t)OP_SET_I64);
+        bc.push_back(slot);
+        emit_i64(bc, v);
+    }
+    static void emit_PRINT_INT_adapter(std::vector<uint8_t> &bc, uint8_t slot)
+    {
+        bc.push_back((uint8_t)OP_PRINT_INT);
+        bc.push_back(slot);
+    }
+    static void emit_END_adapter(std::vector<uint8_t> &bc)
+    {
+        bc.push_back((uint8_t)OP_END);
+    }
+
+    // === glue: .zh -> C++ using the new ZhFrontend (no Python needed) ===
+
+    // 憒?瑼???恐??鋆?嚗歇摮撠梁??
+    extern std::string emit_cpp_from_bc(const std::vector<uint8_t> &bc);
+    // entry 不為 nullptr 時改為匯出 extern "C" int entry()（共享函式庫用，見 zh_aot.h），而不是 main()。
+    // 含函式呼叫（OP_CALL 起）或動態值 / 字串操作碼的程式沒有 C++ 版本，回傳空字串
+    extern std::string emit_cpp_from_bc(const std::vector<uint8_t> &bc, const char *entry);
+
+    // ---- ???脫? ----
+    static void disassemble_bc(const std::vector<uint8_t> &bc, std::ostream &out);
+    static int handle_selfhost_explain(int argc, char **argv);
+
+    // ---- 撠極??----
+    static std::string read_all(const fs::path &p)
+    {
+        std::ifstream f(p, std::ios::binary);
+        std::ostringstream ss;
+        ss << f.rdbuf();
+        return ss.str();
+    }
+    static bool write_all(const fs::path &p, const std::string &s)
+    {
+        fs::create_directories(p.parent_path());
+        std::ofstream f(p, std::ios::binary);
+        f.write(s.data(), (std::streamsize)s.size());
+        return (bool)f;
+    }
+
+    // ---- ??霅臭??Ⅳ?箏霈?澆? ----
+
+    // ?芾?蝢拙?閬?摮?嚗??? UTF-8
+    static std::string quote_utf8_minimal(const std::string &s)
+    {
+        std::string out;
+        out.reserve(s.size() + 2);
+        out.push_back('\"');
+        for (unsigned char c : s)
+        {
+            switch (c)
+            {
+            case '\\':
+                out += "\\\\";
+                break;
+            case '\"':
+                out += "\\\"";
+                break;
+            case '\n':
+                out += "\\n";
+                break;
+            case '\r':
+                out += "\\r";
+                break;
+            case '\t':
+                out += "\\t";
+                break;
+            default:
+                // ??ASCII ?湔?見頛詨嚗TF-8嚗?
+                out.push_back((char)c);
+            }
+        }
+        out.push_back('\"');
+        return out;
+    }
+
+    static void disassemble_bc(const uint8_t *bc, size_t n, std::ostream &out = std::cout)
+    {
+        out << "Bytecode disassembly:" << std::endl;
+        auto at = [&](size_t off)
+        {
+            std::ostringstream o;
+            o << std::setw(4) << std::setfill('0') << off;
+            return o.str();
+        };
+        // 先整段驗證；未通過時只列到出錯位置為止
+        VerifyError err;
+        bool ok = verify_bc(bc, n, err);
+        BcHeader h;
+        size_t limit = ok ? n : err.offset;
+        size_t i = 0;
+        std::string dbg_file;
+        std::vector<DebugRow> rows;
+        if (parse_header(bc, n, h))
+        {
+            if (h.code)
+                out << "frame " << h.frame << " slots, encoding " << (unsigned)h.enc << std::endl;
+            if (h.flags & BCF_POOL)
+                out << "string pool: " << h.pool_count << " strings, "
+                    << (h.pool_count ? rd_u32le(bc + h.pool_ends + 4 * (size_t)(h.pool_count - 1)) : 0) << " bytes"
+                    << std::endl;
+            if (read_debug(bc, n, h, dbg_file, rows))
+                out << "debug lines: " << rows.size() << " rows, " << (h.debug_end - h.debug) << " bytes"
+                    << (dbg_file.empty() ? "" : " (" + dbg_file + ")") << std::endl;
+            i = h.code;
+        }
+        uint32_t line = 0;
+        while (i < limit)
+        {
+            RawInsn R = read_insn_verified(bc, i, h);
+            const char *name = op_name(R.op);
+            if (!rows.empty() && debug_line(rows, i - h.code) != line)
+            {
+                line = debug_line(rows, i - h.code);
+                if (line)
+                    out << "      ; line " << line << std::endl;
+            }
+            out << at(i) << ": ";
+            switch (R.op)
+            {
+            case OP_PRINT:
+                out << "PRINT ";
+                if (h.flags & BCF_POOL)
+                    out << "#" << R.a << " ";
+                out << quote_utf8_minimal(std::string(R.s, (size_t)R.len)) << std::endl;
+                break;
+            case OP_PRINT_INT:
+                out << "PRINT_INT v" << R.a << std::endl;
+                break;
+            case OP_SET_I64:
+                out << "SET_I64 v" << R.a << " = " << (long long)R.imm << std::endl;
+                break;
+            case OP_COPY_I64:
+                out << "COPY_I64 v" << R.a << " = v" << R.b << std::endl;
+                break;
+            case OP_SET_F64:
+            {
+                char num[40];
+                std::snprintf(num, sizeof(num), "%.17g", as_f64(R.imm));
+                out << "SET_F64 v" << R.a << " = " << num << std::endl;
+                break;
+            }
+            case OP_I2F:
+            case OP_F2I:
+                out << name << " v" << R.a << " = v" << R.b << std::endl;
+                break;
+            case OP_PRINT_F64:
+                out << "PRINT_F64 v" << R.a << std::endl;
+                break;
+            case OP_MATH:
+                out << "MATH v" << R.a << " = " << math_name((unsigned)R.imm) << "(v" << R.b;
+                if (math_arity((unsigned)R.imm) == 2)
+                    out << ", v" << R.c;
+                out << ")" << std::endl;
+                break;
+            case OP_ANEW:
+                out << "ANEW v" << R.a << " = new[v" << R.b << "]" << std::endl;
+                break;
+            case OP_ALEN:
+                out << "ALEN v" << R.a << " = len(v" << R.b << ")" << std::endl;
+                break;
+            case OP_AGET:
+                out << "AGET v" << R.a << " = v" << R.b << "[v" << R.c << "]" << std::endl;
+                break;
+            case OP_ASET:
+                out << "ASET v" << R.a << "[v" << R.b << "] = v" << R.c << std::endl;
+                break;
+            case OP_VEC:
+                if (vec_reduces((unsigned)R.imm))
+                {
+                    out << "VEC v" << R.a << " = " << vec_name((unsigned)R.imm) << "(v" << R.b;
+                    if (((unsigned)R.imm & 7) == VK_DOT_I)
+                        out << ", v" << R.c;
+                    out << ")" << std::endl;
+                }
+                else
+                    out << "VEC " << vec_name((unsigned)R.imm) << " v" << R.a << ", v" << R.b << ", v" << R.c
+                        << std::endl;
+                break;
+            case OP_CALL_NATIVE:
+            {
+                const NativeSig *sg = native_sig((unsigned)R.imm);
+                out << "CALL_NATIVE ";
+                if (sg->sig[0] != 'v')
+                    out << "v" << R.a << " = ";
+                out << sg->name << "(";
+                if (R.s)
+                    out << quote_utf8_minimal(std::string(R.s, (size_t)R.len)) << (R.argc ? ", " : "");
+                for (uint32_t k = 0; k < R.argc; k++)
+                    out << (k ? ", v" : "v") << R.args[k];
+                out << ")" << std::endl;
+                break;
+            }
+            case OP_CALL:
+            case OP_TAILCALL:
+                out << name << " ";
+                if (R.op == OP_CALL)
+                    out << "v" << R.a << " = ";
+                out << at((size_t)R.imm) << "(";
+                for (uint32_t k = 0; k < R.argc; k++)
+                    out << (k ? ", v" : "v") << R.args[k];
+                out << ") frame " << R.b << std::endl;
+                break;
+            case OP_RET:
+                out << "RET v" << R.a << std::endl;
+                break;
+            case OP_SPAWN:
+                out << "SPAWN v" << R.a << "..v" << R.b << " -> " << at((size_t)R.imm);
+                for (uint32_t k = 0; k < R.argc; k++)
+                    out << (k ? ", " : " reduce ") << reduce_name(R.red[k]) << (R.red[k] & RD_F64 ? ".f" : "")
+                        << (R.red[k] & RD_TIE ? "=" : "") << " v" << R.args[k];
+                out << std::endl;
+                break;
+            case OP_JOIN:
+                out << "JOIN" << std::endl;
+                break;
+            case OP_GO:
+                out << "GO " << at((size_t)R.imm) << "(";
+                for (uint32_t k = 0; k < R.argc; k++)
+                    out << (k ? ", v" : "v") << R.args[k];
+                out << ") frame " << R.b << std::endl;
+                break;
+            case OP_CHAN:
+                out << "CHAN v" << R.a << " = make(cap v" << R.b << ")" << std::endl;
+                break;
+            case OP_SEND:
+                out << "SEND v" << R.a << " <- v" << R.b << std::endl;
+                break;
+            case OP_RECV:
+                out << "RECV v" << R.a << ", v" << R.b << " = <-v" << R.c << std::endl;
+                break;
+            case OP_CLOSE:
+                out << "CLOSE v" << R.a << std::endl;
+                break;
+            case OP_SELECT:
+            {
+                out << "SELECT v" << R.a << " (v" << R.b << ", v" << R.c << ")";
+                uint32_t q = 0;
+                for (uint32_t k = 0; k < R.argc; k++)
+                {
+                    out << (k ? ", " : " ");
+                    if (R.red[k] == SEL_DEFAULT)
+                        out << "default";
+                    else if (R.red[k] == SEL_SEND)
+                    {
+                        out << "v" << R.args[q] << " <- v" << R.args[q + 1];
+                        q += 2;
+                    }
+                    else
+                        out << "<-v" << R.args[q++];
+                }
+                out << std::endl;
+                break;
+            }
+            case OP_JMP:
+                out << "JMP -> " << at((size_t)R.imm) << std::endl;
+                break;
+            case OP_JZ:
+            case OP_JNZ:
+                out << name << " v" << R.a << " -> " << at((size_t)R.imm) << std::endl;
+                break;
+            case OP_END:
+                out << "END" << std::endl;
+                break;
+            case OP_DBOX:
+                out << "DBOX d" << R.a << " = " << tag_name((unsigned)R.imm) << "(v" << R.b << ")" << std::endl;
+                break;
+            case OP_DUNBOX:
+                out << "DUNBOX v" << R.a << " = " << tag_name((unsigned)R.imm) << "(d" << R.b << ")" << std::endl;
+                break;
+            case OP_DMOV:
+                out << "DMOV d" << R.a << " = d" << R.b << std::endl;
+                break;
+            case OP_SCONST:
+                out << "SCONST v" << R.a << " = #" << R.imm << " "
+                    << quote_utf8_minimal(std::string(R.s, (size_t)R.len)) << std::endl;
+                break;
+            case OP_DPRINT:
+                out << "DPRINT" << ((R.imm & DF_PY) ? ".py" : "") << ((R.imm & DF_SEP) ? ".sep" : "") << " d" << R.a
+                    << std::endl;
+                break;
+            case OP_SPRINT:
+                out << "SPRINT v" << R.a << std::endl;
+                break;
+            default: // 三位址運算 / 比較；動態運算的 pair 運算元記為 d
+            {
+                const unsigned pm = pair_operands(R.op);
+                out << name << ((pm & 1) ? " d" : " v") << R.a << ((pm & 2) ? " = d" : " = v") << R.b
+                    << ((pm & 4) ? ", d" : ", v") << R.c << std::endl;
+                break;
+            }
+            }
+            i = R.next;
+        }
+        if (!ok)
+        {
+            out << at(err.offset) << ": <invalid> " << err.message << std::endl;
+            return;
+        }
+        out << "End of bytecode" << std::endl;
+    }
+    static void disassemble_bc(const std::vector<uint8_t> &bc, std::ostream &out = std::cout)
+    {
+        disassemble_bc(bc.data(), bc.size(), out);
+    }
+
+    // ---- New: 霈??+ 撽? trailer嚗???payload ??閮?----
+    struct PayloadInfo
+    {
+        MappedFile file;               // 整個檔案的唯讀對映
+        const uint8_t *data = nullptr; // payload 在對映中的位置
+        size_t size = 0;
+        Trailer tr{};
+        uint32_t flags = 0; // TrailerExt.flags（無擴充欄位時為 0）
+        bool ok = false;
+        bool crc_ok = false;
+    };
+    static PayloadInfo read_payload_from_file(const fs::path &exe)
+    {
+        PayloadInfo R;
+        if (!R.file.open(exe))
+            return R;
+        const uint8_t *base = R.file.data();
+        uint64_t sz = R.file.size();
+        if (sz < sizeof(Trailer))
+            return R;
+        std::memcpy(&R.tr, base + sz - sizeof(Trailer), sizeof(Trailer)); // 結尾未必對齊
+        if (R.tr.magic != SH_MAGIC)
+            return R;
+        // payload 必須完整落在 trailer 之前（分開比較，避免損毀的欄位相加溢位）
+        uint64_t room = sz - sizeof(Trailer);
+        if (R.tr.payload_offset > room || R.tr.payload_size > room - R.tr.payload_offset)
+            return R;
+        R.ok = true;
+        if (R.tr.payload_offset + R.tr.payload_size + sizeof(TrailerExt) == room)
+        {
+            TrailerExt ext{};
+            std::memcpy(&ext, base + room - sizeof(TrailerExt), sizeof(ext));
+            R.flags = ext.flags;
+        }
+        R.data = base + R.tr.payload_offset;
+        R.size = (size_t)R.tr.payload_size;
+        R.crc_ok = (crc32(R.data, R.size) == R.tr.crc32);
+        return R;
+    }
+
+    // ---- runtime嚗????亙葆 payload 撠勗?芾?璈怠? -> ?瑁? -> ???----
+    // 有 payload 時執行並回傳 true，rc 為結束碼；沒有 payload 回傳 false
+    static bool maybe_run_embedded_payload(int &rc)
+    {
+        if (!g_pack_mark.packed)
+            return false; // 原版 zhcl：不開啟執行檔
+#ifdef _WIN32
+        wchar_t pathW[MAX_PATH]{0};
+        GetModuleFileNameW(nullptr, pathW, MAX_PATH);
+        fs::path self(pathW);
+#else
+        fs::path self = "/proc/self/exe";
+#endif
+        auto R = read_payload_from_file(self);
+        if (!R.ok)
+            return false;
+
+        // 霈??R 銋??璈怠?銋??嚗?
+        bool show_proof = false;
+
+// 1) ?賭誘???貉孛?潘??舀 --prove / --proof / --selfhost-info嚗?
+#ifdef _WIN32
+        {
+            std::wstring cmd = GetCommandLineW();
+            std::wstring lower = cmd;
+            std::transform(lower.begin(), lower.end(), lower.begin(), ::towlower);
+            if (lower.find(L"--prove") != std::wstring::npos ||
+                lower.find(L"--proof") != std::wstring::npos ||
+                lower.find(L"--selfhost-info") != std::wstring::npos)
+            {
+                show_proof = true;
+            }
+        }
+#else
+        {
+            // ??Windows ?舐 argc/argv ??/proc/self/cmdline嚗?雿??暹??嗆???嚗?
+            // 銝?舐?靘??乩??券?楝敺銝 argv嚗隞亙??仿?嚗??函憓??詨??剁?
+        }
+#endif
+
+        // 2) ?啣?霈閫貊嚗I/?單?剁?
+        if (const char *s = std::getenv("ZHCL_SELFHOST_SHOW"))
+        {
+            if (s[0] == '1' || s[0] == 'y' || s[0] == 'Y' || s[0] == 't' || s[0] == 'T')
+            {
+                show_proof = true;
+            }
+        }
+
+        // 3) ?乩?? Trailer.flags 閮剝??HF_SILENT_BANNER??甇方??臬??典蕭?亙?
+        //    ???券?閮剖停?舫?暺??芣?憿臬?閬??＊蝷箝?
+
+        // ????ㄐ?舐??printf 璈怠? ??
+        //    ?寞?嚗??show_proof ?
+        if (show_proof)
+        {
+            std::printf("[selfhost] payload v%u %s size=%llu crc=%s\n",
+                        R.tr.version,
+                        (R.ok ? "found" : "missing"),
+                        (unsigned long long)R.tr.payload_size,
+                        (R.crc_ok ? "OK" : "BAD"));
+        }
+
+        if (!R.crc_ok)
+        {
+            std::fprintf(stderr, "[selfhost] CRC mismatch, abort.\n");
+            rc = 3;
+            return true;
+        }
+
+        rc = execute_bc(R.data, R.size, (R.flags & SHF_VERIFIED) != 0, jit_mode_from_env()); // 直接在對映的頁面上執行
+        return true;
+    }
+
+    // ---- 蝧餉陌?剁?JS ??雿?蝣潘?PoC嚗onsole.log("??) / ?嗡?敹賜嚗?---
+    // 先交給 js-lite 前端（變數、運算式、字串串接）；它不支援的寫法退回下面只取 console.log("…") 字面值的做法
+    static std::vector<uint8_t> translate_js_to_bc(const std::string &js, const std::string &path)
+    {
+        if (IFrontend *fe = FrontendRegistry::instance().by_name("js-lite"))
+        {
+            Bytecode out;
+            std::string err;
+            if (fe->compile(FrontendContext{path, js, false}, out, err))
+                return out.data;
+        }
+        std::vector<uint8_t> bc;
+        bcw::StrPool pool;
+        std::istringstream ss(js);
+        std::string line;
+        // ??????撓??
+        while (std::getline(ss, line))
+        {
+            // ?駁??蝛箇
+            size_t start = line.find_first_not_of(" \t");
+            if (start == std::string::npos)
+                continue;
+            line = line.substr(start);
+            if (line.empty())
+                continue;
+
+            auto pos = line.find("console.log");
+            if (pos != std::string::npos)
+            {
+                // ?曉 console.log( 銋??摰?
+                size_t paren_start = line.find('(', pos);
+                if (paren_start == std::string::npos)
+                    continue;
+                size_t paren_end = line.find(')', paren_start);
+                if (paren_end == std::string::npos)
+                    continue;
+
+                std::string arg = line.substr(paren_start + 1, paren_end - paren_start - 1);
+                // 蝪∪??嚗??隞亙???憪?蝯?嚗??摰?
+                if (arg.size() >= 2 && arg.front() == '"' && arg.back() == '"')
+                {
+                    std::string content = arg.substr(1, arg.size() - 2);
+                    bcw::print(bc, pool, content);
+                }
+            }
+            // 敹賜?嗡?銵?霈?脫???貊?嚗?
+        }
+        // 憒?瘝?銵??泵嚗?閰西????蝚虫葡
+        if (bc.empty())
+        {
+            std::string content = js;
+            // ?駁??蝛箇
+            size_t start = content.find_first_not_of(" \t\r\n");
+            if (start != std::string::npos)
+            {
+                content = content.substr(start);
+                size_t end = content.find_last_not_of(" \t\r\n");
+                if (end != std::string::npos)
+                {
+                    content = content.substr(0, end + 1);
+                }
+            }
+
+            auto pos = content.find("console.log");
+            if (pos != std::string::npos)
+            {
+                // ?曉 console.log( 銋??摰?
+                size_t paren_start = content.find('(', pos);
+                if (paren_start != std::string::npos)
+                {
+                    size_t paren_end = content.find(')', paren_start);
+                    if (paren_end != std::string::npos)
+                    {
+                        std::string arg = content.substr(paren_start + 1, paren_end - paren_start - 1);
+                        // 蝪∪??嚗??隞亙???憪?蝯?嚗??摰?
+                        if (arg.size() >= 2 && arg.front() == '"' && arg.back() == '"')
+                        {
+                            std::string text = arg.substr(1, arg.size() - 2);
+                            bcw::print(bc, pool, text);
+                        }
+                    }
+                }
+            }
+        }
+        bcw::finish(bc, 0, pool); // 只有 PRINT，不使用槽位
+        return bc;
+    }
+
+    // ---- 蝧餉陌?剁?銝剜??芰隤? .zh ??雿?蝣潘?PoC嚗撓?箏?銝?"?? / ?嗡??見嚗?---
+
+    // 1) UTF-8 BOM ?駁 + ?典耦撘?/蝛箇甇????+ 蝜陛撠?
+    static inline void strip_bom_utf8(std::string &s)
+    {
+        if (s.size() >= 3 && (uint8_t)s[0] == 0xEF && (uint8_t)s[1] == 0xBB && (uint8_t)s[2] == 0xBF)
+            s.erase(0, 3);
+    }
+
+    static inline void replace_all(std::string &s, const std::string &a, const std::string &b)
+    {
+        if (a.empty())
+            return;
+        size_t pos = 0;
+        while ((pos = s.find(a, pos)) != std::string::npos)
+        {
+            s.replace(pos, a.size(), b);
+            pos += b.size();
+        }
+    }
+
+    // 嚗?賂?IR ??C++嚗??箝?蝯虫犖???Ｙ嚗?
+    std::string emit_cpp_from_bc(const std::vector<uint8_t> &bc) { return emit_cpp_from_bc(bc, nullptr); }
+
+    std::string emit_cpp_from_bc(const std::vector<uint8_t> &bc, const char *entry)
+    {
+        std::ostringstream out;
+
+        // First pass: collect used variables, jump targets and helpers
+        std::set<uint32_t> used_vars;
+        std::set<size_t> labels;
+        bool need_div = false;
+        bool need_f64 = false;
+        bool need_arr = false;
+        bool need_native = false;
+        std::vector<RawInsn> insns;
+        BcHeader h;
+        size_t n = parse_header(bc.data(), bc.size(), h) ? bc.size() : 0;
+        size_t i = h.code;
+        RawInsn R;
+        while (read_insn(bc.data(), n, i, h, R))
+        {
+            if (R.op >= OP_CALL)
+                return std::string();
+            switch (R.op)
+            {
+            case OP_PRINT:
+            case OP_JMP:
+            case OP_END:
+                break;
+            case OP_PRINT_INT:
+            case OP_SET_I64:
+            case OP_JZ:
+            case OP_JNZ:
+                used_vars.insert(R.a);
+                break;
+            case OP_SET_F64:
+            case OP_PRINT_F64:
+                used_vars.insert(R.a);
+                need_f64 = true;
+                break;
+            case OP_COPY_I64:
+            case OP_I2F:
+            case OP_F2I:
+                used_vars.insert(R.a);
+                used_vars.insert(R.b);
+                need_f64 |= R.op != OP_COPY_I64;
+                break;
+            case OP_ANEW:
+            case OP_ALEN:
+                used_vars.insert(R.a);
+                used_vars.insert(R.b);
+                need_arr = true;
+                break;
+            case OP_CALL_NATIVE:
+            {
+                const char *sig = native_sig((unsigned)R.imm)->sig;
+                if (sig[0] != 'v')
+                    used_vars.insert(R.a);
+                for (uint32_t k = 0; k < R.argc; k++)
+                    used_vars.insert(R.args[k]);
+                need_native = true;
+                need_f64 |= std::strchr(sig, 'f') != nullptr || R.imm == NF_PRINTF;
+                break;
+            }
+            default:
+                used_vars.insert(R.a);
+                used_vars.insert(R.b);
+                used_vars.insert(R.c);
+                need_div |= (R.op == OP_DIV || R.op == OP_MOD || R.op == OP_FLMOD);
+                need_f64 |= R.op >= OP_FADD;
+                need_arr |= R.op >= OP_ANEW;
+                break;
+            }
+            if (R.op == OP_JMP || R.op == OP_JZ || R.op == OP_JNZ)
+                labels.insert((size_t)R.imm);
+            insns.push_back(R);
+            i = R.next;
+        }
+        // 落在指令中間或範圍外的目標視同結尾（與 decode_bc 一致）
+        std::set<size_t> starts;
+        for (auto &r : insns)
+            starts.insert(r.off);
+        auto label_of = [&](int64_t t) -> std::string
+        {
+            if (t < 0 || !starts.count((size_t)t))
+                return "L_end";
+            return "L" + std::to_string(t);
+        };
+
+        need_f64 |= need_arr;
+        out << "#include <cstdio>\n#include <cstdint>\n";
+        if (need_arr)
+            out << "#include <vector>\n";
+        if (need_f64)
+            out << "#include <cmath>\n#include <cstring>\n";
+        if (need_native)
+            out << "#include <cstdlib>\n#include <ctime>\n";
+        if (need_div)
+        {
+            out << "static long long zh_div(long long a, long long b){ if(!b) return 0; if(b==-1) return (long long)(0ULL-(unsigned long long)a); return a/b; }\n";
+            out << "static long long zh_mod(long long a, long long b){ if(!b||b==-1) return 0; return a%b; }\n";
+            out << "static long long zh_flmod(long long a, long long b){ long long r = zh_mod(a, b); return r && (r<0) != (b<0) ? r+b : r; }\n";
+        }
+        if (need_f64)
+        {
+            // 槽位一律為 long long，f64 以位元型樣存放（與 VM 相同）
+            out << "static double zh_f(long long v){ double d; std::memcpy(&d, &v, 8); return d; }\n";
+            out << "static long long zh_b(double d){ long long v; std::memcpy(&v, &d, 8); return v; }\n";
+            out << "static long long zh_f2i(double d){ if(d!=d) return 0; if(d>=9223372036854775807.0) return INT64_MAX; "
+                   "if(d<=-9223372036854775808.0) return INT64_MIN; return (long long)d; }\n";
+        }
+        if (need_arr)
+        {
+            // 陣列與 OP_VEC 的純量參考版本：長度上限、無效代號與浮點歸約順序皆同 VM（見 zh_simd.h）
+            out << "static std::vector<std::vector<long long>> zh_heap; static long long zh_total = 0;\n"
+                   "static long long zh_anew(long long n){ const long long M = " << ARRAY_MAX_LEN << "LL; "
+                   "if(n<0) n=0; if(n>M) n=M; if(zh_total+n>4*M) return 0; zh_total+=n; "
+                   "zh_heap.emplace_back((size_t)n, 0); return (long long)zh_heap.size(); }\n"
+                   "static long long *zh_arr(long long h, size_t &n){ if(h<=0||(unsigned long long)h>zh_heap.size()){ n=0; return 0; } "
+                   "n=zh_heap[h-1].size(); return zh_heap[h-1].data(); }\n"
+                   "static long long zh_alen(long long h){ size_t n; zh_arr(h, n); return (long long)n; }\n"
+                   "static long long zh_aget(long long h, long long i){ size_t n; long long *p=zh_arr(h, n); "
+                   "return (unsigned long long)i<n ? p[i] : 0; }\n"
+                   "static void zh_aset(long long h, long long i, long long x){ size_t n; long long *p=zh_arr(h, n); "
+                   "if((unsigned long long)i<n) p[i]=x; }\n"
+                   "static long long zh_wadd(long long a, long long b){ return (long long)((unsigned long long)a+(unsigned long long)b); }\n"
+                   "static long long zh_wmul(long long a, long long b){ return (long long)((unsigned long long)a*(unsigned long long)b); }\n"
+                   "static double zh_fold(const double *l){ return ((l[0]+l[1])+(l[2]+l[3]))+((l[4]+l[5])+(l[6]+l[7])); }\n"
+                   "static double zh_fpick(double m, double x, bool mx){ return (mx ? x>m : x<m) ? x : m; }\n"
+                   "static long long zh_vec(int k, long long a, long long b, long long c){\n"
+                   "  size_t na=0, nb=0, nc=0; bool red=(k&7)>=4, sc=(k&7)==3, fl=k>=8;\n"
+                   "  long long *pa=red?0:zh_arr(a, na), *pb=zh_arr(b, nb), *pc=sc?0:zh_arr(c, nc);\n"
+                   "  size_t n2=na<nb?na:nb, n3=n2<nc?n2:nc, nd=nb<nc?nb:nc;\n"
+                   "  switch(k&7){\n"
+                   "  case 0: for(size_t i=0;i<n3;i++) pa[i]=fl?zh_b(zh_f(pb[i])+zh_f(pc[i])):zh_wadd(pb[i],pc[i]); return a;\n"
+                   "  case 1: for(size_t i=0;i<n3;i++) pa[i]=fl?zh_b(zh_f(pb[i])*zh_f(pc[i])):zh_wmul(pb[i],pc[i]); return a;\n"
+                   "  case 2: for(size_t i=0;i<n3;i++) pa[i]=fl?zh_b(std::fma(zh_f(pb[i]),zh_f(pc[i]),zh_f(pa[i]))):zh_wadd(pa[i],zh_wmul(pb[i],pc[i])); return a;\n"
+                   "  case 3: for(size_t i=0;i<n2;i++) pa[i]=fl?zh_b(zh_f(pb[i])*zh_f(c)):zh_wmul(pb[i],c); return a;\n"
+                   "  case 4: case 7: {\n"
+                   "    size_t n=(k&7)==7?nd:nb;\n"
+                   "    if(!fl){ long long s=0; for(size_t i=0;i<n;i++) s=zh_wadd(s,(k&7)==7?zh_wmul(pb[i],pc[i]):pb[i]); return s; }\n"
+                   "    double l[8]={0}; size_t i=0;\n"
+                   "    for(;i+8<=n;i+=8) for(int j=0;j<8;j++){ double p=(k&7)==7?zh_f(pb[i+j])*zh_f(pc[i+j]):zh_f(pb[i+j]); l[j]+=p; }\n"
+                   "    double s=zh_fold(l);\n"
+                   "    for(;i<n;i++){ double p=(k&7)==7?zh_f(pb[i])*zh_f(pc[i]):zh_f(pb[i]); s+=p; }\n"
+                   "    return zh_b(s); }\n"
+                   "  default: {\n"
+                   "    bool mx=(k&7)==6; if(!nb) return 0;\n"
+                   "    if(!fl){ long long m=pb[0]; for(size_t i=1;i<nb;i++) m=(mx?pb[i]>m:pb[i]<m)?pb[i]:m; return m; }\n"
+                   "    size_t i=1; double m=zh_f(pb[0]);\n"
+                   "    if(nb>=8){ double l[8]; for(int j=0;j<8;j++) l[j]=zh_f(pb[j]);\n"
+                   "      for(i=8;i+8<=nb;i+=8) for(int j=0;j<8;j++) l[j]=zh_fpick(l[j],zh_f(pb[i+j]),mx);\n"
+                   "      m=zh_fpick(zh_fpick(zh_fpick(l[0],l[1],mx),zh_fpick(l[2],l[3],mx),mx),zh_fpick(zh_fpick(l[4],l[5],mx),zh_fpick(l[6],l[7],mx),mx),mx); }\n"
+                   "    for(;i<nb;i++) m=zh_fpick(m,zh_f(pb[i]),mx);\n"
+                   "    return zh_b(m); }\n"
+                   "  }\n"
+                   "}\n";
+        }
+        if (!entry)
+            out << "int main(){\n";
+        else
+        {
+            out << "#ifdef _WIN32\n#define ZH_EXPORT extern \"C\" __declspec(dllexport)\n#else\n"
+                   "#define ZH_EXPORT extern \"C\" __attribute__((visibility(\"default\")))\n#endif\n";
+            out << "ZH_EXPORT int " << entry << "(){\n";
+            if (need_arr)
+                out << "  zh_heap.clear(); zh_total = 0;\n"; // 同一行程可重複呼叫
+        }
+
+        // Declare all variables at the beginning
+        for (uint32_t id : used_vars)
+        {
+            out << "  long long v" << id << " = 0;\n";
+        }
+
+        // Second pass: generate operations
+        auto v = [](uint32_t id)
+        { return "v" + std::to_string(id); };
+        auto wrap = [&](const RawInsn &r, const char *op)
+        {
+            out << "  " << v(r.a) << " = (long long)((unsigned long long)" << v(r.b) << " " << op
+                << " (unsigned long long)" << v(r.c) << ");\n";
+        };
+        auto cmp = [&](const RawInsn &r, const char *op)
+        {
+            out << "  " << v(r.a) << " = " << v(r.b) << " " << op << " " << v(r.c) << ";\n";
+        };
+        auto lit = [](int64_t x) -> std::string
+        {
+            if (x == INT64_MIN)
+                return "(-9223372036854775807LL - 1)";
+            return std::to_string((long long)x) + "LL";
+        };
+        auto f = [&](uint32_t id)
+        { return "zh_f(" + v(id) + ")"; };
+        auto farith = [&](const RawInsn &r, const char *op)
+        {
+            out << "  " << v(r.a) << " = zh_b(" << f(r.b) << " " << op << " " << f(r.c) << ");\n";
+        };
+        auto fcmp = [&](const RawInsn &r, const char *op)
+        {
+            out << "  " << v(r.a) << " = " << f(r.b) << " " << op << " " << f(r.c) << ";\n";
+        };
+        for (auto &r : insns)
+        {
+            if (labels.count(r.off))
+                out << " L" << r.off << ":;\n";
+            switch (r.op)
+            {
+            case OP_PRINT:
+                out << "  std::puts(" << quote_utf8_minimal(std::string(r.s, (size_t)r.len)) << ");\n";
+                break;
+            case OP_PRINT_INT:
+                out << "  std::printf(\"%lld\\n\", (long long)" << v(r.a) << ");\n";
+                break;
+            case OP_SET_I64:
+                out << "  " << v(r.a) << " = " << lit(r.imm) << ";\n";
+                break;
+            case OP_COPY_I64:
+                out << "  " << v(r.a) << " = " << v(r.b) << ";\n";
+                break;
+            case OP_SET_F64:
+            {
+                char num[40];
+                std::snprintf(num, sizeof(num), "%.17g", as_f64(r.imm));
+                out << "  " << v(r.a) << " = " << lit(r.imm) << "; // " << num << "\n";
+                break;
+            }
+            case OP_I2F:
+                out << "  " << v(r.a) << " = zh_b((double)" << v(r.b) << ");\n";
+                break;
+            case OP_F2I:
+                out << "  " << v(r.a) << " = zh_f2i(" << f(r.b) << ");\n";
+                break;
+            case OP_PRINT_F64:
+                out << "  std::printf(\"%.15g\\n\", " << f(r.a) << ");\n";
+                break;
+            case OP_FADD: farith(r, "+"); break;
+            case OP_FSUB: farith(r, "-"); break;
+            case OP_FMUL: farith(r, "*"); break;
+            case OP_FDIV: farith(r, "/"); break;
+            case OP_FMOD:
+                out << "  " << v(r.a) << " = zh_b(std::fmod(" << f(r.b) << ", " << f(r.c) << "));\n";
+                break;
+            case OP_FFLMOD:
+                out << "  { double m = std::fmod(" << f(r.b) << ", " << f(r.c) << "), d = " << f(r.c) << "; " << v(r.a)
+                    << " = zh_b(m == 0 ? std::copysign(0.0, d) : (m < 0) != (d < 0) ? m + d : m); }\n";
+                break;
+            case OP_FEQ: fcmp(r, "=="); break;
+            case OP_FNE: fcmp(r, "!="); break;
+            case OP_FLT: fcmp(r, "<"); break;
+            case OP_FLE: fcmp(r, "<="); break;
+            case OP_FGT: fcmp(r, ">"); break;
+            case OP_FGE: fcmp(r, ">="); break;
+            case OP_MATH:
+                out << "  " << v(r.a) << " = zh_b(std::" << math_name((unsigned)r.imm) << "(" << f(r.b);
+                if (math_arity((unsigned)r.imm) == 2)
+                    out << ", " << f(r.c);
+                out << "));\n";
+                break;
+            case OP_ANEW:
+                out << "  " << v(r.a) << " = zh_anew(" << v(r.b) << ");\n";
+                break;
+            case OP_ALEN:
+                out << "  " << v(r.a) << " = zh_alen(" << v(r.b) << ");\n";
+                break;
+            case OP_AGET:
+                out << "  " << v(r.a) << " = zh_aget(" << v(r.b) << ", " << v(r.c) << ");\n";
+                break;
+            case OP_ASET:
+                out << "  zh_aset(" << v(r.a) << ", " << v(r.b) << ", " << v(r.c) << ");\n";
+                break;
+            case OP_VEC:
+                out << "  " << v(r.a) << " = zh_vec(" << r.imm << ", " << v(r.a) << ", " << v(r.b) << ", " << v(r.c)
+                    << "); // " << vec_name((unsigned)r.imm) << "\n";
+                break;
+            case OP_CALL_NATIVE:
+            {
+                // 與 zh_native.cpp 相同的行為（chinese.h 的函式展開成標準函式庫呼叫）
+                static const char *const libm[] = {"pow",  "sqrt", "cbrt",  "sin",   "cos",  "tan",   "asin",
+                                                   "acos", "atan", "atan2", "fabs", "floor", "ceil", "round"};
+                const char *sig = native_sig((unsigned)r.imm)->sig;
+                auto arg = [&](uint32_t k, char t) -> std::string
+                {
+                    if (k >= r.argc)
+                        return t == 'f' ? "0.0" : t == 'c' ? "0" : "0LL";
+                    return t == 'f' ? f(r.args[k]) : t == 'c' ? "(int)" + v(r.args[k]) : "(long long)" + v(r.args[k]);
+                };
+                switch ((NativeId)r.imm)
+                {
+                case NF_RAND:
+                    out << "  " << v(r.a) << " = std::rand();\n";
+                    break;
+                case NF_TIME:
+                    out << "  " << v(r.a) << " = (long long)(long)std::time(nullptr);\n";
+                    break;
+                case NF_SRAND:
+                    out << "  std::srand((unsigned)" << v(r.args[0]) << ");\n";
+                    break;
+                case NF_SRAND_TIME:
+                    out << "  std::srand((unsigned)std::time(nullptr));\n";
+                    break;
+                case NF_READ_INT:
+                    out << "  { long long t = 0; if (std::scanf(\"%lld\", &t) != 1) t = 0; " << v(r.a) << " = t; }\n";
+                    break;
+                case NF_READ_F64:
+                    out << "  { double t = 0; if (std::scanf(\"%lf\", &t) != 1) t = 0; " << v(r.a) << " = zh_b(t); }\n";
+                    break;
+                case NF_PRINTF:
+                {
+                    std::string types;
+                    std::string fmt = native_format(r.s, (size_t)r.len, types);
+                    out << "  std::printf(" << quote_utf8_minimal(fmt);
+                    for (size_t k = 0; k < types.size(); k++)
+                        out << ", " << arg((uint32_t)k, types[k]);
+                    out << ");\n";
+                    break;
+                }
+                case NF_WRITE:
+                    out << "  std::fwrite(" << quote_utf8_minimal(std::string(r.s, (size_t)r.len)) << ", 1, " << r.len
+                        << ", stdout);\n";
+                    break;
+                case NF_PRINT_U64:
+                    out << "  std::printf(\"%llu\\n\", (unsigned long long)" << v(r.args[0]) << ");\n";
+                    break;
+                case NF_PRINT_BOOL:
+                    out << "  std::puts(" << v(r.args[0]) << " ? " << quote_utf8_minimal(u8"真") << " : "
+                        << quote_utf8_minimal(u8"假") << ");\n";
+                    break;
+                default:
+                    out << "  " << v(r.a) << " = zh_b(std::" << libm[r.imm - NF_POW] << "(" << f(r.args[0]);
+                    if (std::strlen(sig) == 3)
+                        out << ", " << f(r.args[1]);
+                    out << "));\n";
+                    break;
+                }
+                break;
+            }
+            case OP_ADD: wrap(r, "+"); break;
+            case OP_SUB: wrap(r, "-"); break;
+            case OP_MUL: wrap(r, "*"); break;
+            case OP_DIV:
+                out << "  " << v(r.a) << " = zh_div(" << v(r.b) << ", " << v(r.c) << ");\n";
+                break;
+            case OP_MOD:
+                out << "  " << v(r.a) << " = zh_mod(" << v(r.b) << ", " << v(r.c) << ");\n";
+                break;
+            case OP_FLMOD:
+                out << "  " << v(r.a) << " = zh_flmod(" << v(r.b) << ", " << v(r.c) << ");\n";
+                break;
+            case OP_EQ: cmp(r, "=="); break;
+            case OP_NE: cmp(r, "!="); break;
+            case OP_LT: cmp(r, "<"); break;
+            case OP_LE: cmp(r, "<="); break;
+            case OP_GT: cmp(r, ">"); break;
+            case OP_GE: cmp(r, ">="); break;
+            case OP_JMP:
+                out << "  goto " << label_of(r.imm) << ";\n";
+                break;
+            case OP_JZ:
+                out << "  if (!" << v(r.a) << ") goto " << label_of(r.imm) << ";\n";
+                break;
+            case OP_JNZ:
+                out << "  if (" << v(r.a) << ") goto " << label_of(r.imm) << ";\n";
+                break;
+            case OP_END:
+                out << "  goto L_end;\n";
+                break;
+            }
+        }
+        out << " L_end:;\n";
+        out << "  return 0;\n}\n";
+        return out.str();
+    }
+
+    // ---- 蝧餉陌?剁?Python ??雿?蝣潘?PoC嚗rint("??) / ?嗡?敹賜嚗?---
+    static std::vector<uint8_t> translate_py_to_bc(const std::string &py)
+    {
+        std::vector<uint8_t> bc;
+        bcw::StrPool pool;
+        std::istringstream ss(py);
+        std::string line;
+        while (std::getline(ss, line))
+        {
+            // ?駁??蝛箇
+            size_t start = line.find_first_not_of(" \t");
+            if (start == std::string::npos)
+                continue;
+            line = line.substr(start);
+            if (line.empty())
+                continue;
+
+            auto pos = line.find("print(");
+            if (pos != std::string::npos)
+            {
+                // ?曉 print( 銋??摰?
+                size_t paren_start = line.find('(', pos);
+                if (paren_start == std::string::npos)
+                    continue;
+                size_t paren_end = line.find(')', paren_start);
+                if (paren_end == std::string::npos)
+                    continue;
+
+                std::string arg = line.substr(paren_start + 1, paren_end - paren_start - 1);
+                // 蝪∪??嚗??隞亙???憪?蝯?嚗??摰?
+                if (arg.size() >= 2 && arg.front() == '"' && arg.back() == '"')
+                {
+                    std::string content = arg.substr(1, arg.size() - 2);
+                    bcw::print(bc, pool, content);
+                }
+            }
+            // 敹賜?嗡?銵?霈?脫???貊?嚗?
+        }
+        bcw::finish(bc, 0, pool); // 只有 PRINT，不使用槽位
+        return bc;
+    }
+
+    // ---- 蝧餉陌?剁?Go ??雿?蝣潘?PoC嚗mt.Println("??) / ?嗡?敹賜嚗?---
+    // 先交給 go-lite 前端（goroutine、channel、select）；它不支援的寫法退回下面只取 fmt.Println("…") 字面值的做法
+    static std::vector<uint8_t> translate_go_to_bc(const std::string &go, const std::string &path)
+    {
+        if (IFrontend *fe = FrontendRegistry::instance().by_name("go-lite"))
+        {
+            Bytecode out;
+            std::string err;
+            if (fe->compile(FrontendContext{path, go, false}, out, err))
+                return out.data;
+        }
+        std::vector<uint8_t> bc;
+        bcw::StrPool pool;
+        std::istringstream ss(go);
+        std::string line;
+        while (std::getline(ss, line))
+        {
+            // ?駁??蝛箇
+            size_t start = line.find_first_not_of(" \t");
+            if (start == std::string::npos)
+                continue;
+            line = line.substr(start);
+            if (line.empty())
+                continue;
+
+            auto pos = line.find("fmt.Println(");
+            if (pos != std::string::npos)
+            {
+                // ?曉 fmt.Println( 銋??摰?
+                size_t paren_start = line.find('(', pos);
+                if (paren_start == std::string::npos)
+                    continue;
+                size_t paren_end = line.find(')', paren_start);
+                if (paren_end == std::string::npos)
+                    continue;
+
+                std::string arg = line.substr(paren_start + 1, paren_end - paren_start - 1);
+                // 蝪∪??嚗??隞亙???憪?蝯?嚗??摰?
+                if (arg.size() >= 2 && arg.front() == '"' && arg.back() == '"')
+                {
+                    std::string content = arg.substr(1, arg.size() - 2);
+                    bcw::print(bc, pool, content);
+                }
+            }
+            // 敹賜?嗡?銵?霈?脫???貊?嚗?
+        }
+        bcw::finish(bc, 0, pool); // 只有 PRINT，不使用槽位
+        return bc;
+    }
+
+    // ---- 蝧餉陌?剁?Java ??雿?蝣潘?PoC嚗ystem.out.println("??) / ?嗡?敹賜嚗?---
+    static std::vector<uint8_t> translate_java_to_bc(const std::string &java)
+    {
+        std::vector<uint8_t> bc;
+        bcw::StrPool pool;
+        std::istringstream ss(java);
+        std::string line;
+        while (std::getline(ss, line))
+        {
+            // ?駁??蝛箇
+            size_t start = line.find_first_not_of(" \t");
+            if (start == std::string::npos)
+                continue;
+            line = line.substr(start);
+            if (line.empty())
+                continue;
+
+            auto pos = line.find("System.out.println(");
+            if (pos != std::string::npos)
+            {
+                // ?曉 System.out.println( 銋??摰?
+                size_t paren_start = line.find('(', pos);
+                if (paren_start == std::string::npos)
+                    continue;
+                size_t paren_end = line.find(')', paren_start);
+                if (paren_end == std::string::npos)
+                    continue;
+
+                std::string arg = line.substr(paren_start + 1, paren_end - paren_start - 1);
+                // 蝪∪??嚗??隞亙???憪?蝯?嚗??摰?
+                if (arg.size() >= 2 && arg.front() == '"' && arg.back() == '"')
+                {
+                    std::string content = arg.substr(1, arg.size() - 2);
+                    bcw::print(bc, pool, content);
+                }
+            }
+            // 敹賜?嗡?銵?霈?脫???貊?嚗?
+        }
+        bcw::finish(bc, 0, pool); // 只有 PRINT，不使用槽位
+        return bc;
+    }
+
+    // ---- pack嚗神??version ??CRC??芾?閮 ----
+    static int pack_payload_to_exe(const fs::path &output_exe, const std::vector<uint8_t> &bc,
+#ifdef _WIN32
+                                   const fs::path &self_exe = []
+                                   {
+                                   wchar_t pathW[MAX_PATH]{0};
+                                   GetModuleFileNameW(nullptr, pathW, MAX_PATH);
+                                   return fs::path(pathW); }()
+#else
+                                   const fs::path &self_exe = "/proc/self/exe"
+#endif
+    )
+    {
+        VerifyError verr;
+        if (!verify_bc(bc.data(), bc.size(), verr))
+        {
+            std::fprintf(stderr, "[selfhost] bytecode rejected at offset %zu: %s\n", verr.offset, verr.message.c_str());
+            return 9;
+        }
+        // 複製自身並把打包標記改為 1；找不到或不唯一時不打包，否則產生的執行檔會略過自己的 payload
+        MappedFile self;
+        if (!self.open(self_exe))
+        {
+            std::fprintf(stderr, "[selfhost] copy self -> out failed\n");
+            return 4;
+        }
+        const PackMark unpacked = pack_mark_image(0), packed = pack_mark_image(1);
+        const uint8_t *img = self.data(), *end = img + self.size();
+        auto find_mark = [&](const uint8_t *from)
+        { return std::search(from, end, (const uint8_t *)&unpacked, (const uint8_t *)&unpacked + sizeof(unpacked)); };
+        const uint8_t *mark = find_mark(img);
+        if (mark == end || find_mark(mark + 1) != end)
+        {
+            std::fprintf(stderr, "[selfhost] pack marker not found in %s\n", self_exe.string().c_str());
+            return 4;
+        }
+        {
+            std::ofstream copy(output_exe, std::ios::binary | std::ios::trunc);
+            copy.write((const char *)img, (std::streamsize)(mark - img));
+            copy.write((const char *)&packed, (std::streamsize)sizeof(packed));
+            copy.write((const char *)mark + sizeof(packed), (std::streamsize)(end - mark - sizeof(packed)));
+            if (!copy)
+            {
+                std::fprintf(stderr, "[selfhost] copy self -> out failed\n");
+                return 4;
+            }
+        }
+        self.close();
+        std::ofstream out(output_exe, std::ios::binary | std::ios::app);
+        if (!out)
+        {
+            std::fprintf(stderr, "[selfhost] open out for append failed\n");
+            return 5;
+        }
+        uint64_t off = (uint64_t)fs::file_size(output_exe);
+        out.write((const char *)bc.data(), (std::streamsize)bc.size());
+
+        TrailerExt ext{};
+        ext.flags = SHF_VERIFIED;
+        out.write((const char *)&ext, sizeof(ext));
+
+        Trailer tr{};
+        tr.magic = SH_MAGIC;
+        tr.payload_size = (uint64_t)bc.size();
+        tr.payload_offset = off;
+        tr.version = SH_VERSION;                // <== New
+        tr.crc32 = crc32(bc.data(), bc.size()); // <== New
+
+        out.write((const char *)&tr, sizeof(tr));
+        out.flush();
+
+        std::printf("[selfhost] packed -> %s (v%u, size=%llu, crc=%08X)\n",
+                    output_exe.string().c_str(),
+                    tr.version,
+                    (unsigned long long)tr.payload_size,
+                    tr.crc32);
+
+        return 0;
+    }
+
+    // ---- JAR格式打包 (JAR format packing) ----
+    static int pack_payload_to_jar(const fs::path &output_jar, const std::vector<uint8_t> &bc, const std::string &lang)
+    {
+        // 創建臨時目錄結構
+        fs::path temp_dir = output_jar;
+        temp_dir.replace_extension(".jar_temp");
+        fs::create_directories(temp_dir);
+
+        // 創建META-INF目錄
+        fs::path meta_inf = temp_dir / "META-INF";
+        fs::create_directories(meta_inf);
+
+        // 創建MANIFEST.MF
+        fs::path manifest_path = meta_inf / "MANIFEST.MF";
+        std::ofstream manifest(manifest_path, std::ios::binary);
+        if (!manifest)
+        {
+            std::fprintf(stderr, "[selfhost] create manifest failed\n");
+            return 6;
+        }
+        manifest << "Manifest-Version: 1.0\r\n";
+        manifest << "Main-Class: Main\r\n";
+        manifest << "Created-By: zhcl_universal\r\n";
+        manifest << "\r\n";
+        manifest.close();
+
+        // 保存字節碼文件
+        fs::path bytecode_path = temp_dir / ("Main." + lang + ".bc");
+        std::ofstream bc_file(bytecode_path, std::ios::binary);
+        if (!bc_file)
+        {
+            std::fprintf(stderr, "[selfhost] create bytecode file failed\n");
+            return 7;
+        }
+        bc_file.write((const char *)bc.data(), (std::streamsize)bc.size());
+        bc_file.close();
+
+        // 使用系統zip命令創建JAR文件
+        std::string zip_cmd = "cd \"" + temp_dir.parent_path().string() + "\" && zip -r \"" +
+                              output_jar.string() + "\" \"" + temp_dir.filename().string() + "\"";
+        int zip_result = std::system(zip_cmd.c_str());
+
+        // 清理臨時文件
+        fs::remove_all(temp_dir);
+
+        if (zip_result != 0)
+        {
+            std::fprintf(stderr, "[selfhost] zip command failed (code: %d)\n", zip_result);
+            return 8;
+        }
+
+        std::printf("[selfhost] packed -> %s (JAR format, size=%llu)\n",
+                    output_jar.string().c_str(),
+                    (unsigned long long)bc.size());
+
+        return 0;
+    }
+
+    // ---- 撠??亙嚗 CLI ?澆 ----
+
+    // keep_debug：保留除錯行表（--keep-debug），預設剝除
+    static int pack_from_file(const std::string &lang, const fs::path &in, const fs::path &out, bool keep_debug = false)
+    {
+        std::string src = read_all(in);
+        // BOM/換行正規化
+        strip_utf8_bom(src);
+        normalize_newlines(src);
+
+        std::vector<uint8_t> bc;
+        if (lang == "js" || lang == "javascript")
+            bc = translate_js_to_bc(src, in.string());
+        else if (lang == "py" || lang == "python")
+            bc = translate_py_to_bc(src);
+        else if (lang == "go")
+            bc = translate_go_to_bc(src, in.string());
+        else if (lang == "java")
+            bc = translate_java_to_bc(src);
+        else if (lang == "zh")
+        {
+            ZhFrontend fe;
+            try
+            {
+                bc = fe.translate_to_bc(src, in.string());
+            }
+            catch (const std::exception &e)
+            {
+                std::fprintf(stderr, "[selfhost] zh->bc failed: %s\n", e.what());
+                return 3;
+            }
+        }
+        else
+        {
+            std::fprintf(stderr, "[selfhost] unsupported lang: %s\n", lang.c_str());
+            return 2;
+        }
+        if (!keep_debug)
+            bcw::strip_debug(bc);
+        return pack_payload_to_exe(out, bc);
+    }
+
+    // ---- 撠??亙銝?嚗ack_from_file嚗?銝??verify ??喳 ----
+    static int verify_exe(const fs::path &exe)
+    {
+        auto R = read_payload_from_file(exe);
+        if (!R.ok)
+        {
+            std::fprintf(stderr, "[selfhost] no payload in: %s\n", exe.string().c_str());
+            return 2;
+        }
+        std::printf("[selfhost] verify: %s\n", exe.string().c_str());
+        std::printf("  version : %u\n", R.tr.version);
+        std::printf("  size    : %llu bytes\n", (unsigned long long)R.tr.payload_size);
+        std::printf("  offset  : %llu\n", (unsigned long long)R.tr.payload_offset);
+        std::printf("  crc32   : %08X (%s)\n", R.tr.crc32, R.crc_ok ? "OK" : "BAD");
+        if (!R.crc_ok)
+            return 3;
+        VerifyError verr;
+        if (!verify_bc(R.data, R.size, verr))
+        {
+            std::printf("  bytecode: rejected at offset %zu (%s)\n", verr.offset, verr.message.c_str());
+            return 4;
+        }
+        BcHeader h;
+        parse_header(R.data, R.size, h);
+        static const char *const enc_names[] = {"legacy", "wide slots", "varint"};
+        std::printf("  encoding: %s, frame %u slots\n", enc_names[h.enc], h.frame);
+        if (h.flags & BCF_DEBUG)
+            std::printf("  debug   : line table kept (%zu bytes)\n", h.debug_end - h.debug);
+        std::printf("  bytecode: OK%s\n", (R.flags & SHF_VERIFIED) ? " (verified at pack time)" : "");
+        return 0;
+    }
+
+    // ---- handle selfhost explain command ----
+    static int handle_selfhost_explain(int argc, char **argv)
+    {
+        if (argc < 4)
+        {
+            std::puts("Usage:\n  zhcl_universal selfhost explain <input.(js|py|go|java|zh|zbc)>");
+            return 2;
+        }
+        fs::path in = argv[3];
+        if (is_zbc_path(in))
+        {
+            // 已編譯的 .zbc：直接反組譯對映中的位元碼
+            ZbcFile z;
+            std::string err;
+            if (!z.open(in, err))
+            {
+                std::fprintf(stderr, "[selfhost] %s: %s\n", in.string().c_str(), err.c_str());
+                return 3;
+            }
+            std::cout << "zbc v" << z.version() << ": " << z.file_size() << " bytes, frontend "
+                      << (z.frontend().empty() ? "?" : z.frontend()) << ", source " << (z.source().empty() ? "?" : z.source())
+                      << std::endl;
+            disassemble_bc(z.image(), z.image_size());
+            return 0;
+        }
+        std::string src = read_all(in); // ??征??舐?亦
+        // BOM/換行正規化
+        strip_utf8_bom(src);
+        normalize_newlines(src);
+
+        std::vector<uint8_t> bc;
+        auto ext = in.extension().string();
+        if (ext == ".js")
+            bc = translate_js_to_bc(src, in.string());
+        else if (ext == ".py")
+            bc = translate_py_to_bc(src);
+        else if (ext == ".go")
+            bc = translate_go_to_bc(src, in.string());
+        else if (ext == ".java")
+            bc = translate_java_to_bc(src);
+        else if (ext == ".zh")
+        {
+            ZhFrontend fe;
+            try
+            {
+                bc = fe.translate_to_bc(src, in.string());
+            }
+            catch (const std::exception &e)
+            {
+                std::fprintf(stderr, "[selfhost] zh->bc failed: %s\n", e.what());
+                return 3;
+            }
+        }
+        else
+        {
+            std::fprintf(stderr, "[selfhost] unsupported input: %s\n", ext.c_str());
+            return 2;
+        }
+        disassemble_bc(bc);
+        return 0;
+    }
+
+} // namespace selfhost
+
+// === glue: .zh -> C++ using the new ZhFrontend (no Python needed) ===
+static inline void emit_u64(std::vector<uint8_t> &bc, uint64_t v)
+{
+    for (int i = 0; i < 8; i++)
+        bc.push_back((uint8_t)((v >> (8 * i)) & 0xFF)); // little-endian
+}
+static inline void emit_i64(std::vector<uint8_t> &bc, int64_t v)
+{
+    emit_u64(bc, (uint64_t)v);
+}
+
+static void emit_PRINT_adapter(std::vector<uint8_t> &bc, const std::string &s)
+{
+    bc.push_back((uint8_t)selfhost::OP_PRINT);
+    emit_u64(bc, (uint64_t)s.size());
+    bc.insert(bc.end(), s.begin(), s.end());
+}
+static void emit_SET_I64_adapter(std::vector<uint8_t> &bc, uint8_t slot, long long v)
+{
+    bc.push_back((uint8_t)selfhost::OP_SET_I64);
+    bc.push_back(slot);
+    emit_i64(bc, v);
+}
+static void emit_PRINT_INT_adapter(std::vector<uint8_t> &bc, uint8_t slot)
+{
+    bc.push_back((uint8_t)selfhost::OP_PRINT_INT);
+    bc.push_back(slot);
+}
+static void emit_END_adapter(std::vector<uint8_t> &bc)
+{
+    bc.push_back((uint8_t)selfhost::OP_END);
+}
+
+// Forward declarations
+class CompilerRegistry;
+class LanguageProcessor;
+class CppProcessor;
+class JavaProcessor;
+class PythonProcessor;
+class GoProcessor;
+class RustProcessor;
+
+// JVM Bytecode Writer (Big-Endian)
+struct W
+{
+    std::vector<uint8_t> buf;
+    void u1(uint8_t x) { buf.push_back(x); }
+    void u2(uint16_t x)
+    {
+        buf.push_back((x >> 8) & 0xFF);
+        buf.push_back(x & 0xFF);
+    }
+    void u4(uint32_t x)
+    {
+        buf.push_back((x >> 24) & 0xFF);
+        buf.push_back((x >> 16) & 0xFF);
+        buf.push_back((x >> 8) & 0xFF);
+        buf.push_back(x & 0xFF);
+    }
+    void bytes(const void *p, size_t n)
+    {
+        auto c = (const uint8_t *)p;
+        buf.insert(buf.end(), c, c + n);
+    }
+    void utf8(const std::string &s)
+    {
+        u1(1);
+        u2((uint16_t)s.size());
+        bytes(s.data(), s.size());
+    }
+};
+
+// ============================================================================
+// LANGUAGE PROCESSORS - Handle compilation for each language
+// ============================================================================
+
+class LanguageProcessor
+{
+public:
+    virtual ~LanguageProcessor() = default;
+    virtual bool can_handle(const std::string &ext) = 0;
+    virtual int compile(const std::string &input, const std::string &output,
+                        const std::vector<std::string> &flags, bool verbose) = 0;
+    virtual int run(const std::string &executable, bool verbose) = 0;
+    virtual std::string get_default_output(const std::string &input) = 0;
+};
+
+// ============================================================================
+// COMPILER REGISTRY SYSTEM - Detects and manages all compilers
+// ============================================================================
+
+class CompilerRegistry
+{
+public:
+    struct Compiler
+    {
+        std::string name;
+        std::string command;
+        std::vector<std::string> flags;
+        std::set<std::string> supported_languages;
+        bool available = false;
+        int priority = 0; // Higher = preferred
+    };
+
+    std::map<std::string, Compiler> compilers;
+
+    void detect_compilers()
+    {
+        // C/C++ Compilers
+        detect_compiler("msvc", "cl", {"C", "C++"}, {"-nologo", "-utf-8", "-EHsc", "-std:c++17"}, 100);
+        detect_compiler("gcc", "gcc", {"C", "C++"}, {"-Wall", "-std=c++17"}, 90);
+        detect_compiler("g++", "g++", {"C++"}, {"-Wall", "-std=c++17"}, 90);
+        detect_compiler("clang", "clang", {"C", "C++"}, {"-Wall", "-std=c++17"}, 95);
+        detect_compiler("clang++", "clang++", {"C++"}, {"-Wall", "-std=c++17"}, 95);
+
+        // JVM Languages
+        detect_compiler("javac", "javac", {"Java"}, {"-g"}, 80);
+        detect_compiler("kotlin", "kotlinc", {"Kotlin"}, {}, 70);
+        detect_compiler("scala", "scalac", {"Scala"}, {}, 70);
+
+        // Systems Languages
+        detect_compiler("rustc", "rustc", {"Rust"}, {"-O"}, 85);
+        detect_compiler("go", "go", {"Go"}, {}, 85);
+        detect_compiler("swift", "swiftc", {"Swift"}, {}, 75);
+
+        // Scripting Languages
+        detect_compiler("python", "python", {"Python"}, {}, 60);
+        detect_compiler("node", "node", {"JavaScript"}, {}, 60);
+        detect_compiler("tsc", "tsc", {"TypeScript"}, {}, 65);
+        detect_compiler("ruby", "ruby", {"Ruby"}, {}, 60);
+        detect_compiler("perl", "perl", {"Perl"}, {}, 60);
+
+        // .NET
+        detect_compiler("dotnet", "dotnet", {"C#", "F#", "VB.NET"}, {}, 80);
+        detect_compiler("mono", "mcs", {"C#"}, {}, 70);
+
+        // Special cases
+        detect_compiler("zhcc", "zhcc_cpp.exe", {"Chinese"}, {"--cc"}, 50);
+    }
+
+private:
+    void detect_compiler(const std::string &name, const std::string &cmd, const std::set<std::string> &langs,
+                         const std::vector<std::string> &flags, int priority)
+    {
+        std::string test_cmd;
+        if (name == "msvc")
+        {
+            test_cmd = cmd + " /? >nul 2>&1";
+        }
+        else
+        {
+            test_cmd = cmd + " --version >nul 2>&1";
+        }
+        bool available = (system(test_cmd.c_str()) == 0);
+
+        compilers[name] = {name, cmd, flags, langs, available, priority};
+
+        if (!available)
+        {
+            // Try alternative test commands
+            std::vector<std::string> alt_tests;
+            if (name == "msvc")
+            {
+                alt_tests = {" /help", ""};
+            }
+            else
+            {
+                alt_tests = {" --help", " -v", " -version", ""};
+            }
+            for (const auto &alt : alt_tests)
+            {
+                if (system((cmd + alt + " >nul 2>&1").c_str()) == 0)
+                {
+                    compilers[name].available = true;
+                    break;
+                }
+            }
+
+            // Special handling for MSVC: search common installation paths
+            if (!compilers[name].available && name == "msvc")
+            {
+                // Try the exact path from compile_definitions.bat first
+                std::string exact_path = "C:\\Program Files (x86)\\Microsoft Visual Studio\\2019\\BuildTools\\VC\\Tools\\MSVC\\14.29.30133\\bin\\Hostx64\\x64\\cl.exe";
+                std::string test_exact = "\"" + exact_path + "\" /? >nul 2>&1";
+                if (system(test_exact.c_str()) == 0)
+                {
+                    compilers[name].available = true;
+                    compilers[name].command = "\"" + exact_path + "\"";
+                }
+                else
+                {
+                    // Fallback to path search
+                    std::vector<std::string> common_paths = {
+                        "C:\\Program Files\\Microsoft Visual Studio\\2022\\Professional\\VC\\Tools\\MSVC",
+                        "C:\\Program Files\\Microsoft Visual Studio\\2022\\Enterprise\\VC\\Tools\\MSVC",
+                        "C:\\Program Files\\Microsoft Visual Studio\\2022\\Community\\VC\\Tools\\MSVC",
+                        "C:\\Program Files (x86)\\Microsoft Visual Studio\\2019\\Professional\\VC\\Tools\\MSVC",
+                        "C:\\Program Files (x86)\\Microsoft Visual Studio\\2019\\Enterprise\\VC\\Tools\\MSVC",
+                        "C:\\Program Files (x86)\\Microsoft Visual Studio\\2019\\Community\\VC\\Tools\\MSVC",
+                        "C:\\Program Files (x86)\\Microsoft Visual Studio\\2019\\BuildTools\\VC\\Tools\\MSVC",
+                        "C:\\Program Files (x86)\\Microsoft Visual Studio\\2017\\Professional\\VC\\Tools\\MSVC",
+                        "C:\\Program Files (x86)\\Microsoft Visual Studio\\2017\\Enterprise\\VC\\Tools\\MSVC",
+                        "C:\\Program Files (x86)\\Microsoft Visual Studio\\2017\\Community\\VC\\Tools\\MSVC",
+                        "C:\\Program Files (x86)\\Microsoft Visual Studio\\2017\\BuildTools\\VC\\Tools\\MSVC"};
+
+                    for (const auto &base_path : common_paths)
+                    {
+                        if (fs::exists(base_path))
+                        {
+                            // Find the latest version directory
+                            std::vector<std::string> versions;
+                            for (const auto &entry : fs::directory_iterator(base_path))
+                            {
+                                if (fs::is_directory(entry))
+                                {
+                                    versions.push_back(entry.path().string());
+                                }
+                            }
+                            if (!versions.empty())
+                            {
+                                // Sort and take the latest version
+                                std::sort(versions.begin(), versions.end());
+                                std::string latest_version = versions.back();
+                                std::string cl_path = latest_version + "\\bin\\Hostx64\\x64\\cl.exe";
+                                std::string test_cl = "\"" + cl_path + "\" /? >nul 2>&1";
+                                if (system(test_cl.c_str()) == 0)
+                                {
+                                    compilers[name].available = true;
+                                    compilers[name].command = "\"" + cl_path + "\"";
+                                    break;
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+};
+
+class CppProcessor : public LanguageProcessor
+{
+public:
+    CompilerRegistry *registry;
+
+    bool can_handle(const std::string &ext) override
+    {
+        return ext == ".c" || ext == ".cpp" || ext == ".cc" || ext == ".cxx";
+    }
+
+    int compile(const std::string &input, const std::string &output,
+                const std::vector<std::string> &flags, bool verbose) override
+    {
+        // Find best available C++ compiler
+        std::string compiler_cmd;
+        std::vector<std::string> default_flags;
+
+        if (registry->compilers["msvc"].available)
+        {
+            compiler_cmd = registry->compilers["msvc"].command;
+            default_flags = {"/nologo", "/utf-8", "/EHsc", "/std:c++17"};
+        }
+        else if (registry->compilers["clang++"].available)
+        {
+            compiler_cmd = registry->compilers["clang++"].command;
+            default_flags = {"-Wall", "-std=c++17"};
+        }
+        else if (registry->compilers["g++"].available)
+        {
+            compiler_cmd = registry->compilers["g++"].command;
+            default_flags = {"-Wall", "-std=c++17"};
+        }
+        else
+        {
+            // No compiler available
+            std::cerr << "Error: No C/C++ compiler found. Please install Visual Studio, GCC, or Clang." << std::endl;
+            return 1;
+        }
+
+        std::string cmd = compiler_cmd;
+        for (const auto &flag : default_flags)
+            cmd += " " + flag;
+        for (const auto &flag : flags)
+            cmd += " " + flag;
+        cmd += " \"" + input + "\"";
+
+        if (!output.empty())
+        {
+            if (compiler_cmd.find("cl") != std::string::npos)
+            {
+                cmd += " /Fe:\"" + output + "\"";
+            }
+            else
+            {
+                cmd += " -o \"" + output + "\"";
+            }
+        }
+
+        if (verbose)
+            std::cout << "Compiling C/C++: " << cmd << std::endl;
+        return system(cmd.c_str());
+    }
+
+    int run(const std::string &executable, bool verbose) override
+    {
+        std::string cmd = "\"" + executable + "\"";
+        if (verbose)
+            std::cout << "Running: " << cmd << std::endl;
+        return system(cmd.c_str());
+    }
+
+    std::string get_default_output(const std::string &input) override
+    {
+        return input.substr(0, input.find_last_of('.')) + ".exe";
+    }
+};
+
+class JavaProcessor : public LanguageProcessor
+{
+public:
+    CompilerRegistry *registry;
+
+    bool can_handle(const std::string &ext) override
+    {
+        return ext == ".java" || ext == ".jar";
+    }
+
+    int compile(const std::string &input, const std::string &output,
+                const std::vector<std::string> &flags, bool verbose) override
+    {
+        // Check if output is JAR
+        bool is_jar = !output.empty() && output.size() > 4 &&
+                      output.substr(output.size() - 4) == ".jar";
+
+        std::string class_output = output;
+        if (is_jar)
+        {
+            // For JAR output, first compile to .class
+            class_output = output.substr(0, output.size() - 4) + ".class";
+        }
+
+        // Try javac first
+        if (registry->compilers["javac"].available)
+        {
+            std::string cmd = "javac";
+            for (const auto &flag : flags)
+                cmd += " " + flag;
+            cmd += " \"" + input + "\"";
+            if (verbose)
+                std::cout << "Compiling Java with javac: " << cmd << std::endl;
+            int result = system(cmd.c_str());
+            if (result != 0)
+                return result;
+
+            // If JAR output requested, create JAR file
+            if (is_jar)
+            {
+                std::string class_file = input.substr(0, input.find_last_of('.')) + ".class";
+                std::string main_class = input.substr(0, input.find_last_of('.'));
+                int jar_result = create_jar_file(class_file, output, main_class, verbose);
+                if (jar_result == 0)
+                {
+                    return 0; // JAR created successfully
+                }
+                else
+                {
+                    // JAR creation failed, but class file exists - still return success
+                    if (verbose)
+                    {
+                        std::cout << "Note: JAR creation failed, but class file was created successfully" << std::endl;
+                    }
+                    return 0;
+                }
+            }
+            return 0;
+        }
+        else
+        {
+            // Fallback to embedded bytecode generator
+            int result = generate_bytecode(input, class_output, verbose);
+            if (result != 0)
+                return result;
+
+            // If JAR output requested, create JAR file
+            if (is_jar)
+            {
+                std::string class_file = class_output;
+                std::string main_class = input.substr(0, input.find_last_of('.'));
+                int jar_result = create_jar_file(class_file, output, main_class, verbose);
+                if (jar_result == 0)
+                {
+                    return 0; // JAR created successfully
+                }
+                else
+                {
+                    // JAR creation failed, but class file exists - still return success
+                    if (verbose)
+                    {
+                        std::cout << "Note: JAR creation failed, but class file was created successfully" << std::endl;
+                    }
+                    return 0;
+                }
+            }
+            return 0;
+        }
+    }
+
+    int run(const std::string &executable, bool verbose) override
+    {
+        // Check if it's a JAR file
+        if (executable.size() > 4 && executable.substr(executable.size() - 4) == ".jar")
+        {
+            std::string cmd = "java -jar \"" + executable + "\"";
+            if (verbose)
+                std::cout << "Running JAR: " << cmd << std::endl;
+            return system(cmd.c_str());
+        }
+        else
+        {
+            // Run class file
+            std::string class_name = executable.substr(0, executable.find_last_of('.'));
+            std::string cmd = "java " + class_name;
+            if (verbose)
+                std::cout << "Running Java: " << cmd << std::endl;
+            return system(cmd.c_str());
+        }
+    }
+
+    std::string get_default_output(const std::string &input) override
+    {
+        // Check if user wants JAR output
+        if (input.find(".jar") != std::string::npos ||
+            (input.size() > 4 && input.substr(input.size() - 4) == ".jar"))
+        {
+            return input.substr(0, input.find_last_of('.')) + ".jar";
+        }
+        return input.substr(0, input.find_last_of('.')) + ".class";
+    }
+
+private:
+    int generate_bytecode(const std::string &input, const std::string &output, bool verbose)
+    {
+        // Simple Java bytecode generator - only supports basic System.out.println("...");
+
+        std::ifstream in(input);
+        if (!in)
+        {
+            std::cerr << "Cannot open Java file: " << input << std::endl;
+            return 1;
+        }
+
+        std::string line;
+        std::string print_content;
+        bool found_println = false;
+
+        while (std::getline(in, line))
+        {
+            // Look for System.out.println("...");
+            size_t pos = line.find("System.out.println(");
+            if (pos != std::string::npos)
+            {
+                size_t start = line.find('"', pos);
+                size_t end = line.find('"', start + 1);
+                if (start != std::string::npos && end != std::string::npos)
+                {
+                    print_content = line.substr(start + 1, end - start - 1);
+                    found_println = true;
+                    break;
+                }
+            }
+        }
+
+        in.close();
+
+        if (!found_println)
+        {
+            // Fallback to Hello World
+            print_content = "Hello, World!";
+        }
+
+        // Generate bytecode for System.out.println(print_content);
+        std::vector<uint8_t> classfile;
+        generate_println_class(classfile, print_content);
+
+        std::string classfile_name = output.empty() ? input.substr(0, input.find_last_of('.')) + ".class" : output;
+
+        std::ofstream out(classfile_name, std::ios::binary);
+        out.write((char *)classfile.data(), classfile.size());
+        out.close();
+
+        if (verbose)
+            std::cout << "Generated Java bytecode: " << classfile_name << std::endl;
+        return 0;
+    }
+
+    // Embedded JVM bytecode generator (simplified)
+    void generate_println_class(std::vector<uint8_t> &out, const std::string &message)
+    {
+        // This is a simplified version - in reality you'd parse the Java file
+        // For now, just generate a Hello World class
+        W w;
+        // ... (same bytecode generation code as before)
+        w.u4(0xCAFEBABE);
+        w.u2(0);
+        w.u2(49);
+        w.u2(28);
+        // ... (rest of the bytecode)
+        w.utf8("HelloWorld");
+        w.u1(7);
+        w.u2(1);
+        w.utf8("java/lang/Object");
+        w.u1(7);
+        w.u2(3);
+        w.utf8("java/lang/System");
+        w.u1(7);
+        w.u2(5);
+        w.utf8("out");
+        w.utf8("Ljava/io/PrintStream;");
+        w.u1(12);
+        w.u2(7);
+        w.u2(8);
+        w.u1(9);
+        w.u2(6);
+        w.u2(9);
+        w.utf8("java/io/PrintStream");
+        w.u1(7);
+        w.u2(11);
+        w.utf8("println");
+        w.utf8("(Ljava/lang/string;)V");
+        w.u1(12);
+        w.u2(13);
+        w.u2(14);
+        w.u1(10);
+        w.u2(12);
+        w.u2(15);
+        w.utf8(message); // The message
+        w.u1(8);
+        w.u2(17);
+        w.utf8("<init>");
+        w.utf8("()V");
+        w.u1(12);
+        w.u2(19);
+        w.u2(20);
+        w.u1(10);
+        w.u2(4);
+        w.u2(21);
+        w.utf8("Code");
+        w.utf8("main");
+        w.utf8("([Ljava/lang/string;)V");
+        w.utf8("SourceFile");
+        w.utf8("HelloWorld.java");
+        w.u2(0x0021);
+        w.u2(2);
+        w.u2(4);
+        w.u2(0);
+        w.u2(0);
+        w.u2(2);
+        w.u2(0x0001);
+        w.u2(19);
+        w.u2(20);
+        w.u2(1);
+        w.u2(23);
+        w.u4(17);
+        w.u2(1);
+        w.u2(1);
+        w.u4(5);
+        w.u1(0x2a);
+        w.u1(0xb7);
+        w.u2(22);
+        w.u1(0xb1);
+        w.u2(0);
+        w.u2(0);
+        w.u2(0x0009);
+        w.u2(24);
+        w.u2(25);
+        w.u2(1);
+        w.u2(23);
+        w.u4(21);
+        w.u2(2);
+        w.u2(1);
+        w.u4(9);
+        w.u1(0xb2);
+        w.u2(10);
+        w.u1(0x12);
+        w.u1(18);
+        w.u1(0xb6);
+        w.u2(16);
+        w.u1(0xb1);
+        w.u2(0);
+        w.u2(0);
+        w.u2(1);
+        w.u2(26);
+        w.u4(2);
+        w.u2(27);
+        out.swap(w.buf);
+    }
+
+    // Create JAR file with manifest and class file
+    int create_jar_file(const std::string &class_file, const std::string &jar_file, const std::string &main_class, bool verbose)
+    {
+        // Check if jar command is available
+        int jar_check = system("jar --version >nul 2>&1");
+        if (jar_check != 0)
+        {
+            if (verbose)
+            {
+                std::cout << "Warning: jar command not available, skipping JAR creation" << std::endl;
+                std::cout << "Class file created: " << class_file << std::endl;
+            }
+            return 1; // Indicate JAR creation failed, but class file exists
+        }
+
+        // Create temporary directory for JAR contents
+        std::string temp_dir = class_file.substr(0, class_file.find_last_of('.')) + "_jar_temp";
+        fs::create_directories(temp_dir);
+
+        // Copy class file to temp directory with proper package structure
+        std::string class_name = fs::path(class_file).filename().string();
+        std::string class_in_jar = class_name; // For simple case, no package
+
+        std::string dest_path = temp_dir + "/" + class_in_jar;
+        // Copy class file to temp directory
+        {
+            std::ifstream in(class_file, std::ios::binary);
+            if (!in)
+            {
+                std::cerr << "Failed to open class file for copying" << std::endl;
+                return 1;
+            }
+            std::ofstream out(dest_path, std::ios::binary);
+            if (!out)
+            {
+                std::cerr << "Failed to create destination file" << std::endl;
+                return 1;
+            }
+            out << in.rdbuf();
+        }
+
+        // Create MANIFEST.MF
+        std::string manifest_path = temp_dir + "/META-INF/MANIFEST.MF";
+        fs::create_directories(temp_dir + "/META-INF");
+
+        std::ofstream manifest(manifest_path);
+        if (!manifest)
+        {
+            std::cerr << "Failed to create manifest file" << std::endl;
+            return 1;
+        }
+
+        manifest << "Manifest-Version: 1.0\n";
+        manifest << "Main-Class: " << main_class << "\n";
+        manifest << "Created-By: zhcl_universal\n";
+        manifest.close();
+
+        // Create JAR using jar command if available, otherwise create ZIP
+        std::string jar_cmd = "jar cfm \"" + jar_file + "\" \"" + manifest_path + "\" -C \"" + temp_dir + "\" .";
+        if (verbose)
+            std::cout << "Creating JAR: " << jar_cmd << std::endl;
+
+        int result = system(jar_cmd.c_str());
+
+        // Cleanup temp directory
+        try
+        {
+            fs::remove_all(temp_dir);
+        }
+        catch (...)
+        {
+            // Ignore cleanup errors
+        }
+
+        if (result == 0 && verbose)
+            std::cout << "Created JAR file: " << jar_file << std::endl;
+
+        return result;
+    }
+};
+
+class ChineseProcessor : public LanguageProcessor
+{
+public:
+    CompilerRegistry *registry;
+
+    bool can_handle(const std::string &ext) override
+    {
+        return ext == ".zh";
+    }
+
+    int compile(const std::string &input, const std::string &output,
+                const std::vector<std::string> &flags, bool verbose) override
+    {
+        // Translate .zh to .cpp using built-in translator
+        std::string cpp_file = output.empty() ? input.substr(0, input.find_last_of('.')) + ".cpp" : output.substr(0, output.find_last_of('.')) + ".cpp";
+
+        if (translate_zh_to_cpp(input, cpp_file, verbose) != 0)
+        {
+            return 1;
+        }
+
+        // Then compile the generated C++ file
+        CppProcessor cpp_processor;
+        cpp_processor.registry = registry;
+        std::string exe_output = output.empty() ? input.substr(0, input.find_last_of('.')) + ".exe" : output;
+
+        return cpp_processor.compile(cpp_file, exe_output, flags, verbose);
+    }
+
+    int run(const std::string &executable, bool verbose) override
+    {
+        // Check if it's a .zh file - if so, execute directly without compilation
+        if (executable.size() > 3 && executable.substr(executable.size() - 3) == ".zh")
+        {
+            return run_zh_file(executable, verbose);
+        }
+
+        // Otherwise, run as normal executable
+        std::string cmd = "\"" + executable + "\"";
+        if (verbose)
+            std::cout << "Running Chinese program: " << cmd << std::endl;
+        return system(cmd.c_str());
+    }
+
+    std::string get_default_output(const std::string &input) override
+    {
+        return input.substr(0, input.find_last_of('.')) + ".exe";
+    }
+
+private:
+    int run_zh_file(const std::string &zh_file, bool verbose)
+    {
+        if (verbose)
+            std::cout << "Running Chinese file directly: " << zh_file << std::endl;
+
+        // Read the .zh file
+        std::ifstream ifs(zh_file, std::ios::binary);
+        if (!ifs)
+        {
+            if (verbose)
+                std::fprintf(stderr, "[zhcl] cannot open %s\n", zh_file.c_str());
+            return 1;
+        }
+        std::string src((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+
+        // Convert .zh to bytecode
+        std::vector<uint8_t> bc;
+        ZhFrontend fe;
+        try
+        {
+            bc = fe.translate_to_bc(src);
+        }
+        catch (const std::exception &e)
+        {
+            std::fprintf(stderr, "[zhcl] zh->bc failed: %s\n", e.what());
+            return 2;
+        }
+
+        // Execute bytecode directly
+        return selfhost::execute_bc(bc);
+    }
+};
+
+class PythonProcessor : public LanguageProcessor
+{
+public:
+    CompilerRegistry *registry;
+
+    bool can_handle(const std::string &ext) override { return ext == ".py"; }
+
+    int compile(const std::string &input, const std::string &output,
+                const std::vector<std::string> &flags, bool verbose) override
+    {
+        // Translate .py to .cpp using built-in translator
+        std::string cpp_file = output.empty() ? input.substr(0, input.find_last_of('.')) + ".cpp" : output.substr(0, output.find_last_of('.')) + ".cpp";
+
+        if (translate_py_to_cpp(input, cpp_file, verbose) != 0)
+        {
+            return 1;
+        }
+
+        // Then compile the generated C++ file
+        CppProcessor cpp_processor;
+        cpp_processor.registry = registry;
+        std::string exe_output = output.empty() ? input.substr(0, input.find_last_of('.')) + ".exe" : output;
+
+        return cpp_processor.compile(cpp_file, exe_output, flags, verbose);
+    }
+
+    int run(const std::string &executable, bool verbose) override
+    {
+        std::string cmd = "\"" + executable + "\"";
+        if (verbose)
+            std::cout << "Running Python program: " << cmd << std::endl;
+        return system(cmd.c_str());
+    }
+
+    std::string get_default_output(const std::string &input) override
+    {
+        return input.substr(0, input.find_last_of('.')) + ".exe";
+    }
+
+private:
+    int translate_py_to_cpp(const std::string &py_file, const std::string &cpp_file, bool verbose)
+    {
+        std::ifstream in(py_file);
+        std::ofstream out(cpp_file);
+        std::string line;
+
+        out << "#include <iostream>\n";
+        out << "#include <string>\n";
+        out << "#include <vector>\n\n";
+
+        std::string main_code;
+
+        while (std::getline(in, line))
+        {
+            line = trim(line);
+
+            // Skip empty lines and comments
+            if (line.empty() || line.substr(0, 1) == "#")
+            {
+                continue;
+            }
+
+            // Basic Python to C++ translation (very simplified)
+            if (line.find("print(") != std::string::npos)
+            {
+                // print("hello") -> std::cout << "hello" << std::endl;
+                size_t start = line.find('"');
+                size_t end = line.find('"', start + 1);
+                if (start != std::string::npos && end != std::string::npos)
+                {
+                    std::string content = line.substr(start, end - start + 1);
+                    main_code += "    std::cout << " + content + " << std::endl;\n";
+                }
+            }
+            else if (line.find("=") != std::string::npos && line.find("int(") == std::string::npos)
+            {
+                // x = 5 -> int x = 5;
+                size_t eq_pos = line.find('=');
+                std::string var = trim(line.substr(0, eq_pos));
+                std::string value = trim(line.substr(eq_pos + 1));
+                main_code += "    int " + var + " = " + value + ";\n";
+            }
+            else
+            {
+                // Other lines, pass through with comment
+                main_code += "    // " + line + "\n";
+            }
+        }
+
+        out << "int main() {\n";
+        out << main_code;
+        out << "    return 0;\n";
+        out << "}\n";
+
+        in.close();
+        out.close();
+
+        if (verbose)
+            std::cout << "Translated " + py_file + " to " + cpp_file << std::endl;
+        return 0;
+    }
+
+    std::string trim(const std::string &str)
+    {
+        size_t first = str.find_first_not_of(" \t");
+        if (first == std::string::npos)
+            return "";
+        size_t last = str.find_last_not_of(" \t");
+        return str.substr(first, last - first + 1);
+    }
+};
+
+class GoProcessor : public LanguageProcessor
+{
+public:
+    CompilerRegistry *registry;
+
+    bool can_handle(const std::string &ext) override { return ext == ".go"; }
+
+    int compile(const std::string &input, const std::string &output,
+                const std::vector<std::string> &flags, bool verbose) override
+    {
+        // Translate .go to .cpp using built-in translator
+        std::string cpp_file = output.empty() ? input.substr(0, input.find_last_of('.')) + ".cpp" : output.substr(0, output.find_last_of('.')) + ".cpp";
+
+        if (translate_go_to_cpp(input, cpp_file, verbose) != 0)
+        {
+            return 1;
+        }
+
+        // Then compile the generated C++ file
+        CppProcessor cpp_processor;
+        cpp_processor.registry = registry;
+        std::string exe_output = output.empty() ? input.substr(0, input.find_last_of('.')) + ".exe" : output;
+
+        return cpp_processor.compile(cpp_file, exe_output, flags, verbose);
+    }
+
+    int run(const std::string &executable, bool verbose) override
+    {
+        std::string cmd = "\"" + executable + "\"";
+        if (verbose)
+            std::cout << "Running Go program: " << cmd << std::endl;
+        return system(cmd.c_str());
+    }
+
+    std::string get_default_output(const std::string &input) override
+    {
+        return input.substr(0, input.find_last_of('.')) + ".exe";
+    }
+
+private:
+    int translate_go_to_cpp(const std::string &go_file, const std::string &cpp_file, bool verbose)
+    {
+        std::ifstream in(go_file);
+        std::ofstream out(cpp_file);
+        std::string line;
+
+        out << "#include <iostream>\n";
+        out << "#include <string>\n";
+        out << "#include <vector>\n\n";
+
+        std::string main_code;
+        std::vector<std::string> functions;
+
+        while (std::getline(in, line))
+        {
+            line = trim(line);
+
+            // Skip empty lines and comments
+            if (line.empty() || line.substr(0, 2) == "//")
+            {
+                continue;
+            }
+
+            // Basic Go to C++ translation (very simplified)
+            if (line.find("fmt.Println(") != std::string::npos)
+            {
+                // fmt.Println("hello") -> std::cout << "hello" << std::endl;
+                size_t start = line.find('"');
+                size_t end = line.find('"', start + 1);
+                if (start != std::string::npos && end != std::string::npos)
+                {
+                    std::string content = line.substr(start, end - start + 1);
+                    main_code += "    std::cout << " + content + " << std::endl;\n";
+                }
+            }
+            else if (line.find("func ") != std::string::npos)
+            {
+                // Function declarations
+                functions.push_back(translate_function_declaration(line));
+                continue;
+            }
+
+            // Main code
+            main_code += translate_go_statement(line) + "\n";
+        }
+
+        // Write functions
+        for (const auto &func : functions)
+        {
+            out << func << "\n";
+        }
+
+        // Write main function
+        out << "int main() {\n";
+        out << main_code;
+        out << "    return 0;\n";
+        out << "}\n";
+
+        in.close();
+        out.close();
+
+        if (verbose)
+            std::cout << "Translated " << go_file << " to " << cpp_file << std::endl;
+        return 0;
+    }
+
+    std::string translate_function_declaration(const std::string &line)
+    {
+        // func main() -> void main()
+        // func add(a int, b int) int -> int add(int a, int b)
+        std::string result = line;
+        result = replace_all(result, "func ", "");
+        // Simple replacement - expand for full Go syntax
+        result = replace_all(result, "int", "int");
+        result = replace_all(result, "string", "std::string");
+        result = replace_all(result, "bool", "bool");
+        // Assume return type at end
+        size_t last_space = result.find_last_of(' ');
+        if (last_space != std::string::npos)
+        {
+            std::string return_type = result.substr(last_space + 1);
+            std::string func_sig = result.substr(0, last_space);
+            result = return_type + " " + func_sig;
+        }
+        return result + " {";
+    }
+
+    std::string translate_go_statement(const std::string &line)
+    {
+        std::string result = line;
+
+        // Variable declarations: var x int = 5 -> int x = 5;
+        if (result.substr(0, 4) == "var ")
+        {
+            result = result.substr(4);
+            // Assume format: name type = value
+            // Simple: replace with C++ style
+        }
+
+        // Print statements: fmt.Println("hello") -> std::cout << "hello" << std::endl;
+        if (result.find("fmt.Println") != std::string::npos)
+        {
+            size_t start = result.find('"');
+            size_t end = result.find('"', start + 1);
+            if (start != std::string::npos && end != std::string::npos)
+            {
+                std::string content = result.substr(start, end - start + 1);
+                result = "    std::cout << " + content + " << std::endl;";
+            }
+        }
+
+        // Basic replacements
+        result = replace_all(result, ":=", "="); // Short variable declaration
+
+        return result;
+    }
+
+    std::string trim(const std::string &str)
+    {
+        size_t first = str.find_first_not_of(" \t");
+        if (first == std::string::npos)
+            return "";
+        size_t last = str.find_last_not_of(" \t");
+        return str.substr(first, last - first + 1);
+    }
+
+    std::string replace_all(std::string str, const std::string &from, const std::string &to)
+    {
+        size_t start_pos = 0;
+        while ((start_pos = str.find(from, start_pos)) != std::string::npos)
+        {
+            str.replace(start_pos, from.length(), to);
+            start_pos += to.length();
+        }
+        return str;
+    }
+};
+
+class RustProcessor : public LanguageProcessor
+{
+public:
+    bool can_handle(const std::string &ext) override { return ext == ".rs"; }
+    int compile(const std::string &input, const std::string &output, const std::vector<std::string> &flags, bool verbose) override
+    {
+        std::string cmd = "rustc";
+        for (const auto &flag : flags)
+            cmd += " " + flag;
+        cmd += " \"" + input + "\"";
+        if (!output.empty())
+            cmd += " -o \"" + output + "\"";
+        if (verbose)
+            std::cout << "Compiling Rust: " << cmd << std::endl;
+        return system(cmd.c_str());
+    }
+    int run(const std::string &executable, bool verbose) override
+    {
+        std::string cmd = "\"" + executable + "\"";
+        if (verbose)
+            std::cout << "Running Rust: " << cmd << std::endl;
+        return system(cmd.c_str());
+    }
+    std::string get_default_output(const std::string &input) override
+    {
+        return input.substr(0, input.find_last_of('.')) + ".exe";
+    }
+};
+
+class JSProcessor : public LanguageProcessor
+{
+public:
+    CompilerRegistry *registry;
+
+    bool can_handle(const std::string &ext) override { return ext == ".js"; }
+
+    int compile(const std::string &input, const std::string &output,
+                const std::vector<std::string> &flags, bool verbose) override
+    {
+        // Translate .js to .cpp using built-in translator
+        std::string cpp_file = output.empty() ? input.substr(0, input.find_last_of('.')) + ".cpp" : output.substr(0, output.find_last_of('.')) + ".cpp";
+
+        if (translate_js_to_cpp(input, cpp_file, verbose) != 0)
+        {
+            return 1;
+        }
+
+        // Then compile the generated C++ file
+        CppProcessor cpp_processor;
+        cpp_processor.registry = registry;
+        return cpp_processor.compile(cpp_file, output, flags, verbose);
+    }
+
+    int run(const std::string &executable, bool verbose) override
+    {
+        std::string cmd = "node \"" + executable + "\"";
+        if (verbose)
+            std::cout << "Running JavaScript: " << cmd << std::endl;
+        return system(cmd.c_str());
+    }
+
+    std::string get_default_output(const std::string &input) override { return input; }
+
+private:
+    int translate_js_to_cpp(const std::string &js_file, const std::string &cpp_file, bool verbose)
+    {
+        std::ifstream in(js_file);
+        std::ofstream out(cpp_file);
+        std::string line;
+
+        out << "#include <iostream>\n";
+        out << "#include <string>\n";
+        out << "#include <vector>\n\n";
+
+        std::string main_code;
+
+        while (std::getline(in, line))
+        {
+            line = trim(line);
+
+            // Skip empty lines and comments
+            if (line.empty() || line.substr(0, 2) == "//")
+            {
+                continue;
+            }
+
+            // Basic JavaScript to C++ translation (very simplified)
+            if (line.find("console.log(") != std::string::npos)
+            {
+                // console.log("hello") -> std::cout << "hello" << std::endl;
+                size_t start = line.find('"');
+                size_t end = line.find('"', start + 1);
+                if (start != std::string::npos && end != std::string::npos)
+                {
+                    std::string content = line.substr(start, end - start + 1);
+                    main_code += "    std::cout << " + content + " << std::endl;\n";
+                }
+            }
+            else if (line.find("let ") != std::string::npos || line.find("const ") != std::string::npos || line.find("var ") != std::string::npos)
+            {
+                // let x = 5 -> int x = 5;
+                size_t eq_pos = line.find('=');
+                if (eq_pos != std::string::npos)
+                {
+                    std::string var_part = trim(line.substr(0, eq_pos));
+                    std::string value = trim(line.substr(eq_pos + 1));
+                    // Remove semicolon if present
+                    if (!value.empty() && value.back() == ';')
+                        value.pop_back();
+
+                    // Extract variable name (after let/const/var and space)
+                    size_t space_pos = var_part.find(' ');
+                    if (space_pos != std::string::npos)
+                    {
+                        std::string var_name = trim(var_part.substr(space_pos + 1));
+                        main_code += "    int " + var_name + " = " + value + ";\n";
+                    }
+                }
+            }
+            else
+            {
+                // Other lines, pass through with comment
+                main_code += "    // " + line + "\n";
+            }
+        }
+
+        out << "int main() {\n";
+        out << main_code;
+        out << "    return 0;\n";
+        out << "}\n";
+
+        in.close();
+        out.close();
+
+        if (verbose)
+            std::cout << "Translated " + js_file + " to " + cpp_file << std::endl;
+        return 0;
+    }
+
+    std::string trim(const std::string &str)
+    {
+        size_t first = str.find_first_not_of(" \t");
+        if (first == std::string::npos)
+            return "";
+        size_t last = str.find_last_not_of(" \t");
+        return str.substr(first, last - first + 1);
+    }
+};
+
+// ============================================================================
+// COMPILER COMPATIBILITY LAYER - Maintains traditional compiler habits
+// ============================================================================
+
+class CompilerCompatibilityLayer
+{
+public:
+    CompilerRegistry *registry;
+
+    // Parse traditional compiler arguments and translate to zhcl format
+    int handle_traditional_args(int argc, char **argv)
+    {
+        if (argc < 2)
+            return -1; // Not a traditional compiler call
+
+        std::string compiler_name = argv[0];
+        std::string basename = fs::path(compiler_name).filename().string();
+
+        // map common compiler names to our system
+        if (basename == "cl" || basename == "cl.exe")
+        {
+            return handle_msvc_args(argc, argv);
+        }
+        else if (basename == "gcc" || basename == "g++" || basename == "cc" || basename == "c++")
+        {
+            return handle_gcc_args(argc, argv);
+        }
+        else if (basename == "javac" || basename == "javac.exe")
+        {
+            return handle_javac_args(argc, argv);
+        }
+        else if (basename == "rustc" || basename == "rustc.exe")
+        {
+            return handle_rustc_args(argc, argv);
+        }
+        else if (basename == "go" || basename == "go.exe")
+        {
+            return handle_go_args(argc, argv);
+        }
+        else if (basename == "python" || basename == "python.exe" || basename == "python3")
+        {
+            return handle_python_args(argc, argv);
+        }
+
+        return -1; // Not recognized
+    }
+
+private:
+    // MSVC-style arguments: cl [options] file.cpp
+    int handle_msvc_args(int argc, char **argv)
+    {
+        std::vector<std::string> files;
+        std::string output;
+        std::vector<std::string> includes;
+        std::vector<std::string> defines;
+        std::vector<std::string> flags;
+        bool compile_only = false;
+        bool verbose = false;
+
+        for (int i = 1; i < argc; ++i)
+        {
+            std::string arg = argv[i];
+
+            if (arg == "/c")
+            {
+                compile_only = true;
+            }
+            else if (arg == "/Fe" && i + 1 < argc)
+            {
+                output = argv[++i];
+            }
+            else if (arg.substr(0, 2) == "/I")
+            {
+                includes.push_back(arg.substr(2));
+            }
+            else if (arg.substr(0, 2) == "/D")
+            {
+                defines.push_back(arg.substr(2));
+            }
+            else if (arg == "/nologo")
+            {
+                // Silent mode
+            }
+            else if (arg == "/utf-8")
+            {
+                flags.push_back("-utf-8");
+            }
+            else if (arg == "/EHsc")
+            {
+                flags.push_back("-EHsc");
+            }
+            else if (arg == "/std:c++17")
+            {
+                flags.push_back("-std=c++17");
+            }
+            else if (arg.substr(0, 1) != "/")
+            {
+                // Assume it's a file
+                files.push_back(arg);
+            }
+        }
+
+        if (files.empty())
+        {
+            std::cerr << "cl: no input files" << std::endl;
+            return 1;
+        }
+
+        // Compile each file
+        for (const auto &file : files)
+        {
+            std::string ext = fs::path(file).extension().string();
+            if (ext != ".cpp" && ext != ".c" && ext != ".cc")
+            {
+                std::cerr << "cl: unsupported file type: " << file << std::endl;
+                continue;
+            }
+
+            std::string actual_output = output;
+            if (actual_output.empty())
+            {
+                if (compile_only)
+                {
+                    actual_output = file.substr(0, file.find_last_of('.')) + ".obj";
+                }
+                else
+                {
+                    actual_output = file.substr(0, file.find_last_of('.')) + ".exe";
+                }
+            }
+
+            // Add include paths
+            for (const auto &inc : includes)
+            {
+                flags.push_back("-I" + inc);
+            }
+
+            // Add defines
+            for (const auto &def : defines)
+            {
+                flags.push_back("-D" + def);
+            }
+
+            CppProcessor processor;
+            processor.registry = registry;
+            int ret = processor.compile(file, actual_output, flags, verbose);
+
+            if (ret != 0)
+            {
+                return ret;
+            }
+        }
+
+        return 0;
+    }
+
+    // GCC-style arguments: gcc [options] file.c -o output
+    int handle_gcc_args(int argc, char **argv)
+    {
+        std::vector<std::string> files;
+        std::string output;
+        std::vector<std::string> includes;
+        std::vector<std::string> defines;
+        std::vector<std::string> flags;
+        bool compile_only = false;
+        bool verbose = false;
+
+        for (int i = 1; i < argc; ++i)
+        {
+            std::string arg = argv[i];
+
+            if (arg == "-c")
+            {
+                compile_only = true;
+            }
+            else if (arg == "-o" && i + 1 < argc)
+            {
+                output = argv[++i];
+            }
+            else if (arg.substr(0, 2) == "-I")
+            {
+                includes.push_back(arg.substr(2));
+            }
+            else if (arg.substr(0, 2) == "-D")
+            {
+                defines.push_back(arg.substr(2));
+            }
+            else if (arg == "-Wall" || arg == "-Wextra" || arg == "-g" || arg == "-O2")
+            {
+                flags.push_back(arg);
+            }
+            else if (arg.substr(0, 5) == "-std=")
+            {
+                flags.push_back(arg);
+            }
+            else if (arg.substr(0, 1) != "-")
+            {
+                // Assume it's a file
+                files.push_back(arg);
+            }
+        }
+
+        if (files.empty())
+        {
+            std::cerr << "gcc: no input files" << std::endl;
+            return 1;
+        }
+
+        // Compile each file
+        for (size_t idx = 0; idx < files.size(); ++idx)
+        {
+            const auto &file = files[idx];
+            std::string ext = fs::path(file).extension().string();
+
+            std::string actual_output;
+            if (output.empty())
+            {
+                if (compile_only)
+                {
+                    actual_output = file.substr(0, file.find_last_of('.')) + ".o";
+                }
+                else if (files.size() == 1)
+                {
+                    actual_output = "a.out";
+                }
+                else
+                {
+                    actual_output = file.substr(0, file.find_last_of('.')) + ".o";
+                }
+            }
+            else
+            {
+                if (files.size() > 1)
+                {
+                    // Multiple files with single output = link them
+                    if (idx == files.size() - 1)
+                    {
+                        // Last file, do the linking
+                        actual_output = output;
+                    }
+                    else
+                    {
+                        continue; // Skip intermediate files
+                    }
+                }
+                else
+                {
+                    actual_output = output;
+                }
+            }
+
+            // Add include paths
+            for (const auto &inc : includes)
+            {
+                flags.push_back("-I" + inc);
+            }
+
+            // Add defines
+            for (const auto &def : defines)
+            {
+                flags.push_back("-D" + def);
+            }
+
+            CppProcessor processor;
+            processor.registry = registry;
+            int ret = processor.compile(file, actual_output, flags, verbose);
+
+            if (ret != 0)
+            {
+                return ret;
+            }
+        }
+
+        return 0;
+    }
+
+    // JavaC-style arguments: javac [options] file.java
+    int handle_javac_args(int argc, char **argv)
+    {
+        std::vector<std::string> files;
+        std::string classpath;
+        std::string output_dir = ".";
+        std::vector<std::string> flags;
+
+        for (int i = 1; i < argc; ++i)
+        {
+            std::string arg = argv[i];
+
+            if (arg == "-cp" || arg == "-classpath")
+            {
+                if (i + 1 < argc)
+                {
+                    classpath = argv[++i];
+                }
+            }
+            else if (arg == "-d" && i + 1 < argc)
+            {
+                output_dir = argv[++i];
+            }
+            else if (arg.substr(0, 1) != "-")
+            {
+                files.push_back(arg);
+            }
+            else
+            {
+                flags.push_back(arg);
+            }
+        }
+
+        if (files.empty())
+        {
+            std::cerr << "javac: no input files" << std::endl;
+            return 1;
+        }
+
+        for (const auto &file : files)
+        {
+            std::string ext = fs::path(file).extension().string();
+            if (ext != ".java")
+            {
+                std::cerr << "javac: not a Java file: " << file << std::endl;
+                continue;
+            }
+
+            std::string output = output_dir + "/" + file.substr(0, file.find_last_of('.')) + ".class";
+
+            JavaProcessor processor;
+            processor.registry = registry;
+            int ret = processor.compile(file, output, flags, false);
+
+            if (ret != 0)
+            {
+                return ret;
+            }
+        }
+
+        return 0;
+    }
+
+    // RustC-style arguments: rustc [options] file.rs
+    int handle_rustc_args(int argc, char **argv)
+    {
+        std::vector<std::string> files;
+        std::string output;
+        std::string out_dir = ".";
+        std::vector<std::string> flags;
+        bool verbose = false;
+
+        for (int i = 1; i < argc; ++i)
+        {
+            std::string arg = argv[i];
+
+            if (arg == "-o" && i + 1 < argc)
+            {
+                output = argv[++i];
+            }
+            else if (arg == "--out-dir" && i + 1 < argc)
+            {
+                out_dir = argv[++i];
+            }
+            else if (arg == "-O" || arg == "-g")
+            {
+                flags.push_back(arg);
+            }
+            else if (arg.substr(0, 1) != "-")
+            {
+                files.push_back(arg);
+            }
+        }
+
+        if (files.empty())
+        {
+            std::cerr << "rustc: no input files" << std::endl;
+            return 1;
+        }
+
+        for (const auto &file : files)
+        {
+            std::string ext = fs::path(file).extension().string();
+            if (ext != ".rs")
+            {
+                std::cerr << "rustc: not a Rust file: " << file << std::endl;
+                continue;
+            }
+
+            std::string actual_output = output.empty() ? out_dir + "/" + file.substr(0, file.find_last_of('.')) + ".exe" : output;
+
+            RustProcessor processor;
+            int ret = processor.compile(file, actual_output, flags, verbose);
+
+            if (ret != 0)
+            {
+                return ret;
+            }
+        }
+
+        return 0;
+    }
+
+    // Go-style arguments: go build/run [options] file.go
+    int handle_go_args(int argc, char **argv)
+    {
+        if (argc < 2)
+            return -1;
+
+        std::string subcommand = argv[1];
+        std::vector<std::string> files;
+        std::string output;
+        std::vector<std::string> flags;
+
+        for (int i = 2; i < argc; ++i)
+        {
+            std::string arg = argv[i];
+
+            if (arg == "-o" && i + 1 < argc)
+            {
+                output = argv[++i];
+            }
+            else if (arg.substr(0, 1) == "-")
+            {
+                flags.push_back(arg);
+            }
+            else
+            {
+                files.push_back(arg);
+            }
+        }
+
+        if (files.empty())
+        {
+            std::cerr << "go: no input files" << std::endl;
+            return 1;
+        }
+
+        for (const auto &file : files)
+        {
+            std::string ext = fs::path(file).extension().string();
+            if (ext != ".go")
+            {
+                std::cerr << "go: not a Go file: " << file << std::endl;
+                continue;
+            }
+
+            std::string actual_output = output.empty() ? file.substr(0, file.find_last_of('.')) + ".exe" : output;
+
+            GoProcessor processor;
+            int ret;
+
+            if (subcommand == "run")
+            {
+                ret = processor.compile(file, actual_output, flags, false);
+                if (ret == 0)
+                {
+                    ret = processor.run(actual_output, false);
+                }
+            }
+            else
+            { // build or default
+                ret = processor.compile(file, actual_output, flags, false);
+            }
+
+            if (ret != 0)
+            {
+                return ret;
+            }
+        }
+
+        return 0;
+    }
+
+    // Python-style arguments: python [options] file.py
+    int handle_python_args(int argc, char **argv)
+    {
+        std::vector<std::string> args;
+
+        for (int i = 1; i < argc; ++i)
+        {
+            args.push_back(argv[i]);
+        }
+
+        if (args.empty())
+        {
+            // Start Python REPL
+            return system("python");
+        }
+
+        std::string file = args.back();
+        std::string ext = fs::path(file).extension().string();
+
+        if (ext != ".py")
+        {
+            // Not a Python file, pass through to python
+            std::string cmd = "python";
+            for (const auto &arg : args)
+            {
+                cmd += " \"" + arg + "\"";
+            }
+            return system(cmd.c_str());
+        }
+
+        PythonProcessor processor;
+        return processor.run(file, false);
+    }
+};
+
+// ============================================================================
+// BUILD SYSTEM - Replaces CMake, Make, etc.
+// ============================================================================
+
+class BuildSystem
+{
+public:
+    CompilerRegistry *registry;
+    std::map<std::string, std::unique_ptr<LanguageProcessor>> processors;
+
+    BuildSystem(CompilerRegistry *reg) : registry(reg)
+    {
+        // Register processors
+        processors["cpp"] = std::make_unique<CppProcessor>();
+        auto *cpp_processor = static_cast<CppProcessor *>(processors["cpp"].get());
+        cpp_processor->registry = registry;
+
+        processors["java"] = std::make_unique<JavaProcessor>();
+        auto *java_processor = static_cast<JavaProcessor *>(processors["java"].get());
+        java_processor->registry = registry;
+
+        processors["python"] = std::make_unique<PythonProcessor>();
+        auto *python_processor = static_cast<PythonProcessor *>(processors["python"].get());
+        python_processor->registry = registry;
+
+        processors["javascript"] = std::make_unique<JSProcessor>();
+        auto *js_processor = static_cast<JSProcessor *>(processors["javascript"].get());
+        js_processor->registry = registry;
+        processors["go"] = std::make_unique<GoProcessor>();
+        auto *go_processor = static_cast<GoProcessor *>(processors["go"].get());
+        go_processor->registry = registry;
+        processors["rust"] = std::make_unique<RustProcessor>();
+
+        processors["chinese"] = std::make_unique<ChineseProcessor>();
+        auto *chinese_processor = static_cast<ChineseProcessor *>(processors["chinese"].get());
+        chinese_processor->registry = registry;
+    }
+
+    int build_project(const std::string &project_dir, bool verbose)
+    {
+        if (verbose)
+            std::cout << "Building project in: " << project_dir << std::endl;
+
+        // Find all source files
+        std::vector<std::string> source_files;
+        for (const auto &entry : fs::recursive_directory_iterator(project_dir))
+        {
+            if (fs::is_regular_file(entry.path()))
+            {
+                std::string ext = entry.path().extension().string();
+                if (is_supported_extension(ext))
+                {
+                    source_files.push_back(entry.path().string());
+                }
+            }
+        }
+
+        if (source_files.empty())
+        {
+            std::cerr << "No supported source files found" << std::endl;
+            return 1;
+        }
+
+        // Group by language
+        std::map<std::string, std::vector<std::string>> files_by_lang;
+        for (const auto &file : source_files)
+        {
+            std::string ext = fs::path(file).extension().string();
+            files_by_lang[ext].push_back(file);
+        }
+
+        // Compile each group
+        std::vector<std::string> outputs;
+        for (const auto &[ext, files] : files_by_lang)
+        {
+            for (const auto &file : files)
+            {
+                std::string output = get_processor_by_ext(ext)->get_default_output(file);
+                if (get_processor_by_ext(ext)->compile(file, output, {}, verbose) == 0)
+                {
+                    outputs.push_back(output);
+                    if (verbose)
+                        std::cout << "Compiled: " << file << " -> " << output << std::endl;
+                }
+                else
+                {
+                    std::cerr << "Failed to compile: " << file << std::endl;
+                    return 1;
+                }
+            }
+        }
+
+        if (verbose)
+            std::cout << "Build completed successfully!" << std::endl;
+        return 0;
+    }
+
+    int compile_file(const std::string &input, const std::string &output, bool verbose, bool run_after)
+    {
+        std::string ext = fs::path(input).extension().string();
+        auto processor = get_processor_by_ext(ext);
+        if (!processor)
+        {
+            std::cerr << "Unsupported file type: " << ext << std::endl;
+            return 1;
+        }
+
+        std::string actual_output = output.empty() ? processor->get_default_output(input) : output;
+
+        int ret = processor->compile(input, actual_output, {}, verbose);
+        if (ret == 0 && run_after)
+        {
+            return processor->run(actual_output, verbose);
+        }
+        return ret;
+    }
+
+private:
+    LanguageProcessor *get_processor_by_ext(const std::string &ext)
+    {
+        for (auto &[name, processor] : processors)
+        {
+            if (processor->can_handle(ext))
+            {
+                return processor.get();
+            }
+        }
+        return nullptr;
+    }
+
+    bool is_supported_extension(const std::string &ext)
+    {
+        return get_processor_by_ext(ext) != nullptr;
+    }
+
+private:
+    std::string get_language_from_extension(const std::string &ext)
+    {
+        if (ext == ".cpp" || ext == ".c" || ext == ".cc" || ext == ".cxx")
+            return "cpp";
+        if (ext == ".java")
+            return "java";
+        if (ext == ".py")
+            return "python";
+        if (ext == ".js")
+            return "javascript";
+        if (ext == ".go")
+            return "go";
+        if (ext == ".rs")
+            return "rust";
+        if (ext == ".zh")
+            return "chinese";
+        return "unknown";
+    }
+
+    std::string get_output_path(const std::string &input, const std::string &lang)
+    {
+        std::string base = input.substr(0, input.find_last_of('.'));
+        if (lang == "cpp")
+            return base + ".exe";
+        if (lang == "java")
+            return base + ".class";
+        if (lang == "python")
+            return input;
+        if (lang == "javascript")
+            return base + ".exe";
+        if (lang == "go")
+            return base + ".exe";
+        if (lang == "rust")
+            return base + ".exe";
+        if (lang == "chinese")
+            return base + ".exe";
+        return base + ".out";
+    }
+
+    std::vector<std::string> get_default_flags(const std::string &lang)
+    {
+        if (lang == "cpp")
+            return {"-Wall", "-std=c++17"};
+        if (lang == "java")
+            return {};
+        if (lang == "python")
+            return {};
+        if (lang == "go")
+            return {};
+        if (lang == "rust")
+            return {};
+        if (lang == "chinese")
+            return {};
+        return {};
+    }
+};
+
+// ============================================================================
+// MAIN APPLICATION
+// ============================================================================
+
+// ---- NEW: Frontend-based commands (Self-Host Universal Runner)
+static bool read_file(const std::string &p, std::string &out)
+{
+    std::ifstream f(p, std::ios::binary);
+    if (!f)
+        return false;
+    out.assign((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+    return true;
+}
+
+int cmd_list_frontends()
+{
+    for (auto &fe : FrontendRegistry::instance().all())
+        std::cout << "- " << fe->name() << "\n";
+    return 0;
+}
+
+// 讀檔 + 選前端 + 編譯（run / run-batch 共用）；失敗時回傳 1 讀檔、2 無前端、3 編譯錯誤，err 為訊息
+// use_cache：以原始碼內容查位元碼快取（zh_cache.h），命中時略過正規化、前端比對與編譯
+static int compile_source(const std::string &path, const std::string &forced, Bytecode &bc,
+                          const IFrontend *&fe, std::string &err, bool use_cache = false)
+{
+    std::string src;
+    if (!read_file(path, src))
+    {
+        err = "read fail: " + path;
+        return 1;
+    }
+
+    selfhost::BcCache cache;
+    std::string key;
+    if (use_cache && cache.enabled())
+    {
+        key = selfhost::BcCache::key(src, path, forced);
+        std::string name;
+        if (cache.get(key, src, name, bc.data) && (fe = FrontendRegistry::instance().by_name(name)))
+            return 0;
+        bc.data.clear();
+    }
+    std::string raw = key.empty() ? std::string() : src; // 快取項目記錄正規化前的內容
+
+    // BOM/換行正規化
+    strip_utf8_bom(src);
+    normalize_newlines(src);
+
+    fe = forced.empty() ? FrontendRegistry::instance().match(path, src) : FrontendRegistry::instance().by_name(forced);
+    if (!fe)
+    {
+        err = "no frontend: " + (forced.empty() ? path : forced);
+        return 2;
+    }
+    FrontendContext ctx{path, src, true};
+    if (!fe->compile(ctx, bc, err))
+    {
+        err = "compile err: " + err;
+        return 3;
+    }
+    if (!key.empty())
+        cache.put(key, raw, fe->name(), bc.data);
+    return 0;
+}
+
+// --vm-profile 的報表：表格印到 stderr，json 非空時另寫 JSON
+static void report_vm_profile(const selfhost::VmProfile &prof, const std::string &json)
+{
+    prof.print(stderr);
+    if (!json.empty() && !prof.write_json(json))
+        std::fprintf(stderr, "[vm-profile] cannot write %s\n", json.c_str());
+}
+
+// 逐行報表（需要 BCF_DEBUG 行表）：最熱的幾行印到 stderr；folded 非空時另寫 flamegraph.pl 可讀的 folded stacks，
+// 每行一筆「檔名;外層區塊;…;該行 ticks」，外層區塊依縮排推得
+static void report_vm_lines(const std::vector<uint8_t> &bc, const selfhost::Program &prog,
+                            const selfhost::VmProfile &prof, const std::string &path, const std::string &folded)
+{
+    const size_t TOP = 10;
+    std::string file;
+    std::vector<selfhost::LineProfile> lines;
+    if (!selfhost::profile_lines(bc.data(), bc.size(), prog, prof, file, lines))
+    {
+        std::fprintf(stderr, "[vm-profile] no debug line table, per-line report skipped\n");
+        return;
+    }
+    if (file.empty())
+        file = path;
+
+    // 原始碼各行：第 k 行在 text[k - 1]
+    std::vector<std::string> text;
+    std::string src;
+    if (read_file(path, src))
+    {
+        strip_utf8_bom(src);
+        normalize_newlines(src);
+        std::stringstream ss(src);
+        for (std::string l; std::getline(ss, l);)
+            text.push_back(l);
+    }
+    auto indent_of = [&](uint32_t ln)
+    {
+        size_t k = text[ln - 1].find_first_not_of(" \t");
+        return k == std::string::npos ? SIZE_MAX : k;
+    };
+    auto label = [&](uint32_t ln)
+    {
+        if (ln == 0 || ln > text.size())
+            return ln ? "L" + std::to_string(ln) : std::string("(no line)");
+        std::string t = text[ln - 1];
+        t.erase(0, t.find_first_not_of(" \t"));
+        t.erase(t.find_last_not_of(" \t") + 1);
+        std::replace(t.begin(), t.end(), ';', ','); // ';' 是 folded 格式的分隔符號
+        return "L" + std::to_string(ln) + " " + t;
+    };
+
+    uint64_t total = 0;
+    for (auto &l : lines)
+        total += l.ticks;
+    std::fprintf(stderr, "[vm-profile] hottest lines in %s\n", file.c_str());
+    std::fprintf(stderr, "%14s %16s %7s  %s\n", "count", selfhost::VmProfile::unit(), "%", "line");
+    for (size_t i = 0; i < lines.size() && i < TOP; i++)
+        std::fprintf(stderr, "%14llu %16llu %6.2f%%  %s\n", (unsigned long long)lines[i].count,
+                     (unsigned long long)lines[i].ticks, total ? 100.0 * lines[i].ticks / total : 0.0,
+                     label(lines[i].line).c_str());
+
+    if (folded.empty())
+        return;
+    std::FILE *f = std::fopen(folded.c_str(), "wb");
+    if (!f)
+    {
+        std::fprintf(stderr, "[vm-profile] cannot write %s\n", folded.c_str());
+        return;
+    }
+    std::string root = fs::path(file).filename().string();
+    std::replace(root.begin(), root.end(), ';', ',');
+    for (auto &l : lines)
+    {
+        if (!l.ticks)
+            continue;
+        std::vector<uint32_t> stack{l.line};
+        if (l.line && l.line <= text.size())
+        {
+            // 往上找縮排較淺的行，即所在的區塊標頭
+            size_t ind = indent_of(l.line);
+            for (uint32_t k = l.line - 1; k >= 1 && ind > 0; k--)
+            {
+                size_t ki = indent_of(k);
+                if (ki < ind)
+                {
+                    stack.push_back(k);
+                    ind = ki;
+                }
+            }
+        }
+        std::string row = root;
+        for (size_t i = stack.size(); i-- > 0;)
+            row += ";" + label(stack[i]);
+        std::fprintf(f, "%s %llu\n", row.c_str(), (unsigned long long)l.ticks);
+    }
+    if (std::fclose(f) != 0)
+        std::fprintf(stderr, "[vm-profile] cannot write %s\n", folded.c_str());
+}
+
+// vm_profile：nullptr 不剖析；"" 只印表格；其他為 JSON 輸出路徑。
+// 剖析時另依行表印出最熱的原始碼行，folded 非空時寫出 folded stacks
+int cmd_run(const std::string &path, const std::string &forced, const std::vector<std::string> &extra_args,
+            selfhost::JitMode jit = selfhost::JitMode::Off, const char *vm_profile = nullptr,
+            const std::string &folded = "", bool aot = false, bool use_cache = true)
+{
+    Bytecode bc;
+    std::string err;
+    // .zbc：略過前端，直接使用檔案對映中的位元碼
+    selfhost::ZbcFile zbc;
+    bool is_zbc = selfhost::is_zbc_path(path);
+    if (is_zbc)
+    {
+        if (!zbc.open(path, err))
+        {
+            std::cerr << path << ": " << err << "\n";
+            return 1;
+        }
+        std::cout << "Using frontend: " << zbc.frontend() << " (" << path << ")\n";
+    }
+    else
+    {
+        const IFrontend *fe = nullptr;
+        if (int rc = compile_source(path, forced, bc, fe, err, use_cache))
+        {
+            if (fe)
+                std::cout << "Using frontend: " << fe->name() << "\n";
+            std::cerr << err << "\n";
+            return rc;
+        }
+        std::cout << "Using frontend: " << fe->name() << "\n";
+    }
+
+    // 解析命令列參數並注入 SET_I64
+    std::vector<int64_t> args;
+    bool sep = false;
+    for (auto &a : extra_args)
+    {
+        if (a == "--")
+        {
+            sep = true;
+            continue;
+        }
+        if (!sep)
+            continue;
+        try
+        {
+            args.push_back(std::stoll(a));
+        }
+        catch (...)
+        {
+            std::cerr << "Invalid arg: " << a << "\n";
+            return 4;
+        }
+    }
+
+    if (is_zbc)
+    {
+        if (args.empty() && !aot && !vm_profile)
+            return selfhost::execute_bc(zbc.image(), zbc.image_size(), false, jit);
+        bc.data.assign(zbc.image(), zbc.image() + zbc.image_size()); // 需要改寫或另作他用時才複製
+    }
+
+    // 在程式碼開頭插入 SET_I64（槽位 0, 1, 2, ...）；frame 不足時一併放大
+    if (!args.empty())
+    {
+        selfhost::BcHeader h;
+        if (!selfhost::parse_header(bc.data.data(), bc.data.size(), h) ||
+            (h.enc == selfhost::ENC_LEGACY && args.size() > selfhost::LEGACY_FRAME))
+        {
+            std::cerr << "cannot inject args into bytecode\n";
+            return 4;
+        }
+        std::vector<uint8_t> code;
+        for (size_t i = 0; i < args.size(); ++i)
+            selfhost::bcw::set_i64_enc(code, h.enc, (uint32_t)i, args[i]);
+        size_t prefix = code.size();
+        code.insert(code.end(), bc.data.begin() + h.code, bc.data.end());
+        if (h.enc != selfhost::ENC_LEGACY)
+            selfhost::bcw::refinish(code, bc.data.data(), bc.data.size(), h,
+                                    std::max<uint32_t>(h.frame, (uint32_t)args.size()), prefix);
+        bc.data.swap(code);
+    }
+
+    // 確保 OP_END 在最後
+    if (bc.data.empty() || bc.data.back() != 0x04)
+        bc.data.push_back(0x04);
+
+    // 分層 AOT：快取中已有原生版本就直接呼叫；否則照常執行，同時在背景把 emit_cpp 的輸出編譯進快取
+    if (aot && !vm_profile && jit != selfhost::JitMode::Check)
+    {
+        selfhost::VerifyError verr;
+        if (selfhost::verify_bc(bc.data.data(), bc.data.size(), verr))
+        {
+            std::string key = selfhost::aot_key(bc.data.data(), bc.data.size());
+            selfhost::AotModule mod;
+            if (mod.open(key))
+            {
+                std::cout.flush();
+                return mod.run();
+            }
+            std::unique_ptr<selfhost::AotBuild> build;
+            std::string cpp;
+            if (!selfhost::aot_failed(key) && !(cpp = selfhost::emit_cpp_from_bc(bc.data, selfhost::AOT_ENTRY)).empty())
+                build = std::make_unique<selfhost::AotBuild>(key, std::move(cpp));
+            return selfhost::execute_bc(bc.data, true, jit); // build 解構時等待編譯結束
+        }
+    }
+
+    // ?瑁?嚗?怎?? VM
+    if (!vm_profile)
+        return selfhost::execute_bc(bc.data, false, jit);
+    selfhost::VmProfile prof;
+    selfhost::Vm vm;
+    vm.set_profile(&prof);
+    if (!vm.load(bc.data.data(), bc.data.size()))
+    {
+        std::fprintf(stderr, "[vm] bytecode rejected at offset %zu: %s\n", vm.error().offset, vm.error().message.c_str());
+        return selfhost::VM_REJECTED;
+    }
+    int rc = vm.run();
+    report_vm_profile(prof, vm_profile);
+    report_vm_lines(bc.data, vm.program(), prof, is_zbc ? zbc.source() : path, folded);
+    return rc;
+}
+
+// ---- run-batch：同一行程內以執行緒池編譯並執行多個檔案 ----
+struct BatchResult
+{
+    int rc = 0;
+    std::string status = "ok";
+    std::string frontend;
+    std::string error;
+    std::string output; // 程式輸出（各自擷取）
+    double compile_ms = 0;
+    double run_ms = 0;
+};
+
+// 前端的除錯訊息寫在 std::cout；批次執行期間暫時丟棄，報表改用 stdio 輸出
+class NullStreamBuf : public std::streambuf
+{
+protected:
+    int overflow(int c) override { return traits_type::not_eof(c); }
+    std::streamsize xsputn(const char *, std::streamsize n) override { return n; }
+};
+
+// manifest：每行一個路徑，空行與 # 開頭的行略過
+static bool read_manifest(const std::string &path, std::vector<std::string> &files)
+{
+    std::string text;
+    if (!read_file(path, text))
+        return false;
+    normalize_newlines(text);
+    std::stringstream ss(text);
+    std::string line;
+    while (std::getline(ss, line))
+    {
+        size_t b = line.find_first_not_of(" \t");
+        if (b == std::string::npos || line[b] == '#')
+            continue;
+        size_t e = line.find_last_not_of(" \t");
+        files.push_back(line.substr(b, e - b + 1));
+    }
+    return true;
+}
+
+int cmd_run_batch(const std::vector<std::string> &files, const std::string &forced, selfhost::JitMode jit,
+                  unsigned jobs, const std::string &out_dir, bool show_output, const char *vm_profile = nullptr,
+                  bool use_cache = true)
+{
+    using clock = std::chrono::steady_clock;
+    auto ms_since = [](clock::time_point t0)
+    { return std::chrono::duration<double, std::milli>(clock::now() - t0).count(); };
+
+    if (jobs == 0)
+        jobs = std::max(1u, std::thread::hardware_concurrency());
+    jobs = (unsigned)std::min<size_t>(jobs, std::max<size_t>(files.size(), 1));
+    if (!out_dir.empty())
+    {
+        std::error_code ec;
+        fs::create_directories(out_dir, ec);
+    }
+
+    std::vector<BatchResult> results(files.size());
+    std::vector<selfhost::VmProfile> profiles(vm_profile ? jobs : 0); // 每個 worker 一份，結束後合併
+    std::atomic<size_t> next{0};
+    auto worker = [&](unsigned w)
+    {
+        // 每個 worker 一組 VM 狀態與擷取緩衝，跨檔案重複使用
+        std::string captured;
+        selfhost::OutputSink out(&captured);
+        selfhost::Vm vm(&out);
+        vm.set_jit(jit);
+        if (vm_profile)
+            vm.set_profile(&profiles[w]);
+        for (size_t k; (k = next.fetch_add(1)) < files.size();)
+        {
+            BatchResult &r = results[k];
+            auto t0 = clock::now();
+            Bytecode bc;
+            const IFrontend *fe = nullptr;
+            r.rc = compile_source(files[k], forced, bc, fe, r.error, use_cache);
+            if (fe)
+                r.frontend = fe->name();
+            r.compile_ms = ms_since(t0);
+            if (r.rc)
+            {
+                r.status = r.rc == 1 ? "read-error" : r.rc == 2 ? "no-frontend" : "compile-error";
+                continue;
+            }
+            if (bc.data.empty() || bc.data.back() != 0x04)
+                bc.data.push_back(0x04);
+            t0 = clock::now();
+            if (!vm.load(std::move(bc.data)))
+            {
+                r.rc = selfhost::VM_REJECTED;
+                r.status = "rejected";
+                r.error = "bytecode rejected at offset " + std::to_string(vm.error().offset) + ": " + vm.error().message;
+            }
+            else
+            {
+                r.rc = vm.run();
+                if (r.rc == selfhost::VM_JIT_MISMATCH)
+                    r.status = "jit-mismatch";
+                else if (r.rc == selfhost::VM_STACK_OVERFLOW)
+                    r.status = "stack-overflow";
+                else if (r.rc == selfhost::VM_TASK_FAULT)
+                    r.status = "task-fault";
+                else if (r.rc == selfhost::VM_GO_PANIC)
+                    r.status = "go-panic";
+            }
+            r.run_ms = ms_since(t0);
+            out.flush();
+            r.output.swap(captured);
+            captured.clear();
+        }
+    };
+
+    NullStreamBuf null_buf;
+    std::cout.flush();
+    std::streambuf *saved = std::cout.rdbuf(&null_buf);
+    auto t_all = clock::now();
+    {
+        std::vector<std::thread> pool;
+        for (unsigned t = 1; t < jobs; ++t)
+            pool.emplace_back(worker, t);
+        worker(0); // 主執行緒也參與
+        for (auto &th : pool)
+            th.join();
+    }
+    double wall_ms = ms_since(t_all);
+    std::cout.rdbuf(saved);
+
+    // 依輸入順序報告，結果可直接 diff
+    size_t failed = 0;
+    double busy_ms = 0;
+    for (size_t k = 0; k < files.size(); ++k)
+    {
+        const BatchResult &r = results[k];
+        if (r.rc)
+            failed++;
+        busy_ms += r.compile_ms + r.run_ms;
+        std::printf("%-13s %9.3f ms compile %9.3f ms run %8zu bytes  %s%s%s\n", r.status.c_str(), r.compile_ms, r.run_ms,
+                    r.output.size(), files[k].c_str(), r.frontend.empty() ? "" : "  [", r.frontend.empty() ? "" : (r.frontend + "]").c_str());
+        if (!r.error.empty())
+            std::printf("    %s\n", r.error.c_str());
+        if (show_output && !r.output.empty())
+        {
+            std::fwrite(r.output.data(), 1, r.output.size(), stdout);
+            if (r.output.back() != '\n')
+                std::fputc('\n', stdout);
+        }
+        if (!out_dir.empty() && !r.rc)
+        {
+            std::ofstream of(fs::path(out_dir) / (fs::path(files[k]).filename().string() + ".out"), std::ios::binary);
+            of.write(r.output.data(), (std::streamsize)r.output.size());
+        }
+    }
+    std::printf("run-batch: %zu files, %zu ok, %zu failed, %u jobs, %.3f ms wall, %.3f ms busy\n",
+                files.size(), files.size() - failed, failed, jobs, wall_ms, busy_ms);
+    std::fflush(stdout);
+    if (vm_profile)
+    {
+        for (unsigned t = 1; t < jobs; ++t)
+            profiles[0].merge(profiles[t]);
+        report_vm_profile(profiles[0], vm_profile);
+    }
+    return failed ? 1 : 0;
+}
+
+// ---- Forward declarations for functions used by main/clean_project ----
+int initialize_project(bool verbose);
+int list_compilers(const CompilerRegistry &registry, bool verbose);
+int clean_project(bool verbose);
+bool matches_pattern(const std::string &filename, const std::string &pattern);
+
+// 新增：判斷此命令是否需要偵測外部編譯器
+static bool command_needs_compiler_detect(const std::string &cmd)
+{
+    return (cmd == "build" || cmd == "list" || cmd == "init");
+}
+
+static bool skip_detect_from_env()
+{
+    const char *v = std::getenv("ZHCL_SKIP_DETECT");
+    return (v && *v && (*v != '0'));
+}
+
+int main(int argc, char **argv)
+{
+#ifdef _WIN32
+    SetConsoleOutputCP(CP_UTF8);
+    SetConsoleCP(CP_UTF8);
+#endif
+
+    initialize_chinese_environment();
+
+    // 前端在第一次查詢時才註冊（見 frontend.cpp）
+
+    // ??main() ?脣暺????
+    int payload_rc = 0;
+    if (selfhost::maybe_run_embedded_payload(payload_rc))
+    {
+        return payload_rc; // 帶有 payload：執行完畢後以 VM 狀態碼結束
+    }
+
+    if (argc <= 1)
+    {
+        std::cout << "zhcl - Universal VM & Selfhost System v1.0" << std::endl;
+        std::cout << "Run any supported language via built-in VM, no external compilers needed" << std::endl;
+        std::cout << std::endl;
+        std::cout << "Usage: zhcl <command> [options]" << std::endl;
+        std::cout << std::endl;
+        std::cout << "Commands:" << std::endl;
+        std::cout << "  run <file>      Run file directly via VM (zh/c-lite/cpp-lite/js-lite)" << std::endl;
+        std::cout << "  run-batch <...> Run many files in-process (see --help)" << std::endl;
+        std::cout << "  compile <file>  Compile to a .zbc bytecode file (zhcl run accepts .zbc)" << std::endl;
+        std::cout << "  list-frontends  List available language frontends" << std::endl;
+        std::cout << "  selfhost        Self-contained executable generation" << std::endl;
+        std::cout << std::endl;
+        std::cout << "Selfhost Commands:" << std::endl;
+        std::cout << "  selfhost pack <input.(js|py|go|java|zh)> -o <output.exe>    Pack source into self-contained exe" << std::endl;
+        std::cout << "  selfhost verify <exe>                                      Verify exe integrity" << std::endl;
+        std::cout << "  selfhost explain <input.(js|py|go|java|zh|zbc)>            Show bytecode disassembly" << std::endl;
+        std::cout << std::endl;
+        std::cout << "Options:" << std::endl;
+        std::cout << "  --frontend=<name>  Force specific frontend (zh|c-lite|cpp-lite|js-lite)" << std::endl;
+        std::cout << "  --jit              Run via x86-64 JIT (falls back to interpreter)" << std::endl;
+        std::cout << "  -- <args...>       Pass integer arguments to VM slots (0,1,2,...)" << std::endl;
+        std::cout << std::endl;
+        std::cout << "Examples:" << std::endl;
+        std::cout << "  zhcl run hello.zh" << std::endl;
+        std::cout << "  zhcl run --frontend=c-lite hello.c" << std::endl;
+        std::cout << "  zhcl run script.zh -- 2025 3 20 16 0 0 -5" << std::endl;
+        std::cout << "  zhcl selfhost pack hello.js -o hello.exe" << std::endl;
+        std::cout << std::endl;
+        std::cout << "Supported: C/C++, Java, Python, Go, JavaScript, Chinese (.zh)" << std::endl;
+        std::cout << "No external compilers required - everything runs via built-in VM" << std::endl;
+        return 0;
+    }
+
+    std::string cmd = argv[1];
+
+    // 完全 VM 的安全路徑
+    if (cmd == "--help" || cmd == "-h")
+    {
+        // 上面已經處理了 argc <= 1 的情況，這裡重複一下
+        std::cout << "zhcl - Universal VM & Selfhost System v1.0" << std::endl;
+        std::cout << "Run any supported language via built-in VM, no external compilers needed" << std::endl;
+        std::cout << std::endl;
+        std::cout << "Usage: zhcl <command> [options]" << std::endl;
+        std::cout << std::endl;
+        std::cout << "Commands:" << std::endl;
+        std::cout << "  run <file>           Run file directly via VM (zh/c-lite/cpp-lite/js-lite)" << std::endl;
+        std::cout << "  run-batch <files...> Run many files in-process on a thread pool, report status/timing" << std::endl;
+        std::cout << "  compile <file> [-o out.zbc]  Compile once to a .zbc bytecode file; run/explain load it directly" << std::endl;
+        std::cout << "  list-frontends       List available language frontends" << std::endl;
+        std::cout << "  selfhost             Self-contained executable generation" << std::endl;
+        std::cout << std::endl;
+        std::cout << "Selfhost Commands:" << std::endl;
+        std::cout << "  selfhost pack <input> -o <output.exe>    Pack source into self-contained exe" << std::endl;
+        std::cout << "  selfhost verify <exe>                   Verify exe integrity (CRC32 check)" << std::endl;
+        std::cout << "  selfhost explain <input>                Show bytecode disassembly" << std::endl;
+        std::cout << std::endl;
+        std::cout << "Options:" << std::endl;
+        std::cout << "  --frontend=<name>    Force specific frontend (zh|c-lite|cpp-lite|js-lite)" << std::endl;
+        std::cout << "  --jit                Run via x86-64 JIT (falls back to interpreter if unsupported)" << std::endl;
+        std::cout << "  --jit=check          Run interpreter and JIT, compare output and slots" << std::endl;
+        std::cout << "  --aot                Tier up: run the cached native build, else interpret and compile it in the background" << std::endl;
+        std::cout << "  --no-cache           run/run-batch: bypass the compiled-bytecode cache" << std::endl;
+        std::cout << "  --vm-profile[=FILE]  Count executions/time per opcode and source line, print to stderr (JSON to FILE)" << std::endl;
+        std::cout << "  --vm-folded=FILE     Profile and write per-line folded stacks (flamegraph.pl input)" << std::endl;
+        std::cout << "  --keep-debug         selfhost pack / compile: keep the debug line table in the output" << std::endl;
+        std::cout << "  -- <args...>         Pass integer arguments to VM slots (0,1,2,...)" << std::endl;
+        std::cout << std::endl;
+        std::cout << "Examples:" << std::endl;
+        std::cout << "  zhcl run hello.zh" << std::endl;
+        std::cout << "  zhcl run --frontend=c-lite hello.c" << std::endl;
+        std::cout << "  zhcl run script.zh -- 2025 3 20 16 0 0 -5" << std::endl;
+        std::cout << "  zhcl run-batch --jobs=8 --out-dir=out tests/*.zh" << std::endl;
+        std::cout << "  zhcl run-batch --manifest=tests.txt --show-output" << std::endl;
+        std::cout << "  zhcl selfhost pack hello.js -o hello.exe" << std::endl;
+        std::cout << "  zhcl selfhost verify hello.exe" << std::endl;
+        std::cout << "  zhcl compile hello.zh -o hello.zbc && zhcl run hello.zbc" << std::endl;
+        std::cout << std::endl;
+        std::cout << "Standards Compatibility:" << std::endl;
+        std::cout << "  System: C11/C17/C23 and C++17/C++20/C++23 compatible" << std::endl;
+        std::cout << "  Generated code: C89/C90 standard for maximum compatibility" << std::endl;
+        std::cout << "  Encoding: UTF-8 native support" << std::endl;
+        std::cout << std::endl;
+        std::cout << "Documentation:" << std::endl;
+        std::cout << "  README.md        - Quick start guide and examples" << std::endl;
+        std::cout << "  PARAMETERS.md    - Detailed parameter reference (Chinese)" << std::endl;
+        std::cout << "  PARAMETERS_EN.md - Detailed parameter reference (English)" << std::endl;
+        std::cout << "  LANGUAGE.md      - Chinese language specification" << std::endl;
+        std::cout << std::endl;
+        std::cout << "Environment Variables:" << std::endl;
+        std::cout << "  ZHCL_SELFHOST_QUIET=1  - Suppress selfhost banner output" << std::endl;
+        std::cout << "  ZHCL_JIT=1|check       - JIT mode for `run` and packed executables" << std::endl;
+        std::cout << std::endl;
+        std::cout << "No external compilers required - everything runs via built-in VM" << std::endl;
+        return 0;
+    }
+
+    if (cmd == "list-frontends")
+    {
+        return cmd_list_frontends();
+    }
+    if (cmd == "run")
+    {
+        if (argc < 3)
+        {
+            std::cerr << "Usage: zhcl run <file> [--frontend=name] [--jit|--jit=check] [--aot] [--no-cache] [--vm-profile[=out.json]] [--vm-folded=out.folded] [-- args...]\n";
+            return 1;
+        }
+        std::string file;
+        std::string forced;
+        std::vector<std::string> extra_args;
+        selfhost::JitMode jit = selfhost::jit_mode_from_env();
+        std::string profile_json, folded;
+        bool profile = false;
+        bool aot = selfhost::aot_enabled_from_env();
+        bool use_cache = true;
+        for (int i = 2; i < argc; ++i)
+        {
+            std::string a = argv[i];
+            if (a.rfind("--frontend=", 0) == 0)
+            {
+                forced = a.substr(11);
+            }
+            else if (a == "--aot")
+            {
+                aot = true;
+            }
+            else if (a == "--no-aot")
+            {
+                aot = false;
+            }
+            else if (a == "--no-cache")
+            {
+                use_cache = false;
+            }
+            else if (a == "--vm-profile" || a.rfind("--vm-profile=", 0) == 0)
+            {
+                profile = true;
+                profile_json = a.size() > 12 ? a.substr(13) : "";
+            }
+            else if (a.rfind("--vm-folded=", 0) == 0)
+            {
+                profile = true;
+                folded = a.substr(12);
+            }
+            else if (a == "--jit")
+            {
+                jit = selfhost::JitMode::On;
+            }
+            else if (a == "--jit=check")
+            {
+                jit = selfhost::JitMode::Check;
+            }
+            else if (a == "--no-jit")
+            {
+                jit = selfhost::JitMode::Off;
+            }
+            else if (a == "--")
+            {
+                for (int j = i + 1; j < argc; ++j)
+                {
+                    extra_args.push_back(argv[j]);
+                }
+                break;
+            }
+            else if (file.empty())
+            {
+                file = a;
+            }
+            else
+            {
+                // 不支援額外的參數，除非是 -- 之後的
+                std::cerr << "Unexpected argument: " << a << "\n";
+                std::cerr << "Usage: zhcl run <file> [--frontend=name] [--jit|--jit=check] [--aot] [--no-cache] [--vm-profile[=out.json]] [--vm-folded=out.folded] [-- args...]\n";
+                return 1;
+            }
+        }
+        if (file.empty())
+        {
+            std::cerr << "Usage: zhcl run <file> [--frontend=name] [--jit|--jit=check] [--aot] [--no-cache] [--vm-profile[=out.json]] [--vm-folded=out.folded] [-- args...]\n";
+            return 1;
+        }
+        return cmd_run(file, forced, extra_args, jit, profile ? profile_json.c_str() : nullptr, folded, aot, use_cache);
+    }
+    if (cmd == "compile")
+    {
+        const char *usage = "Usage: zhcl compile <file> [-o out.zbc] [--frontend=name] [--keep-debug] [--no-cache]\n";
+        std::string file, out, forced;
+        bool keep_debug = false, use_cache = true;
+        for (int i = 2; i < argc; ++i)
+        {
+            std::string a = argv[i];
+            if (a == "-o" && i + 1 < argc)
+                out = argv[++i];
+            else if (a.rfind("--frontend=", 0) == 0)
+                forced = a.substr(11);
+            else if (a == "--keep-debug")
+                keep_debug = true;
+            else if (a == "--no-cache")
+                use_cache = false;
+            else if (file.empty() && a[0] != '-')
+                file = a;
+            else
+            {
+                std::cerr << "Unexpected argument: " << a << "\n" << usage;
+                return 1;
+            }
+        }
+        if (file.empty())
+        {
+            std::cerr << usage;
+            return 1;
+        }
+        if (out.empty())
+            out = fs::path(file).replace_extension(".zbc").string();
+        Bytecode bc;
+        const IFrontend *fe = nullptr;
+        std::string err;
+        if (int rc = compile_source(file, forced, bc, fe, err, use_cache))
+        {
+            std::cerr << err << "\n";
+            return rc;
+        }
+        // 與 cmd_run 相同：確保 OP_END 在最後；行表預設剝除（同 selfhost pack）
+        if (bc.data.empty() || bc.data.back() != 0x04)
+            bc.data.push_back(0x04);
+        if (!keep_debug)
+            selfhost::bcw::strip_debug(bc.data);
+        selfhost::VerifyError verr;
+        if (!selfhost::verify_bc(bc.data.data(), bc.data.size(), verr))
+        {
+            std::fprintf(stderr, "[zbc] bytecode rejected at offset %zu: %s\n", verr.offset, verr.message.c_str());
+            return selfhost::VM_REJECTED;
+        }
+        std::vector<uint8_t> z = selfhost::zbc_build(bc.data, fe->name(), file);
+        std::ofstream f(out, std::ios::binary | std::ios::trunc);
+        f.write((const char *)z.data(), (std::streamsize)z.size());
+        if (!f)
+        {
+            std::cerr << "[zbc] write failed: " << out << "\n";
+            return 5;
+        }
+        std::printf("[zbc] %s -> %s (frontend %s, %zu bytes)\n", file.c_str(), out.c_str(), fe->name().c_str(), z.size());
+        return 0;
+    }
+    if (cmd == "run-batch")
+    {
+        const char *usage = "Usage: zhcl run-batch [--jobs=N] [--frontend=name] [--jit|--jit=check|--no-jit]\n"
+                            "                      [--out-dir=DIR] [--show-output] [--no-cache] [--vm-profile[=out.json]]\n"
+                            "                      [--manifest=FILE] <files...>\n";
+        std::vector<std::string> files;
+        std::string forced, out_dir;
+        unsigned jobs = 0;
+        bool show_output = false;
+        selfhost::JitMode jit = selfhost::jit_mode_from_env();
+        std::string profile_json;
+        bool profile = false;
+        bool use_cache = true;
+        for (int i = 2; i < argc; ++i)
+        {
+            std::string a = argv[i];
+            if (a.rfind("--frontend=", 0) == 0)
+                forced = a.substr(11);
+            else if (a == "--no-cache")
+                use_cache = false;
+            else if (a.rfind("--jobs=", 0) == 0 || a.rfind("-j", 0) == 0)
+            {
+                try
+                {
+                    jobs = (unsigned)std::stoul(a.substr(a[1] == 'j' ? 2 : 7));
+                }
+                catch (...)
+                {
+                    std::cerr << "Invalid job count: " << a << "\n";
+                    return 1;
+                }
+            }
+            else if (a == "--jit")
+                jit = selfhost::JitMode::On;
+            else if (a == "--jit=check")
+                jit = selfhost::JitMode::Check;
+            else if (a == "--no-jit")
+                jit = selfhost::JitMode::Off;
+            else if (a.rfind("--out-dir=", 0) == 0)
+                out_dir = a.substr(10);
+            else if (a == "--show-output")
+                show_output = true;
+            else if (a == "--vm-profile" || a.rfind("--vm-profile=", 0) == 0)
+            {
+                profile = true;
+                profile_json = a.size() > 12 ? a.substr(13) : "";
+            }
+            else if (a.rfind("--manifest=", 0) == 0 || (a.size() > 1 && a[0] == '@'))
+            {
+                std::string m = a[0] == '@' ? a.substr(1) : a.substr(11);
+                if (!read_manifest(m, files))
+                {
+                    std::cerr << "read fail: " << m << "\n";
+                    return 1;
+                }
+            }
+            else if (a.rfind("--", 0) == 0)
+            {
+                std::cerr << "Unexpected argument: " << a << "\n" << usage;
+                return 1;
+            }
+            else
+                files.push_back(a);
+        }
+        if (files.empty())
+        {
+            std::cerr << usage;
+            return 1;
+        }
+        return cmd_run_batch(files, forced, jit, jobs, out_dir, show_output, profile ? profile_json.c_str() : nullptr,
+                             use_cache);
+    }
+    if (cmd == "selfhost")
+    {
+        if (argc < 3)
+        {
+            std::puts("Usage:\n  zhcl selfhost pack <input.(js|py|go|java|zh)> -o <output.exe>\n"
+                      "  zhcl selfhost verify <exe>\n"
+                      "  zhcl selfhost explain <input.(js|py|go|java|zh|zbc)>            Show bytecode disassembly");
+            return 1;
+        }
+        std::string sub = argv[2];
+        if (sub == "pack")
+        {
+            if (argc < 6 || std::string(argv[4]) != "-o")
+            {
+                std::puts("Usage:\n  zhcl selfhost pack <input.(js|py|go|java|zh)> -o <output.exe> [--keep-debug]");
+                return 2;
+            }
+            bool keep_debug = false;
+            for (int i = 6; i < argc; ++i)
+            {
+                if (std::string(argv[i]) == "--keep-debug")
+                    keep_debug = true;
+                else
+                {
+                    std::fprintf(stderr, "[selfhost] unexpected argument: %s\n", argv[i]);
+                    return 2;
+                }
+            }
+            fs::path in = argv[3];
+            fs::path out = argv[5];
+            std::string lang;
+            auto ext = in.extension().string();
+            if (ext == ".js")
+                lang = "js";
+            else if (ext == ".py")
+                lang = "py";
+            else if (ext == ".go")
+                lang = "go";
+            else if (ext == ".java")
+                lang = "java";
+            else if (ext == ".zh")
+                lang = "zh";
+            else
+            {
+                std::fprintf(stderr, "[selfhost] unsupported input: %s\n", ext.c_str());
+                return 2;
+            }
+            int rc = selfhost::pack_from_file(lang, in, out, keep_debug);
+            return rc;
+        }
+        else if (sub == "verify")
+        {
+            if (argc < 4)
+            {
+                std::puts("Usage:\n  zhcl selfhost verify <exe>");
+                return 2;
+            }
+            return selfhost::verify_exe(argv[3]);
+        }
+        else if (sub == "explain")
+        {
+            return selfhost::handle_selfhost_explain(argc, argv);
+        }
+        std::fprintf(stderr, "Unknown subcommand: selfhost %s\n", sub.c_str());
+        return 1;
+    }
+
+#if ZHCL_ENABLE_EXTERNAL_TOOLCHAIN
+    // （可選）外部編譯器相關子命令
+    // ... 保留舊邏輯 ...
+#else
+    // 關閉時，任何外部相關一律回覆提示
+    if (cmd == "list" || cmd == "build" || cmd == "init" || cmd == "clean")
+    {
+        std::cerr << "External toolchain is disabled. Use `run` or `selfhost pack`.\n";
+        return 2;
+    }
+#endif
+
+    // 直呼檔名的舊行為→全部改導到 VM
+    if (cmd.size() > 2 && cmd.find('.') != std::string::npos)
+    {
+        // 舊用法: zhcl hello.c → 現在直接以 VM 跑
+        return cmd_run(cmd, "", {});
+    }
+
+    std::cerr << "Unknown command. Try --help.\n";
+    return 1;
+}
+
+// ============================================================================
+// UTILITY FUNCTIONS
+// ============================================================================
+
+int initialize_project(bool verbose)
+{
+    if (verbose)
+        std::cout << "Initializing new zhcl project..." << std::endl;
+
+    // Create zhcl.toml
+    std::ofstream config("zhcl.toml");
+    config << "[project]\n";
+    config << "name = \"my_project\"\n";
+    config << "version = \"0.1.0\"\n";
+    config << "type = \"exe\"\n";
+    config << "\n[build]\n";
+    config << "compiler = \"auto\"\n";
+    config << "flags = []\n";
+    config << "\n[dependencies]\n";
+    config << "# Add dependencies here\n";
+    config.close();
+
+    // Create main.cpp
+    std::ofstream main_cpp("main.cpp");
+    main_cpp << "#include <iostream>\n";
+    main_cpp << "\n";
+    main_cpp << "int main() {\n";
+    main_cpp << "    std::cout << \"Hello, zhcl!\" << std::endl;\n";
+    main_cpp << "    return 0;\n";
+    main_cpp << "}\n";
+    main_cpp.close();
+
+    // Create README.md
+    std::ofstream readme("README.md");
+    readme << "# My zhcl Project\n";
+    readme << "\n";
+    readme << "Built with zhcl - the universal compiler.\n";
+    readme << "\n";
+    readme << "## Building\n";
+    readme << "```\n";
+    readme << "zhcl build\n";
+    readme << "```\n";
+    readme << "\n";
+    readme << "## Running\n";
+    readme << "```\n";
+    readme << "zhcl run main.cpp\n";
+    readme << "```\n";
+    readme.close();
+
+    if (verbose)
+        std::cout << "Created zhcl.toml, main.cpp, and README.md" << std::endl;
+    return 0;
+}
+
+int list_compilers(const CompilerRegistry &registry, bool verbose)
+{
+    // Only show built-in supported languages (no external dependencies needed)
+    std::cout << "Built-in supported languages (no external dependencies):" << std::endl;
+    std::cout << "  ?批遣 C/C++ (via MSVC/gcc detection)" << std::endl;
+    std::cout << "  ?批遣 Java (bytecode generation)" << std::endl;
+    std::cout << "  ?批遣 Go (translation to C++)" << std::endl;
+    std::cout << "  ?批遣 Chinese (.zh files) - 蝜??芸?嚗撓??摮葡/?湔/閮剔/憒?/?血?/??蝯?" << std::endl;
+    std::cout << "  ?批遣 Python (translation to C++)" << std::endl;
+    std::cout << "  ?批遣 JavaScript (translation to C++)" << std::endl;
+
+    return 0;
+}
+
+int clean_project(bool verbose)
+{
+    if (verbose)
+        std::cout << "Cleaning build artifacts..." << std::endl;
+
+    std::vector<std::string> patterns = {"*.exe", "*.obj", "*.o", "*.class", "*.pyc", "__pycache__"};
+
+    for (const auto &pattern : patterns)
+    {
+        for (const auto &entry : fs::recursive_directory_iterator("."))
+        {
+            std::string filename = entry.path().filename().string();
+            if (fs::is_regular_file(entry.path()))
+            {
+                if (matches_pattern(filename, pattern))
+                {
+                    fs::remove(entry.path());
+                    if (verbose)
+                        std::cout << "Removed: " << entry.path() << std::endl;
+                }
+            }
+            else if (fs::is_directory(entry.path()) && filename == "__pycache__")
+            {
+                fs::remove_all(entry.path());
+                if (verbose)
+                    std::cout << "Removed directory: " << entry.path() << std::endl;
+            }
+        }
+    }
+
+    return 0;
+}
+
+bool matches_pattern(const std::string &filename, const std::string &pattern)
+{
+    if (pattern == "*.exe")
+        return filename.find(".exe") != std::string::npos;
+    if (pattern == "*.obj")
+        return filename.find(".obj") != std::string::npos;
+    if (pattern == "*.o")
+        return filename.find(".o") != std::string::npos;
+    if (pattern == "*.class")
+        return filename.find(".class") != std::string::npos;
+    if (pattern == "*.pyc")
+        return filename.find(".pyc") != std::string::npos;
+    return false;
+}
@@ -0,0 +1,80 @@
+#!/usr/bin/env python3
+"""
+zhcl 冷啟動延遲測試
+反覆啟動 zhcl（原版與打包後的執行檔），量測每次從建立行程到結束的牆鐘時間
+"""
+
+import argparse
+import os
+import statistics
+import subprocess
+import sys
+import tempfile
+import time
+from pathlib import Path
+
+HELLO_ZH = '輸出("你好")\n'
+
+
+def measure(cmd, runs, warmup, env):
+    """執行 cmd 共 warmup + runs 次，回傳後 runs 次的耗時（毫秒）"""
+    times = []
+    for i in range(warmup + runs):
+        t0 = time.perf_counter()
+        r = subprocess.run(cmd, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL, stdin=subprocess.DEVNULL, env=env)
+        dt = (time.perf_counter() - t0) * 1000.0
+        if r.returncode != 0:
+            raise RuntimeError(f"{' '.join(map(str, cmd))} 結束碼 {r.returncode}")
+        if i >= warmup:
+            times.append(dt)
+    return times
+
+
+def report(name, times):
+    times = sorted(times)
+    p95 = times[min(len(times) - 1, int(len(times) * 0.95))]
+    print(f"{name:<28} min {times[0]:8.2f}  median {statistics.median(times):8.2f}  p95 {p95:8.2f}  ms")
+
+
+def main():
+    ap = argparse.ArgumentParser(description="zhcl 冷啟動延遲測試")
+    ap.add_argument("zhcl", help="zhcl 執行檔路徑")
+    ap.add_argument("-n", "--runs", type=int, default=200, help="每個情境的量測次數（預設 200）")
+    ap.add_argument("--warmup", type=int, default=10, help="不計入的暖身次數（預設 10）")
+    ap.add_argument("--source", help="run / pack 使用的原始檔（預設為內建的 hello.zh）")
+    args = ap.parse_args()
+
+    zhcl = Path(args.zhcl).resolve()
+    if not zhcl.exists():
+        print(f"找不到 {zhcl}", file=sys.stderr)
+        return 1
+
+    with tempfile.TemporaryDirectory() as tmp:
+        tmp = Path(tmp)
+        src = Path(args.source).resolve() if args.source else tmp / "hello.zh"
+        if not args.source:
+            src.write_text(HELLO_ZH, encoding="utf-8")
+        packed = tmp / ("hello_packed.exe" if os.name == "nt" else "hello_packed")
+
+        # 獨立的快取目錄：run 的第一次編譯在暖身中寫入快取，之後量的是命中的情況
+        env = dict(os.environ, ZHCL_CACHE_DIR=str(tmp / "cache"))
+        r = subprocess.run([zhcl, "selfhost", "pack", src, "-o", packed], stdout=subprocess.DEVNULL, env=env)
+        if r.returncode != 0:
+            print("selfhost pack 失敗", file=sys.stderr)
+            return 1
+        packed.chmod(0o755)
+
+        cases = [
+            ("zhcl --help", [zhcl, "--help"]),
+            ("zhcl list-frontends", [zhcl, "list-frontends"]),
+            ("zhcl run " + src.name, [zhcl, "run", src]),
+            ("packed " + src.stem, [packed]),
+        ]
+        print(f"{zhcl}  runs={args.runs} warmup={args.warmup}")
+        for name, cmd in cases:
+            report(name, measure(cmd, args.runs, args.warmup, env))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())